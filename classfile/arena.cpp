@@ -0,0 +1,22 @@
+#include "arena.h"
+
+namespace kh::arena {
+
+Arena::Arena()
+    : buffers_(std::deque<std::vector<std::byte>>{})
+    , strings_(std::deque<std::string>{}) {}
+
+auto Arena::clear() noexcept -> void {
+    buffers_.clear();
+    strings_.clear();
+}
+
+auto Arena::store(std::vector<std::byte>&& buffer) -> std::span<const std::byte> {
+    return buffers_.emplace_back(std::move(buffer));
+}
+
+auto Arena::store(std::string&& text) -> std::string_view {
+    return strings_.emplace_back(std::move(text));
+}
+
+} // namespace kh::arena
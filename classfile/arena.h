@@ -0,0 +1,33 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <deque>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace kh::arena {
+
+// NOTE(garrett): Class file structures only hold views onto their backing
+// data, so anything generated after parsing needs an owner that never moves
+// its contents around.
+class Arena {
+private:
+    std::deque<std::vector<std::byte>> buffers_;
+    std::deque<std::string> strings_;
+public:
+    Arena();
+
+    auto store(std::vector<std::byte>&&) -> std::span<const std::byte>;
+    auto store(std::string&&) -> std::string_view;
+
+    // NOTE(garrett): Invalidates every view handed out so far, letting one
+    // arena be reused across many short-lived classes
+    auto clear() noexcept -> void;
+};
+
+} // namespace kh::arena
+
+#endif // ARENA_H
@@ -0,0 +1,362 @@
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <future>
+#include <optional>
+
+#include "batch.h"
+#include "hashing.h"
+#include "parsing.h"
+#include "serialization.h"
+
+namespace kh::jvm::batch {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Outcome {
+    // NOTE(garrett): The original bytes when the class failed to parse or
+    // transform, empty when it couldn't be read at all
+    std::vector<std::byte> output;
+    std::size_t input_size;
+    std::array<std::chrono::nanoseconds, 5> stages;
+    std::optional<Failure> failure;
+    bool cached;
+};
+
+struct Job {
+    std::string name;
+    std::filesystem::path path;
+    // NOTE(garrett): Set when reading from an archive instead of a directory
+    const kh::jvm::jar::Entry* entry;
+};
+
+// NOTE(garrett): Every pool thread keeps its own input buffer and arena alive
+// across classes instead of allocating fresh ones per class
+struct Worker {
+    std::vector<std::byte> input;
+    kh::arena::Arena arena;
+};
+
+auto read_file(const std::filesystem::path& path, std::vector<std::byte>& contents) -> bool {
+    auto file = std::ifstream{path, std::ios::binary | std::ios::ate};
+
+    if (!file) {
+        return false;
+    }
+
+    const auto size = file.tellg();
+
+    if (size < 0) {
+        return false;
+    }
+
+    contents.resize(static_cast<std::size_t>(size));
+    file.seekg(0, std::ios::beg);
+
+    return static_cast<bool>(
+        file.read(reinterpret_cast<char*>(contents.data()), size)
+    );
+}
+
+// NOTE(garrett): Combines every transform's name and fingerprint in order
+auto fingerprint(std::span<const Transform> transforms) noexcept -> std::uint64_t {
+    auto combined = std::uint64_t{0u};
+
+    for (const auto& transform : transforms) {
+        combined = kh::hashing::xxh64(std::as_bytes(std::span{transform.name}), combined);
+        combined = kh::hashing::xxh64(
+            std::as_bytes(std::span{&transform.fingerprint, 1u}),
+            combined
+        );
+    }
+
+    return combined;
+}
+
+// NOTE(garrett): `load` fills the worker's buffer, or returns a view of input
+// that's already in memory, such as a stored archive entry
+template <typename Load>
+auto process(
+        Load&& load,
+        std::string name,
+        std::span<const Transform> transforms,
+        kh::cache::Cache* cache,
+        const std::uint64_t fingerprint) -> Outcome {
+    thread_local auto worker = Worker{std::vector<std::byte>{}, kh::arena::Arena{}};
+
+    auto outcome = Outcome{
+        std::vector<std::byte>{},
+        0u,
+        std::array<std::chrono::nanoseconds, 5>{},
+        std::nullopt,
+        false
+    };
+
+    auto stage = [&outcome, last = Clock::now()](const Stage completed) mutable {
+        const auto now = Clock::now();
+
+        outcome.stages[static_cast<std::size_t>(completed)] += now - last;
+        last = now;
+    };
+
+    const auto input = load(worker.input);
+
+    if (!input) {
+        outcome.failure = Failure{std::move(name), Error::ReadFailed, 0u};
+        return outcome;
+    }
+
+    outcome.input_size = input->size();
+    stage(Stage::Read);
+
+    auto key = kh::cache::Key{};
+
+    if (cache) {
+        key = kh::cache::key(input.value(), fingerprint);
+
+        // NOTE(garrett): The cache only saves work, so a lookup that fails on
+        // I/O is treated as a miss rather than failing the class
+        auto cached = std::optional<std::vector<std::byte>>{};
+
+        try {
+            cached = cache->find(key);
+        } catch (const std::exception&) {
+            cached.reset();
+        }
+
+        stage(Stage::Cache);
+
+        if (cached) {
+            outcome.output = std::move(cached.value());
+            outcome.cached = true;
+
+            return outcome;
+        }
+    }
+
+    auto fail = [&outcome, &name, &input](const Error error, const std::size_t transform) {
+        outcome.output.assign(input->begin(), input->end());
+        outcome.failure = Failure{std::move(name), error, transform};
+
+        return std::move(outcome);
+    };
+
+    // NOTE(garrett): Parsing doesn't check references between entries, so
+    // transforms and serialization can still throw on a malformed class
+    // when they resolve one. Exceptions are pinned on the step that raised
+    // them, so a single class never takes down the batch.
+    auto error = Error::ParseFailed;
+    auto transform = 0uz;
+
+    try {
+        auto reader = kh::reader::Reader{input.value()};
+        auto klass = kh::jvm::parsing::parse_class_file(reader);
+        stage(Stage::Parse);
+
+        if (!klass) {
+            return fail(Error::ParseFailed, 0u);
+        }
+
+        worker.arena.clear();
+        error = Error::TransformFailed;
+
+        for (; transform < transforms.size(); ++transform) {
+            if (!transforms[transform].apply(klass.value(), worker.arena)) {
+                return fail(Error::TransformFailed, transform);
+            }
+        }
+
+        stage(Stage::Transform);
+
+        // NOTE(garrett): Serialization only throws on references that were
+        // already broken in the input
+        error = Error::ParseFailed;
+        transform = 0u;
+
+        outcome.output.resize(kh::jvm::serialization::serialized_size(klass.value()));
+
+        auto sink = kh::sinks::SpanSink{outcome.output};
+        kh::jvm::serialization::serialize(sink, klass.value());
+        stage(Stage::Serialize);
+    } catch (const std::exception&) {
+        return fail(error, transform);
+    }
+
+    if (cache) {
+        try {
+            static_cast<void>(cache->insert(key, outcome.output));
+        } catch (const std::exception&) {
+            // NOTE(garrett): Likewise, the class is still written uncached
+        }
+
+        stage(Stage::Cache);
+    }
+
+    return outcome;
+}
+
+} // namespace
+
+auto collect(const std::filesystem::path& directory) -> std::vector<std::filesystem::path> {
+    auto paths = std::vector<std::filesystem::path>{};
+
+    for (const auto& entry : std::filesystem::recursive_directory_iterator{directory}) {
+        if (entry.is_regular_file() && entry.path().extension() == ".class") {
+            paths.push_back(entry.path().lexically_relative(directory));
+        }
+    }
+
+    std::ranges::sort(paths);
+    return paths;
+}
+
+auto run(
+        const std::filesystem::path& input,
+        std::span<const Transform> transforms,
+        kh::jvm::jar::Writer& output,
+        kh::threading::ThreadPool& pool,
+        kh::cache::Cache* cache) -> std::expected<Report, kh::jvm::jar::Error> {
+    const auto start = Clock::now();
+    const auto combined = fingerprint(transforms);
+
+    auto report = Report{
+        0u,
+        0u,
+        0u,
+        0u,
+        std::chrono::nanoseconds{0},
+        std::array<std::chrono::nanoseconds, 5>{},
+        std::vector<Failure>{}
+    };
+
+    auto archive = std::optional<kh::jvm::jar::Archive>{};
+    auto jobs = std::vector<Job>{};
+
+    if (std::filesystem::is_directory(input)) {
+        for (const auto& path : collect(input)) {
+            jobs.push_back(Job{path.generic_string(), input / path, nullptr});
+        }
+    } else {
+        auto opened = kh::jvm::jar::Archive::open(input);
+
+        if (!opened) {
+            return std::unexpected(opened.error());
+        }
+
+        archive.emplace(std::move(opened.value()));
+
+        for (const auto& entry : archive->entries()) {
+            jobs.push_back(Job{std::string{entry.name}, std::filesystem::path{}, &entry});
+        }
+    }
+
+    const auto submit = [&](const Job& job) -> std::future<Outcome> {
+        if (!job.entry) {
+            return pool.submit([&job, transforms, cache, combined] {
+                const auto load = [&job](std::vector<std::byte>& buffer)
+                        -> std::optional<std::span<const std::byte>> {
+                    if (!read_file(job.path, buffer)) {
+                        return std::nullopt;
+                    }
+
+                    return buffer;
+                };
+
+                return process(load, job.name, transforms, cache, combined);
+            });
+        }
+
+        // NOTE(garrett): Resources and directories are copied over untouched
+        if (!job.name.ends_with(".class")) {
+            return std::future<Outcome>{};
+        }
+
+        return pool.submit([&job, &archive, transforms, cache, combined] {
+            const auto load = [&job, &archive](std::vector<std::byte>& buffer)
+                    -> std::optional<std::span<const std::byte>> {
+                const auto extracted = archive->extract(*job.entry, buffer);
+
+                if (!extracted) {
+                    return std::nullopt;
+                }
+
+                return extracted.value();
+            };
+
+            return process(load, job.name, transforms, cache, combined);
+        });
+    };
+
+    // NOTE(garrett): Results are consumed in order, so a window a few times
+    // the pool size keeps workers busy behind a slow class without holding
+    // the whole corpus in memory
+    const auto window = 4u * pool.size();
+    auto pending = std::deque<std::future<Outcome>>{};
+    auto next = 0uz;
+
+    // NOTE(garrett): Queued tasks reference the jobs and archive, so they're
+    // waited on however the loop is left, including by an exception
+    struct Drain {
+        std::deque<std::future<Outcome>>& pending;
+
+        ~Drain() {
+            for (auto& future : pending) {
+                if (future.valid()) {
+                    future.wait();
+                }
+            }
+        }
+    };
+
+    const auto drain = Drain{pending};
+
+    for (const auto& job : jobs) {
+        for (; next < jobs.size() && pending.size() < window; ++next) {
+            pending.push_back(submit(jobs[next]));
+        }
+
+        auto future = std::move(pending.front());
+        pending.pop_front();
+
+        if (!future.valid()) {
+            if (const auto copied = output.copy(*archive, *job.entry); !copied) {
+                return std::unexpected(copied.error());
+            }
+
+            continue;
+        }
+
+        auto outcome = future.get();
+
+        for (auto j = 0uz; j < outcome.stages.size(); ++j) {
+            report.stages[j] += outcome.stages[j];
+        }
+
+        report.input_bytes += outcome.input_size;
+
+        if (outcome.failure) {
+            report.failures.push_back(std::move(outcome.failure.value()));
+        } else {
+            ++report.classes;
+            report.cached += outcome.cached;
+        }
+
+        if (outcome.output.empty()) {
+            continue;
+        }
+
+        report.output_bytes += outcome.output.size();
+
+        if (const auto added = output.add(job.name, std::move(outcome.output)); !added) {
+            return std::unexpected(added.error());
+        }
+    }
+
+    report.elapsed = Clock::now() - start;
+    return report;
+}
+
+} // namespace kh::jvm::batch
@@ -0,0 +1,123 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "arena.h"
+#include "cache.h"
+#include "classfile.h"
+#include "jar.h"
+#include "threading.h"
+
+namespace kh::jvm::batch {
+
+enum Error {
+    ParseFailed,
+    ReadFailed,
+    TransformFailed
+};
+
+enum class Stage : std::uint8_t {
+    Read,
+    Cache,
+    Parse,
+    Transform,
+    Serialize
+};
+
+constexpr auto name(const Error error) noexcept -> std::string_view {
+    switch (error) {
+        case Error::ParseFailed:
+            return "Class file could not be parsed";
+        case Error::ReadFailed:
+            return "Class file could not be read";
+        case Error::TransformFailed:
+            return "Transform failed";
+    }
+
+    return "Unknown error";
+}
+
+constexpr auto name(const Stage stage) noexcept -> std::string_view {
+    switch (stage) {
+        case Stage::Read:
+            return "Read";
+        case Stage::Cache:
+            return "Cache";
+        case Stage::Parse:
+            return "Parse";
+        case Stage::Transform:
+            return "Transform";
+        case Stage::Serialize:
+            return "Serialize";
+    }
+
+    return "Unknown";
+}
+
+// NOTE(garrett): Transforms run concurrently on every worker, so `apply` must
+// be safe to call from several threads at once. Anything it generates belongs
+// in the arena it's handed, which is reset between classes. `fingerprint`
+// should change whenever the transform's output would, since it's part of the
+// key for cached results.
+struct Transform {
+    std::string_view name;
+    std::function<bool(kh::jvm::classfile::ClassFile&, kh::arena::Arena&)> apply;
+    std::uint64_t fingerprint = 0u;
+};
+
+struct Failure {
+    std::string name;
+    Error error;
+    // NOTE(garrett): Index of the failing transform for TransformFailed
+    std::size_t transform;
+};
+
+struct Report {
+    std::size_t classes;
+    // NOTE(garrett): Classes whose output came from the cache, which are also
+    // counted in `classes`
+    std::size_t cached;
+    std::size_t input_bytes;
+    std::size_t output_bytes;
+    std::chrono::nanoseconds elapsed;
+    // NOTE(garrett): Summed across workers, so these add up to more than
+    // `elapsed` when running in parallel
+    std::array<std::chrono::nanoseconds, 5> stages;
+    std::vector<Failure> failures;
+};
+
+// NOTE(garrett): Paths of every class file below `directory` relative to it,
+// sorted so output order doesn't depend on the filesystem.
+auto collect(const std::filesystem::path& directory) -> std::vector<std::filesystem::path>;
+
+// NOTE(garrett): Reads, parses, transforms and serializes every class in
+// `input` on `pool`, adding the results to `output` in a deterministic order.
+// Directories are walked in the order given by `collect`. Anything else is
+// read as a jar, in the order of its central directory, with other entries
+// copied over as they are. Classes that fail to parse or transform are
+// reported and copied to the output unmodified, only classes that can't be
+// read are left out. Errors from `output` or from opening the jar end the
+// batch. With a `cache`, classes are looked up by their bytes and the
+// transforms' names and fingerprints before parsing, and transformed classes
+// are added to it. Failing to add to the cache is ignored.
+auto run(
+        const std::filesystem::path& input,
+        std::span<const Transform>,
+        kh::jvm::jar::Writer& output,
+        kh::threading::ThreadPool&,
+        kh::cache::Cache* cache = nullptr) -> std::expected<Report, kh::jvm::jar::Error>;
+
+} // namespace kh::jvm::batch
+
+#endif // BATCH_H
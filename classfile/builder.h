@@ -0,0 +1,287 @@
+#ifndef BUILDER_H
+#define BUILDER_H
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "bytecode.h"
+#include "classfile.h"
+#include "serialization.h"
+#include "sinks.h"
+
+namespace kh::jvm::builder {
+
+// NOTE(garrett): A constexpr counterpart to `ClassFile` for small helper
+// classes that get injected alongside instrumented code. Everything here can
+// run in a constant expression, so mistakes such as overflowing the constant
+// pool fail the build rather than surfacing at runtime.
+class ClassBuilder {
+private:
+    struct MethodDefinition {
+        std::uint16_t access_flags;
+        std::uint16_t name_index;
+        std::uint16_t descriptor_index;
+        std::uint16_t max_stack;
+        std::uint16_t max_locals;
+        std::vector<std::byte> bytecode;
+    };
+
+    std::vector<kh::jvm::constant_pool::Entry> entries_;
+    std::vector<std::uint16_t> indices_;
+    std::uint16_t count_;
+    kh::jvm::classfile::Version version_;
+    std::uint16_t access_flags_;
+    std::uint16_t class_index_;
+    std::uint16_t superclass_index_;
+    std::vector<std::uint16_t> interfaces_;
+    std::vector<kh::jvm::field::Field> fields_;
+    std::vector<MethodDefinition> methods_;
+    std::uint16_t code_index_;
+
+    constexpr auto code_attribute_size(const MethodDefinition& method) const -> std::uint32_t {
+        auto sink = kh::sinks::CountingSink{};
+
+        kh::jvm::serialization::serialize(
+            sink,
+            kh::jvm::code::Code{
+                method.max_stack,
+                method.max_locals,
+                method.bytecode,
+                std::vector<kh::jvm::code::ExceptionHandler>{},
+                std::vector<kh::jvm::attribute::Attribute>{}
+            }
+        );
+
+        return static_cast<std::uint32_t>(sink.size());
+    }
+public:
+    constexpr ClassBuilder(
+            std::string_view name,
+            std::string_view superclass = "java/lang/Object")
+        : entries_(std::vector<kh::jvm::constant_pool::Entry>{})
+        , indices_(std::vector<std::uint16_t>{})
+        , count_(1u)
+        , version_(kh::jvm::classfile::Version{55u, 0u})
+        , access_flags_(
+            static_cast<std::uint16_t>(kh::jvm::classfile::AccessFlags::ACC_PUBLIC)
+                | static_cast<std::uint16_t>(kh::jvm::classfile::AccessFlags::ACC_FINAL)
+                | static_cast<std::uint16_t>(kh::jvm::classfile::AccessFlags::ACC_SUPER)
+                | static_cast<std::uint16_t>(kh::jvm::classfile::AccessFlags::ACC_SYNTHETIC)
+        )
+        , class_index_(0u)
+        , superclass_index_(0u)
+        , interfaces_(std::vector<std::uint16_t>{})
+        , fields_(std::vector<kh::jvm::field::Field>{})
+        , methods_(std::vector<MethodDefinition>{})
+        , code_index_(0u) {
+        class_index_ = class_entry(name);
+        superclass_index_ = class_entry(superclass);
+    }
+
+    constexpr auto access_flags(const std::uint16_t flags) -> ClassBuilder& {
+        access_flags_ = flags;
+        return *this;
+    }
+
+    constexpr auto version(const kh::jvm::classfile::Version version) -> ClassBuilder& {
+        version_ = version;
+        return *this;
+    }
+
+    constexpr auto add(const kh::jvm::constant_pool::Entry entry) -> std::uint16_t {
+        for (auto i = 0uz; i < entries_.size(); ++i) {
+            if (entries_[i] == entry) {
+                return indices_[i];
+            }
+        }
+
+        const auto width = kh::jvm::constant_pool::is_wide(entry) ? 2u : 1u;
+
+        if (count_ + width > 0xFFFF) {
+            throw std::length_error("Constant pool overflow");
+        }
+
+        const auto index = count_;
+
+        entries_.push_back(entry);
+        indices_.push_back(index);
+        count_ = static_cast<std::uint16_t>(count_ + width);
+
+        return index;
+    }
+
+    constexpr auto utf8(std::string_view text) -> std::uint16_t {
+        return add(kh::jvm::constant_pool::UTF8Entry{text});
+    }
+
+    constexpr auto class_entry(std::string_view name) -> std::uint16_t {
+        return add(kh::jvm::constant_pool::ClassEntry{utf8(name)});
+    }
+
+    constexpr auto string_entry(std::string_view text) -> std::uint16_t {
+        return add(kh::jvm::constant_pool::StringEntry{utf8(text)});
+    }
+
+    constexpr auto name_and_type(std::string_view name, std::string_view descriptor)
+            -> std::uint16_t {
+        return add(
+            kh::jvm::constant_pool::NameAndTypeEntry{utf8(name), utf8(descriptor)}
+        );
+    }
+
+    constexpr auto field_reference(
+            std::string_view class_name,
+            std::string_view name,
+            std::string_view descriptor) -> std::uint16_t {
+        return add(
+            kh::jvm::constant_pool::FieldReferenceEntry{
+                class_entry(class_name),
+                name_and_type(name, descriptor)
+            }
+        );
+    }
+
+    constexpr auto method_reference(
+            std::string_view class_name,
+            std::string_view name,
+            std::string_view descriptor) -> std::uint16_t {
+        return add(
+            kh::jvm::constant_pool::MethodReferenceEntry{
+                class_entry(class_name),
+                name_and_type(name, descriptor)
+            }
+        );
+    }
+
+    constexpr auto this_class() const noexcept -> std::uint16_t {
+        return class_index_;
+    }
+
+    constexpr auto interface(std::string_view name) -> ClassBuilder& {
+        interfaces_.push_back(class_entry(name));
+        return *this;
+    }
+
+    constexpr auto field(
+            const std::uint16_t access_flags,
+            std::string_view name,
+            std::string_view descriptor) -> ClassBuilder& {
+        fields_.push_back(
+            kh::jvm::field::Field{
+                access_flags,
+                utf8(name),
+                utf8(descriptor),
+                std::vector<kh::jvm::attribute::Attribute>{},
+                std::span<const std::byte>{}
+            }
+        );
+
+        return *this;
+    }
+
+    // NOTE(garrett): Helper methods are expected to be straight-line code, as
+    // no StackMapTable is emitted for them.
+    constexpr auto method(
+            const std::uint16_t access_flags,
+            std::string_view name,
+            std::string_view descriptor,
+            const std::uint16_t max_stack,
+            const std::uint16_t max_locals,
+            kh::jvm::bytecode::Assembler&& code) -> ClassBuilder& {
+        if (code.size() == 0 || code.size() > 0xFFFF) {
+            throw std::length_error("Method code must be between 1 and 65535 bytes");
+        }
+
+        code_index_ = utf8("Code");
+
+        methods_.push_back(
+            MethodDefinition{
+                access_flags,
+                utf8(name),
+                utf8(descriptor),
+                max_stack,
+                max_locals,
+                code.take()
+            }
+        );
+
+        return *this;
+    }
+
+    constexpr auto write(kh::sinks::Sink auto& sink) const -> void {
+        sink.write(static_cast<std::uint32_t>(0xCAFEBABE));
+        sink.write(version_.minor);
+        sink.write(version_.major);
+        sink.write(count_);
+
+        for (const auto& entry : entries_) {
+            std::visit([&sink](const auto& e) {
+                kh::jvm::serialization::serialize(sink, e);
+            }, entry);
+        }
+
+        sink.write(access_flags_);
+        sink.write(class_index_);
+        sink.write(superclass_index_);
+        sink.write(static_cast<std::uint16_t>(interfaces_.size()));
+
+        for (const auto interface : interfaces_) {
+            sink.write(interface);
+        }
+
+        sink.write(static_cast<std::uint16_t>(fields_.size()));
+
+        for (const auto& field : fields_) {
+            kh::jvm::serialization::serialize(sink, field);
+        }
+
+        sink.write(static_cast<std::uint16_t>(methods_.size()));
+
+        for (const auto& method : methods_) {
+            sink.write(method.access_flags);
+            sink.write(method.name_index);
+            sink.write(method.descriptor_index);
+            sink.write(static_cast<std::uint16_t>(1u));
+            sink.write(code_index_);
+            sink.write(code_attribute_size(method));
+
+            kh::jvm::serialization::serialize(
+                sink,
+                kh::jvm::code::Code{
+                    method.max_stack,
+                    method.max_locals,
+                    method.bytecode,
+                    std::vector<kh::jvm::code::ExceptionHandler>{},
+                    std::vector<kh::jvm::attribute::Attribute>{}
+                }
+            );
+        }
+
+        sink.write(static_cast<std::uint16_t>(0u));
+    }
+};
+
+template <auto build>
+constexpr auto serialized_size() -> std::size_t {
+    auto sink = kh::sinks::CountingSink{};
+    build().write(sink);
+
+    return sink.size();
+}
+
+// NOTE(garrett): Runs `build` twice during compilation, once to size the
+// output and once to fill it, yielding the finished class file bytes.
+template <auto build>
+consteval auto embed() -> std::array<std::byte, serialized_size<build>()> {
+    auto sink = kh::sinks::ArraySink<serialized_size<build>()>{};
+    build().write(sink);
+
+    return sink.take();
+}
+
+} // namespace kh::jvm::builder
+
+#endif // BUILDER_H
@@ -0,0 +1,162 @@
+#include <bit>
+
+#include "bytecode.h"
+#include "reader.h"
+
+namespace kh::jvm::bytecode {
+
+auto decode(std::span<const std::byte> code)
+        -> std::expected<std::vector<Instruction>, Error> {
+    auto instructions = std::vector<Instruction>{};
+    auto offset = 0u;
+
+    while (offset < code.size()) {
+        const auto length = instruction_length(code, offset);
+
+        if (!length) {
+            return std::unexpected(length.error());
+        }
+
+        instructions.push_back(
+            Instruction{
+                offset,
+                length.value(),
+                static_cast<Opcode>(code[offset])
+            }
+        );
+
+        offset += length.value();
+    }
+
+    return instructions;
+}
+
+auto switch_length(std::span<const std::byte> code, const uint32_t offset)
+        -> std::expected<uint32_t, Error> {
+    const auto operands_offset = offset + 1 + switch_padding(offset);
+    const auto opcode = static_cast<Opcode>(code[offset]);
+
+    // NOTE(garrett): Default offset followed by either low/high or the
+    // match-offset pair count
+    const auto fixed_size = 3 * sizeof(std::uint32_t);
+
+    if (operands_offset + fixed_size > code.size()) {
+        return std::unexpected(Error::Truncated);
+    }
+
+    auto reader = kh::reader::Reader{code.subspan(operands_offset, fixed_size)};
+    reader.read_unchecked<std::uint32_t>();
+
+    auto length = 0ull;
+
+    if (opcode == Opcode::TABLESWITCH) {
+        const auto low = static_cast<std::int32_t>(reader.read_unchecked<std::uint32_t>());
+        const auto high = static_cast<std::int32_t>(reader.read_unchecked<std::uint32_t>());
+
+        if (high < low) {
+            return std::unexpected(Error::Truncated);
+        }
+
+        length = fixed_size
+            + (static_cast<std::int64_t>(high) - low + 1) * sizeof(std::uint32_t);
+    } else {
+        const auto pairs = static_cast<std::int32_t>(reader.read_unchecked<std::uint32_t>());
+
+        if (pairs < 0) {
+            return std::unexpected(Error::Truncated);
+        }
+
+        length = 2 * sizeof(std::uint32_t) + pairs * 2ull * sizeof(std::uint32_t);
+    }
+
+    if (operands_offset + length > code.size()) {
+        return std::unexpected(Error::Truncated);
+    }
+
+    return static_cast<uint32_t>(operands_offset + length - offset);
+}
+
+auto instruction_length(std::span<const std::byte> code, const uint32_t offset)
+        -> std::expected<uint32_t, Error> {
+    if (offset >= code.size()) {
+        return std::unexpected(Error::Truncated);
+    }
+
+    const auto opcode = static_cast<Opcode>(code[offset]);
+    auto length = 1u;
+
+    switch (opcode) {
+        case Opcode::BIPUSH:
+        case Opcode::LDC:
+        case Opcode::ILOAD:
+        case Opcode::LLOAD:
+        case Opcode::FLOAD:
+        case Opcode::DLOAD:
+        case Opcode::ALOAD:
+        case Opcode::ISTORE:
+        case Opcode::LSTORE:
+        case Opcode::FSTORE:
+        case Opcode::DSTORE:
+        case Opcode::ASTORE:
+        case Opcode::RET:
+        case Opcode::NEWARRAY:
+            length = 2;
+            break;
+        case Opcode::SIPUSH:
+        case Opcode::LDC_W:
+        case Opcode::LDC2_W:
+        case Opcode::IINC:
+        case Opcode::GETSTATIC:
+        case Opcode::PUTSTATIC:
+        case Opcode::GETFIELD:
+        case Opcode::PUTFIELD:
+        case Opcode::INVOKEVIRTUAL:
+        case Opcode::INVOKESPECIAL:
+        case Opcode::INVOKESTATIC:
+        case Opcode::NEW:
+        case Opcode::ANEWARRAY:
+        case Opcode::CHECKCAST:
+        case Opcode::INSTANCEOF:
+        case Opcode::IFNULL:
+        case Opcode::IFNONNULL:
+            length = 3;
+            break;
+        case Opcode::MULTIANEWARRAY:
+            length = 4;
+            break;
+        case Opcode::INVOKEINTERFACE:
+        case Opcode::INVOKEDYNAMIC:
+        case Opcode::GOTO_W:
+        case Opcode::JSR_W:
+            length = 5;
+            break;
+        case Opcode::WIDE: {
+            if (offset + 1 >= code.size()) {
+                return std::unexpected(Error::Truncated);
+            }
+
+            length = static_cast<Opcode>(code[offset + 1]) == Opcode::IINC ? 6 : 4;
+            break;
+        }
+        case Opcode::TABLESWITCH:
+        case Opcode::LOOKUPSWITCH:
+            return switch_length(code, offset);
+        default: {
+            if (opcode > Opcode::JSR_W) {
+                return std::unexpected(Error::InvalidOpcode);
+            }
+
+            if (opcode >= Opcode::IFEQ && opcode <= Opcode::JSR) {
+                length = 3;
+            }
+        }
+    }
+
+    if (offset + length > code.size()) {
+        return std::unexpected(Error::Truncated);
+    }
+
+    return length;
+}
+
+} // namespace kh::jvm::bytecode
@@ -0,0 +1,432 @@
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <fstream>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cache.h"
+#include "hashing.h"
+
+namespace kh::cache {
+
+namespace {
+
+constexpr auto index_magic = std::uint64_t{0x4B48434143484531u};
+constexpr auto index_version = std::uint64_t{1u};
+
+struct IndexHeader {
+    std::uint64_t magic;
+    std::uint64_t version;
+    std::uint64_t generation;
+    std::uint64_t clock;
+    std::uint64_t count;
+};
+
+struct IndexRecord {
+    std::uint64_t hash;
+    std::uint64_t input_size;
+    std::uint64_t offset;
+    std::uint64_t size;
+    std::uint64_t last_used;
+};
+
+auto write_all(const int descriptor, std::span<const std::byte> bytes, off_t offset) -> bool {
+    while (!bytes.empty()) {
+        const auto written = ::pwrite(descriptor, bytes.data(), bytes.size(), offset);
+
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return false;
+        }
+
+        bytes = bytes.subspan(static_cast<std::size_t>(written));
+        offset += written;
+    }
+
+    return true;
+}
+
+auto read_all(const int descriptor, std::span<std::byte> bytes, off_t offset) -> bool {
+    while (!bytes.empty()) {
+        const auto read = ::pread(descriptor, bytes.data(), bytes.size(), offset);
+
+        if (read < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return false;
+        }
+
+        if (read == 0) {
+            return false;
+        }
+
+        bytes = bytes.subspan(static_cast<std::size_t>(read));
+        offset += read;
+    }
+
+    return true;
+}
+
+} // namespace
+
+auto key(std::span<const std::byte> input, const std::uint64_t fingerprint) noexcept -> Key {
+    return Key{kh::hashing::xxh64(input, fingerprint), input.size()};
+}
+
+Cache::Cache(const std::filesystem::path& directory, const std::uint64_t capacity)
+        : directory_(directory)
+        , capacity_(capacity)
+        , mutex_()
+        , idle_()
+        , entries_(std::unordered_map<Key, Entry, KeyHash>{})
+        , current_(std::span<const std::byte>{})
+        , descriptor_(-1)
+        , generation_(0u)
+        , pack_size_(0u)
+        , clock_(0u)
+        , writing_(0u)
+        , evicting_(false) {
+    std::filesystem::create_directories(directory_);
+    load();
+
+    // NOTE(garrett): Leftovers from an eviction that was interrupted
+    for (const auto& entry : std::filesystem::directory_iterator{directory_}) {
+        const auto name = entry.path().filename().string();
+
+        if (name.starts_with("pack-") && entry.path() != pack_path(generation_)) {
+            std::filesystem::remove(entry.path());
+        }
+    }
+
+    map();
+}
+
+Cache::~Cache() {
+    try {
+        flush();
+    } catch (const std::exception&) {
+        // NOTE(garrett): Losing the index only costs the next run its hits
+    }
+
+    if (!current_.empty()) {
+        ::munmap(const_cast<std::byte*>(current_.data()), current_.size());
+    }
+
+    if (descriptor_ >= 0) {
+        ::close(descriptor_);
+    }
+}
+
+auto Cache::pack_path(const std::uint64_t generation) const -> std::filesystem::path {
+    return directory_ / ("pack-" + std::to_string(generation));
+}
+
+auto Cache::open(const std::uint64_t generation, const bool truncate) -> int {
+    const auto flags = O_RDWR | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0);
+    const auto descriptor = ::open(pack_path(generation).c_str(), flags, 0644);
+
+    if (descriptor < 0) {
+        throw std::system_error(errno, std::generic_category(), "Failed to open cache pack");
+    }
+
+    return descriptor;
+}
+
+auto Cache::load() -> void {
+    const auto path = directory_ / "index";
+    auto error = std::error_code{};
+    const auto size = std::filesystem::file_size(path, error);
+
+    auto file = std::ifstream{path, std::ios::binary};
+    auto header = IndexHeader{};
+    auto records = std::vector<IndexRecord>{};
+
+    // NOTE(garrett): The count is checked against the file before anything is
+    // allocated for it, so a corrupt index starts an empty cache as well
+    const auto valid = !error
+        && file
+        && file.read(reinterpret_cast<char*>(&header), sizeof(header))
+        && header.magic == index_magic
+        && header.version == index_version
+        && header.count == (size - sizeof(header)) / sizeof(IndexRecord)
+        && [&] {
+            records.resize(header.count);
+
+            return static_cast<bool>(file.read(
+                reinterpret_cast<char*>(records.data()),
+                static_cast<std::streamsize>(records.size() * sizeof(IndexRecord))
+            ));
+        }();
+
+    if (!valid) {
+        descriptor_ = open(0u, true);
+        return;
+    }
+
+    generation_ = header.generation;
+    clock_ = header.clock;
+    descriptor_ = open(generation_, false);
+
+    struct stat status{};
+
+    if (::fstat(descriptor_, &status) < 0) {
+        throw std::system_error(errno, std::generic_category(), "Failed to stat cache pack");
+    }
+
+    pack_size_ = static_cast<std::uint64_t>(status.st_size);
+
+    // NOTE(garrett): Entries appended after the index was last written are
+    // unreachable, but harmless until the next eviction drops them
+    for (const auto& record : records) {
+        if (record.offset <= pack_size_ && record.size <= pack_size_ - record.offset) {
+            entries_.insert_or_assign(
+                Key{record.hash, record.input_size},
+                Entry{record.offset, record.size, record.last_used}
+            );
+        }
+    }
+}
+
+auto Cache::map() -> void {
+    if (pack_size_ <= current_.size()) {
+        return;
+    }
+
+    auto* data = ::mmap(nullptr, pack_size_, PROT_READ, MAP_SHARED, descriptor_, 0);
+
+    if (data == MAP_FAILED) {
+        throw std::system_error(errno, std::generic_category(), "Failed to map cache pack");
+    }
+
+    if (!current_.empty()) {
+        ::munmap(const_cast<std::byte*>(current_.data()), current_.size());
+    }
+
+    current_ = std::span{static_cast<const std::byte*>(data), pack_size_};
+}
+
+auto Cache::evict(std::unique_lock<std::mutex>& lock, const std::uint64_t incoming)
+        -> std::expected<void, Error> {
+    // NOTE(garrett): Stops new appends, then waits out the ones under way, so
+    // the pack holds still while it's copied without the lock held
+    evicting_ = true;
+    idle_.wait(lock, [this] { return !writing_; });
+
+    auto order = std::vector<std::pair<Key, Entry>>(entries_.begin(), entries_.end());
+
+    std::ranges::sort(order, [](const auto& left, const auto& right) {
+        return left.second.last_used > right.second.last_used;
+    });
+
+    // NOTE(garrett): Leaves a quarter of the capacity free so that evictions
+    // aren't triggered again by the next few inserts
+    const auto target = capacity_ - capacity_ / 4u;
+    const auto budget = target > incoming ? target - incoming : 0u;
+
+    const auto source = descriptor_;
+    const auto generation = generation_ + 1u;
+    auto kept = std::unordered_map<Key, Entry, KeyHash>{};
+    auto offset = std::uint64_t{0u};
+    auto descriptor = -1;
+
+    lock.unlock();
+
+    const auto copied = [&] {
+        try {
+            descriptor = open(generation, true);
+        } catch (const std::system_error&) {
+            return false;
+        }
+
+        auto buffer = std::vector<std::byte>{};
+
+        for (const auto& [key, entry] : order) {
+            if (offset + entry.size > budget) {
+                break;
+            }
+
+            buffer.resize(entry.size);
+
+            if (!read_all(source, buffer, static_cast<off_t>(entry.offset))
+                    || !write_all(descriptor, buffer, static_cast<off_t>(offset))) {
+                return false;
+            }
+
+            kept.emplace(key, Entry{offset, entry.size, entry.last_used});
+            offset += entry.size;
+        }
+
+        return true;
+    }();
+
+    lock.lock();
+    evicting_ = false;
+
+    if (!copied) {
+        if (descriptor >= 0) {
+            ::close(descriptor);
+        }
+
+        std::filesystem::remove(pack_path(generation));
+        return std::unexpected(Error::WriteFailed);
+    }
+
+    const auto previous = generation_;
+
+    if (!current_.empty()) {
+        ::munmap(const_cast<std::byte*>(current_.data()), current_.size());
+    }
+
+    ::close(descriptor_);
+    descriptor_ = descriptor;
+    generation_ = generation;
+    entries_ = std::move(kept);
+    pack_size_ = offset;
+    current_ = std::span<const std::byte>{};
+
+    // NOTE(garrett): The old pack is only removed once the index points at
+    // the new one
+    try {
+        save();
+    } catch (const std::system_error&) {
+        return std::unexpected(Error::WriteFailed);
+    }
+
+    std::filesystem::remove(pack_path(previous));
+    return {};
+}
+
+auto Cache::save() -> void {
+    const auto temporary = directory_ / "index.tmp";
+
+    {
+        auto file = std::ofstream{temporary, std::ios::binary | std::ios::trunc};
+        const auto header = IndexHeader{
+            index_magic,
+            index_version,
+            generation_,
+            clock_,
+            entries_.size()
+        };
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        for (const auto& [key, entry] : entries_) {
+            const auto record = IndexRecord{
+                key.hash,
+                key.size,
+                entry.offset,
+                entry.size,
+                entry.last_used
+            };
+
+            file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        }
+
+        if (!file.flush()) {
+            throw std::system_error(
+                std::make_error_code(std::errc::io_error),
+                "Failed to write cache index"
+            );
+        }
+    }
+
+    std::filesystem::rename(temporary, directory_ / "index");
+}
+
+auto Cache::find(const Key& key) -> std::optional<std::vector<std::byte>> {
+    const auto lock = std::lock_guard{mutex_};
+    const auto found = entries_.find(key);
+
+    if (found == entries_.end()) {
+        return std::nullopt;
+    }
+
+    auto& entry = found->second;
+    entry.last_used = ++clock_;
+
+    if (!entry.size) {
+        return std::vector<std::byte>{};
+    }
+
+    if (entry.offset + entry.size > current_.size()) {
+        map();
+    }
+
+    const auto contents = current_.subspan(entry.offset, entry.size);
+    return std::vector<std::byte>(contents.begin(), contents.end());
+}
+
+auto Cache::insert(const Key& key, std::span<const std::byte> output)
+        -> std::expected<void, Error> {
+    auto lock = std::unique_lock{mutex_};
+
+    if (output.size() > capacity_) {
+        return std::unexpected(Error::EntryTooLarge);
+    }
+
+    if (const auto found = entries_.find(key); found != entries_.end()) {
+        found->second.last_used = ++clock_;
+        return {};
+    }
+
+    if (evicting_) {
+        return {};
+    }
+
+    if (pack_size_ + output.size() > capacity_) {
+        if (const auto result = evict(lock, output.size()); !result) {
+            return result;
+        }
+    }
+
+    // NOTE(garrett): Space is reserved up front so appends can run side by
+    // side. A failed append leaves a gap that nothing refers to, which the
+    // next eviction drops.
+    const auto offset = pack_size_;
+    const auto descriptor = descriptor_;
+
+    pack_size_ += output.size();
+    ++writing_;
+    lock.unlock();
+
+    const auto written = write_all(descriptor, output, static_cast<off_t>(offset));
+
+    lock.lock();
+    --writing_;
+    idle_.notify_all();
+
+    if (!written) {
+        return std::unexpected(Error::WriteFailed);
+    }
+
+    entries_.emplace(key, Entry{offset, output.size(), ++clock_});
+    return {};
+}
+
+auto Cache::flush() -> void {
+    const auto lock = std::lock_guard{mutex_};
+    save();
+}
+
+auto Cache::count() -> std::size_t {
+    const auto lock = std::lock_guard{mutex_};
+    return entries_.size();
+}
+
+auto Cache::size() -> std::uint64_t {
+    const auto lock = std::lock_guard{mutex_};
+    return pack_size_;
+}
+
+} // namespace kh::cache
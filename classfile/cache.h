@@ -0,0 +1,106 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <compare>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace kh::cache {
+
+enum Error {
+    EntryTooLarge,
+    WriteFailed
+};
+
+// NOTE(garrett): The input length is kept next to its hash, so a collision
+// also needs inputs of the same size
+struct Key {
+    std::uint64_t hash;
+    std::uint64_t size;
+
+    auto operator<=>(const Key&) const = default;
+};
+
+// NOTE(garrett): `fingerprint` identifies whatever produced the output, so
+// changing a transform or its configuration misses instead of returning stale
+// results
+auto key(std::span<const std::byte> input, std::uint64_t fingerprint) noexcept -> Key;
+
+// NOTE(garrett): Outputs are appended to a pack file that is memory-mapped for
+// lookups, with an index of their locations kept in memory and written back by
+// `flush`. Once the pack would grow past `capacity` bytes, it's rewritten with
+// only the most recently used entries. Packs carry a generation in their name
+// and the index records which one it describes, so a crash part way through
+// never pairs an index with the wrong pack. The index is stored in native byte
+// order, so a cache directory shouldn't be shared between architectures.
+//
+// All members are safe to call concurrently. Entries are written and packs
+// rewritten outside of the lock, so lookups carry on while that I/O runs, and
+// `find` copies entries out, so a pack is unmapped and deleted as soon as an
+// eviction replaces it. Inserts that arrive while an eviction is rewriting the
+// pack are dropped.
+class Cache {
+private:
+    struct Entry {
+        std::uint64_t offset;
+        std::uint64_t size;
+        std::uint64_t last_used;
+    };
+
+    struct KeyHash {
+        auto operator()(const Key& key) const noexcept -> std::size_t {
+            return static_cast<std::size_t>(key.hash);
+        }
+    };
+
+    std::filesystem::path directory_;
+    std::uint64_t capacity_;
+    std::mutex mutex_;
+    // NOTE(garrett): Signalled whenever an append finishes, for evictions
+    // waiting on the pack to settle
+    std::condition_variable idle_;
+    std::unordered_map<Key, Entry, KeyHash> entries_;
+    std::span<const std::byte> current_;
+    int descriptor_;
+    std::uint64_t generation_;
+    std::uint64_t pack_size_;
+    std::uint64_t clock_;
+    std::size_t writing_;
+    bool evicting_;
+
+    auto pack_path(std::uint64_t generation) const -> std::filesystem::path;
+    auto load() -> void;
+    auto open(std::uint64_t generation, bool truncate) -> int;
+    auto map() -> void;
+    auto evict(std::unique_lock<std::mutex>&, std::uint64_t incoming)
+        -> std::expected<void, Error>;
+    auto save() -> void;
+public:
+    // NOTE(garrett): Creates `directory` when missing. A missing or unreadable
+    // index starts an empty cache rather than failing.
+    Cache(const std::filesystem::path& directory, std::uint64_t capacity);
+    Cache(const Cache&) = delete;
+    auto operator=(const Cache&) -> Cache& = delete;
+    ~Cache();
+
+    auto find(const Key&) -> std::optional<std::vector<std::byte>>;
+    auto insert(const Key&, std::span<const std::byte>) -> std::expected<void, Error>;
+
+    // NOTE(garrett): Writes the index, replacing the previous one atomically
+    auto flush() -> void;
+
+    auto count() -> std::size_t;
+    auto size() -> std::uint64_t;
+};
+
+} // namespace kh::cache
+
+#endif // CACHE_H
@@ -0,0 +1,245 @@
+#include <algorithm>
+
+#include "classcache.h"
+
+namespace kh::jvm::classcache {
+
+namespace {
+
+// NOTE(garrett): Laps a class can earn in the main queue
+constexpr auto max_frequency = std::uint8_t{3u};
+
+template <typename T>
+constexpr auto bytes(const std::vector<T>& values) noexcept -> std::size_t {
+    return values.capacity() * sizeof(T);
+}
+
+} // namespace
+
+auto footprint(const kh::jvm::parsing::LoadedClass& loaded) noexcept -> std::size_t {
+    const auto& klass = loaded.class_file;
+
+    auto size = sizeof(loaded)
+        + bytes(loaded.raw)
+        + klass.constant_pool.count()
+            * (sizeof(kh::jvm::constant_pool::Entry) + sizeof(std::optional<std::size_t>))
+        + klass.constant_pool.text_index_size()
+        + bytes(klass.interfaces)
+        + bytes(klass.fields)
+        + bytes(klass.methods)
+        + bytes(klass.attributes);
+
+    for (const auto& field : klass.fields) {
+        size += bytes(field.attributes);
+    }
+
+    for (const auto& method : klass.methods) {
+        size += bytes(method.attributes);
+    }
+
+    return size;
+}
+
+ClassCache::ClassCache(const std::size_t capacity)
+        : capacity_(capacity)
+        , mutex_()
+        , small_(std::list<Slot>{})
+        , main_(std::list<Slot>{})
+        , slots_(std::unordered_map<std::string, std::list<Slot>::iterator>{})
+        , ghosts_(std::list<std::string>{})
+        , ghost_slots_(std::unordered_map<std::string, std::list<std::string>::iterator>{})
+        , small_bytes_(0u)
+        , main_bytes_(0u)
+        , hits_(0u)
+        , misses_(0u) {}
+
+auto ClassCache::load(const std::filesystem::path& path)
+        -> std::expected<std::shared_ptr<const kh::jvm::parsing::LoadedClass>,
+            kh::jvm::parsing::Error> {
+    auto key = path.lexically_normal().string();
+
+    {
+        const auto lock = std::lock_guard{mutex_};
+
+        if (const auto found = slots_.find(key); found != slots_.end()) {
+            auto& slot = *found->second;
+            slot.frequency = std::min<std::uint8_t>(slot.frequency + 1u, max_frequency);
+            ++hits_;
+
+            return slot.klass;
+        }
+
+        ++misses_;
+    }
+
+    auto loaded = kh::jvm::parsing::load_class_from_file(path);
+
+    if (!loaded) {
+        return std::unexpected(loaded.error());
+    }
+
+    // NOTE(garrett): Cached classes are only read from here on, often as
+    // overlay bases, so their text is indexed while it can still be built
+    loaded->class_file.constant_pool.index_text();
+
+    auto klass = std::make_shared<const kh::jvm::parsing::LoadedClass>(
+        std::move(loaded.value())
+    );
+
+    const auto lock = std::lock_guard{mutex_};
+
+    // NOTE(garrett): Another caller may have loaded the same class meanwhile,
+    // and theirs is kept so everyone shares a single copy
+    if (const auto found = slots_.find(key); found != slots_.end()) {
+        return found->second->klass;
+    }
+
+    insert(std::move(key), klass);
+    return klass;
+}
+
+auto ClassCache::insert(
+        std::string path,
+        std::shared_ptr<const kh::jvm::parsing::LoadedClass> klass) -> void {
+    const auto size = footprint(*klass);
+
+    if (size > capacity_) {
+        return;
+    }
+
+    evict(size);
+
+    auto main = false;
+
+    if (const auto ghost = ghost_slots_.find(path); ghost != ghost_slots_.end()) {
+        ghosts_.erase(ghost->second);
+        ghost_slots_.erase(ghost);
+        main = true;
+    }
+
+    auto& queue = main ? main_ : small_;
+    (main ? main_bytes_ : small_bytes_) += size;
+
+    queue.push_back(Slot{path, std::move(klass), size, 0u, main});
+    slots_.emplace(std::move(path), std::prev(queue.end()));
+}
+
+auto ClassCache::evict(const std::size_t incoming) -> void {
+    // NOTE(garrett): Pinned classes in the main queue passed over in a row.
+    // Once that's all of them, only the small queue is left to evict from.
+    auto pinned = 0uz;
+
+    while (small_bytes_ + main_bytes_ + incoming > capacity_) {
+        const auto main_exhausted = main_.empty() || pinned >= main_.size();
+
+        if (!small_.empty() && (small_bytes_ > capacity_ / 10u || main_exhausted)) {
+            const auto slot = small_.begin();
+            const auto held = slot->klass.use_count() > 1;
+
+            if (!held && !slot->frequency) {
+                small_bytes_ -= slot->bytes;
+                remember(slot->path);
+                slots_.erase(slot->path);
+                small_.erase(slot);
+
+                continue;
+            }
+
+            if (!held) {
+                pinned = 0u;
+            }
+
+            slot->frequency = 0u;
+            slot->main = true;
+            small_bytes_ -= slot->bytes;
+            main_bytes_ += slot->bytes;
+            main_.splice(main_.end(), small_, slot);
+
+            continue;
+        }
+
+        if (main_exhausted) {
+            break;
+        }
+
+        const auto slot = main_.begin();
+
+        if (slot->klass.use_count() > 1) {
+            ++pinned;
+            main_.splice(main_.end(), main_, slot);
+
+            continue;
+        }
+
+        pinned = 0u;
+
+        if (slot->frequency) {
+            --slot->frequency;
+            main_.splice(main_.end(), main_, slot);
+
+            continue;
+        }
+
+        main_bytes_ -= slot->bytes;
+        slots_.erase(slot->path);
+        main_.erase(slot);
+    }
+}
+
+auto ClassCache::remember(std::string path) -> void {
+    if (ghost_slots_.contains(path)) {
+        return;
+    }
+
+    // NOTE(garrett): As many paths are remembered as there are classes resident
+    while (!ghosts_.empty() && ghosts_.size() >= slots_.size()) {
+        ghost_slots_.erase(ghosts_.front());
+        ghosts_.pop_front();
+    }
+
+    ghosts_.push_back(path);
+    ghost_slots_.emplace(std::move(path), std::prev(ghosts_.end()));
+}
+
+auto ClassCache::invalidate(const std::filesystem::path& path) -> void {
+    const auto key = path.lexically_normal().string();
+    const auto lock = std::lock_guard{mutex_};
+
+    if (const auto ghost = ghost_slots_.find(key); ghost != ghost_slots_.end()) {
+        ghosts_.erase(ghost->second);
+        ghost_slots_.erase(ghost);
+    }
+
+    const auto found = slots_.find(key);
+
+    if (found == slots_.end()) {
+        return;
+    }
+
+    const auto slot = found->second;
+    (slot->main ? main_bytes_ : small_bytes_) -= slot->bytes;
+    (slot->main ? main_ : small_).erase(slot);
+    slots_.erase(found);
+}
+
+auto ClassCache::count() -> std::size_t {
+    const auto lock = std::lock_guard{mutex_};
+    return slots_.size();
+}
+
+auto ClassCache::size() -> std::size_t {
+    const auto lock = std::lock_guard{mutex_};
+    return small_bytes_ + main_bytes_;
+}
+
+auto ClassCache::hits() -> std::size_t {
+    const auto lock = std::lock_guard{mutex_};
+    return hits_;
+}
+
+auto ClassCache::misses() -> std::size_t {
+    const auto lock = std::lock_guard{mutex_};
+    return misses_;
+}
+
+} // namespace kh::jvm::classcache
@@ -0,0 +1,89 @@
+#ifndef CLASSCACHE_H
+#define CLASSCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "parsing.h"
+
+namespace kh::jvm::classcache {
+
+// NOTE(garrett): Bytes held by a loaded class, counting its source buffer and
+// its parsed structures. Anything stored in its arena isn't counted, as
+// loading never stores any there.
+auto footprint(const kh::jvm::parsing::LoadedClass&) noexcept -> std::size_t;
+
+// NOTE(garrett): Keeps recently loaded classes resident within a budget of
+// `capacity` bytes, as measured by `footprint`, evicting with S3-FIFO. New
+// classes enter a small queue holding a tenth of the budget, and only those
+// requested again before they leave it move on to the main queue, so a single
+// pass over many classes can't flush out the ones being worked with. Classes
+// the small queue drops are remembered by path for a while, and go straight to
+// the main queue if loaded again. The main queue gives each class another lap
+// for every time it was requested, up to three.
+//
+// Classes are handed out as shared pointers, and a class is pinned for as
+// long as any are held outside the cache, so the budget can be overrun when
+// callers hold on to more than it. Classes larger than the whole budget are
+// returned without being kept. Classes are never revalidated against
+// their files; `invalidate` drops one that's known to have changed. All
+// members are safe to call concurrently.
+class ClassCache {
+private:
+    struct Slot {
+        std::string path;
+        std::shared_ptr<const kh::jvm::parsing::LoadedClass> klass;
+        std::size_t bytes;
+        std::uint8_t frequency;
+        bool main;
+    };
+
+    std::size_t capacity_;
+    std::mutex mutex_;
+    std::list<Slot> small_;
+    std::list<Slot> main_;
+    std::unordered_map<std::string, std::list<Slot>::iterator> slots_;
+    std::list<std::string> ghosts_;
+    std::unordered_map<std::string, std::list<std::string>::iterator> ghost_slots_;
+    std::size_t small_bytes_;
+    std::size_t main_bytes_;
+    std::size_t hits_;
+    std::size_t misses_;
+
+    auto insert(std::string path, std::shared_ptr<const kh::jvm::parsing::LoadedClass>) -> void;
+    // NOTE(garrett): Makes room for `incoming` more bytes, as far as pinned
+    // classes allow
+    auto evict(std::size_t incoming) -> void;
+    auto remember(std::string path) -> void;
+public:
+    explicit ClassCache(std::size_t capacity);
+    ClassCache(const ClassCache&) = delete;
+    auto operator=(const ClassCache&) -> ClassCache& = delete;
+
+    // NOTE(garrett): Returns the resident class when there is one, and loads
+    // it through `parsing::load_class_from_file` otherwise, throwing as that
+    // does when the file can't be read. Files are loaded and parsed outside of
+    // the lock, so a miss doesn't hold up other callers.
+    auto load(const std::filesystem::path&)
+        -> std::expected<std::shared_ptr<const kh::jvm::parsing::LoadedClass>,
+            kh::jvm::parsing::Error>;
+
+    auto invalidate(const std::filesystem::path&) -> void;
+
+    auto count() -> std::size_t;
+    // NOTE(garrett): Bytes held by resident classes
+    auto size() -> std::size_t;
+    auto hits() -> std::size_t;
+    auto misses() -> std::size_t;
+};
+
+} // namespace kh::jvm::classcache
+
+#endif // CLASSCACHE_H
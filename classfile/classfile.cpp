@@ -8,6 +8,8 @@ ClassFile::ClassFile() noexcept
     , superclass_index{0u}
     , constant_pool(kh::jvm::constant_pool::ConstantPool{})
     , access_flags(0x0021)
+    , interfaces(std::vector<uint16_t>{})
+    , fields(std::vector<kh::jvm::field::Field>{})
     , methods(std::vector<kh::jvm::method::Method>{})
     , attributes(std::vector<kh::jvm::attribute::Attribute>{}) {}
 
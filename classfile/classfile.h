@@ -8,6 +8,7 @@
 
 #include "attribute.h"
 #include "constant_pool.h"
+#include "field.h"
 #include "method.h"
 
 namespace kh::jvm::classfile {
@@ -40,7 +41,8 @@ struct ClassFile {
     uint16_t superclass_index;
     kh::jvm::constant_pool::ConstantPool constant_pool;
     uint16_t access_flags;
-    // TODO(garrett): Interface, field storage
+    std::vector<uint16_t> interfaces;
+    std::vector<kh::jvm::field::Field> fields;
     std::vector<kh::jvm::method::Method> methods;
     std::vector<kh::jvm::attribute::Attribute> attributes;
 
@@ -0,0 +1,821 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "classindex.h"
+#include "hashing.h"
+#include "jar.h"
+#include "parsing.h"
+#include "reader.h"
+
+namespace kh::jvm::classindex {
+
+namespace {
+
+constexpr auto index_magic = std::uint64_t{0x4B48434C41535331u};
+constexpr auto index_version = std::uint32_t{1u};
+
+constexpr auto missing = std::numeric_limits<std::int64_t>::min();
+
+// NOTE(garrett): Text lives in a single table at the end of the index and is
+// stored once however many classes refer to it
+struct Reference {
+    std::uint32_t offset;
+    std::uint32_t size;
+};
+
+struct Header {
+    std::uint64_t magic;
+    std::uint32_t version;
+    std::uint32_t file_count;
+    std::uint32_t class_count;
+    std::uint32_t interface_count;
+    std::uint32_t method_count;
+    std::uint32_t slot_count;
+    std::uint64_t strings_size;
+};
+
+struct FileRecord {
+    Reference path;
+    std::int64_t modified;
+    std::uint64_t size;
+    std::uint64_t hash;
+    std::uint32_t first_class;
+    std::uint32_t class_count;
+};
+
+struct ClassRecord {
+    Reference name;
+    Reference superclass;
+    std::uint64_t offset;
+    std::uint64_t stored_size;
+    std::uint64_t size;
+    std::uint32_t file;
+    std::uint16_t compression;
+    std::uint16_t reserved;
+    std::uint32_t first_interface;
+    std::uint32_t interface_count;
+    std::uint32_t first_method;
+    std::uint32_t method_count;
+};
+
+struct MethodRecord {
+    Reference name;
+    Reference descriptor;
+};
+
+template <typename V>
+auto record(const std::span<const std::byte> section, const std::size_t index) noexcept -> V {
+    auto value = V{};
+    std::memcpy(&value, section.data() + index * sizeof(V), sizeof(V));
+
+    return value;
+}
+
+// NOTE(garrett): Narrows a range read from the index to the records that
+// are actually there
+auto clamp(const std::uint32_t first, const std::uint32_t count, const std::size_t total) noexcept
+        -> std::pair<std::uint32_t, std::uint32_t> {
+    const auto start = std::min<std::uint64_t>(first, total);
+    const auto end = std::min<std::uint64_t>(start + count, total);
+
+    return {static_cast<std::uint32_t>(start), static_cast<std::uint32_t>(end - start)};
+}
+
+auto hash(const std::string_view name) noexcept -> std::uint64_t {
+    return kh::hashing::xxh64(std::as_bytes(std::span{name}));
+}
+
+struct Status {
+    std::int64_t modified;
+    std::uint64_t size;
+    bool directory;
+};
+
+auto stat_path(const std::filesystem::path& path) noexcept -> Status {
+    auto error = std::error_code{};
+    const auto kind = std::filesystem::status(path, error).type();
+
+    if (error || kind == std::filesystem::file_type::not_found) {
+        return Status{missing, 0u, false};
+    }
+
+    const auto modified = std::filesystem::last_write_time(path, error);
+
+    if (error) {
+        return Status{missing, 0u, false};
+    }
+
+    const auto directory = kind == std::filesystem::file_type::directory;
+    const auto size = directory ? 0u : std::filesystem::file_size(path, error);
+
+    return Status{
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            modified.time_since_epoch()
+        ).count(),
+        error ? 0u : static_cast<std::uint64_t>(size),
+        directory
+    };
+}
+
+auto read_file(const std::filesystem::path& path, std::vector<std::byte>& buffer) -> bool {
+    auto file = std::ifstream{path, std::ios::binary | std::ios::ate};
+
+    if (!file) {
+        return false;
+    }
+
+    buffer.resize(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0, std::ios::beg);
+
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(buffer.data()), buffer.size()));
+}
+
+auto class_name(const kh::jvm::classfile::ClassFile& klass, const std::uint16_t index) noexcept
+        -> std::string_view {
+    const auto* entry = klass.constant_pool.find<constant_pool::ClassEntry>(index);
+
+    if (!entry) {
+        return {};
+    }
+
+    const auto* text = klass.constant_pool.find<constant_pool::UTF8Entry>(entry->name_index);
+    return text ? text->text : std::string_view{};
+}
+
+auto utf8(const kh::jvm::classfile::ClassFile& klass, const std::uint16_t index) noexcept
+        -> std::string_view {
+    const auto* text = klass.constant_pool.find<constant_pool::UTF8Entry>(index);
+    return text ? text->text : std::string_view{};
+}
+
+class Builder {
+private:
+    std::vector<std::byte> strings_;
+    std::unordered_map<std::string, Reference> references_;
+    std::vector<FileRecord> files_;
+    std::vector<ClassRecord> classes_;
+    std::vector<Reference> interfaces_;
+    std::vector<MethodRecord> methods_;
+
+    auto text(const std::string_view text) -> Reference {
+        const auto [existing, inserted] = references_.try_emplace(
+            std::string{text},
+            Reference{
+                static_cast<std::uint32_t>(strings_.size()),
+                static_cast<std::uint32_t>(text.size())
+            }
+        );
+
+        if (inserted) {
+            const auto bytes = std::as_bytes(std::span{text});
+            strings_.insert(strings_.end(), bytes.begin(), bytes.end());
+        }
+
+        return existing->second;
+    }
+
+    template <typename V>
+    static auto append(std::vector<std::byte>& buffer, const std::vector<V>& values) -> void {
+        const auto bytes = std::as_bytes(std::span{values});
+        buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+    }
+public:
+    Builder()
+            : strings_(std::vector<std::byte>{})
+            , references_(std::unordered_map<std::string, Reference>{})
+            , files_(std::vector<FileRecord>{})
+            , classes_(std::vector<ClassRecord>{})
+            , interfaces_(std::vector<Reference>{})
+            , methods_(std::vector<MethodRecord>{}) {}
+
+    auto file(
+            const std::filesystem::path& path,
+            const Status& status,
+            const std::uint64_t hash) -> void {
+        files_.push_back(FileRecord{
+            text(path.string()),
+            status.modified,
+            status.size,
+            hash,
+            static_cast<std::uint32_t>(classes_.size()),
+            0u
+        });
+    }
+
+    auto add(
+            const kh::jvm::classfile::ClassFile& klass,
+            const std::uint16_t compression,
+            const std::uint64_t offset,
+            const std::uint64_t stored_size,
+            const std::uint64_t size) -> void {
+        const auto name = class_name(klass, klass.class_index);
+
+        if (name.empty()) {
+            return;
+        }
+
+        auto record = ClassRecord{
+            text(name),
+            text(class_name(klass, klass.superclass_index)),
+            offset,
+            stored_size,
+            size,
+            static_cast<std::uint32_t>(files_.size() - 1u),
+            compression,
+            0u,
+            static_cast<std::uint32_t>(interfaces_.size()),
+            static_cast<std::uint32_t>(klass.interfaces.size()),
+            static_cast<std::uint32_t>(methods_.size()),
+            static_cast<std::uint32_t>(klass.methods.size())
+        };
+
+        for (const auto interface : klass.interfaces) {
+            interfaces_.push_back(text(class_name(klass, interface)));
+        }
+
+        for (const auto& method : klass.methods) {
+            methods_.push_back(MethodRecord{
+                text(utf8(klass, method.name_index)),
+                text(utf8(klass, method.descriptor_index))
+            });
+        }
+
+        classes_.push_back(record);
+        ++files_.back().class_count;
+    }
+
+    // NOTE(garrett): Carries a file's classes over from an earlier index
+    auto copy(const Index& previous, const File& file) -> void {
+        for (auto i = 0u; i < file.class_count; ++i) {
+            const auto klass = previous.entry(file.first_class + i);
+
+            auto record = ClassRecord{
+                text(klass.name),
+                text(klass.superclass),
+                klass.offset,
+                klass.stored_size,
+                klass.size,
+                static_cast<std::uint32_t>(files_.size() - 1u),
+                klass.compression,
+                0u,
+                static_cast<std::uint32_t>(interfaces_.size()),
+                klass.interface_count,
+                static_cast<std::uint32_t>(methods_.size()),
+                klass.method_count
+            };
+
+            for (auto j = 0uz; j < klass.interface_count; ++j) {
+                interfaces_.push_back(text(previous.interface(klass, j)));
+            }
+
+            for (auto j = 0uz; j < klass.method_count; ++j) {
+                const auto method = previous.method(klass, j);
+                methods_.push_back(MethodRecord{text(method.name), text(method.descriptor)});
+            }
+
+            classes_.push_back(record);
+            ++files_.back().class_count;
+        }
+    }
+
+    auto finish() -> std::vector<std::byte> {
+        // NOTE(garrett): Open addressing at no more than half full, where only
+        // the first class with a name gets a slot
+        const auto slot_count = std::bit_ceil(std::max(classes_.size() * 2u, 2uz));
+        auto slots = std::vector<std::uint32_t>(slot_count, 0u);
+
+        auto name = [this](const Reference reference) {
+            return std::string_view{
+                reinterpret_cast<const char*>(strings_.data()) + reference.offset,
+                reference.size
+            };
+        };
+
+        for (auto i = 0uz; i < classes_.size(); ++i) {
+            const auto text = name(classes_[i].name);
+
+            for (auto slot = hash(text) & (slot_count - 1u);;
+                    slot = (slot + 1u) & (slot_count - 1u)) {
+                if (!slots[slot]) {
+                    slots[slot] = static_cast<std::uint32_t>(i + 1u);
+                    break;
+                }
+
+                if (name(classes_[slots[slot] - 1u].name) == text) {
+                    break;
+                }
+            }
+        }
+
+        const auto header = Header{
+            index_magic,
+            index_version,
+            static_cast<std::uint32_t>(files_.size()),
+            static_cast<std::uint32_t>(classes_.size()),
+            static_cast<std::uint32_t>(interfaces_.size()),
+            static_cast<std::uint32_t>(methods_.size()),
+            static_cast<std::uint32_t>(slot_count),
+            strings_.size()
+        };
+
+        auto index = std::vector<std::byte>{};
+        const auto bytes = std::as_bytes(std::span{&header, 1u});
+        index.insert(index.end(), bytes.begin(), bytes.end());
+
+        append(index, files_);
+        append(index, classes_);
+        append(index, interfaces_);
+        append(index, methods_);
+        append(index, slots);
+        append(index, strings_);
+
+        return index;
+    }
+};
+
+auto add_archive(Builder& builder, const jar::Archive& archive) -> void {
+    auto buffer = std::vector<std::byte>{};
+
+    for (const auto& entry : archive.entries()) {
+        if (!entry.name.ends_with(".class") || entry.name.starts_with("META-INF/")) {
+            continue;
+        }
+
+        const auto contents = archive.extract(entry, buffer);
+
+        if (!contents) {
+            continue;
+        }
+
+        auto reader = kh::reader::Reader{contents.value()};
+        const auto klass = kh::jvm::parsing::parse_class_file(reader);
+
+        if (klass) {
+            builder.add(
+                klass.value(),
+                static_cast<std::uint16_t>(entry.compression),
+                entry.offset,
+                entry.compressed_size,
+                entry.size
+            );
+        }
+    }
+}
+
+} // namespace
+
+Index::Index(const std::span<const std::byte> mapping, const bool owned) noexcept
+        : mapping_(mapping)
+        , owned_(owned)
+        , files_(std::span<const std::byte>{})
+        , classes_(std::span<const std::byte>{})
+        , interfaces_(std::span<const std::byte>{})
+        , methods_(std::span<const std::byte>{})
+        , slots_(std::span<const std::byte>{})
+        , strings_(std::span<const std::byte>{}) {}
+
+Index::Index(Index&& other) noexcept
+        : mapping_(std::exchange(other.mapping_, std::span<const std::byte>{}))
+        , owned_(std::exchange(other.owned_, false))
+        , files_(other.files_)
+        , classes_(other.classes_)
+        , interfaces_(other.interfaces_)
+        , methods_(other.methods_)
+        , slots_(other.slots_)
+        , strings_(other.strings_) {}
+
+auto Index::operator=(Index&& other) noexcept -> Index& {
+    if (this != &other) {
+        if (owned_) {
+            ::munmap(const_cast<std::byte*>(mapping_.data()), mapping_.size());
+        }
+
+        mapping_ = std::exchange(other.mapping_, std::span<const std::byte>{});
+        owned_ = std::exchange(other.owned_, false);
+        files_ = other.files_;
+        classes_ = other.classes_;
+        interfaces_ = other.interfaces_;
+        methods_ = other.methods_;
+        slots_ = other.slots_;
+        strings_ = other.strings_;
+    }
+
+    return *this;
+}
+
+Index::~Index() {
+    if (owned_) {
+        ::munmap(const_cast<std::byte*>(mapping_.data()), mapping_.size());
+    }
+}
+
+auto Index::open(const std::filesystem::path& path) -> std::expected<Index, Error> {
+    const auto descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (descriptor < 0) {
+        return std::unexpected(Error::ReadFailed);
+    }
+
+    struct stat status{};
+
+    if (::fstat(descriptor, &status) < 0) {
+        ::close(descriptor);
+        return std::unexpected(Error::ReadFailed);
+    }
+
+    const auto size = static_cast<std::size_t>(status.st_size);
+
+    if (size < sizeof(Header)) {
+        ::close(descriptor);
+        return std::unexpected(Error::InvalidIndex);
+    }
+
+    auto* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    ::close(descriptor);
+
+    if (data == MAP_FAILED) {
+        return std::unexpected(Error::ReadFailed);
+    }
+
+    // NOTE(garrett): Unmapped by the index from here on, even if loading fails
+    auto index = Index{std::span{static_cast<const std::byte*>(data), size}, true};
+
+    if (auto loaded = index.load(); !loaded) {
+        return std::unexpected(loaded.error());
+    }
+
+    return index;
+}
+
+auto Index::view(const std::span<const std::byte> bytes) -> std::expected<Index, Error> {
+    auto index = Index{bytes, false};
+
+    if (auto loaded = index.load(); !loaded) {
+        return std::unexpected(loaded.error());
+    }
+
+    return index;
+}
+
+auto Index::load() -> std::expected<void, Error> {
+    if (mapping_.size() < sizeof(Header)) {
+        return std::unexpected(Error::InvalidIndex);
+    }
+
+    const auto header = record<Header>(mapping_, 0u);
+
+    if (header.magic != index_magic) {
+        return std::unexpected(Error::InvalidIndex);
+    }
+
+    if (header.version != index_version) {
+        return std::unexpected(Error::UnsupportedVersion);
+    }
+
+    const auto sizes = std::array{
+        std::uint64_t{header.file_count} * sizeof(FileRecord),
+        std::uint64_t{header.class_count} * sizeof(ClassRecord),
+        std::uint64_t{header.interface_count} * sizeof(Reference),
+        std::uint64_t{header.method_count} * sizeof(MethodRecord),
+        std::uint64_t{header.slot_count} * sizeof(std::uint32_t),
+        header.strings_size
+    };
+
+    auto expected_size = std::uint64_t{sizeof(Header)};
+
+    for (const auto size : sizes) {
+        expected_size += size;
+    }
+
+    if (expected_size != mapping_.size() || !std::has_single_bit(header.slot_count)) {
+        return std::unexpected(Error::InvalidIndex);
+    }
+
+    auto position = sizeof(Header);
+
+    auto take = [this, &position](const std::uint64_t size) {
+        const auto taken = mapping_.subspan(position, size);
+        position += size;
+
+        return taken;
+    };
+
+    files_ = take(sizes[0]);
+    classes_ = take(sizes[1]);
+    interfaces_ = take(sizes[2]);
+    methods_ = take(sizes[3]);
+    slots_ = take(sizes[4]);
+    strings_ = take(sizes[5]);
+
+    return {};
+}
+
+// NOTE(garrett): Reads the reference at `offset` within `section`. References
+// that fall outside the string table come back empty rather than being trusted.
+auto Index::text(const std::span<const std::byte> section, const std::size_t offset) const noexcept
+        -> std::string_view {
+    auto reference = Reference{};
+    std::memcpy(&reference, section.data() + offset, sizeof(reference));
+
+    if (reference.offset > strings_.size() || reference.size > strings_.size() - reference.offset) {
+        return {};
+    }
+
+    return std::string_view{
+        reinterpret_cast<const char*>(strings_.data()) + reference.offset,
+        reference.size
+    };
+}
+
+auto Index::file_count() const noexcept -> std::size_t {
+    return files_.size() / sizeof(FileRecord);
+}
+
+auto Index::file(const std::size_t index) const noexcept -> File {
+    if (index >= file_count()) {
+        return File{};
+    }
+
+    const auto file = record<FileRecord>(files_, index);
+    const auto [first_class, class_count] = clamp(file.first_class, file.class_count, size());
+
+    return File{
+        text(files_, index * sizeof(FileRecord) + offsetof(FileRecord, path)),
+        file.modified,
+        file.size,
+        file.hash,
+        first_class,
+        class_count
+    };
+}
+
+auto Index::size() const noexcept -> std::size_t {
+    return classes_.size() / sizeof(ClassRecord);
+}
+
+auto Index::entry(const std::size_t index) const noexcept -> Class {
+    if (index >= size()) {
+        return Class{};
+    }
+
+    const auto position = index * sizeof(ClassRecord);
+    const auto klass = record<ClassRecord>(classes_, index);
+
+    const auto [first_interface, interface_count] = clamp(
+        klass.first_interface,
+        klass.interface_count,
+        interfaces_.size() / sizeof(Reference)
+    );
+
+    const auto [first_method, method_count] = clamp(
+        klass.first_method,
+        klass.method_count,
+        methods_.size() / sizeof(MethodRecord)
+    );
+
+    return Class{
+        text(classes_, position + offsetof(ClassRecord, name)),
+        text(classes_, position + offsetof(ClassRecord, superclass)),
+        klass.file,
+        klass.compression,
+        klass.offset,
+        klass.stored_size,
+        klass.size,
+        first_interface,
+        interface_count,
+        first_method,
+        method_count
+    };
+}
+
+auto Index::find(const std::string_view name) const noexcept -> std::optional<Class> {
+    const auto slot_count = slots_.size() / sizeof(std::uint32_t);
+    auto slot = hash(name) & (slot_count - 1u);
+
+    for (auto probes = 0uz; probes < slot_count; ++probes) {
+        const auto occupant = record<std::uint32_t>(slots_, slot);
+
+        if (!occupant || occupant > size()) {
+            return std::nullopt;
+        }
+
+        if (const auto klass = entry(occupant - 1u); klass.name == name) {
+            return klass;
+        }
+
+        slot = (slot + 1u) & (slot_count - 1u);
+    }
+
+    return std::nullopt;
+}
+
+auto Index::interface(const Class& klass, const std::size_t index) const noexcept
+        -> std::string_view {
+    const auto position = std::uint64_t{klass.first_interface} + index;
+
+    if (index >= klass.interface_count || position >= interfaces_.size() / sizeof(Reference)) {
+        return {};
+    }
+
+    return text(interfaces_, position * sizeof(Reference));
+}
+
+auto Index::method(const Class& klass, const std::size_t index) const noexcept -> Method {
+    const auto position = std::uint64_t{klass.first_method} + index;
+
+    if (index >= klass.method_count || position >= methods_.size() / sizeof(MethodRecord)) {
+        return Method{};
+    }
+
+    return Method{
+        text(methods_, position * sizeof(MethodRecord) + offsetof(MethodRecord, name)),
+        text(methods_, position * sizeof(MethodRecord) + offsetof(MethodRecord, descriptor))
+    };
+}
+
+auto Index::changed() const -> std::vector<std::size_t> {
+    auto changed = std::vector<std::size_t>{};
+
+    for (auto i = 0uz; i < file_count(); ++i) {
+        const auto file = this->file(i);
+        const auto current = stat_path(file.path);
+
+        if (current.modified != file.modified || current.size != file.size) {
+            changed.push_back(i);
+        }
+    }
+
+    return changed;
+}
+
+auto build(const std::span<const std::filesystem::path> classpath, const Index* previous)
+        -> std::vector<std::byte> {
+    auto builder = Builder{};
+    auto previous_files = std::unordered_map<std::string_view, std::size_t>{};
+
+    if (previous) {
+        for (auto i = 0uz; i < previous->file_count(); ++i) {
+            previous_files.try_emplace(previous->file(i).path, i);
+        }
+    }
+
+    auto earlier = [previous, &previous_files](const std::filesystem::path& path)
+            -> std::optional<File> {
+        const auto found = previous_files.find(path.native());
+
+        if (found == previous_files.end()) {
+            return std::nullopt;
+        }
+
+        return previous->file(found->second);
+    };
+
+    auto buffer = std::vector<std::byte>{};
+
+    auto add_file = [&](const std::filesystem::path& path, const Status& current) {
+        const auto recorded = earlier(path);
+
+        if (recorded && recorded->modified == current.modified && recorded->size == current.size) {
+            builder.file(path, current, recorded->hash);
+            builder.copy(*previous, recorded.value());
+
+            return;
+        }
+
+        if (current.modified == missing) {
+            builder.file(path, current, 0u);
+            return;
+        }
+
+        // NOTE(garrett): Rewritten with the same contents, as a rebuild often
+        // does, so only the modification time needs updating
+        auto reuse = [&](const std::uint64_t hash) {
+            if (!recorded || recorded->size != current.size || recorded->hash != hash) {
+                return false;
+            }
+
+            builder.file(path, current, hash);
+            builder.copy(*previous, recorded.value());
+
+            return true;
+        };
+
+        if (path.extension() == ".class") {
+            if (!read_file(path, buffer)) {
+                builder.file(path, current, 0u);
+                return;
+            }
+
+            const auto hash = kh::hashing::xxh64(buffer);
+
+            if (reuse(hash)) {
+                return;
+            }
+
+            builder.file(path, current, hash);
+
+            auto reader = kh::reader::Reader{buffer};
+
+            if (const auto klass = kh::jvm::parsing::parse_class_file(reader)) {
+                builder.add(klass.value(), 0u, 0u, buffer.size(), buffer.size());
+            }
+
+            return;
+        }
+
+        const auto archive = jar::Archive::open(path);
+
+        if (!archive) {
+            builder.file(path, current, 0u);
+            return;
+        }
+
+        const auto hash = kh::hashing::xxh64(archive->bytes());
+
+        if (reuse(hash)) {
+            return;
+        }
+
+        builder.file(path, current, hash);
+        add_archive(builder, archive.value());
+    };
+
+    for (const auto& element : classpath) {
+        const auto current = stat_path(element);
+
+        if (!current.directory) {
+            add_file(element, current);
+            continue;
+        }
+
+        // NOTE(garrett): Sorted so indexing the same tree always lays out the
+        // same index
+        auto paths = std::vector<std::filesystem::path>{element};
+        auto error = std::error_code{};
+
+        for (auto it = std::filesystem::recursive_directory_iterator{element, error};
+                !error && it != std::filesystem::recursive_directory_iterator{};
+                it.increment(error)) {
+            if (it->is_directory(error) || it->path().extension() == ".class") {
+                paths.push_back(it->path());
+            }
+        }
+
+        std::ranges::sort(paths);
+
+        for (const auto& path : paths) {
+            const auto status = stat_path(path);
+
+            if (status.directory) {
+                builder.file(path, status, 0u);
+            } else {
+                add_file(path, status);
+            }
+        }
+    }
+
+    return builder.finish();
+}
+
+auto write(const std::filesystem::path& path, const std::span<const std::byte> index)
+        -> std::expected<void, Error> {
+    auto temporary = path;
+    temporary += ".tmp";
+
+    auto error = std::error_code{};
+    std::filesystem::create_directories(path.parent_path(), error);
+
+    {
+        auto file = std::ofstream{temporary, std::ios::binary | std::ios::trunc};
+        file.write(reinterpret_cast<const char*>(index.data()), index.size());
+
+        if (!file.flush()) {
+            std::filesystem::remove(temporary, error);
+            return std::unexpected(Error::WriteFailed);
+        }
+    }
+
+    std::filesystem::rename(temporary, path, error);
+
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        return std::unexpected(Error::WriteFailed);
+    }
+
+    return {};
+}
+
+} // namespace kh::jvm::classindex
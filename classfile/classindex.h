@@ -0,0 +1,144 @@
+#ifndef CLASSINDEX_H
+#define CLASSINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace kh::jvm::classindex {
+
+enum Error {
+    InvalidIndex,
+    ReadFailed,
+    UnsupportedVersion,
+    WriteFailed
+};
+
+constexpr auto name(const Error error) noexcept -> std::string_view {
+    switch (error) {
+        case Error::InvalidIndex:
+            return "Index is malformed";
+        case Error::ReadFailed:
+            return "Index could not be read";
+        case Error::UnsupportedVersion:
+            return "Index was written by an unsupported version";
+        case Error::WriteFailed:
+            return "Index could not be written";
+    }
+
+    return "Unknown error";
+}
+
+// NOTE(garrett): A jar, loose class file or directory from the classpath, as
+// it was when indexed. Directories are recorded so classes added to or removed
+// from them are noticed, and hold no classes themselves.
+struct File {
+    std::string_view path;
+    // NOTE(garrett): Nanoseconds on the filesystem clock, or the lowest value
+    // for files that were missing
+    std::int64_t modified;
+    std::uint64_t size;
+    // NOTE(garrett): XXH64 of the file's contents, zero for directories
+    std::uint64_t hash;
+    // NOTE(garrett): A file's classes are numbered contiguously
+    std::uint32_t first_class;
+    std::uint32_t class_count;
+};
+
+struct Method {
+    std::string_view name;
+    std::string_view descriptor;
+};
+
+struct Class {
+    std::string_view name;
+    // NOTE(garrett): Empty for classes without one
+    std::string_view superclass;
+    std::uint32_t file;
+    // NOTE(garrett): Where the class is stored in its file. Loose class files
+    // are stored whole, and jar entries as a ZIP compression method.
+    std::uint16_t compression;
+    std::uint64_t offset;
+    std::uint64_t stored_size;
+    std::uint64_t size;
+    std::uint32_t first_interface;
+    std::uint32_t interface_count;
+    std::uint32_t first_method;
+    std::uint32_t method_count;
+};
+
+// NOTE(garrett): Maps an index built from a classpath by `build`, and answers
+// lookups straight from the mapping through a hash table stored in it, so
+// opening one costs the same however many classes it holds. Records are only
+// checked as they're read: out of range files and classes come back empty,
+// and ranges of classes, interfaces and methods are cut short at the end of
+// their section. The index is stored in native byte order, so shouldn't be
+// shared between architectures.
+class Index {
+private:
+    std::span<const std::byte> mapping_;
+    bool owned_;
+    std::span<const std::byte> files_;
+    std::span<const std::byte> classes_;
+    std::span<const std::byte> interfaces_;
+    std::span<const std::byte> methods_;
+    std::span<const std::byte> slots_;
+    std::span<const std::byte> strings_;
+
+    Index(std::span<const std::byte> mapping, bool owned) noexcept;
+
+    auto load() -> std::expected<void, Error>;
+    auto text(std::span<const std::byte> section, std::size_t offset) const noexcept
+        -> std::string_view;
+public:
+    static auto open(const std::filesystem::path&) -> std::expected<Index, Error>;
+
+    // NOTE(garrett): Reads an index already in memory, which must outlive the
+    // returned one
+    static auto view(std::span<const std::byte>) -> std::expected<Index, Error>;
+
+    Index(Index&&) noexcept;
+    auto operator=(Index&&) noexcept -> Index&;
+    Index(const Index&) = delete;
+    auto operator=(const Index&) -> Index& = delete;
+    ~Index();
+
+    auto file_count() const noexcept -> std::size_t;
+    auto file(std::size_t) const noexcept -> File;
+
+    auto size() const noexcept -> std::size_t;
+    auto entry(std::size_t) const noexcept -> Class;
+
+    // NOTE(garrett): Takes internal names such as `java/lang/Object`. When
+    // several files hold a class, the earliest on the classpath wins.
+    auto find(std::string_view name) const noexcept -> std::optional<Class>;
+
+    auto interface(const Class&, std::size_t) const noexcept -> std::string_view;
+    auto method(const Class&, std::size_t) const noexcept -> Method;
+
+    // NOTE(garrett): Indices of files whose size or modification time no
+    // longer match, which `build` will read again
+    auto changed() const -> std::vector<std::size_t>;
+};
+
+// NOTE(garrett): Indexes every class in the jars, class files and directories
+// of `classpath`, skipping entries below `META-INF/` in jars and classes that
+// fail to parse. Files recorded unchanged in `previous` aren't read at all, and
+// ones whose contents hash the same aren't parsed again, so refreshing an index
+// after a few jars change only pays for those.
+auto build(std::span<const std::filesystem::path> classpath, const Index* previous = nullptr)
+    -> std::vector<std::byte>;
+
+// NOTE(garrett): Written beside `path` and renamed over it, so an index being
+// read is never observed part way through being replaced
+auto write(const std::filesystem::path& path, std::span<const std::byte>)
+    -> std::expected<void, Error>;
+
+} // namespace kh::jvm::classindex
+
+#endif // CLASSINDEX_H
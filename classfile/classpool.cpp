@@ -0,0 +1,165 @@
+#include "classpool.h"
+#include "parsing.h"
+#include "reader.h"
+
+namespace kh::jvm::classpool {
+
+namespace {
+
+constexpr auto no_class = std::uint32_t{0xFFFFFFFFu};
+
+// NOTE(garrett): The symbol for the name of the class entry at `index`
+auto class_symbol(const PooledClass& klass, const std::uint16_t index) noexcept -> Symbol {
+    const auto* entry = klass.class_file.constant_pool.find<constant_pool::ClassEntry>(index);
+
+    if (!entry || entry->name_index >= klass.symbols.size()) {
+        return no_symbol;
+    }
+
+    return klass.symbols[entry->name_index];
+}
+
+auto symbol(const PooledClass& klass, const std::uint16_t index) noexcept -> Symbol {
+    return index < klass.symbols.size() ? klass.symbols[index] : no_symbol;
+}
+
+} // namespace
+
+SymbolTable::SymbolTable()
+        : texts_(std::vector<std::string_view>{})
+        , symbols_(std::unordered_map<std::string_view, Symbol>{}) {}
+
+auto SymbolTable::intern(const std::string_view text) -> Symbol {
+    const auto [existing, inserted] = symbols_.try_emplace(
+        text,
+        static_cast<Symbol>(texts_.size())
+    );
+
+    if (inserted) {
+        texts_.push_back(text);
+    }
+
+    return existing->second;
+}
+
+auto SymbolTable::find(const std::string_view text) const noexcept -> std::optional<Symbol> {
+    const auto found = symbols_.find(text);
+
+    if (found == symbols_.end()) {
+        return std::nullopt;
+    }
+
+    return found->second;
+}
+
+auto SymbolTable::text(const Symbol symbol) const noexcept -> std::string_view {
+    return symbol < texts_.size() ? texts_[symbol] : std::string_view{};
+}
+
+auto SymbolTable::size() const noexcept -> std::size_t {
+    return texts_.size();
+}
+
+ClassPool::ClassPool()
+        : symbols_()
+        , classes_(std::deque<PooledClass>{})
+        , by_name_(std::vector<std::uint32_t>{}) {}
+
+auto ClassPool::add(std::vector<std::byte>&& raw) -> std::expected<const PooledClass*, Error> {
+    auto reader = kh::reader::Reader{raw};
+    auto parsed = kh::jvm::parsing::parse_class_file(reader);
+
+    if (!parsed) {
+        return std::unexpected(Error::ParseFailed);
+    }
+
+    // NOTE(garrett): Moving the bytes keeps their address, so the parsed
+    // class and the interned text can keep pointing into them
+    auto klass = PooledClass{
+        std::move(raw),
+        std::move(parsed.value()),
+        std::vector<Symbol>{},
+        no_symbol,
+        no_symbol
+    };
+
+    const auto& pool = klass.class_file.constant_pool;
+    const auto* entry = pool.find<constant_pool::ClassEntry>(klass.class_file.class_index);
+    const auto* name = entry ? pool.find<constant_pool::UTF8Entry>(entry->name_index) : nullptr;
+
+    if (!name) {
+        return std::unexpected(Error::ParseFailed);
+    }
+
+    // NOTE(garrett): Rejected before anything is interned, since interned text
+    // points into the bytes of the class it came from
+    const auto existing = symbols_.find(name->text);
+
+    if (existing && find(existing.value())) {
+        return std::unexpected(Error::DuplicateClass);
+    }
+
+    klass.symbols.resize(pool.count(), no_symbol);
+
+    for (auto i = 1uz; i < pool.count(); ++i) {
+        const auto index = static_cast<std::uint16_t>(i);
+
+        if (const auto* text = pool.find<constant_pool::UTF8Entry>(index)) {
+            klass.symbols[i] = symbols_.intern(text->text);
+        }
+    }
+
+    klass.name = class_symbol(klass, klass.class_file.class_index);
+    klass.superclass = class_symbol(klass, klass.class_file.superclass_index);
+
+    by_name_.resize(symbols_.size(), no_class);
+    by_name_[klass.name] = static_cast<std::uint32_t>(classes_.size());
+
+    return &classes_.emplace_back(std::move(klass));
+}
+
+auto ClassPool::classes() const noexcept -> const std::deque<PooledClass>& {
+    return classes_;
+}
+
+auto ClassPool::symbols() const noexcept -> const SymbolTable& {
+    return symbols_;
+}
+
+auto ClassPool::size() const noexcept -> std::size_t {
+    return classes_.size();
+}
+
+auto ClassPool::find(const Symbol name) const noexcept -> const PooledClass* {
+    if (name >= by_name_.size() || by_name_[name] == no_class) {
+        return nullptr;
+    }
+
+    return &classes_[by_name_[name]];
+}
+
+auto ClassPool::find(const std::string_view name) const noexcept -> const PooledClass* {
+    const auto symbol = symbols_.find(name);
+    return symbol ? find(symbol.value()) : nullptr;
+}
+
+auto ClassPool::superclass(const PooledClass& klass) const noexcept -> const PooledClass* {
+    return klass.superclass == no_symbol ? nullptr : find(klass.superclass);
+}
+
+auto find_method(const PooledClass& klass, const Symbol name, const Symbol descriptor) noexcept
+        -> const kh::jvm::method::Method* {
+    for (const auto& method : klass.class_file.methods) {
+        if (symbol(klass, method.name_index) != name) {
+            continue;
+        }
+
+        if (descriptor == no_symbol || symbol(klass, method.descriptor_index) == descriptor) {
+            return &method;
+        }
+    }
+
+    return nullptr;
+}
+
+} // namespace kh::jvm::classpool
@@ -0,0 +1,91 @@
+#ifndef CLASSPOOL_H
+#define CLASSPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "classfile.h"
+
+namespace kh::jvm::classpool {
+
+enum Error {
+    DuplicateClass,
+    ParseFailed
+};
+
+using Symbol = std::uint32_t;
+
+constexpr auto no_symbol = Symbol{0xFFFFFFFFu};
+
+// NOTE(garrett): Hands out dense IDs for text, starting from zero. Interned
+// text isn't copied, so it has to outlive the table.
+class SymbolTable {
+private:
+    std::vector<std::string_view> texts_;
+    std::unordered_map<std::string_view, Symbol> symbols_;
+public:
+    SymbolTable();
+
+    auto intern(std::string_view) -> Symbol;
+    auto find(std::string_view) const noexcept -> std::optional<Symbol>;
+    auto text(Symbol) const noexcept -> std::string_view;
+    auto size() const noexcept -> std::size_t;
+};
+
+struct PooledClass {
+    std::vector<std::byte> raw;
+    kh::jvm::classfile::ClassFile class_file;
+    // NOTE(garrett): The symbol of every UTF8 entry by constant pool index,
+    // and `no_symbol` for every other index
+    std::vector<Symbol> symbols;
+    Symbol name;
+    // NOTE(garrett): `no_symbol` for classes without one, such as
+    // java/lang/Object and module descriptors
+    Symbol superclass;
+};
+
+// NOTE(garrett): Owns a corpus of classes with every piece of constant pool
+// text interned across all of them as it's added, so names that recur in every
+// class are hashed and stored once, and comparing them between classes is an
+// integer compare. Classes are found by name without hashing through a table
+// indexed by symbol. Added classes never move, and adding isn't thread safe,
+// but reading a pool from any number of threads is.
+class ClassPool {
+private:
+    SymbolTable symbols_;
+    std::deque<PooledClass> classes_;
+    // NOTE(garrett): Index of the class named by each symbol, when there is one
+    std::vector<std::uint32_t> by_name_;
+public:
+    ClassPool();
+    ClassPool(const ClassPool&) = delete;
+    auto operator=(const ClassPool&) -> ClassPool& = delete;
+
+    // NOTE(garrett): The first class added with a name wins, as on a classpath
+    auto add(std::vector<std::byte>&& raw) -> std::expected<const PooledClass*, Error>;
+
+    auto classes() const noexcept -> const std::deque<PooledClass>&;
+    auto symbols() const noexcept -> const SymbolTable&;
+    auto size() const noexcept -> std::size_t;
+
+    auto find(Symbol name) const noexcept -> const PooledClass*;
+    auto find(std::string_view name) const noexcept -> const PooledClass*;
+
+    // NOTE(garrett): Follows a class to its superclass within the pool
+    auto superclass(const PooledClass&) const noexcept -> const PooledClass*;
+};
+
+// NOTE(garrett): Backs `views::ClassView::method` for pooled classes, with
+// `no_symbol` as the descriptor matching any overload
+auto find_method(const PooledClass&, Symbol name, Symbol descriptor = no_symbol) noexcept
+    -> const kh::jvm::method::Method*;
+
+} // namespace kh::jvm::classpool
+
+#endif // CLASSPOOL_H
@@ -0,0 +1,42 @@
+#ifndef CODE_H
+#define CODE_H
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "attribute.h"
+
+namespace kh::jvm::code {
+
+struct ExceptionHandler {
+    std::uint16_t start_pc;
+    std::uint16_t end_pc;
+    std::uint16_t handler_pc;
+    std::uint16_t catch_type;
+};
+
+struct Code {
+    std::uint16_t max_stack;
+    std::uint16_t max_locals;
+    std::span<const std::byte> bytecode;
+    std::vector<ExceptionHandler> exception_table;
+    std::vector<kh::jvm::attribute::Attribute> attributes;
+};
+
+struct LineNumber {
+    std::uint16_t start_pc;
+    std::uint16_t line_number;
+};
+
+struct LocalVariable {
+    std::uint16_t start_pc;
+    std::uint16_t length;
+    std::uint16_t name_index;
+    std::uint16_t descriptor_index;
+    std::uint16_t index;
+};
+
+} // namespace kh::jvm::code
+
+#endif // CODE_H
@@ -0,0 +1,863 @@
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "bytecode.h"
+#include "compaction.h"
+#include "parsing.h"
+#include "serialization.h"
+
+namespace kh::jvm::compaction {
+
+namespace {
+
+using kh::jvm::bytecode::Opcode;
+
+constexpr auto class_debug_attributes = std::to_array<std::string_view>({"SourceFile"});
+
+constexpr auto code_debug_attributes = std::to_array<std::string_view>({
+    "LineNumberTable",
+    "LocalVariableTable",
+    "LocalVariableTypeTable"
+});
+
+// NOTE(garrett): Annotations can nest arbitrarily, this only guards against
+// running out of stack on malicious input.
+constexpr auto max_depth = 64u;
+
+struct Reference {
+    std::uint32_t offset;
+    std::uint8_t width;
+};
+
+// NOTE(garrett): Walks the raw bytes of an attribute recording where each
+// constant pool index sits. Reading past the end, or finding anything
+// malformed, is sticky and reported once scanning has finished.
+class Scanner {
+private:
+    const kh::jvm::constant_pool::ConstantPool& pool_;
+    std::span<const std::byte> data_;
+    std::size_t offset_;
+    std::uint32_t depth_;
+    bool invalid_;
+    bool unsupported_;
+    std::vector<Reference> references_;
+
+    auto ok() const noexcept -> bool {
+        return !invalid_ && !unsupported_;
+    }
+
+    auto skip(const std::size_t count) -> void {
+        if (count > data_.size() - offset_) {
+            invalid_ = true;
+            offset_ = data_.size();
+            return;
+        }
+
+        offset_ += count;
+    }
+
+    auto u1() -> std::uint8_t {
+        if (offset_ + 1 > data_.size()) {
+            invalid_ = true;
+            return 0u;
+        }
+
+        return std::to_integer<std::uint8_t>(data_[offset_++]);
+    }
+
+    auto u2() -> std::uint16_t {
+        const auto high = u1();
+        const auto low = u1();
+
+        return static_cast<std::uint16_t>((high << 8) | low);
+    }
+
+    auto u4() -> std::uint32_t {
+        const auto high = u2();
+        const auto low = u2();
+
+        return (static_cast<std::uint32_t>(high) << 16) | low;
+    }
+
+    auto reference() -> std::uint16_t {
+        references_.push_back(Reference{static_cast<std::uint32_t>(offset_), 2u});
+        return u2();
+    }
+
+    auto references() -> void {
+        const auto count = u2();
+
+        for (auto i = 0u; i < count && ok(); ++i) {
+            reference();
+        }
+    }
+
+    auto verification_type() -> void {
+        const auto tag = u1();
+
+        if (tag == static_cast<std::uint8_t>(kh::jvm::stack_map::VerificationTag::Object)) {
+            reference();
+        } else if (tag == static_cast<std::uint8_t>(
+                kh::jvm::stack_map::VerificationTag::Uninitialized)) {
+            u2();
+        } else if (tag > static_cast<std::uint8_t>(
+                kh::jvm::stack_map::VerificationTag::Uninitialized)) {
+            invalid_ = true;
+        }
+    }
+
+    auto stack_map_table() -> void {
+        const auto count = u2();
+
+        for (auto i = 0u; i < count && ok(); ++i) {
+            const auto type = u1();
+
+            if (type < 64u) {
+                continue;
+            }
+
+            if (type < 128u) {
+                verification_type();
+            } else if (type < 247u) {
+                invalid_ = true;
+            } else if (type == 247u) {
+                u2();
+                verification_type();
+            } else if (type <= 251u) {
+                u2();
+            } else if (type <= 254u) {
+                u2();
+
+                for (auto j = 251u; j < type; ++j) {
+                    verification_type();
+                }
+            } else {
+                u2();
+
+                const auto locals = u2();
+
+                for (auto j = 0u; j < locals && ok(); ++j) {
+                    verification_type();
+                }
+
+                const auto stack = u2();
+
+                for (auto j = 0u; j < stack && ok(); ++j) {
+                    verification_type();
+                }
+            }
+        }
+    }
+
+    auto element_value() -> void {
+        if (++depth_ > max_depth) {
+            invalid_ = true;
+            return;
+        }
+
+        switch (static_cast<char>(u1())) {
+            case 'B': case 'C': case 'D': case 'F': case 'I':
+            case 'J': case 'S': case 'Z': case 's': case 'c':
+                reference();
+                break;
+            case 'e':
+                reference();
+                reference();
+                break;
+            case '@':
+                annotation();
+                break;
+            case '[': {
+                const auto count = u2();
+
+                for (auto i = 0u; i < count && ok(); ++i) {
+                    element_value();
+                }
+
+                break;
+            }
+            default:
+                invalid_ = true;
+        }
+
+        --depth_;
+    }
+
+    auto annotation() -> void {
+        reference();
+
+        const auto pairs = u2();
+
+        for (auto i = 0u; i < pairs && ok(); ++i) {
+            reference();
+            element_value();
+        }
+    }
+
+    auto annotations() -> void {
+        const auto count = u2();
+
+        for (auto i = 0u; i < count && ok(); ++i) {
+            annotation();
+        }
+    }
+
+    auto type_annotation() -> void {
+        const auto target = u1();
+
+        if (target <= 0x01u || target == 0x16u) {
+            u1();
+        } else if (target == 0x10u || target == 0x17u || (target >= 0x42u && target <= 0x46u)) {
+            u2();
+        } else if (target == 0x11u || target == 0x12u) {
+            u1();
+            u1();
+        } else if (target >= 0x13u && target <= 0x15u) {
+            // NOTE(garrett): empty_target
+        } else if (target == 0x40u || target == 0x41u) {
+            skip(u2() * 3uz * sizeof(std::uint16_t));
+        } else if (target >= 0x47u && target <= 0x4Bu) {
+            u2();
+            u1();
+        } else {
+            invalid_ = true;
+            return;
+        }
+
+        skip(u1() * 2uz);
+        annotation();
+    }
+
+    auto module() -> void {
+        reference();
+        u2();
+        reference();
+
+        const auto requires_count = u2();
+
+        for (auto i = 0u; i < requires_count && ok(); ++i) {
+            reference();
+            u2();
+            reference();
+        }
+
+        // NOTE(garrett): Exports and opens share a layout
+        for (auto table = 0u; table < 2u; ++table) {
+            const auto count = u2();
+
+            for (auto i = 0u; i < count && ok(); ++i) {
+                reference();
+                u2();
+                references();
+            }
+        }
+
+        references();
+
+        const auto provides_count = u2();
+
+        for (auto i = 0u; i < provides_count && ok(); ++i) {
+            reference();
+            references();
+        }
+    }
+
+    auto attributes() -> void {
+        const auto count = u2();
+
+        for (auto i = 0u; i < count && ok(); ++i) {
+            const auto name_index = reference();
+            const auto length = u4();
+            const auto* name = pool_.find<kh::jvm::constant_pool::UTF8Entry>(name_index);
+
+            if (!name) {
+                invalid_ = true;
+                return;
+            }
+
+            body(name->text, length);
+        }
+    }
+public:
+    Scanner(
+            const kh::jvm::constant_pool::ConstantPool& pool,
+            std::span<const std::byte> data)
+        : pool_(pool)
+        , data_(data)
+        , offset_(0)
+        , depth_(0)
+        , invalid_(false)
+        , unsupported_(false)
+        , references_(std::vector<Reference>{}) {}
+
+    auto body(std::string_view name, const std::size_t length) -> void {
+        if (length > data_.size() - offset_) {
+            invalid_ = true;
+            return;
+        }
+
+        const auto end = offset_ + length;
+
+        if (name == "ConstantValue"
+                || name == "Signature"
+                || name == "SourceFile"
+                || name == "NestHost"
+                || name == "ModuleMainClass") {
+            reference();
+        } else if (name == "Exceptions"
+                || name == "NestMembers"
+                || name == "PermittedSubclasses"
+                || name == "ModulePackages") {
+            references();
+        } else if (name == "Synthetic"
+                || name == "Deprecated"
+                || name == "SourceDebugExtension"
+                || name == "LineNumberTable") {
+            skip(length);
+        } else if (name == "InnerClasses") {
+            const auto count = u2();
+
+            for (auto i = 0u; i < count && ok(); ++i) {
+                reference();
+                reference();
+                reference();
+                u2();
+            }
+        } else if (name == "EnclosingMethod") {
+            reference();
+            reference();
+        } else if (name == "LocalVariableTable" || name == "LocalVariableTypeTable") {
+            const auto count = u2();
+
+            for (auto i = 0u; i < count && ok(); ++i) {
+                u2();
+                u2();
+                reference();
+                reference();
+                u2();
+            }
+        } else if (name == "StackMapTable") {
+            stack_map_table();
+        } else if (name == "RuntimeVisibleAnnotations"
+                || name == "RuntimeInvisibleAnnotations") {
+            annotations();
+        } else if (name == "RuntimeVisibleParameterAnnotations"
+                || name == "RuntimeInvisibleParameterAnnotations") {
+            const auto parameters = u1();
+
+            for (auto i = 0u; i < parameters && ok(); ++i) {
+                annotations();
+            }
+        } else if (name == "RuntimeVisibleTypeAnnotations"
+                || name == "RuntimeInvisibleTypeAnnotations") {
+            const auto count = u2();
+
+            for (auto i = 0u; i < count && ok(); ++i) {
+                type_annotation();
+            }
+        } else if (name == "AnnotationDefault") {
+            element_value();
+        } else if (name == "BootstrapMethods") {
+            const auto count = u2();
+
+            for (auto i = 0u; i < count && ok(); ++i) {
+                reference();
+                references();
+            }
+        } else if (name == "MethodParameters") {
+            const auto count = u1();
+
+            for (auto i = 0u; i < count && ok(); ++i) {
+                reference();
+                u2();
+            }
+        } else if (name == "Module") {
+            module();
+        } else if (name == "Record") {
+            const auto count = u2();
+
+            for (auto i = 0u; i < count && ok(); ++i) {
+                reference();
+                reference();
+                attributes();
+            }
+        } else {
+            unsupported_ = true;
+            return;
+        }
+
+        if (offset_ != end) {
+            invalid_ = true;
+        }
+    }
+
+    auto finish() && -> std::expected<std::vector<Reference>, Error> {
+        if (unsupported_) {
+            return std::unexpected(Error::UnsupportedAttribute);
+        }
+
+        if (invalid_ || offset_ != data_.size()) {
+            return std::unexpected(Error::InvalidAttribute);
+        }
+
+        return std::move(references_);
+    }
+};
+
+auto scan_bytecode(std::span<const std::byte> bytecode)
+        -> std::expected<std::vector<Reference>, Error> {
+    const auto instructions = kh::jvm::bytecode::decode(bytecode);
+
+    if (!instructions) {
+        return std::unexpected(Error::InvalidBytecode);
+    }
+
+    auto references = std::vector<Reference>{};
+
+    for (const auto& instruction : instructions.value()) {
+        switch (instruction.opcode) {
+            case Opcode::LDC:
+                references.push_back(Reference{instruction.offset + 1u, 1u});
+                break;
+            case Opcode::LDC_W:
+            case Opcode::LDC2_W:
+            case Opcode::GETSTATIC:
+            case Opcode::PUTSTATIC:
+            case Opcode::GETFIELD:
+            case Opcode::PUTFIELD:
+            case Opcode::INVOKEVIRTUAL:
+            case Opcode::INVOKESPECIAL:
+            case Opcode::INVOKESTATIC:
+            case Opcode::INVOKEINTERFACE:
+            case Opcode::INVOKEDYNAMIC:
+            case Opcode::NEW:
+            case Opcode::ANEWARRAY:
+            case Opcode::CHECKCAST:
+            case Opcode::INSTANCEOF:
+            case Opcode::MULTIANEWARRAY:
+                references.push_back(Reference{instruction.offset + 1u, 2u});
+                break;
+            default:
+                break;
+        }
+    }
+
+    return references;
+}
+
+// NOTE(garrett): Pool entries refer to at most two others
+auto entry_references(kh::jvm::constant_pool::Entry& entry)
+        -> std::array<std::uint16_t*, 2> {
+    using namespace kh::jvm::constant_pool;
+
+    return std::visit([](auto& e) -> std::array<std::uint16_t*, 2> {
+        using T = std::decay_t<decltype(e)>;
+
+        if constexpr (std::is_same_v<T, ClassEntry>
+                || std::is_same_v<T, ModuleEntry>
+                || std::is_same_v<T, PackageEntry>) {
+            return {&e.name_index, nullptr};
+        } else if constexpr (std::is_same_v<T, StringEntry>) {
+            return {&e.string_index, nullptr};
+        } else if constexpr (std::is_same_v<T, FieldReferenceEntry>
+                || std::is_same_v<T, MethodReferenceEntry>
+                || std::is_same_v<T, InterfaceMethodReferenceEntry>) {
+            return {&e.class_index, &e.name_and_type_index};
+        } else if constexpr (std::is_same_v<T, NameAndTypeEntry>) {
+            return {&e.name_index, &e.descriptor_index};
+        } else if constexpr (std::is_same_v<T, MethodHandleEntry>) {
+            return {&e.reference_index, nullptr};
+        } else if constexpr (std::is_same_v<T, MethodTypeEntry>) {
+            return {&e.descriptor_index, nullptr};
+        } else if constexpr (std::is_same_v<T, DynamicEntry>
+                || std::is_same_v<T, InvokeDynamicEntry>) {
+            return {&e.name_and_type_index, nullptr};
+        } else {
+            return {nullptr, nullptr};
+        }
+    }, entry);
+}
+
+// NOTE(garrett): The class is walked twice with the same code, first to mark
+// which entries are reachable and then to renumber them. Everything that can
+// fail does so during the first walk, so a class is never left half rewritten.
+class Compactor {
+private:
+    kh::jvm::classfile::ClassFile& klass_;
+    kh::arena::Arena& arena_;
+    const Options& options_;
+    std::vector<std::optional<std::size_t>> slots_;
+    std::vector<bool> used_;
+    std::vector<std::uint16_t> mapping_;
+    bool rewriting_;
+    std::size_t removed_attributes_;
+
+    auto visit(std::uint16_t& index) -> std::expected<void, Error> {
+        if (!index) {
+            return {};
+        }
+
+        if (index >= slots_.size() || !slots_[index]) {
+            return std::unexpected(Error::InvalidConstant);
+        }
+
+        if (rewriting_) {
+            index = mapping_[index];
+        } else {
+            used_[index] = true;
+        }
+
+        return {};
+    }
+
+    auto patch(std::span<const std::byte> data, std::span<const Reference> references)
+            -> std::expected<std::span<const std::byte>, Error> {
+        auto patched = std::vector<std::byte>{};
+
+        for (const auto reference : references) {
+            const auto high = reference.width == 2u
+                ? std::to_integer<std::uint16_t>(data[reference.offset]) << 8
+                : 0u;
+            const auto low = std::to_integer<std::uint16_t>(
+                data[reference.offset + reference.width - 1u]
+            );
+
+            const auto original = static_cast<std::uint16_t>(high | low);
+            auto index = original;
+
+            if (const auto result = visit(index); !result) {
+                return std::unexpected(result.error());
+            }
+
+            if (index == original) {
+                continue;
+            }
+
+            if (patched.empty()) {
+                patched.assign(data.begin(), data.end());
+            }
+
+            if (reference.width == 2u) {
+                patched[reference.offset] = static_cast<std::byte>(index >> 8);
+            }
+
+            patched[reference.offset + reference.width - 1u] = static_cast<std::byte>(index);
+        }
+
+        if (patched.empty()) {
+            return data;
+        }
+
+        return arena_.store(std::move(patched));
+    }
+
+    auto visit_code(kh::jvm::attribute::Attribute& attribute) -> std::expected<void, Error> {
+        auto reader = kh::reader::Reader{attribute.data};
+        auto code = kh::jvm::parsing::parse_code(reader);
+
+        if (!code || !reader.remaining().empty()) {
+            return std::unexpected(Error::InvalidAttribute);
+        }
+
+        const auto references = scan_bytecode(code->bytecode);
+
+        if (!references) {
+            return std::unexpected(references.error());
+        }
+
+        const auto bytecode = patch(code->bytecode, references.value());
+
+        if (!bytecode) {
+            return std::unexpected(bytecode.error());
+        }
+
+        auto changed = bytecode->data() != code->bytecode.data();
+        code->bytecode = bytecode.value();
+
+        for (auto& handler : code->exception_table) {
+            const auto original = handler.catch_type;
+
+            if (const auto result = visit(handler.catch_type); !result) {
+                return result;
+            }
+
+            changed = changed || handler.catch_type != original;
+        }
+
+        const auto original_attributes = code->attributes;
+        const auto visited = visit_attributes(code->attributes, code_debug_attributes);
+
+        if (!visited) {
+            return visited;
+        }
+
+        changed = changed || !std::ranges::equal(
+            original_attributes,
+            code->attributes,
+            [](const auto& a, const auto& b) {
+                return a.name_index == b.name_index && a.data.data() == b.data.data();
+            }
+        );
+
+        if (changed) {
+            kh::sinks::VectorSink sink{};
+            kh::jvm::serialization::serialize(sink, code.value());
+
+            attribute.data = arena_.store(sink.take());
+        }
+
+        return {};
+    }
+
+    auto visit_attribute(
+            kh::jvm::attribute::Attribute& attribute,
+            std::string_view name) -> std::expected<void, Error> {
+        if (const auto result = visit(attribute.name_index); !result) {
+            return result;
+        }
+
+        if (name == "Code") {
+            return visit_code(attribute);
+        }
+
+        auto scanner = Scanner{klass_.constant_pool, attribute.data};
+        scanner.body(name, attribute.data.size());
+
+        const auto references = std::move(scanner).finish();
+
+        if (!references) {
+            return std::unexpected(references.error());
+        }
+
+        const auto data = patch(attribute.data, references.value());
+
+        if (!data) {
+            return std::unexpected(data.error());
+        }
+
+        attribute.data = data.value();
+        return {};
+    }
+
+    auto visit_attributes(
+            std::vector<kh::jvm::attribute::Attribute>& attributes,
+            std::span<const std::string_view> debug_attributes = {})
+            -> std::expected<void, Error> {
+        for (auto it = attributes.begin(); it != attributes.end();) {
+            const auto* name = klass_.constant_pool.find<kh::jvm::constant_pool::UTF8Entry>(
+                it->name_index
+            );
+
+            if (!name) {
+                return std::unexpected(Error::InvalidConstant);
+            }
+
+            if (options_.strip_debug_info
+                    && std::ranges::find(debug_attributes, name->text)
+                        != debug_attributes.end()) {
+                if (rewriting_) {
+                    it = attributes.erase(it);
+                    ++removed_attributes_;
+                } else {
+                    ++it;
+                }
+
+                continue;
+            }
+
+            if (const auto result = visit_attribute(*it, name->text); !result) {
+                return result;
+            }
+
+            ++it;
+        }
+
+        return {};
+    }
+
+    template <typename T>
+    auto visit_members(std::vector<T>& members) -> std::expected<void, Error> {
+        for (auto& member : members) {
+            if (const auto result = visit(member.name_index); !result) {
+                return result;
+            }
+
+            if (const auto result = visit(member.descriptor_index); !result) {
+                return result;
+            }
+
+            if (const auto result = visit_attributes(member.attributes); !result) {
+                return result;
+            }
+        }
+
+        return {};
+    }
+
+    auto visit_class() -> std::expected<void, Error> {
+        if (const auto result = visit(klass_.class_index); !result) {
+            return result;
+        }
+
+        if (const auto result = visit(klass_.superclass_index); !result) {
+            return result;
+        }
+
+        for (auto& interface : klass_.interfaces) {
+            if (const auto result = visit(interface); !result) {
+                return result;
+            }
+        }
+
+        if (const auto result = visit_members(klass_.fields); !result) {
+            return result;
+        }
+
+        if (const auto result = visit_members(klass_.methods); !result) {
+            return result;
+        }
+
+        return visit_attributes(klass_.attributes, class_debug_attributes);
+    }
+
+    auto mark_entries() -> std::expected<void, Error> {
+        const auto& entries = klass_.constant_pool.entries();
+        auto pending = std::vector<std::uint16_t>{};
+
+        for (auto index = 1uz; index < used_.size(); ++index) {
+            if (used_[index]) {
+                pending.push_back(static_cast<std::uint16_t>(index));
+            }
+        }
+
+        while (!pending.empty()) {
+            auto entry = entries[slots_[pending.back()].value()];
+            pending.pop_back();
+
+            for (auto* reference : entry_references(entry)) {
+                if (!reference || !*reference) {
+                    continue;
+                }
+
+                const auto index = *reference;
+
+                if (index >= slots_.size() || !slots_[index]) {
+                    return std::unexpected(Error::InvalidConstant);
+                }
+
+                if (!used_[index]) {
+                    used_[index] = true;
+                    pending.push_back(index);
+                }
+            }
+        }
+
+        return {};
+    }
+
+    auto rebuild_pool() -> void {
+        const auto& entries = klass_.constant_pool.entries();
+        auto pool = kh::jvm::constant_pool::ConstantPool{};
+
+        for (auto index = 1uz; index < slots_.size(); ++index) {
+            if (!slots_[index] || !used_[index]) {
+                continue;
+            }
+
+            auto entry = entries[slots_[index].value()];
+
+            for (auto* reference : entry_references(entry)) {
+                if (reference && *reference) {
+                    *reference = mapping_[*reference];
+                }
+            }
+
+            pool.add(entry);
+        }
+
+        klass_.constant_pool = std::move(pool);
+    }
+public:
+    Compactor(
+            kh::jvm::classfile::ClassFile& klass,
+            kh::arena::Arena& arena,
+            const Options& options)
+        : klass_(klass)
+        , arena_(arena)
+        , options_(options)
+        , slots_(std::vector<std::optional<std::size_t>>{std::nullopt})
+        , used_(std::vector<bool>{})
+        , mapping_(std::vector<std::uint16_t>{})
+        , rewriting_(false)
+        , removed_attributes_(0) {
+        const auto& entries = klass_.constant_pool.entries();
+
+        for (auto i = 0uz; i < entries.size(); ++i) {
+            slots_.push_back(i);
+
+            if (kh::jvm::constant_pool::is_wide(entries[i])) {
+                slots_.push_back(std::nullopt);
+            }
+        }
+
+        used_.resize(slots_.size());
+        mapping_.resize(slots_.size());
+    }
+
+    auto run() -> std::expected<Statistics, Error> {
+        if (const auto result = visit_class(); !result) {
+            return std::unexpected(result.error());
+        }
+
+        if (const auto result = mark_entries(); !result) {
+            return std::unexpected(result.error());
+        }
+
+        const auto& entries = klass_.constant_pool.entries();
+        auto removed_entries = 0uz;
+        auto next = 1u;
+
+        for (auto index = 1uz; index < slots_.size(); ++index) {
+            if (!slots_[index]) {
+                continue;
+            }
+
+            if (!used_[index]) {
+                ++removed_entries;
+                continue;
+            }
+
+            mapping_[index] = static_cast<std::uint16_t>(next);
+            next += kh::jvm::constant_pool::is_wide(entries[slots_[index].value()]) ? 2u : 1u;
+        }
+
+        if (!removed_entries && !options_.strip_debug_info) {
+            return Statistics{0uz, 0uz};
+        }
+
+        rewriting_ = true;
+
+        // NOTE(garrett): Every reference was validated while marking
+        static_cast<void>(visit_class());
+
+        if (removed_entries) {
+            rebuild_pool();
+        }
+
+        return Statistics{removed_entries, removed_attributes_};
+    }
+};
+
+} // namespace
+
+auto compact(
+        kh::jvm::classfile::ClassFile& klass,
+        kh::arena::Arena& arena,
+        const Options& options) -> std::expected<Statistics, Error> {
+    return Compactor{klass, arena, options}.run();
+}
+
+} // namespace kh::jvm::compaction
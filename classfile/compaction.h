@@ -0,0 +1,45 @@
+#ifndef COMPACTION_H
+#define COMPACTION_H
+
+#include <cstddef>
+#include <expected>
+
+#include "arena.h"
+#include "classfile.h"
+
+namespace kh::jvm::compaction {
+
+enum Error {
+    InvalidAttribute,
+    InvalidBytecode,
+    InvalidConstant,
+    UnsupportedAttribute
+};
+
+struct Options {
+    // NOTE(garrett): Drops LineNumberTable, LocalVariableTable and
+    // LocalVariableTypeTable from every method along with the class's
+    // SourceFile. None of them affect execution.
+    bool strip_debug_info = false;
+};
+
+struct Statistics {
+    std::size_t removed_entries;
+    std::size_t removed_attributes;
+};
+
+// NOTE(garrett): Removes constant pool entries that nothing in the class
+// refers to and renumbers the rest, keeping their relative order so that
+// `ldc` operands never outgrow a single byte. References are collected from
+// the class structure, bytecode operands and every attribute defined by the
+// JVMS. Attributes with any other name can't be renumbered safely, so they
+// cause the class to be left alone. Rewritten attribute data is stored in
+// `arena`, and untouched members keep copying through from their source.
+auto compact(
+        kh::jvm::classfile::ClassFile&,
+        kh::arena::Arena&,
+        const Options& options = Options{}) -> std::expected<Statistics, Error>;
+
+} // namespace kh::jvm::compaction
+
+#endif // COMPACTION_H
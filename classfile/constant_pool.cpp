@@ -1,3 +1,5 @@
+#include <tuple>
+
 #include "constant_pool.h"
 
 namespace kh::jvm::constant_pool {
@@ -5,7 +7,10 @@ namespace kh::jvm::constant_pool {
 ConstantPool::ConstantPool()
         : entries_(std::deque<Entry>{})
         , resolution_table_(std::vector<std::optional<std::size_t>>{})
-        , text_entries_(std::unordered_map<std::string_view, std::size_t>{}) {
+        , text_entries_(std::unordered_map<std::string_view, std::size_t>{})
+        , text_indexed_(false)
+        , source_(std::span<const std::byte>{})
+        , source_entries_(0) {
     // NOTE(garrett): Index zero is reserved, access should be 1-indexed so we
     // can grab data directly from other classfile references
     resolution_table_.push_back(std::nullopt);
@@ -25,25 +30,152 @@ auto ConstantPool::add(const Entry entry) -> std::size_t {
     const auto resolution_index = resolution_table_.size() - 1;
 
     if (std::holds_alternative<UTF8Entry>(entry)) {
-        const auto text_entry = std::get<UTF8Entry>(entry);
-        text_entries_.try_emplace(text_entry.text, resolution_index);
+        if (text_indexed_) {
+            const auto text_entry = std::get<UTF8Entry>(entry);
+            text_entries_.try_emplace(text_entry.text, resolution_index);
+        }
+    } else if (is_wide(entry)) {
+        resolution_table_.push_back(std::nullopt);
     }
 
     return resolution_index;
 }
 
+auto ConstantPool::count() const noexcept -> std::size_t {
+    return resolution_table_.size();
+}
+
 auto ConstantPool::entries() const -> const std::deque<Entry>& {
     return entries_;
 }
 
-auto ConstantPool::try_add_utf8_entry(std::string_view text) -> std::size_t {
-    const auto search_result = text_entries_.find(text);
+auto ConstantPool::find_entry(const Entry& entry) const noexcept
+        -> std::optional<std::size_t> {
+    if (const auto* text_entry = std::get_if<UTF8Entry>(&entry); text_entry && text_indexed_) {
+        const auto search_result = text_entries_.find(text_entry->text);
+
+        if (search_result == text_entries_.end()) {
+            return std::nullopt;
+        }
 
-    if (search_result != text_entries_.end()) {
         return search_result->second;
     }
 
-    return add(UTF8Entry{text});
+    // NOTE(garrett): Non-text entries are rarely added after parsing, so a
+    // linear search is preferred over keeping another index up to date. Text
+    // entries only get here before the index is built.
+    for (auto i = 1uz; i < resolution_table_.size(); ++i) {
+        const auto entry_idx = resolution_table_[i];
+
+        if (entry_idx.has_value() && entries_[entry_idx.value()] == entry) {
+            return i;
+        }
+    }
+
+    return std::nullopt;
+}
+
+auto ConstantPool::index_text() -> void {
+    if (text_indexed_) {
+        return;
+    }
+
+    for (auto i = 1uz; i < resolution_table_.size(); ++i) {
+        const auto entry_idx = resolution_table_[i];
+
+        if (!entry_idx.has_value()) {
+            continue;
+        }
+
+        if (const auto* text_entry = std::get_if<UTF8Entry>(&entries_[entry_idx.value()])) {
+            text_entries_.try_emplace(text_entry->text, i);
+        }
+    }
+
+    text_indexed_ = true;
+}
+
+auto ConstantPool::text_index_size() const noexcept -> std::size_t {
+    using Node = std::tuple<void*, decltype(text_entries_)::value_type, std::size_t>;
+
+    return text_entries_.bucket_count() * sizeof(void*) + text_entries_.size() * sizeof(Node);
+}
+
+auto ConstantPool::set_source(std::span<const std::byte> source) noexcept -> void {
+    source_ = source;
+    source_entries_ = entries_.size();
+}
+
+auto ConstantPool::source() const noexcept -> std::span<const std::byte> {
+    return source_;
+}
+
+auto ConstantPool::source_entries() const noexcept -> std::size_t {
+    return source_entries_;
+}
+
+auto ConstantPool::try_add(const Entry entry) -> std::size_t {
+    if (std::holds_alternative<UTF8Entry>(entry)) {
+        index_text();
+    }
+
+    if (const auto index = find_entry(entry)) {
+        return index.value();
+    }
+
+    return add(entry);
+}
+
+auto ConstantPool::try_add_class_entry(std::string_view name) -> std::size_t {
+    const auto name_index = try_add_utf8_entry(name);
+    return try_add(ClassEntry{static_cast<std::uint16_t>(name_index)});
+}
+
+auto ConstantPool::try_add_field_reference(
+        std::string_view class_name,
+        std::string_view name,
+        std::string_view descriptor) -> std::size_t {
+    const auto class_index = try_add_class_entry(class_name);
+    const auto name_and_type_index = try_add_name_and_type(name, descriptor);
+
+    return try_add(FieldReferenceEntry{
+        static_cast<std::uint16_t>(class_index),
+        static_cast<std::uint16_t>(name_and_type_index)
+    });
+}
+
+auto ConstantPool::try_add_method_reference(
+        std::string_view class_name,
+        std::string_view name,
+        std::string_view descriptor) -> std::size_t {
+    const auto class_index = try_add_class_entry(class_name);
+    const auto name_and_type_index = try_add_name_and_type(name, descriptor);
+
+    return try_add(MethodReferenceEntry{
+        static_cast<std::uint16_t>(class_index),
+        static_cast<std::uint16_t>(name_and_type_index)
+    });
+}
+
+auto ConstantPool::try_add_name_and_type(
+        std::string_view name,
+        std::string_view descriptor) -> std::size_t {
+    const auto name_index = try_add_utf8_entry(name);
+    const auto descriptor_index = try_add_utf8_entry(descriptor);
+
+    return try_add(NameAndTypeEntry{
+        static_cast<std::uint16_t>(name_index),
+        static_cast<std::uint16_t>(descriptor_index)
+    });
+}
+
+auto ConstantPool::try_add_string_entry(std::string_view text) -> std::size_t {
+    const auto text_index = try_add_utf8_entry(text);
+    return try_add(StringEntry{static_cast<std::uint16_t>(text_index)});
+}
+
+auto ConstantPool::try_add_utf8_entry(std::string_view text) -> std::size_t {
+    return try_add(UTF8Entry{text});
 }
 
 } // namespace kh::jvm::constant_pool
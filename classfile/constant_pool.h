@@ -5,6 +5,7 @@
 #include <format>
 #include <initializer_list>
 #include <optional>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
@@ -15,47 +16,218 @@ namespace kh::jvm::constant_pool {
 
 enum class Tag : uint8_t {
     UTF8 = 1,
+    Integer = 3,
+    Float = 4,
+    Long = 5,
+    Double = 6,
     Class = 7,
+    String = 8,
+    FieldReference = 9,
     MethodReference = 10,
-    NameAndType = 12
+    InterfaceMethodReference = 11,
+    NameAndType = 12,
+    MethodHandle = 15,
+    MethodType = 16,
+    Dynamic = 17,
+    InvokeDynamic = 18,
+    Module = 19,
+    Package = 20
 };
 
 struct ClassEntry {
     uint16_t name_index;
+
+    friend auto operator==(const ClassEntry&, const ClassEntry&) -> bool = default;
+};
+
+struct DoubleEntry {
+    uint64_t bits;
+
+    friend auto operator==(const DoubleEntry&, const DoubleEntry&) -> bool = default;
+};
+
+struct DynamicEntry {
+    uint16_t bootstrap_method_attr_index;
+    uint16_t name_and_type_index;
+
+    friend auto operator==(const DynamicEntry&, const DynamicEntry&) -> bool = default;
+};
+
+struct FieldReferenceEntry {
+    uint16_t class_index;
+    uint16_t name_and_type_index;
+
+    friend auto operator==(
+        const FieldReferenceEntry&,
+        const FieldReferenceEntry&) -> bool = default;
+};
+
+struct FloatEntry {
+    uint32_t bits;
+
+    friend auto operator==(const FloatEntry&, const FloatEntry&) -> bool = default;
+};
+
+struct IntegerEntry {
+    uint32_t value;
+
+    friend auto operator==(const IntegerEntry&, const IntegerEntry&) -> bool = default;
+};
+
+struct InterfaceMethodReferenceEntry {
+    uint16_t class_index;
+    uint16_t name_and_type_index;
+
+    friend auto operator==(
+        const InterfaceMethodReferenceEntry&,
+        const InterfaceMethodReferenceEntry&) -> bool = default;
+};
+
+struct InvokeDynamicEntry {
+    uint16_t bootstrap_method_attr_index;
+    uint16_t name_and_type_index;
+
+    friend auto operator==(
+        const InvokeDynamicEntry&,
+        const InvokeDynamicEntry&) -> bool = default;
+};
+
+struct LongEntry {
+    uint64_t value;
+
+    friend auto operator==(const LongEntry&, const LongEntry&) -> bool = default;
+};
+
+struct MethodHandleEntry {
+    uint8_t reference_kind;
+    uint16_t reference_index;
+
+    friend auto operator==(
+        const MethodHandleEntry&,
+        const MethodHandleEntry&) -> bool = default;
 };
 
 struct MethodReferenceEntry {
     uint16_t class_index;
     uint16_t name_and_type_index;
+
+    friend auto operator==(
+        const MethodReferenceEntry&,
+        const MethodReferenceEntry&) -> bool = default;
+};
+
+struct MethodTypeEntry {
+    uint16_t descriptor_index;
+
+    friend auto operator==(const MethodTypeEntry&, const MethodTypeEntry&) -> bool = default;
+};
+
+struct ModuleEntry {
+    uint16_t name_index;
+
+    friend auto operator==(const ModuleEntry&, const ModuleEntry&) -> bool = default;
 };
 
 struct NameAndTypeEntry {
     uint16_t name_index;
     uint16_t descriptor_index;
+
+    friend auto operator==(
+        const NameAndTypeEntry&,
+        const NameAndTypeEntry&) -> bool = default;
+};
+
+struct PackageEntry {
+    uint16_t name_index;
+
+    friend auto operator==(const PackageEntry&, const PackageEntry&) -> bool = default;
+};
+
+struct StringEntry {
+    uint16_t string_index;
+
+    friend auto operator==(const StringEntry&, const StringEntry&) -> bool = default;
 };
 
 struct UTF8Entry {
     std::string_view text;
+
+    friend auto operator==(const UTF8Entry&, const UTF8Entry&) -> bool = default;
 };
 
 using Entry = std::variant<
     ClassEntry,
+    DoubleEntry,
+    DynamicEntry,
+    FieldReferenceEntry,
+    FloatEntry,
+    IntegerEntry,
+    InterfaceMethodReferenceEntry,
+    InvokeDynamicEntry,
+    LongEntry,
+    MethodHandleEntry,
     MethodReferenceEntry,
+    MethodTypeEntry,
+    ModuleEntry,
     NameAndTypeEntry,
+    PackageEntry,
+    StringEntry,
     UTF8Entry
 >;
 
+// NOTE(garrett): Long and double entries take up two slots in the pool, with
+// the second one being unusable.
+constexpr auto is_wide(const Entry& entry) noexcept -> bool {
+    return std::holds_alternative<LongEntry>(entry)
+        || std::holds_alternative<DoubleEntry>(entry);
+}
+
 class ConstantPool {
 private:
     std::deque<Entry> entries_;
     std::vector<std::optional<std::size_t>> resolution_table_;
+    // NOTE(garrett): Only built once something is added through `try_add`, or
+    // on request, so pools that are parsed and read but never extended don't
+    // pay for it
     std::unordered_map<std::string_view, std::size_t> text_entries_;
+    bool text_indexed_;
+    std::span<const std::byte> source_;
+    std::size_t source_entries_;
 public:
     ConstantPool();
     ConstantPool(std::initializer_list<Entry>);
 
     auto add(const Entry entry) -> std::size_t;
+    auto count() const noexcept -> std::size_t;
     auto entries() const -> const std::deque<Entry>&;
+    // NOTE(garrett): Text is looked up through the index once it's built,
+    // and found by scanning the pool before then
+    auto find_entry(const Entry& entry) const noexcept -> std::optional<std::size_t>;
+    // NOTE(garrett): Builds the text index ahead of the first `try_add`, for
+    // pools about to be shared read-only, such as overlay bases, whose
+    // lookups only go through `find_entry`
+    auto index_text() -> void;
+    // NOTE(garrett): An estimate of what the text index holds on the heap
+    auto text_index_size() const noexcept -> std::size_t;
+    // NOTE(garrett): Entries are only ever appended, so the encoded bytes of
+    // a parsed pool remain valid for its leading `source_entries` entries.
+    auto set_source(std::span<const std::byte>) noexcept -> void;
+    auto source() const noexcept -> std::span<const std::byte>;
+    auto source_entries() const noexcept -> std::size_t;
+    auto try_add(const Entry entry) -> std::size_t;
+    auto try_add_class_entry(std::string_view) -> std::size_t;
+    auto try_add_field_reference(
+        std::string_view class_name,
+        std::string_view name,
+        std::string_view descriptor) -> std::size_t;
+    auto try_add_method_reference(
+        std::string_view class_name,
+        std::string_view name,
+        std::string_view descriptor) -> std::size_t;
+    auto try_add_name_and_type(
+        std::string_view name,
+        std::string_view descriptor) -> std::size_t;
+    auto try_add_string_entry(std::string_view) -> std::size_t;
     auto try_add_utf8_entry(std::string_view) -> std::size_t;
 
     template <typename T>
@@ -90,6 +262,17 @@ public:
 
         return std::get<T>(entry);
     }
+
+    // NOTE(garrett): Non-throwing counterpart to `resolve` for indices that
+    // come from untrusted bytecode
+    template <typename T>
+    auto find(std::uint16_t index) const noexcept -> const T* {
+        if (index >= resolution_table_.size() || !resolution_table_[index].has_value()) {
+            return nullptr;
+        }
+
+        return std::get_if<T>(&entries_[resolution_table_[index].value()]);
+    }
 };
 
 template <typename>
@@ -101,10 +284,36 @@ constexpr auto tag(const Entry entry) -> Tag {
 
         if constexpr (std::same_as<T, ClassEntry>) {
             return Tag::Class;
+        } else if constexpr (std::same_as<T, DoubleEntry>) {
+            return Tag::Double;
+        } else if constexpr (std::same_as<T, DynamicEntry>) {
+            return Tag::Dynamic;
+        } else if constexpr (std::same_as<T, FieldReferenceEntry>) {
+            return Tag::FieldReference;
+        } else if constexpr (std::same_as<T, FloatEntry>) {
+            return Tag::Float;
+        } else if constexpr (std::same_as<T, IntegerEntry>) {
+            return Tag::Integer;
+        } else if constexpr (std::same_as<T, InterfaceMethodReferenceEntry>) {
+            return Tag::InterfaceMethodReference;
+        } else if constexpr (std::same_as<T, InvokeDynamicEntry>) {
+            return Tag::InvokeDynamic;
+        } else if constexpr (std::same_as<T, LongEntry>) {
+            return Tag::Long;
+        } else if constexpr (std::same_as<T, MethodHandleEntry>) {
+            return Tag::MethodHandle;
         } else if constexpr (std::same_as<T, MethodReferenceEntry>) {
             return Tag::MethodReference;
+        } else if constexpr (std::same_as<T, MethodTypeEntry>) {
+            return Tag::MethodType;
+        } else if constexpr (std::same_as<T, ModuleEntry>) {
+            return Tag::Module;
         } else if constexpr (std::same_as<T, NameAndTypeEntry>) {
             return Tag::NameAndType;
+        } else if constexpr (std::same_as<T, PackageEntry>) {
+            return Tag::Package;
+        } else if constexpr (std::same_as<T, StringEntry>) {
+            return Tag::String;
         } else if constexpr (std::same_as<T, UTF8Entry>) {
             return Tag::UTF8;
         } else {
@@ -124,10 +333,36 @@ constexpr auto name(const Entry entry) -> std::string {
 
         if constexpr (std::same_as<T, ClassEntry>) {
             return "Class";
+        } else if constexpr (std::same_as<T, DoubleEntry>) {
+            return "Double";
+        } else if constexpr (std::same_as<T, DynamicEntry>) {
+            return "Dynamic";
+        } else if constexpr (std::same_as<T, FieldReferenceEntry>) {
+            return "FieldReference";
+        } else if constexpr (std::same_as<T, FloatEntry>) {
+            return "Float";
+        } else if constexpr (std::same_as<T, IntegerEntry>) {
+            return "Integer";
+        } else if constexpr (std::same_as<T, InterfaceMethodReferenceEntry>) {
+            return "InterfaceMethodReference";
+        } else if constexpr (std::same_as<T, InvokeDynamicEntry>) {
+            return "InvokeDynamic";
+        } else if constexpr (std::same_as<T, LongEntry>) {
+            return "Long";
+        } else if constexpr (std::same_as<T, MethodHandleEntry>) {
+            return "MethodHandle";
         } else if constexpr (std::same_as<T, MethodReferenceEntry>) {
             return "MethodReference";
+        } else if constexpr (std::same_as<T, MethodTypeEntry>) {
+            return "MethodType";
+        } else if constexpr (std::same_as<T, ModuleEntry>) {
+            return "Module";
         } else if constexpr (std::same_as<T, NameAndTypeEntry>) {
             return "NameAndType";
+        } else if constexpr (std::same_as<T, PackageEntry>) {
+            return "Package";
+        } else if constexpr (std::same_as<T, StringEntry>) {
+            return "String";
         } else if constexpr (std::same_as<T, UTF8Entry>) {
             return "UTF-8";
         } else {
@@ -0,0 +1,230 @@
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "corpus.h"
+#include "jar.h"
+#include "loading.h"
+#include "reader.h"
+
+namespace kh::jvm::corpus {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// NOTE(garrett): Class files below a directory are read in batches of this
+// many, which is also the depth of each worker's loader
+constexpr auto batch_size = 64uz;
+
+struct Worker {
+    std::vector<std::byte> input;
+    kh::arena::Arena arena;
+    kh::loading::Loader loader;
+};
+
+struct State {
+    kh::threading::ThreadPool& pool;
+    const Visitor& visitor;
+    std::atomic<std::size_t> outstanding;
+    std::atomic<std::size_t> classes;
+    std::atomic<std::size_t> failures;
+    std::atomic<std::size_t> bytes;
+    std::mutex mutex;
+    std::condition_variable finished;
+    bool done;
+};
+
+auto worker() -> Worker& {
+    thread_local auto worker = Worker{
+        std::vector<std::byte>{},
+        kh::arena::Arena{},
+        kh::loading::Loader{batch_size}
+    };
+
+    return worker;
+}
+
+// NOTE(garrett): Every task is counted until it has finished, including any
+// it spawns, so the count only reaches zero once the whole corpus is done
+template <typename F>
+auto spawn(State& state, F&& task) -> void {
+    state.outstanding.fetch_add(1u, std::memory_order_relaxed);
+
+    state.pool.post([&state, task = std::forward<F>(task)]() mutable {
+        task();
+
+        if (state.outstanding.fetch_sub(1u, std::memory_order_acq_rel) == 1u) {
+            const auto lock = std::lock_guard{state.mutex};
+
+            state.done = true;
+            state.finished.notify_all();
+        }
+    });
+}
+
+auto visit(State& state, const Source& source) -> void {
+    auto reader = kh::reader::Reader{source.bytes};
+    auto klass = kh::jvm::parsing::parse_class_file(reader);
+
+    (klass ? state.classes : state.failures).fetch_add(1u, std::memory_order_relaxed);
+    state.bytes.fetch_add(source.bytes.size(), std::memory_order_relaxed);
+
+    auto& arena = worker().arena;
+    arena.clear();
+
+    state.visitor(source, klass, arena);
+}
+
+auto visit_files(
+        State& state,
+        const std::size_t input,
+        const std::vector<std::string>& names,
+        const std::vector<std::filesystem::path>& paths) -> void {
+    worker().loader.load(paths, [&](const std::size_t i, const auto contents) {
+        if (!contents) {
+            state.failures.fetch_add(1u, std::memory_order_relaxed);
+            return;
+        }
+
+        visit(state, Source{input, names[i], contents.value()});
+    });
+}
+
+auto walk(
+        State& state,
+        const std::size_t input,
+        const std::filesystem::path& root,
+        const std::filesystem::path& directory) -> void {
+    auto error = std::error_code{};
+    auto names = std::vector<std::string>{};
+    auto paths = std::vector<std::filesystem::path>{};
+
+    auto flush = [&] {
+        spawn(state, [&state, input, names = std::move(names), paths = std::move(paths)] {
+            visit_files(state, input, names, paths);
+        });
+
+        names.clear();
+        paths.clear();
+    };
+
+    auto unreadable = false;
+    auto entries = std::filesystem::directory_iterator{directory, error};
+
+    // NOTE(garrett): Advanced with an error code, as the throwing increment
+    // would escape the pool task
+    for (; !error && entries != std::filesystem::directory_iterator{}; entries.increment(error)) {
+        const auto& entry = *entries;
+        auto status = std::error_code{};
+
+        if (entry.is_directory(status) && !entry.is_symlink(status)) {
+            spawn(state, [&state, input, &root, path = entry.path()] {
+                walk(state, input, root, path);
+            });
+        } else if (entry.is_regular_file(status) && entry.path().extension() == ".class") {
+            names.push_back(entry.path().lexically_relative(root).generic_string());
+            paths.push_back(entry.path());
+
+            if (paths.size() == batch_size) {
+                flush();
+            }
+        }
+
+        unreadable = unreadable || status;
+    }
+
+    if (!paths.empty()) {
+        flush();
+    }
+
+    if (error || unreadable) {
+        state.failures.fetch_add(1u, std::memory_order_relaxed);
+    }
+}
+
+} // namespace
+
+auto parse(
+        std::span<const std::filesystem::path> inputs,
+        kh::threading::ThreadPool& pool,
+        const Visitor& visitor) -> Report {
+    const auto start = Clock::now();
+
+    // NOTE(garrett): Enumerating the inputs counts as a task of its own, so
+    // tasks that finish early can't end the corpus before the rest are spawned
+    auto state = State{
+        pool,
+        visitor,
+        1u,
+        0u,
+        0u,
+        0u,
+        std::mutex{},
+        std::condition_variable{},
+        false
+    };
+
+    // NOTE(garrett): Opened here and kept until every task has finished, since
+    // tasks read straight out of their mappings
+    auto archives = std::deque<kh::jvm::jar::Tree>{};
+
+    for (auto i = 0uz; i < inputs.size(); ++i) {
+        const auto& path = inputs[i];
+        auto error = std::error_code{};
+
+        if (std::filesystem::is_directory(path, error)) {
+            spawn(state, [&state, i, &path] { walk(state, i, path, path); });
+            continue;
+        }
+
+        if (path.extension() == ".class") {
+            spawn(state, [&state, i, &path] {
+                visit_files(state, i, {path.filename().string()}, {path});
+            });
+
+            continue;
+        }
+
+        auto tree = kh::jvm::jar::Tree::open(path);
+
+        if (!tree) {
+            state.failures.fetch_add(1u, std::memory_order_relaxed);
+            continue;
+        }
+
+        for (const auto& nested : archives.emplace_back(std::move(tree.value())).entries()) {
+            if (!nested.path.ends_with(".class")) {
+                continue;
+            }
+
+            spawn(state, [&state, i, &nested] {
+                const auto bytes = nested.archive->extract(*nested.entry, worker().input);
+
+                if (!bytes) {
+                    state.failures.fetch_add(1u, std::memory_order_relaxed);
+                    return;
+                }
+
+                visit(state, Source{i, nested.path, bytes.value()});
+            });
+        }
+    }
+
+    if (state.outstanding.fetch_sub(1u, std::memory_order_acq_rel) != 1u) {
+        auto lock = std::unique_lock{state.mutex};
+        state.finished.wait(lock, [&state] { return state.done; });
+    }
+
+    return Report{
+        state.classes.load(),
+        state.failures.load(),
+        state.bytes.load(),
+        Clock::now() - start
+    };
+}
+
+} // namespace kh::jvm::corpus
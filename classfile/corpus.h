@@ -0,0 +1,60 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <chrono>
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <string_view>
+
+#include "arena.h"
+#include "classfile.h"
+#include "parsing.h"
+#include "threading.h"
+
+namespace kh::jvm::corpus {
+
+struct Source {
+    // NOTE(garrett): Index of the input the class was found in
+    std::size_t input;
+    // NOTE(garrett): Relative to a directory input, or the entry's path in an
+    // archive input, including any nested archives
+    std::string_view name;
+    std::span<const std::byte> bytes;
+};
+
+// NOTE(garrett): Called from every worker at once, so it must be safe to call
+// concurrently and must not throw. Everything it's handed, including the arena,
+// is only valid until it returns.
+using Visitor = std::function<void(
+    const Source&,
+    std::expected<kh::jvm::classfile::ClassFile, kh::jvm::parsing::Error>&,
+    kh::arena::Arena&)>;
+
+struct Report {
+    std::size_t classes;
+    // NOTE(garrett): Classes that couldn't be read or parsed, and inputs that
+    // couldn't be opened
+    std::size_t failures;
+    std::size_t bytes;
+    std::chrono::nanoseconds elapsed;
+};
+
+// NOTE(garrett): Parses every class file in `inputs` on `pool`, handing each
+// to `visitor` as soon as it's parsed, in no particular order. Inputs may be
+// directories, class files or jars, with jars nested in jars traversed too.
+// Directories are walked by the workers themselves, a task per directory, so
+// enumeration overlaps with parsing and wide trees are split between workers
+// by stealing. Class files in a directory are read in batches through each
+// worker's own `kh::loading::Loader`, and each worker reuses its own buffers
+// and arena throughout.
+auto parse(
+        std::span<const std::filesystem::path> inputs,
+        kh::threading::ThreadPool&,
+        const Visitor&) -> Report;
+
+} // namespace kh::jvm::corpus
+
+#endif // CORPUS_H
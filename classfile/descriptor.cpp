@@ -0,0 +1,82 @@
+#include "descriptor.h"
+
+namespace kh::jvm::descriptor {
+
+auto parse_field_type(std::string_view text)
+        -> std::expected<std::string_view, Error> {
+    auto length = 0uz;
+
+    while (length < text.size() && text[length] == '[') {
+        ++length;
+    }
+
+    if (length >= text.size()) {
+        return std::unexpected(Error::InvalidDescriptor);
+    }
+
+    switch (text[length]) {
+        case 'B':
+        case 'C':
+        case 'D':
+        case 'F':
+        case 'I':
+        case 'J':
+        case 'S':
+        case 'Z':
+            return text.substr(0, length + 1);
+        case 'L': {
+            const auto end = text.find(';', length);
+
+            if (end == std::string_view::npos || end == length + 1) {
+                return std::unexpected(Error::InvalidDescriptor);
+            }
+
+            return text.substr(0, end + 1);
+        }
+        default:
+            return std::unexpected(Error::InvalidDescriptor);
+    }
+}
+
+auto parse_method_descriptor(std::string_view text)
+        -> std::expected<MethodDescriptor, Error> {
+    if (text.empty() || text.front() != '(') {
+        return std::unexpected(Error::InvalidDescriptor);
+    }
+
+    auto result = MethodDescriptor{};
+    auto remaining = text.substr(1);
+
+    while (!remaining.empty() && remaining.front() != ')') {
+        const auto parameter = parse_field_type(remaining);
+
+        if (!parameter) {
+            return std::unexpected(parameter.error());
+        }
+
+        result.parameters.push_back(parameter.value());
+        remaining.remove_prefix(parameter.value().size());
+    }
+
+    if (remaining.empty()) {
+        return std::unexpected(Error::InvalidDescriptor);
+    }
+
+    remaining.remove_prefix(1);
+
+    if (remaining == "V") {
+        result.return_type = remaining;
+        return result;
+    }
+
+    const auto return_type = parse_field_type(remaining);
+
+    if (!return_type || return_type.value().size() != remaining.size()) {
+        return std::unexpected(Error::InvalidDescriptor);
+    }
+
+    result.return_type = return_type.value();
+    return result;
+}
+
+} // namespace kh::jvm::descriptor
@@ -0,0 +1,31 @@
+#ifndef DESCRIPTOR_H
+#define DESCRIPTOR_H
+
+#include <expected>
+#include <string_view>
+#include <vector>
+
+namespace kh::jvm::descriptor {
+
+enum Error {
+    InvalidDescriptor
+};
+
+struct MethodDescriptor {
+    std::vector<std::string_view> parameters;
+    std::string_view return_type;
+};
+
+constexpr auto is_wide(std::string_view field_type) noexcept -> bool {
+    return field_type == "J" || field_type == "D";
+}
+
+auto parse_field_type(std::string_view)
+        -> std::expected<std::string_view, Error>;
+
+auto parse_method_descriptor(std::string_view)
+        -> std::expected<MethodDescriptor, Error>;
+
+} // namespace kh::jvm::descriptor
+
+#endif // DESCRIPTOR_H
@@ -13,10 +13,11 @@ template <typename T>
 concept MultiByteIntegral =
     std::same_as<T, uint8_t>
     || std::same_as<T, uint16_t>
-    || std::same_as<T, uint32_t>;
+    || std::same_as<T, uint32_t>
+    || std::same_as<T, uint64_t>;
 
 template <MultiByteIntegral V>
-auto big(V value) {
+constexpr auto big(V value) {
     if constexpr (std::same_as<V, uint8_t>) {
         return value;
     } else {
@@ -30,6 +31,21 @@ auto big(V value) {
     }
 }
 
+template <MultiByteIntegral V>
+constexpr auto little(V value) {
+    if constexpr (std::same_as<V, uint8_t>) {
+        return value;
+    } else {
+        V result = value;
+
+        if constexpr (std::endian::native == std::endian::little) {
+            return result;
+        } else {
+            return std::byteswap(result);
+        }
+    }
+}
+
 } // namespace kh::endian
 
 }
@@ -0,0 +1,36 @@
+#ifndef FIELD_H
+#define FIELD_H
+
+#include <span>
+#include <vector>
+
+#include "attribute.h"
+
+namespace kh::jvm::field {
+
+enum class AccessFlags : uint16_t {
+    ACC_PUBLIC = 0x0001,
+    ACC_PRIVATE = 0x0002,
+    ACC_PROTECTED = 0x0004,
+    ACC_STATIC = 0x0008,
+    ACC_FINAL = 0x0010,
+    ACC_VOLATILE = 0x0040,
+    ACC_TRANSIENT = 0x0080,
+    ACC_SYNTHETIC = 0x1000,
+    ACC_ENUM = 0x4000
+};
+
+struct Field {
+    std::uint16_t access_flags;
+    std::uint16_t name_index;
+    std::uint16_t descriptor_index;
+    std::vector<kh::jvm::attribute::Attribute> attributes;
+    // NOTE(garrett): Encoded bytes this was parsed from, empty for members
+    // created from scratch. Serialization copies them through verbatim when
+    // nothing has been changed since.
+    std::span<const std::byte> source{};
+};
+
+} // namespace kh::jvm::field
+
+#endif // FIELD_H
@@ -0,0 +1,145 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <version>
+
+#if defined(__cpp_lib_generator)
+#include <generator>
+#else
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#endif
+
+namespace kh::generator {
+
+#if defined(__cpp_lib_generator)
+
+template <typename Reference>
+using Generator = std::generator<Reference>;
+
+#else
+
+// NOTE(garrett): Stands in for std::generator on standard libraries that don't
+// ship it yet. Only reference types are supported, since yielded values are
+// handed out by address while the coroutine is suspended.
+template <typename Reference>
+class Generator : public std::ranges::view_interface<Generator<Reference>> {
+    static_assert(std::is_reference_v<Reference>);
+public:
+    struct promise_type;
+private:
+    std::coroutine_handle<promise_type> handle_;
+
+    explicit Generator(const std::coroutine_handle<promise_type> handle) noexcept
+            : handle_(handle) {}
+public:
+    struct promise_type {
+        std::add_pointer_t<Reference> current = nullptr;
+        std::exception_ptr exception = nullptr;
+
+        auto get_return_object() noexcept -> Generator {
+            return Generator{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        auto initial_suspend() const noexcept -> std::suspend_always {
+            return {};
+        }
+
+        auto final_suspend() const noexcept -> std::suspend_always {
+            return {};
+        }
+
+        auto yield_value(Reference value) noexcept -> std::suspend_always {
+            current = std::addressof(value);
+            return {};
+        }
+
+        auto return_void() const noexcept -> void {}
+
+        auto unhandled_exception() noexcept -> void {
+            exception = std::current_exception();
+        }
+
+        template <typename U>
+        auto await_transform(U&&) -> std::suspend_never = delete;
+    };
+
+    class iterator {
+    private:
+        std::coroutine_handle<promise_type> handle_;
+    public:
+        using value_type = std::remove_cvref_t<Reference>;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() noexcept
+                : handle_(nullptr) {}
+
+        explicit iterator(const std::coroutine_handle<promise_type> handle) noexcept
+                : handle_(handle) {}
+
+        auto operator*() const noexcept -> Reference {
+            return static_cast<Reference>(*handle_.promise().current);
+        }
+
+        auto operator++() -> iterator& {
+            handle_.resume();
+
+            if (handle_.promise().exception) {
+                std::rethrow_exception(std::exchange(handle_.promise().exception, nullptr));
+            }
+
+            return *this;
+        }
+
+        auto operator++(int) -> void {
+            ++*this;
+        }
+
+        auto operator==(std::default_sentinel_t) const noexcept -> bool {
+            return !handle_ || handle_.done();
+        }
+    };
+
+    Generator(Generator&& other) noexcept
+            : handle_(std::exchange(other.handle_, nullptr)) {}
+
+    auto operator=(Generator&& other) noexcept -> Generator& {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+
+        return *this;
+    }
+
+    ~Generator() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    // NOTE(garrett): Like std::generator, can only be iterated once
+    auto begin() -> iterator {
+        auto started = iterator{handle_};
+        ++started;
+
+        return started;
+    }
+
+    auto end() const noexcept -> std::default_sentinel_t {
+        return std::default_sentinel;
+    }
+};
+
+#endif
+
+} // namespace kh::generator
+
+#endif // GENERATOR_H
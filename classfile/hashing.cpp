@@ -0,0 +1,100 @@
+#include <array>
+#include <bit>
+#include <cstring>
+
+#include "endian.h"
+#include "hashing.h"
+
+namespace kh::hashing {
+
+namespace {
+
+constexpr auto prime_1 = std::uint64_t{0x9E3779B185EBCA87u};
+constexpr auto prime_2 = std::uint64_t{0xC2B2AE3D27D4EB4Fu};
+constexpr auto prime_3 = std::uint64_t{0x165667B19E3779F9u};
+constexpr auto prime_4 = std::uint64_t{0x85EBCA77C2B2AE63u};
+constexpr auto prime_5 = std::uint64_t{0x27D4EB2F165667C5u};
+
+template <kh::endian::MultiByteIntegral V>
+auto load(const std::byte* data) noexcept -> V {
+    auto value = V{};
+    std::memcpy(&value, data, sizeof(V));
+
+    return kh::endian::little(value);
+}
+
+constexpr auto round(std::uint64_t accumulator, const std::uint64_t input) noexcept
+        -> std::uint64_t {
+    accumulator += input * prime_2;
+    accumulator = std::rotl(accumulator, 31);
+
+    return accumulator * prime_1;
+}
+
+constexpr auto merge(std::uint64_t accumulator, const std::uint64_t lane) noexcept
+        -> std::uint64_t {
+    accumulator ^= round(0u, lane);
+    return accumulator * prime_1 + prime_4;
+}
+
+} // namespace
+
+auto xxh64(std::span<const std::byte> data, const std::uint64_t seed) noexcept
+        -> std::uint64_t {
+    const auto length = data.size();
+    auto position = data.data();
+    const auto end = position + length;
+    auto hash = std::uint64_t{};
+
+    if (length >= 32u) {
+        auto lanes = std::array<std::uint64_t, 4>{
+            seed + prime_1 + prime_2,
+            seed + prime_2,
+            seed,
+            seed - prime_1
+        };
+
+        for (; end - position >= 32; position += 32) {
+            for (auto i = 0uz; i < lanes.size(); ++i) {
+                lanes[i] = round(lanes[i], load<std::uint64_t>(position + 8u * i));
+            }
+        }
+
+        hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7)
+            + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+
+        for (const auto lane : lanes) {
+            hash = merge(hash, lane);
+        }
+    } else {
+        hash = seed + prime_5;
+    }
+
+    hash += length;
+
+    for (; end - position >= 8; position += 8) {
+        hash ^= round(0u, load<std::uint64_t>(position));
+        hash = std::rotl(hash, 27) * prime_1 + prime_4;
+    }
+
+    if (end - position >= 4) {
+        hash ^= load<std::uint32_t>(position) * prime_1;
+        hash = std::rotl(hash, 23) * prime_2 + prime_3;
+        position += 4;
+    }
+
+    for (; position < end; ++position) {
+        hash ^= std::to_integer<std::uint64_t>(*position) * prime_5;
+        hash = std::rotl(hash, 11) * prime_1;
+    }
+
+    hash ^= hash >> 33u;
+    hash *= prime_2;
+    hash ^= hash >> 29u;
+    hash *= prime_3;
+    hash ^= hash >> 32u;
+
+    return hash;
+}
+
+} // namespace kh::hashing
@@ -0,0 +1,16 @@
+#ifndef HASHING_H
+#define HASHING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace kh::hashing {
+
+// NOTE(garrett): XXH64, matching the reference implementation for any seed.
+// Not cryptographic, only suited to detecting accidental changes.
+auto xxh64(std::span<const std::byte>, std::uint64_t seed = 0u) noexcept -> std::uint64_t;
+
+} // namespace kh::hashing
+
+#endif // HASHING_H
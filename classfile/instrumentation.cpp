@@ -0,0 +1,1093 @@
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <optional>
+
+#include "bytecode.h"
+#include "instrumentation.h"
+#include "rewriting.h"
+#include "serialization.h"
+#include "views.h"
+
+namespace kh::jvm::instrumentation {
+
+namespace {
+
+using kh::jvm::bytecode::Assembler;
+using kh::jvm::bytecode::Opcode;
+
+// NOTE(garrett): Striped countdowns are spread a cache line apart, sixteen
+// ints, so that threads on different stripes never share a line
+constexpr auto countdown_stripes = std::int16_t{64};
+constexpr auto countdown_stride_shift = std::int16_t{4};
+
+constexpr auto has_flag(const std::uint16_t flags, const auto flag) noexcept -> bool {
+    return (flags & static_cast<std::uint16_t>(flag)) != 0;
+}
+
+auto index(const std::size_t value) -> std::uint16_t {
+    return static_cast<std::uint16_t>(value);
+}
+
+auto add_method(
+        kh::jvm::classfile::ClassFile& klass,
+        kh::arena::Arena& arena,
+        const std::uint16_t access_flags,
+        std::string_view name,
+        std::string_view descriptor,
+        const kh::jvm::code::Code& code) -> void {
+    auto& pool = klass.constant_pool;
+    auto sink = kh::sinks::VectorSink{};
+
+    kh::jvm::serialization::serialize(sink, code);
+
+    klass.methods.push_back(
+        kh::jvm::method::Method{
+            .access_flags = access_flags,
+            .name_index = index(pool.try_add_utf8_entry(name)),
+            .descriptor_index = index(pool.try_add_utf8_entry(descriptor)),
+            .attributes = std::vector<kh::jvm::attribute::Attribute>{
+                kh::jvm::attribute::Attribute{
+                    index(pool.try_add_utf8_entry("Code")),
+                    arena.store(sink.take())
+                }
+            },
+            .source = std::span<const std::byte>{}
+        }
+    );
+}
+
+// NOTE(garrett): Runs the given straight-line code ahead of anything else in
+// the class initializer, creating one when the class doesn't have it yet.
+auto prepend_static_initializer(
+        kh::jvm::classfile::ClassFile& klass,
+        kh::arena::Arena& arena,
+        std::span<const std::byte> code,
+        const std::uint16_t max_stack) -> std::expected<void, Error> {
+    const auto view = kh::jvm::views::ClassView{klass};
+    const auto initializer = view.method("<clinit>");
+
+    if (initializer) {
+        const auto method_index = static_cast<std::size_t>(
+            &initializer.value().method - klass.methods.data()
+        );
+
+        auto editor = kh::jvm::rewriting::CodeEditor::open(klass, arena, method_index);
+
+        if (!editor) {
+            return std::unexpected(Error::RewriteFailed);
+        }
+
+        editor.value().prologue(code);
+        editor.value().reserve_stack(max_stack);
+
+        if (!editor.value().commit()) {
+            return std::unexpected(Error::RewriteFailed);
+        }
+
+        return {};
+    }
+
+    auto body = std::vector<std::byte>{code.begin(), code.end()};
+    body.push_back(static_cast<std::byte>(Opcode::RETURN));
+
+    add_method(
+        klass,
+        arena,
+        static_cast<std::uint16_t>(kh::jvm::method::AccessFlags::ACC_STATIC)
+            | static_cast<std::uint16_t>(kh::jvm::method::AccessFlags::ACC_SYNTHETIC),
+        "<clinit>",
+        "()V",
+        kh::jvm::code::Code{
+            max_stack,
+            0u,
+            body,
+            std::vector<kh::jvm::code::ExceptionHandler>{},
+            std::vector<kh::jvm::attribute::Attribute>{}
+        }
+    );
+
+    return {};
+}
+
+auto has_field(const kh::jvm::classfile::ClassFile& klass, std::string_view name) -> bool {
+    for (const auto& field : klass.fields) {
+        const auto field_name = klass.constant_pool.resolve<
+                kh::jvm::constant_pool::UTF8Entry>(field.name_index).text;
+
+        if (field_name == name) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+auto has_method(const kh::jvm::classfile::ClassFile& klass, std::string_view name) -> bool {
+    return kh::jvm::views::ClassView{klass}.method(name).has_value();
+}
+
+auto add_field(
+        kh::jvm::classfile::ClassFile& klass,
+        std::string_view name,
+        std::string_view descriptor) -> void {
+    using kh::jvm::field::AccessFlags;
+
+    klass.fields.push_back(
+        kh::jvm::field::Field{
+            .access_flags = static_cast<std::uint16_t>(AccessFlags::ACC_PRIVATE)
+                | static_cast<std::uint16_t>(AccessFlags::ACC_STATIC)
+                | static_cast<std::uint16_t>(AccessFlags::ACC_FINAL)
+                | static_cast<std::uint16_t>(AccessFlags::ACC_SYNTHETIC),
+            .name_index = index(klass.constant_pool.try_add_utf8_entry(name)),
+            .descriptor_index = index(klass.constant_pool.try_add_utf8_entry(descriptor)),
+            .attributes = std::vector<kh::jvm::attribute::Attribute>{},
+            .source = std::span<const std::byte>{}
+        }
+    );
+}
+
+auto push_int(
+        Assembler& assembler,
+        kh::jvm::constant_pool::ConstantPool& pool,
+        const std::int32_t value) -> Assembler& {
+    if (value >= std::numeric_limits<std::int16_t>::min()
+            && value <= std::numeric_limits<std::int16_t>::max()) {
+        return assembler.push_short(static_cast<std::int16_t>(value));
+    }
+
+    const auto entry = pool.try_add(
+        kh::jvm::constant_pool::IntegerEntry{static_cast<std::uint32_t>(value)}
+    );
+
+    return assembler.op(Opcode::LDC_W, index(entry));
+}
+
+// NOTE(garrett): Helpers are private static synthetic methods, with the given
+// frames only emitted for class versions that expect a StackMapTable.
+auto add_helper_method(
+        kh::jvm::classfile::ClassFile& klass,
+        kh::arena::Arena& arena,
+        std::string_view name,
+        std::string_view descriptor,
+        kh::jvm::code::Code&& code,
+        const std::vector<kh::jvm::stack_map::Frame>& frames,
+        const std::vector<kh::jvm::stack_map::VerificationType>& initial_locals) -> void {
+    if (klass.version.major >= 50 && !frames.empty()) {
+        auto sink = kh::sinks::VectorSink{};
+        kh::jvm::serialization::serialize(sink, frames, initial_locals);
+
+        code.attributes.push_back(
+            kh::jvm::attribute::Attribute{
+                index(klass.constant_pool.try_add_utf8_entry("StackMapTable")),
+                arena.store(sink.take())
+            }
+        );
+    }
+
+    using kh::jvm::method::AccessFlags;
+
+    add_method(
+        klass,
+        arena,
+        static_cast<std::uint16_t>(AccessFlags::ACC_PRIVATE)
+            | static_cast<std::uint16_t>(AccessFlags::ACC_STATIC)
+            | static_cast<std::uint16_t>(AccessFlags::ACC_SYNTHETIC),
+        name,
+        descriptor,
+        code
+    );
+}
+
+// NOTE(garrett): Pushes the striped countdown array and the index of the
+// calling thread's stripe. Threads are spread by identity hash, since both
+// `currentThread` and `identityHashCode` are intrinsics, where a ThreadLocal
+// lookup would cost more than the allocation or lock being sampled.
+auto push_countdown_stripe(
+        Assembler& assembler,
+        kh::jvm::constant_pool::ConstantPool& pool,
+        const std::uint16_t countdowns) -> Assembler& {
+    const auto current_thread = index(
+        pool.try_add_method_reference("java/lang/Thread", "currentThread", "()Ljava/lang/Thread;")
+    );
+
+    const auto identity_hash = index(
+        pool.try_add_method_reference(
+            "java/lang/System",
+            "identityHashCode",
+            "(Ljava/lang/Object;)I"
+        )
+    );
+
+    return assembler.op(Opcode::GETSTATIC, countdowns)
+        .op(Opcode::INVOKESTATIC, current_thread)
+        .op(Opcode::INVOKESTATIC, identity_hash)
+        .push_short(countdown_stripes - 1)
+        .op(Opcode::IAND)
+        .push_short(countdown_stride_shift)
+        .op(Opcode::ISHL);
+}
+
+auto countdown_fast_path(
+        Assembler& assembler,
+        kh::jvm::constant_pool::ConstantPool& pool,
+        const std::uint16_t countdowns,
+        std::span<const Opcode> fast_exit) -> Assembler& {
+    push_countdown_stripe(assembler, pool, countdowns)
+        .op(Opcode::DUP2)
+        .op(Opcode::IALOAD)
+        .op(Opcode::ICONST_1)
+        .op(Opcode::ISUB)
+        .op(Opcode::DUP_X2)
+        .op(Opcode::IASTORE)
+        .branch(Opcode::IFLE, static_cast<std::int16_t>(3 + fast_exit.size()));
+
+    for (const auto opcode : fast_exit) {
+        assembler.op(opcode);
+    }
+
+    return assembler;
+}
+
+// NOTE(garrett): Allocates the striped countdowns in the class initializer,
+// zeroed so that the first call on every stripe takes a sample. Each
+// instrumented class gets its own 4 KiB array, as sharing one would take a
+// class of its own, and these passes only ever rewrite the class in hand.
+auto add_countdown_field(
+        kh::jvm::classfile::ClassFile& klass,
+        kh::arena::Arena& arena,
+        std::string_view name,
+        const std::uint16_t countdowns) -> std::expected<void, Error> {
+    add_field(klass, name, "[I");
+
+    auto initializer = Assembler{};
+    initializer.push_short(static_cast<std::int16_t>(countdown_stripes << countdown_stride_shift))
+        .op(
+            Opcode::NEWARRAY,
+            static_cast<std::uint8_t>(kh::jvm::bytecode::ArrayType::T_INT)
+        )
+        .op(Opcode::PUTSTATIC, countdowns);
+
+    return prepend_static_initializer(klass, arena, initializer.bytes(), 1u);
+}
+
+// NOTE(garrett): The sampler is kept tiny so that the JIT inlines it into
+// every allocation site, leaving a stripe lookup, a decrement and a branch on
+// the fast path. Each thread mostly counts down its own stripe, so sampling
+// doesn't bounce one cache line between every allocating core. Threads that
+// do share a stripe only lose updates, which stretches the sampling period.
+// The lookup's two intrinsic calls make the fast path heavier than a single
+// shared counter, which is the price of not contending on one line.
+auto add_allocation_sampler(
+        kh::jvm::classfile::ClassFile& klass,
+        kh::arena::Arena& arena,
+        const AllocationOptions& options,
+        const std::uint16_t countdowns) -> void {
+    auto& pool = klass.constant_pool;
+    const auto class_name = kh::jvm::views::ClassView{klass}.name();
+
+    const auto callback = index(
+        pool.try_add_method_reference(
+            options.callback_class,
+            options.callback_method,
+            "(Ljava/lang/String;II)V"
+        )
+    );
+
+    const auto leading_zeros = index(
+        pool.try_add_method_reference(
+            "java/lang/Integer",
+            "numberOfLeadingZeros",
+            "(I)I"
+        )
+    );
+
+    const auto class_name_string = index(pool.try_add_string_entry(class_name));
+
+    constexpr auto not_sampled = std::to_array({Opcode::RETURN});
+
+    auto body = Assembler{};
+    countdown_fast_path(body, pool, countdowns, not_sampled);
+    const auto slow_path_offset = static_cast<std::uint16_t>(body.size());
+
+    push_countdown_stripe(body, pool, countdowns);
+    push_int(body, pool, options.period)
+        .op(Opcode::IASTORE)
+        .op(Opcode::LDC_W, class_name_string)
+        .op(Opcode::ILOAD_0)
+        .push_short(32)
+        .op(Opcode::ILOAD_1)
+        .op(Opcode::INVOKESTATIC, leading_zeros)
+        .op(Opcode::ISUB)
+        .op(Opcode::INVOKESTATIC, callback)
+        .op(Opcode::RETURN);
+
+    const auto integer = kh::jvm::stack_map::VerificationType{
+        kh::jvm::stack_map::VerificationTag::Integer,
+        0u
+    };
+
+    add_helper_method(
+        klass,
+        arena,
+        options.sampler_method,
+        "(II)V",
+        kh::jvm::code::Code{
+            4u,
+            2u,
+            body.bytes(),
+            std::vector<kh::jvm::code::ExceptionHandler>{},
+            std::vector<kh::jvm::attribute::Attribute>{}
+        },
+        std::vector<kh::jvm::stack_map::Frame>{
+            kh::jvm::stack_map::Frame{slow_path_offset, {integer, integer}, {}}
+        },
+        {integer, integer}
+    );
+}
+
+// NOTE(garrett): Timestamps double as the sampling decision, a zero start time
+// meaning the acquisition wasn't picked and both lock callbacks are skipped.
+// Sampled times are moved off zero, which `System.nanoTime` can return.
+// Like the allocation sampler, the countdown is striped per thread so that
+// untimed acquisitions don't all write the same cache line. Exceptions thrown
+// by the callbacks are swallowed so that probing can never leave a monitor
+// held.
+// NOTE(garrett): Leaves a time of zero as one, and every other time as is
+auto nonzero_time(Assembler& code) -> Assembler& {
+    return code.op(Opcode::DUP2)
+        .op(Opcode::DUP2)
+        .op(Opcode::LNEG)
+        .op(Opcode::LOR)
+        .push_short(63)
+        .op(Opcode::LUSHR)
+        .op(Opcode::LCONST_1)
+        .op(Opcode::LXOR)
+        .op(Opcode::LOR);
+}
+
+auto add_lock_helpers(
+        kh::jvm::classfile::ClassFile& klass,
+        kh::arena::Arena& arena,
+        const LockOptions& options,
+        const std::uint16_t countdowns) -> void {
+    using kh::jvm::stack_map::Frame;
+    using kh::jvm::stack_map::VerificationTag;
+    using kh::jvm::stack_map::VerificationType;
+
+    auto& pool = klass.constant_pool;
+    const auto class_name = kh::jvm::views::ClassView{klass}.name();
+    const auto class_name_string = index(pool.try_add_string_entry(class_name));
+    const auto throwable = index(pool.try_add_class_entry("java/lang/Throwable"));
+
+    const auto nano_time = index(
+        pool.try_add_method_reference("java/lang/System", "nanoTime", "()J")
+    );
+
+    const auto acquired = index(
+        pool.try_add_method_reference(
+            options.callback_class,
+            options.acquired_method,
+            "(Ljava/lang/String;IJ)V"
+        )
+    );
+
+    const auto released = index(
+        pool.try_add_method_reference(
+            options.callback_class,
+            options.released_method,
+            "(Ljava/lang/String;IJ)V"
+        )
+    );
+
+    const auto long_type = VerificationType{VerificationTag::Long, 0u};
+    const auto integer = VerificationType{VerificationTag::Integer, 0u};
+    const auto caught = VerificationType{VerificationTag::Object, throwable};
+    constexpr auto not_sampled = std::to_array({Opcode::LCONST_0, Opcode::LRETURN});
+
+    auto sample = Assembler{};
+    countdown_fast_path(sample, pool, countdowns, not_sampled);
+    const auto sample_slow_path = static_cast<std::uint16_t>(sample.size());
+
+    push_countdown_stripe(sample, pool, countdowns);
+    push_int(sample, pool, options.period)
+        .op(Opcode::IASTORE)
+        .op(Opcode::INVOKESTATIC, nano_time);
+
+    nonzero_time(sample).op(Opcode::LRETURN);
+
+    add_helper_method(
+        klass,
+        arena,
+        options.sample_method,
+        "()J",
+        kh::jvm::code::Code{
+            6u,
+            0u,
+            sample.bytes(),
+            std::vector<kh::jvm::code::ExceptionHandler>{},
+            std::vector<kh::jvm::attribute::Attribute>{}
+        },
+        std::vector<Frame>{Frame{sample_slow_path, {}, {}}},
+        {}
+    );
+
+    auto acquire = Assembler{};
+    acquire.op(Opcode::LLOAD_0)
+        .op(Opcode::LCONST_0)
+        .op(Opcode::LCMP)
+        .branch(Opcode::IFNE, 5)
+        .op(Opcode::LCONST_0)
+        .op(Opcode::LRETURN);
+
+    const auto acquire_slow_path = static_cast<std::uint16_t>(acquire.size());
+    acquire.op(Opcode::INVOKESTATIC, nano_time);
+    nonzero_time(acquire).op(Opcode::LSTORE_3);
+
+    const auto acquire_try_start = static_cast<std::uint16_t>(acquire.size());
+    acquire.op(Opcode::LDC_W, class_name_string)
+        .op(Opcode::ILOAD_2)
+        .op(Opcode::LLOAD_3)
+        .op(Opcode::LLOAD_0)
+        .op(Opcode::LSUB)
+        .op(Opcode::INVOKESTATIC, acquired);
+
+    const auto acquire_try_end = static_cast<std::uint16_t>(acquire.size());
+    acquire.op(Opcode::LLOAD_3).op(Opcode::LRETURN);
+
+    const auto acquire_handler = static_cast<std::uint16_t>(acquire.size());
+    acquire.op(Opcode::POP).op(Opcode::LLOAD_3).op(Opcode::LRETURN);
+
+    add_helper_method(
+        klass,
+        arena,
+        options.acquire_method,
+        "(JI)J",
+        kh::jvm::code::Code{
+            6u,
+            5u,
+            acquire.bytes(),
+            std::vector<kh::jvm::code::ExceptionHandler>{
+                kh::jvm::code::ExceptionHandler{
+                    acquire_try_start,
+                    acquire_try_end,
+                    acquire_handler,
+                    throwable
+                }
+            },
+            std::vector<kh::jvm::attribute::Attribute>{}
+        },
+        std::vector<Frame>{
+            Frame{acquire_slow_path, {long_type, integer}, {}},
+            Frame{acquire_handler, {long_type, integer, long_type}, {caught}}
+        },
+        {long_type, integer}
+    );
+
+    auto release = Assembler{};
+    release.op(Opcode::LLOAD_0)
+        .op(Opcode::LCONST_0)
+        .op(Opcode::LCMP)
+        .branch(Opcode::IFNE, 5)
+        .op(Opcode::LCONST_0)
+        .op(Opcode::LRETURN);
+
+    const auto release_try_start = static_cast<std::uint16_t>(release.size());
+    release.op(Opcode::LDC_W, class_name_string)
+        .op(Opcode::ILOAD_2)
+        .op(Opcode::INVOKESTATIC, nano_time)
+        .op(Opcode::LLOAD_0)
+        .op(Opcode::LSUB)
+        .op(Opcode::INVOKESTATIC, released);
+
+    const auto release_try_end = static_cast<std::uint16_t>(release.size());
+    release.op(Opcode::LCONST_0).op(Opcode::LRETURN);
+
+    const auto release_handler = static_cast<std::uint16_t>(release.size());
+    release.op(Opcode::POP).op(Opcode::LCONST_0).op(Opcode::LRETURN);
+
+    add_helper_method(
+        klass,
+        arena,
+        options.release_method,
+        "(JI)J",
+        kh::jvm::code::Code{
+            6u,
+            3u,
+            release.bytes(),
+            std::vector<kh::jvm::code::ExceptionHandler>{
+                kh::jvm::code::ExceptionHandler{
+                    release_try_start,
+                    release_try_end,
+                    release_handler,
+                    throwable
+                }
+            },
+            std::vector<kh::jvm::attribute::Attribute>{}
+        },
+        std::vector<Frame>{
+            Frame{release_try_start, {long_type, integer}, {}},
+            Frame{release_handler, {long_type, integer}, {caught}}
+        },
+        {long_type, integer}
+    );
+}
+
+} // namespace
+
+auto add_allocation_sampling(
+        kh::jvm::classfile::ClassFile& klass,
+        kh::arena::Arena& arena,
+        const AllocationOptions& options)
+        -> std::expected<std::vector<AllocationSite>, Error> {
+    if (options.callback_class.empty() || options.period <= 0) {
+        return std::unexpected(Error::InvalidOptions);
+    }
+
+    if (has_flag(klass.access_flags, kh::jvm::classfile::AccessFlags::ACC_INTERFACE)) {
+        return std::unexpected(Error::UnsupportedClass);
+    }
+
+    if (has_field(klass, options.countdown_field)
+            || has_method(klass, options.sampler_method)) {
+        return std::unexpected(Error::AlreadyInstrumented);
+    }
+
+    auto& pool = klass.constant_pool;
+    const auto class_name = kh::jvm::views::ClassView{klass}.name();
+
+    // NOTE(garrett): References are only added once a site turns up, so
+    // classes without allocations come out with their pool untouched
+    auto sampler = std::optional<std::uint16_t>{};
+    auto sites = std::vector<AllocationSite>{};
+    const auto method_count = klass.methods.size();
+
+    for (auto method_index = 0uz; method_index < method_count; ++method_index) {
+        using kh::jvm::method::AccessFlags;
+        const auto flags = klass.methods[method_index].access_flags;
+
+        if (has_flag(flags, AccessFlags::ACC_ABSTRACT)
+                || has_flag(flags, AccessFlags::ACC_NATIVE)) {
+            continue;
+        }
+
+        auto editor = kh::jvm::rewriting::CodeEditor::open(klass, arena, method_index);
+
+        if (!editor) {
+            return std::unexpected(Error::RewriteFailed);
+        }
+
+        const auto bytecode = editor.value().code().bytecode;
+        auto modified = false;
+
+        for (const auto& instruction : editor.value().instructions()) {
+            const auto opcode = instruction.opcode;
+            auto probe = Assembler{};
+
+            switch (opcode) {
+                case Opcode::NEW: {
+                    push_int(probe, pool, static_cast<std::int32_t>(instruction.offset))
+                        .op(Opcode::ICONST_M1);
+                    break;
+                }
+                case Opcode::NEWARRAY:
+                case Opcode::ANEWARRAY:
+                case Opcode::MULTIANEWARRAY: {
+                    // NOTE(garrett): The length on top of the stack is the
+                    // innermost dimension for multi-dimensional arrays
+                    probe.op(Opcode::DUP);
+                    push_int(probe, pool, static_cast<std::int32_t>(instruction.offset))
+                        .op(Opcode::SWAP);
+                    break;
+                }
+                default:
+                    continue;
+            }
+
+            if (!sampler) {
+                sampler = index(
+                    pool.try_add_method_reference(class_name, options.sampler_method, "(II)V")
+                );
+            }
+
+            probe.op(Opcode::INVOKESTATIC, sampler.value());
+            editor.value().insert_before(instruction.offset, probe.bytes());
+            modified = true;
+
+            const auto type = opcode == Opcode::NEWARRAY
+                ? std::to_integer<std::uint16_t>(bytecode[instruction.offset + 1])
+                : static_cast<std::uint16_t>(
+                    std::to_integer<std::uint16_t>(bytecode[instruction.offset + 1]) << 8
+                    | std::to_integer<std::uint16_t>(bytecode[instruction.offset + 2])
+                );
+
+            sites.push_back(
+                AllocationSite{
+                    static_cast<std::uint16_t>(method_index),
+                    static_cast<std::uint16_t>(instruction.offset),
+                    opcode,
+                    type
+                }
+            );
+        }
+
+        if (!modified) {
+            continue;
+        }
+
+        editor.value().reserve_stack(2u);
+
+        if (!editor.value().commit()) {
+            return std::unexpected(Error::RewriteFailed);
+        }
+    }
+
+    if (sites.empty()) {
+        return sites;
+    }
+
+    const auto countdowns = index(
+        pool.try_add_field_reference(class_name, options.countdown_field, "[I")
+    );
+
+    if (const auto result = add_countdown_field(klass, arena, options.countdown_field, countdowns);
+            !result) {
+        return std::unexpected(result.error());
+    }
+
+    add_allocation_sampler(klass, arena, options, countdowns);
+
+    if (pool.count() > std::numeric_limits<std::uint16_t>::max()) {
+        return std::unexpected(Error::ConstantPoolOverflow);
+    }
+
+    return sites;
+}
+
+auto add_lock_probes(
+        kh::jvm::classfile::ClassFile& klass,
+        kh::arena::Arena& arena,
+        const LockOptions& options) -> std::expected<std::vector<LockSite>, Error> {
+    if (options.callback_class.empty() || options.period <= 0) {
+        return std::unexpected(Error::InvalidOptions);
+    }
+
+    if (has_flag(klass.access_flags, kh::jvm::classfile::AccessFlags::ACC_INTERFACE)) {
+        return std::unexpected(Error::UnsupportedClass);
+    }
+
+    if (has_field(klass, options.countdown_field)
+            || has_method(klass, options.sample_method)
+            || has_method(klass, options.acquire_method)
+            || has_method(klass, options.release_method)) {
+        return std::unexpected(Error::AlreadyInstrumented);
+    }
+
+    using kh::jvm::stack_map::VerificationTag;
+    using kh::jvm::stack_map::VerificationType;
+
+    auto& pool = klass.constant_pool;
+    const auto class_name = kh::jvm::views::ClassView{klass}.name();
+
+    // NOTE(garrett): Helper references are only added once a method with
+    // monitors turns up, so classes without any keep their pool untouched
+    auto sample = std::uint16_t{0u};
+    auto acquire = std::uint16_t{0u};
+    auto release = std::uint16_t{0u};
+    auto sites = std::vector<LockSite>{};
+    const auto method_count = klass.methods.size();
+
+    const auto next_site = [&sites]() -> std::int32_t {
+        return static_cast<std::int32_t>(sites.size());
+    };
+
+    for (auto method_index = 0uz; method_index < method_count; ++method_index) {
+        using kh::jvm::method::AccessFlags;
+        auto& method = klass.methods[method_index];
+
+        if (has_flag(method.access_flags, AccessFlags::ACC_ABSTRACT)
+                || has_flag(method.access_flags, AccessFlags::ACC_NATIVE)) {
+            continue;
+        }
+
+        const auto is_static = has_flag(method.access_flags, AccessFlags::ACC_STATIC);
+        const auto is_synchronized = has_flag(method.access_flags, AccessFlags::ACC_SYNCHRONIZED)
+            && (!is_static || klass.version.major >= 49);
+
+        auto editor = kh::jvm::rewriting::CodeEditor::open(klass, arena, method_index);
+
+        if (!editor) {
+            return std::unexpected(Error::RewriteFailed);
+        }
+
+        const auto has_monitors = std::ranges::any_of(
+            editor.value().instructions(),
+            [](const auto& instruction) {
+                return instruction.opcode == Opcode::MONITORENTER
+                    || instruction.opcode == Opcode::MONITOREXIT;
+            }
+        );
+
+        if (!is_synchronized && !has_monitors) {
+            continue;
+        }
+
+        if (!sample) {
+            sample = index(
+                pool.try_add_method_reference(class_name, options.sample_method, "()J")
+            );
+
+            acquire = index(
+                pool.try_add_method_reference(class_name, options.acquire_method, "(JI)J")
+            );
+
+            release = index(
+                pool.try_add_method_reference(class_name, options.release_method, "(JI)J")
+            );
+        }
+
+        // NOTE(garrett): A single hold timestamp is shared by every monitor in
+        // the method. Releasing clears it, so nested locks only report the
+        // innermost hold time rather than a misattributed one.
+        const auto held_since = editor.value().add_local(
+            VerificationType{VerificationTag::Long, 0u}
+        );
+
+        auto entry = Assembler{};
+        entry.op(Opcode::LCONST_0).local(Opcode::LSTORE, held_since);
+
+        if (is_synchronized) {
+            const auto lock_type = is_static
+                ? index(pool.try_add_class_entry("java/lang/Class"))
+                : klass.class_index;
+
+            const auto lock = editor.value().add_local(
+                VerificationType{VerificationTag::Object, lock_type}
+            );
+
+            const auto site = next_site();
+            sites.push_back(
+                LockSite{
+                    static_cast<std::uint16_t>(method_index),
+                    0u,
+                    LockSiteKind::SynchronizedMethod
+                }
+            );
+
+            if (is_static) {
+                entry.op(Opcode::LDC_W, klass.class_index);
+            } else {
+                entry.op(Opcode::ALOAD_0);
+            }
+
+            entry.local(Opcode::ASTORE, lock)
+                .op(Opcode::INVOKESTATIC, sample)
+                .local(Opcode::ALOAD, lock)
+                .op(Opcode::MONITORENTER);
+
+            // NOTE(garrett): The monitor is held from here on, so the rest of
+            // the prologue runs under the handler that releases it
+            editor.value().prologue(entry.bytes());
+            editor.value().guard_prologue();
+
+            entry = Assembler{};
+            push_int(entry, pool, site)
+                .op(Opcode::INVOKESTATIC, acquire)
+                .local(Opcode::LSTORE, held_since);
+
+            auto exit = Assembler{};
+            exit.local(Opcode::LLOAD, held_since);
+
+            push_int(exit, pool, site)
+                .op(Opcode::INVOKESTATIC, release)
+                .local(Opcode::LSTORE, held_since)
+                .local(Opcode::ALOAD, lock)
+                .op(Opcode::MONITOREXIT);
+
+            auto returns = std::vector<std::uint32_t>{};
+
+            for (const auto& instruction : editor.value().instructions()) {
+                if (kh::jvm::bytecode::is_return(instruction.opcode)) {
+                    editor.value().insert_before(instruction.offset, exit.bytes());
+                    returns.push_back(instruction.offset);
+                }
+            }
+
+            auto rethrow = exit.take();
+            rethrow.push_back(static_cast<std::byte>(Opcode::ATHROW));
+
+            // NOTE(garrett): Exit sequences are left uncovered, as the handler
+            // would otherwise exit the monitor a second time
+            editor.value().append_handler(
+                rethrow,
+                0u,
+                static_cast<std::uint32_t>(editor.value().code().bytecode.size()),
+                0u,
+                std::vector<VerificationType>{
+                    VerificationType{
+                        VerificationTag::Object,
+                        index(pool.try_add_class_entry("java/lang/Throwable"))
+                    }
+                },
+                std::move(returns)
+            );
+
+            method.access_flags &= static_cast<std::uint16_t>(
+                ~static_cast<std::uint16_t>(AccessFlags::ACC_SYNCHRONIZED)
+            );
+        }
+
+        editor.value().prologue(entry.bytes());
+
+        for (const auto& instruction : editor.value().instructions()) {
+            if (instruction.opcode == Opcode::MONITORENTER) {
+                const auto site = next_site();
+
+                // NOTE(garrett): The sample is tucked under the lock object so
+                // that it survives the monitorenter
+                auto before = Assembler{};
+                before.op(Opcode::INVOKESTATIC, sample)
+                    .op(Opcode::DUP2_X1)
+                    .op(Opcode::POP2);
+
+                auto after = Assembler{};
+                push_int(after, pool, site)
+                    .op(Opcode::INVOKESTATIC, acquire)
+                    .local(Opcode::LSTORE, held_since);
+
+                editor.value().insert_before(instruction.offset, before.bytes());
+                editor.value().insert_after(instruction.offset, after.bytes());
+
+                sites.push_back(
+                    LockSite{
+                        static_cast<std::uint16_t>(method_index),
+                        static_cast<std::uint16_t>(instruction.offset),
+                        LockSiteKind::MonitorEnter
+                    }
+                );
+            } else if (instruction.opcode == Opcode::MONITOREXIT) {
+                const auto site = next_site();
+
+                auto before = Assembler{};
+                before.local(Opcode::LLOAD, held_since);
+
+                push_int(before, pool, site)
+                    .op(Opcode::INVOKESTATIC, release)
+                    .local(Opcode::LSTORE, held_since);
+
+                editor.value().insert_before(instruction.offset, before.bytes());
+
+                sites.push_back(
+                    LockSite{
+                        static_cast<std::uint16_t>(method_index),
+                        static_cast<std::uint16_t>(instruction.offset),
+                        LockSiteKind::MonitorExit
+                    }
+                );
+            }
+        }
+
+        // NOTE(garrett): Probes peak at four slots on top of the lock object,
+        // return value or exception beneath them
+        editor.value().reserve_stack(4u);
+
+        if (!editor.value().commit()) {
+            return std::unexpected(Error::RewriteFailed);
+        }
+    }
+
+    if (sites.empty()) {
+        return sites;
+    }
+
+    const auto countdowns = index(
+        pool.try_add_field_reference(class_name, options.countdown_field, "[I")
+    );
+
+    if (const auto result = add_countdown_field(klass, arena, options.countdown_field, countdowns);
+            !result) {
+        return std::unexpected(result.error());
+    }
+
+    add_lock_helpers(klass, arena, options, countdowns);
+
+    if (pool.count() > std::numeric_limits<std::uint16_t>::max()) {
+        return std::unexpected(Error::ConstantPoolOverflow);
+    }
+
+    return sites;
+}
+
+auto add_latency_probes(
+        kh::jvm::classfile::ClassFile& klass,
+        kh::arena::Arena& arena,
+        const LatencyOptions& options) -> std::expected<std::vector<LatencyProbe>, Error> {
+    if (has_flag(klass.access_flags, kh::jvm::classfile::AccessFlags::ACC_INTERFACE)) {
+        return std::unexpected(Error::UnsupportedClass);
+    }
+
+    if (has_field(klass, options.field)) {
+        return std::unexpected(Error::AlreadyInstrumented);
+    }
+
+    auto targets = std::vector<std::size_t>{};
+
+    for (auto current = options.methods.begin(); current != options.methods.end(); ++current) {
+        const auto name = *current;
+
+        // NOTE(garrett): Listing a name twice would otherwise probe its
+        // methods twice, nesting one probe inside the other
+        if (std::ranges::find(options.methods.begin(), current, name) != current) {
+            continue;
+        }
+
+        if (name == "<init>") {
+            return std::unexpected(Error::UnsupportedMethod);
+        }
+
+        if (!kh::jvm::views::ClassView{klass}.method(name)) {
+            return std::unexpected(Error::MethodNotFound);
+        }
+
+        // NOTE(garrett): Overloads share a name, so each of them gets probed
+        for (auto i = 0uz; i < klass.methods.size(); ++i) {
+            const auto view = kh::jvm::views::MethodView{
+                klass.constant_pool,
+                klass.methods[i]
+            };
+
+            if (view.name() != name) {
+                continue;
+            }
+
+            using kh::jvm::method::AccessFlags;
+            const auto flags = klass.methods[i].access_flags;
+
+            if (has_flag(flags, AccessFlags::ACC_ABSTRACT)
+                    || has_flag(flags, AccessFlags::ACC_NATIVE)) {
+                return std::unexpected(Error::UnsupportedMethod);
+            }
+
+            targets.push_back(i);
+        }
+    }
+
+    if (targets.size() * 2 > std::numeric_limits<std::int16_t>::max()) {
+        return std::unexpected(Error::TooManyProbes);
+    }
+
+    auto& pool = klass.constant_pool;
+    const auto class_name = kh::jvm::views::ClassView{klass}.name();
+
+    const auto counters = index(
+        pool.try_add_field_reference(class_name, options.field, "[J")
+    );
+
+    const auto nano_time = index(
+        pool.try_add_method_reference("java/lang/System", "nanoTime", "()J")
+    );
+
+    const auto throwable = index(pool.try_add_class_entry("java/lang/Throwable"));
+
+    auto probes = std::vector<LatencyProbe>{};
+
+    for (const auto method_index : targets) {
+        const auto slot = static_cast<std::uint16_t>(probes.size());
+        auto editor = kh::jvm::rewriting::CodeEditor::open(klass, arena, method_index);
+
+        if (!editor) {
+            return std::unexpected(Error::RewriteFailed);
+        }
+
+        const auto start = editor.value().add_local(
+            kh::jvm::stack_map::VerificationType{
+                kh::jvm::stack_map::VerificationTag::Long,
+                0u
+            }
+        );
+
+        auto entry = Assembler{};
+        entry.op(Opcode::INVOKESTATIC, nano_time).local(Opcode::LSTORE, start);
+
+        auto exit = Assembler{};
+        exit.op(Opcode::GETSTATIC, counters)
+            .push_short(static_cast<std::int16_t>(2 * slot))
+            .op(Opcode::DUP2)
+            .op(Opcode::LALOAD)
+            .op(Opcode::INVOKESTATIC, nano_time)
+            .local(Opcode::LLOAD, start)
+            .op(Opcode::LSUB)
+            .op(Opcode::LADD)
+            .op(Opcode::LASTORE)
+            .op(Opcode::GETSTATIC, counters)
+            .push_short(static_cast<std::int16_t>(2 * slot + 1))
+            .op(Opcode::DUP2)
+            .op(Opcode::LALOAD)
+            .op(Opcode::LCONST_1)
+            .op(Opcode::LADD)
+            .op(Opcode::LASTORE);
+
+        editor.value().prologue(entry.bytes());
+
+        auto returns = std::vector<std::uint32_t>{};
+
+        for (const auto& instruction : editor.value().instructions()) {
+            if (kh::jvm::bytecode::is_return(instruction.opcode)) {
+                editor.value().insert_before(instruction.offset, exit.bytes());
+                returns.push_back(instruction.offset);
+            }
+        }
+
+        auto rethrow = std::vector<std::byte>{exit.bytes().begin(), exit.bytes().end()};
+        rethrow.push_back(static_cast<std::byte>(Opcode::ATHROW));
+
+        // NOTE(garrett): The exit probes stay outside the handler, otherwise a
+        // failure inside one would record the call a second time
+        editor.value().append_handler(
+            rethrow,
+            0u,
+            static_cast<std::uint32_t>(editor.value().code().bytecode.size()),
+            0u,
+            std::vector<kh::jvm::stack_map::VerificationType>{
+                kh::jvm::stack_map::VerificationType{
+                    kh::jvm::stack_map::VerificationTag::Object,
+                    throwable
+                }
+            },
+            std::move(returns)
+        );
+
+        // NOTE(garrett): Exit probes peak at eight slots on top of whatever is
+        // being returned, or the exception in the case of the handler.
+        editor.value().reserve_stack(9u);
+
+        if (!editor.value().commit()) {
+            return std::unexpected(Error::RewriteFailed);
+        }
+
+        probes.push_back(LatencyProbe{static_cast<std::uint16_t>(method_index), slot});
+    }
+
+    add_field(klass, options.field, "[J");
+
+    auto initializer = Assembler{};
+    initializer.push_short(static_cast<std::int16_t>(2 * probes.size()))
+        .op(
+            Opcode::NEWARRAY,
+            static_cast<std::uint8_t>(kh::jvm::bytecode::ArrayType::T_LONG)
+        )
+        .op(Opcode::PUTSTATIC, counters);
+
+    if (const auto result = prepend_static_initializer(klass, arena, initializer.bytes(), 1u);
+            !result) {
+        return std::unexpected(result.error());
+    }
+
+    if (pool.count() > std::numeric_limits<std::uint16_t>::max()) {
+        return std::unexpected(Error::ConstantPoolOverflow);
+    }
+
+    return probes;
+}
+
+} // namespace kh::jvm::instrumentation
@@ -0,0 +1,113 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <cstdint>
+#include <expected>
+#include <string_view>
+#include <vector>
+
+#include "arena.h"
+#include "bytecode.h"
+#include "classfile.h"
+
+namespace kh::jvm::instrumentation {
+
+enum Error {
+    AlreadyInstrumented,
+    ConstantPoolOverflow,
+    InvalidOptions,
+    MethodNotFound,
+    RewriteFailed,
+    TooManyProbes,
+    UnsupportedClass,
+    UnsupportedMethod
+};
+
+struct LatencyOptions {
+    std::vector<std::string_view> methods;
+    std::string_view field = "$kh$latency";
+};
+
+// NOTE(garrett): Each probed method owns two slots in the counter array, the
+// total elapsed nanoseconds at `2 * slot` and the invocation count right after
+// it. Updates are plain loads and stores, trading exactness under contention
+// for probes without allocation or synchronization.
+struct LatencyProbe {
+    std::uint16_t method_index;
+    std::uint16_t slot;
+};
+
+// NOTE(garrett): The callback is a static `(Ljava/lang/String;II)V` method
+// receiving the allocating class, the site's bytecode index and a size class.
+// Size classes are the bit length of the requested array length, with plain
+// instances reported as 32. Every thread counts down `period` allocations on
+// its own stripe of the `int[]` countdown field, which the class initializer
+// allocates.
+struct AllocationOptions {
+    std::string_view callback_class;
+    std::string_view callback_method = "onAllocation";
+    std::int32_t period = 1024;
+    std::string_view countdown_field = "$kh$allocationCountdown";
+    std::string_view sampler_method = "$kh$allocation";
+};
+
+struct AllocationSite {
+    std::uint16_t method_index;
+    std::uint16_t bci;
+    kh::jvm::bytecode::Opcode opcode;
+    // NOTE(garrett): Constant pool class index, or the array type for
+    // `newarray` sites
+    std::uint16_t type;
+};
+
+// NOTE(garrett): Callbacks are static `(Ljava/lang/String;IJ)V` methods
+// receiving the locking class, the index of the site within the returned list
+// and either the nanoseconds spent waiting to acquire the lock or the
+// nanoseconds it was held for. Only one in every `period` acquisitions on a
+// thread is timed, the rest cost a countdown on the thread's stripe of the
+// `int[]` countdown field and a couple of untaken branches.
+struct LockOptions {
+    std::string_view callback_class;
+    std::string_view acquired_method = "onLockAcquired";
+    std::string_view released_method = "onLockReleased";
+    std::int32_t period = 256;
+    std::string_view countdown_field = "$kh$lockCountdown";
+    std::string_view sample_method = "$kh$lockSample";
+    std::string_view acquire_method = "$kh$lockAcquired";
+    std::string_view release_method = "$kh$lockReleased";
+};
+
+enum class LockSiteKind : std::uint8_t {
+    MonitorEnter,
+    MonitorExit,
+    SynchronizedMethod
+};
+
+struct LockSite {
+    std::uint16_t method_index;
+    // NOTE(garrett): Offset in the original code, zero for synchronized methods
+    std::uint16_t bci;
+    LockSiteKind kind;
+};
+
+auto add_allocation_sampling(
+        kh::jvm::classfile::ClassFile&,
+        kh::arena::Arena&,
+        const AllocationOptions&) -> std::expected<std::vector<AllocationSite>, Error>;
+
+// NOTE(garrett): Synchronized methods are rewritten to lock explicitly, which
+// drops their ACC_SYNCHRONIZED flag. Static ones need class literals and are
+// left alone in classes older than version 49.
+auto add_lock_probes(
+        kh::jvm::classfile::ClassFile&,
+        kh::arena::Arena&,
+        const LockOptions&) -> std::expected<std::vector<LockSite>, Error>;
+
+auto add_latency_probes(
+        kh::jvm::classfile::ClassFile&,
+        kh::arena::Arena&,
+        const LatencyOptions&) -> std::expected<std::vector<LatencyProbe>, Error>;
+
+} // namespace kh::jvm::instrumentation
+
+#endif // INSTRUMENTATION_H
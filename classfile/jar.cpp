@@ -0,0 +1,842 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "endian.h"
+#include "jar.h"
+#include "sinks.h"
+
+namespace kh::jvm::jar {
+
+namespace {
+
+constexpr auto local_header_size = 30uz;
+constexpr auto central_header_size = 46uz;
+constexpr auto end_record_size = 22uz;
+constexpr auto zip64_locator_size = 20uz;
+constexpr auto zip64_end_record_size = 56uz;
+
+constexpr auto local_header_signature = std::uint32_t{0x04034B50u};
+constexpr auto central_header_signature = std::uint32_t{0x02014B50u};
+constexpr auto end_record_signature = std::uint32_t{0x06054B50u};
+constexpr auto zip64_locator_signature = std::uint32_t{0x07064B50u};
+constexpr auto zip64_end_record_signature = std::uint32_t{0x06064B50u};
+constexpr auto zip64_extra_id = std::uint16_t{0x0001u};
+constexpr auto encrypted_flag = std::uint16_t{0x0001u};
+constexpr auto version = std::uint16_t{20u};
+// NOTE(garrett): Entry names are always encoded as UTF-8
+constexpr auto flags = std::uint16_t{0x0800u};
+// NOTE(garrett): MS-DOS time and date for 1980-01-01 00:00, the earliest
+// value representable
+constexpr auto dos_time = std::uint16_t{0u};
+constexpr auto dos_date = std::uint16_t{0x0021u};
+
+template <typename V>
+auto put(std::vector<std::byte>& buffer, const V value) -> void {
+    for (auto i = 0uz; i < sizeof(V); ++i) {
+        buffer.push_back(static_cast<std::byte>(value >> (8u * i)));
+    }
+}
+
+// NOTE(garrett): Callers check bounds beforehand
+template <kh::endian::MultiByteIntegral V>
+auto get(std::span<const std::byte> bytes, const std::size_t offset) noexcept -> V {
+    auto value = V{};
+    std::memcpy(&value, bytes.data() + offset, sizeof(V));
+
+    return kh::endian::little(value);
+}
+
+auto put_text(std::vector<std::byte>& buffer, std::string_view text) -> void {
+    const auto bytes = std::as_bytes(std::span{text});
+    buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+}
+
+#if defined(__ARM_FEATURE_CRC32)
+
+auto crc32_hardware(std::uint32_t crc, std::span<const std::byte> data) noexcept
+        -> std::uint32_t {
+    auto state = ~crc;
+
+    while (data.size() >= sizeof(std::uint64_t)) {
+        auto word = std::uint64_t{};
+        std::memcpy(&word, data.data(), sizeof(word));
+
+        state = __crc32d(state, word);
+        data = data.subspan(sizeof(word));
+    }
+
+    for (const auto byte : data) {
+        state = __crc32b(state, std::to_integer<std::uint8_t>(byte));
+    }
+
+    return ~state;
+}
+
+#elif defined(__x86_64__) || defined(__i386__)
+
+[[gnu::target("pclmul,sse4.1")]]
+inline auto fold(const __m128i value, const __m128i constants, const __m128i next) -> __m128i {
+    const auto low = _mm_clmulepi64_si128(value, constants, 0x00);
+    const auto high = _mm_clmulepi64_si128(value, constants, 0x11);
+
+    return _mm_xor_si128(_mm_xor_si128(low, high), next);
+}
+
+[[gnu::target("pclmul,sse4.1")]]
+inline auto load(const std::byte* data) -> __m128i {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+}
+
+// NOTE(garrett): Folds four 128 bit lanes at a time and reduces the result
+// with a Barrett reduction, following Intel's "Fast CRC Computation Using
+// PCLMULQDQ". Operates on the raw register value without the usual inversion
+// and expects at least 64 bytes, in multiples of 16.
+[[gnu::target("pclmul,sse4.1")]]
+auto crc32_pclmul(const std::uint32_t state, const std::byte* data, std::size_t length)
+        -> std::uint32_t {
+    const auto r2r1 = _mm_set_epi64x(0x00000001C6E41596, 0x0000000154442BD4);
+    const auto r4r3 = _mm_set_epi64x(0x00000000CCAA009E, 0x00000001751997D0);
+    const auto r5 = _mm_set_epi64x(0, 0x0000000163CD6124);
+    const auto polynomial = _mm_set_epi64x(0x00000001F7011641, 0x00000001DB710641);
+    const auto mask = _mm_set_epi32(0, 0, 0, -1);
+
+    auto x1 = _mm_xor_si128(load(data), _mm_cvtsi32_si128(static_cast<int>(state)));
+    auto x2 = load(data + 16);
+    auto x3 = load(data + 32);
+    auto x4 = load(data + 48);
+
+    data += 64;
+    length -= 64;
+
+    while (length >= 64) {
+        x1 = fold(x1, r2r1, load(data));
+        x2 = fold(x2, r2r1, load(data + 16));
+        x3 = fold(x3, r2r1, load(data + 32));
+        x4 = fold(x4, r2r1, load(data + 48));
+
+        data += 64;
+        length -= 64;
+    }
+
+    x1 = fold(x1, r4r3, x2);
+    x1 = fold(x1, r4r3, x3);
+    x1 = fold(x1, r4r3, x4);
+
+    while (length >= 16) {
+        x1 = fold(x1, r4r3, load(data));
+
+        data += 16;
+        length -= 16;
+    }
+
+    // NOTE(garrett): 128 to 64 bits, then 64 to 32
+    x1 = _mm_xor_si128(_mm_clmulepi64_si128(x1, r4r3, 0x10), _mm_srli_si128(x1, 8));
+    x1 = _mm_xor_si128(
+        _mm_clmulepi64_si128(_mm_and_si128(x1, mask), r5, 0x00),
+        _mm_srli_si128(x1, 4)
+    );
+
+    auto reduced = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), polynomial, 0x10);
+    reduced = _mm_clmulepi64_si128(_mm_and_si128(reduced, mask), polynomial, 0x00);
+
+    return static_cast<std::uint32_t>(_mm_extract_epi32(_mm_xor_si128(reduced, x1), 1));
+}
+
+auto crc32_hardware(std::uint32_t crc, std::span<const std::byte> data) noexcept
+        -> std::uint32_t {
+    static const auto supported = __builtin_cpu_supports("pclmul")
+        && __builtin_cpu_supports("sse4.1");
+
+    if (supported && data.size() >= 64u) {
+        const auto length = data.size() & ~std::size_t{15u};
+
+        crc = ~crc32_pclmul(~crc, data.data(), length);
+        data = data.subspan(length);
+    }
+
+    return static_cast<std::uint32_t>(
+        ::crc32_z(crc, reinterpret_cast<const Bytef*>(data.data()), data.size())
+    );
+}
+
+#else
+
+auto crc32_hardware(const std::uint32_t crc, std::span<const std::byte> data) noexcept
+        -> std::uint32_t {
+    return static_cast<std::uint32_t>(
+        ::crc32_z(crc, reinterpret_cast<const Bytef*>(data.data()), data.size())
+    );
+}
+
+#endif
+
+auto deflate(std::span<const std::byte> data, const int level)
+        -> std::expected<std::vector<std::byte>, Error> {
+    auto stream = z_stream{};
+
+    // NOTE(garrett): Negative window bits produce raw deflate data without the
+    // zlib header, as ZIP expects
+    if (::deflateInit2(&stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return std::unexpected(Error::CompressionFailed);
+    }
+
+    auto output = std::vector<std::byte>(::deflateBound(&stream, data.size()));
+
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<std::byte*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(output.data());
+    stream.avail_out = static_cast<uInt>(output.size());
+
+    const auto result = ::deflate(&stream, Z_FINISH);
+    ::deflateEnd(&stream);
+
+    if (result != Z_STREAM_END) {
+        return std::unexpected(Error::CompressionFailed);
+    }
+
+    output.resize(stream.total_out);
+    return output;
+}
+
+auto inflate(std::span<const std::byte> data, std::span<std::byte> output) -> bool {
+    auto stream = z_stream{};
+
+    if (::inflateInit2(&stream, -15) != Z_OK) {
+        return false;
+    }
+
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<std::byte*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(output.data());
+    stream.avail_out = static_cast<uInt>(output.size());
+
+    const auto result = ::inflate(&stream, Z_FINISH);
+    ::inflateEnd(&stream);
+
+    return result == Z_STREAM_END && stream.total_out == output.size();
+}
+
+// NOTE(garrett): Fills in whichever of the sizes and offset were too large for
+// the central directory header, in the order the ZIP64 extra field stores them
+auto read_zip64_extra(
+        std::span<const std::byte> extra,
+        std::uint64_t& size,
+        std::uint64_t& compressed_size,
+        std::uint64_t& offset) -> bool {
+    while (extra.size() >= 4u) {
+        const auto id = get<std::uint16_t>(extra, 0u);
+        const auto length = get<std::uint16_t>(extra, 2u);
+
+        if (extra.size() - 4u < length) {
+            return false;
+        }
+
+        if (id == zip64_extra_id) {
+            auto field = extra.subspan(4u, length);
+
+            for (auto* value : {&size, &compressed_size, &offset}) {
+                if (*value != 0xFFFFFFFFu) {
+                    continue;
+                }
+
+                if (field.size() < sizeof(std::uint64_t)) {
+                    return false;
+                }
+
+                *value = get<std::uint64_t>(field, 0u);
+                field = field.subspan(sizeof(std::uint64_t));
+            }
+
+            return true;
+        }
+
+        extra = extra.subspan(4u + length);
+    }
+
+    return size != 0xFFFFFFFFu && compressed_size != 0xFFFFFFFFu && offset != 0xFFFFFFFFu;
+}
+
+} // namespace
+
+auto crc32(std::span<const std::byte> data, const std::uint32_t crc) noexcept
+        -> std::uint32_t {
+    return crc32_hardware(crc, data);
+}
+
+Archive::Archive(
+        const std::span<const std::byte> mapping,
+        const bool owned,
+        std::vector<Entry>&& entries) noexcept
+        : mapping_(mapping)
+        , owned_(owned)
+        , entries_(std::move(entries)) {}
+
+Archive::Archive(Archive&& other) noexcept
+        : mapping_(std::exchange(other.mapping_, std::span<const std::byte>{}))
+        , owned_(std::exchange(other.owned_, false))
+        , entries_(std::move(other.entries_)) {}
+
+auto Archive::operator=(Archive&& other) noexcept -> Archive& {
+    if (this != &other) {
+        if (owned_) {
+            ::munmap(const_cast<std::byte*>(mapping_.data()), mapping_.size());
+        }
+
+        mapping_ = std::exchange(other.mapping_, std::span<const std::byte>{});
+        owned_ = std::exchange(other.owned_, false);
+        entries_ = std::move(other.entries_);
+    }
+
+    return *this;
+}
+
+Archive::~Archive() {
+    if (owned_) {
+        ::munmap(const_cast<std::byte*>(mapping_.data()), mapping_.size());
+    }
+}
+
+auto Archive::open(const std::filesystem::path& path) -> std::expected<Archive, Error> {
+    const auto descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (descriptor < 0) {
+        return std::unexpected(Error::ReadFailed);
+    }
+
+    struct stat status{};
+
+    if (::fstat(descriptor, &status) < 0) {
+        ::close(descriptor);
+        return std::unexpected(Error::ReadFailed);
+    }
+
+    const auto size = static_cast<std::size_t>(status.st_size);
+
+    if (size < end_record_size) {
+        ::close(descriptor);
+        return std::unexpected(Error::InvalidArchive);
+    }
+
+    auto* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    ::close(descriptor);
+
+    if (data == MAP_FAILED) {
+        return std::unexpected(Error::ReadFailed);
+    }
+
+    const auto mapping = std::span{static_cast<const std::byte*>(data), size};
+    auto entries = index(mapping);
+
+    if (!entries) {
+        ::munmap(data, size);
+        return std::unexpected(entries.error());
+    }
+
+    return Archive{mapping, true, std::move(entries.value())};
+}
+
+auto Archive::view(const std::span<const std::byte> bytes) -> std::expected<Archive, Error> {
+    auto entries = index(bytes);
+
+    if (!entries) {
+        return std::unexpected(entries.error());
+    }
+
+    return Archive{bytes, false, std::move(entries.value())};
+}
+
+auto Archive::index(const std::span<const std::byte> bytes)
+        -> std::expected<std::vector<Entry>, Error> {
+    if (bytes.size() < end_record_size) {
+        return std::unexpected(Error::InvalidArchive);
+    }
+
+    // NOTE(garrett): The end record sits before a comment of up to 64KiB, so
+    // it's searched for backwards from the end
+    const auto lowest = bytes.size() - std::min(bytes.size(), end_record_size + 0xFFFFu);
+    auto end = bytes.size() - end_record_size;
+
+    while (get<std::uint32_t>(bytes, end) != end_record_signature) {
+        if (end == lowest) {
+            return std::unexpected(Error::InvalidArchive);
+        }
+
+        --end;
+    }
+
+    auto count = std::uint64_t{get<std::uint16_t>(bytes, end + 10u)};
+    auto directory_size = std::uint64_t{get<std::uint32_t>(bytes, end + 12u)};
+    auto directory_offset = std::uint64_t{get<std::uint32_t>(bytes, end + 16u)};
+
+    const auto zip64 = end >= zip64_locator_size
+        && get<std::uint32_t>(bytes, end - zip64_locator_size) == zip64_locator_signature;
+
+    if (zip64) {
+        const auto record = get<std::uint64_t>(bytes, end - zip64_locator_size + 8u);
+
+        if (bytes.size() < zip64_end_record_size
+                || record > bytes.size() - zip64_end_record_size
+                || get<std::uint32_t>(bytes, record) != zip64_end_record_signature) {
+            return std::unexpected(Error::InvalidArchive);
+        }
+
+        count = get<std::uint64_t>(bytes, record + 32u);
+        directory_size = get<std::uint64_t>(bytes, record + 40u);
+        directory_offset = get<std::uint64_t>(bytes, record + 48u);
+    }
+
+    if (directory_offset > bytes.size() || directory_size > bytes.size() - directory_offset) {
+        return std::unexpected(Error::InvalidArchive);
+    }
+
+    const auto directory = bytes.subspan(directory_offset, directory_size);
+    auto entries = std::vector<Entry>{};
+    auto position = 0uz;
+
+    entries.reserve(std::min(count, directory_size / central_header_size));
+
+    for (auto i = 0uz; i < count; ++i) {
+        if (directory.size() - position < central_header_size
+                || get<std::uint32_t>(directory, position) != central_header_signature) {
+            return std::unexpected(Error::InvalidArchive);
+        }
+
+        const auto flags = get<std::uint16_t>(directory, position + 8u);
+        const auto method = get<std::uint16_t>(directory, position + 10u);
+        const auto crc = get<std::uint32_t>(directory, position + 16u);
+        auto compressed_size = std::uint64_t{get<std::uint32_t>(directory, position + 20u)};
+        auto size = std::uint64_t{get<std::uint32_t>(directory, position + 24u)};
+        const auto name_length = get<std::uint16_t>(directory, position + 28u);
+        const auto extra_length = get<std::uint16_t>(directory, position + 30u);
+        const auto comment_length = get<std::uint16_t>(directory, position + 32u);
+        auto local = std::uint64_t{get<std::uint32_t>(directory, position + 42u)};
+
+        const auto header_size = central_header_size + name_length + extra_length
+            + comment_length;
+
+        if (directory.size() - position < header_size) {
+            return std::unexpected(Error::InvalidArchive);
+        }
+
+        const auto name = directory.subspan(position + central_header_size, name_length);
+        const auto extra = directory.subspan(
+            position + central_header_size + name_length,
+            extra_length
+        );
+
+        if (!read_zip64_extra(extra, size, compressed_size, local)) {
+            return std::unexpected(Error::InvalidArchive);
+        }
+
+        if (bytes.size() < local_header_size
+                || local > bytes.size() - local_header_size
+                || get<std::uint32_t>(bytes, local) != local_header_signature) {
+            return std::unexpected(Error::InvalidArchive);
+        }
+
+        const auto offset = local + local_header_size + get<std::uint16_t>(bytes, local + 26u)
+            + get<std::uint16_t>(bytes, local + 28u);
+
+        if (offset > bytes.size() || compressed_size > bytes.size() - offset) {
+            return std::unexpected(Error::InvalidArchive);
+        }
+
+        entries.push_back(Entry{
+            std::string_view{reinterpret_cast<const char*>(name.data()), name.size()},
+            flags,
+            static_cast<Compression>(method),
+            crc,
+            compressed_size,
+            size,
+            offset
+        });
+
+        position += header_size;
+    }
+
+    return entries;
+}
+
+auto Archive::bytes() const noexcept -> std::span<const std::byte> {
+    return mapping_;
+}
+
+auto Archive::entries() const noexcept -> std::span<const Entry> {
+    return entries_;
+}
+
+auto Archive::find(const std::string_view name) const noexcept -> std::optional<std::size_t> {
+    const auto found = std::ranges::find(entries_, name, &Entry::name);
+
+    if (found == entries_.end()) {
+        return std::nullopt;
+    }
+
+    return static_cast<std::size_t>(found - entries_.begin());
+}
+
+auto Archive::raw(const Entry& entry) const noexcept -> std::span<const std::byte> {
+    return mapping_.subspan(entry.offset, entry.compressed_size);
+}
+
+auto Archive::extract(const Entry& entry, std::vector<std::byte>& buffer) const
+        -> std::expected<std::span<const std::byte>, Error> {
+    if (entry.flags & encrypted_flag) {
+        return std::unexpected(Error::UnsupportedCompression);
+    }
+
+    const auto data = raw(entry);
+    auto contents = std::span<const std::byte>{};
+
+    switch (entry.compression) {
+        case Compression::Stored:
+            if (data.size() != entry.size) {
+                return std::unexpected(Error::InvalidArchive);
+            }
+
+            contents = data;
+            break;
+        case Compression::Deflated:
+            // NOTE(garrett): zlib counts in 32 bits
+            if (entry.size > std::numeric_limits<uInt>::max()
+                    || data.size() > std::numeric_limits<uInt>::max()) {
+                return std::unexpected(Error::EntryTooLarge);
+            }
+
+            // NOTE(garrett): The size comes from the central directory, so is
+            // checked against the data before anything is allocated for it
+            if (entry.size / deflate_expansion > data.size()) {
+                return std::unexpected(Error::EntryTooLarge);
+            }
+
+            buffer.resize(entry.size);
+
+            if (!inflate(data, buffer)) {
+                return std::unexpected(Error::DecompressionFailed);
+            }
+
+            contents = buffer;
+            break;
+        default:
+            return std::unexpected(Error::UnsupportedCompression);
+    }
+
+    if (jar::crc32(contents) != entry.crc) {
+        return std::unexpected(Error::ChecksumMismatch);
+    }
+
+    return contents;
+}
+
+Tree::Tree() noexcept
+        : buffers_(std::deque<std::vector<std::byte>>{})
+        , archives_(std::deque<Archive>{})
+        , entries_(std::vector<NestedEntry>{}) {}
+
+auto Tree::open(const std::filesystem::path& path, const std::size_t depth)
+        -> std::expected<Tree, Error> {
+    auto root = Archive::open(path);
+
+    if (!root) {
+        return std::unexpected(root.error());
+    }
+
+    auto tree = Tree{};
+    tree.expand(tree.archives_.emplace_back(std::move(root.value())), {}, depth);
+
+    return tree;
+}
+
+auto Tree::expand(const Archive& archive, const std::string_view prefix, const std::size_t depth)
+        -> void {
+    for (const auto& entry : archive.entries()) {
+        auto path = std::string{prefix};
+        path += entry.name;
+
+        if (depth && entry.name.ends_with(".jar") && !(entry.flags & encrypted_flag)) {
+            auto nested = std::expected<Archive, Error>{std::unexpected(Error::InvalidArchive)};
+
+            // NOTE(garrett): Stored archives are read straight out of the outer
+            // one without touching their contents, so their checksum is left
+            // unverified
+            if (entry.compression == Compression::Stored && entry.compressed_size == entry.size) {
+                nested = Archive::view(archive.raw(entry));
+            } else if (entry.compression == Compression::Deflated) {
+                auto& buffer = buffers_.emplace_back();
+                const auto contents = archive.extract(entry, buffer);
+
+                if (contents) {
+                    nested = Archive::view(contents.value());
+                }
+
+                if (!nested) {
+                    buffers_.pop_back();
+                }
+            }
+
+            if (nested) {
+                path += "!/";
+                expand(archives_.emplace_back(std::move(nested.value())), path, depth - 1u);
+
+                continue;
+            }
+        }
+
+        entries_.push_back(NestedEntry{&archive, &entry, std::move(path)});
+    }
+}
+
+auto Tree::archives() const noexcept -> const std::deque<Archive>& {
+    return archives_;
+}
+
+auto Tree::entries() const noexcept -> std::span<const NestedEntry> {
+    return entries_;
+}
+
+Writer::Writer(const int descriptor, kh::threading::ThreadPool& pool, const int level)
+        : descriptor_(descriptor)
+        , pool_(pool)
+        , level_(level)
+        , pending_(std::deque<std::future<std::expected<Compressed, Error>>>{})
+        , records_(std::vector<Record>{})
+        , offset_(0u)
+        , entries_(0u) {}
+
+auto Writer::add(
+        std::string name,
+        std::vector<std::byte> data,
+        const Compression compression) -> std::expected<void, Error> {
+    if (const auto reserved = reserve(name, data.size()); !reserved) {
+        return reserved;
+    }
+
+    pending_.push_back(pool_.submit(
+        [name = std::move(name), data = std::move(data), compression, level = level_]() mutable
+                -> std::expected<Compressed, Error> {
+            const auto crc = jar::crc32(data);
+            const auto size = static_cast<std::uint32_t>(data.size());
+
+            if (compression == Compression::Deflated && !data.empty()) {
+                auto deflated = deflate(data, level);
+
+                if (!deflated) {
+                    return std::unexpected(deflated.error());
+                }
+
+                if (deflated->size() < data.size()) {
+                    const auto compressed_size = static_cast<std::uint32_t>(deflated->size());
+
+                    return Compressed{
+                        Record{std::move(name), compression, crc, compressed_size, size, 0u},
+                        std::move(deflated.value())
+                    };
+                }
+            }
+
+            return Compressed{
+                Record{std::move(name), Compression::Stored, crc, size, size, 0u},
+                std::move(data)
+            };
+        }
+    ));
+
+    // NOTE(garrett): Bounds the amount of compressed output held in memory
+    // while still keeping every worker busy
+    return drain(2u * pool_.size());
+}
+
+auto Writer::copy(const Archive& archive, const Entry& entry) -> std::expected<void, Error> {
+    if (entry.flags & encrypted_flag) {
+        return std::unexpected(Error::UnsupportedCompression);
+    }
+
+    if (const auto reserved = reserve(entry.name, entry.size); !reserved) {
+        return reserved;
+    }
+
+    if (entry.compressed_size > 0xFFFFFFFFu) {
+        return std::unexpected(Error::EntryTooLarge);
+    }
+
+    const auto data = archive.raw(entry);
+    auto ready = std::promise<std::expected<Compressed, Error>>{};
+
+    ready.set_value(Compressed{
+        Record{
+            std::string{entry.name},
+            entry.compression,
+            entry.crc,
+            static_cast<std::uint32_t>(entry.compressed_size),
+            static_cast<std::uint32_t>(entry.size),
+            0u
+        },
+        std::vector<std::byte>(data.begin(), data.end())
+    });
+
+    // NOTE(garrett): Queued behind any entries still being compressed, so the
+    // order entries were added in is kept
+    pending_.push_back(ready.get_future());
+    return drain(2u * pool_.size());
+}
+
+auto Writer::reserve(const std::string_view name, const std::uint64_t size)
+        -> std::expected<void, Error> {
+    if (name.empty() || name.size() > 0xFFFFu) {
+        return std::unexpected(Error::InvalidName);
+    }
+
+    if (size > 0xFFFFFFFFu) {
+        return std::unexpected(Error::EntryTooLarge);
+    }
+
+    if (entries_ == 0xFFFFu) {
+        return std::unexpected(Error::TooManyEntries);
+    }
+
+    ++entries_;
+    return {};
+}
+
+auto Writer::drain(const std::size_t keep) -> std::expected<void, Error> {
+    while (!pending_.empty()) {
+        auto& next = pending_.front();
+
+        if (pending_.size() <= keep
+                && next.wait_for(std::chrono::seconds{0}) != std::future_status::ready) {
+            break;
+        }
+
+        auto compressed = next.get();
+        pending_.pop_front();
+
+        if (!compressed) {
+            return std::unexpected(compressed.error());
+        }
+
+        if (const auto result = write(std::move(compressed.value())); !result) {
+            return result;
+        }
+    }
+
+    return {};
+}
+
+auto Writer::write(Compressed&& compressed) -> std::expected<void, Error> {
+    auto& record = compressed.record;
+    const auto length = local_header_size + record.name.size() + compressed.data.size();
+
+    if (offset_ + length > 0xFFFFFFFFu) {
+        return std::unexpected(Error::EntryTooLarge);
+    }
+
+    record.offset = static_cast<std::uint32_t>(offset_);
+
+    auto header = std::vector<std::byte>{};
+    header.reserve(local_header_size + record.name.size());
+
+    put(header, local_header_signature);
+    put(header, version);
+    put(header, flags);
+    put(header, static_cast<std::uint16_t>(record.compression));
+    put(header, dos_time);
+    put(header, dos_date);
+    put(header, record.crc);
+    put(header, record.compressed_size);
+    put(header, record.size);
+    put(header, static_cast<std::uint16_t>(record.name.size()));
+    put(header, std::uint16_t{0u});
+    put_text(header, record.name);
+
+    try {
+        auto sink = kh::sinks::VectoredSink{descriptor_};
+        sink.write_bytes(header);
+        sink.write_bytes(compressed.data);
+        sink.flush();
+    } catch (const std::system_error&) {
+        return std::unexpected(Error::WriteFailed);
+    }
+
+    offset_ += length;
+    records_.push_back(std::move(record));
+
+    return {};
+}
+
+auto Writer::finish() -> std::expected<void, Error> {
+    if (const auto result = drain(0u); !result) {
+        return result;
+    }
+
+    auto directory = std::vector<std::byte>{};
+    directory.reserve(records_.size() * central_header_size);
+
+    for (const auto& record : records_) {
+        put(directory, central_header_signature);
+        put(directory, version);
+        put(directory, version);
+        put(directory, flags);
+        put(directory, static_cast<std::uint16_t>(record.compression));
+        put(directory, dos_time);
+        put(directory, dos_date);
+        put(directory, record.crc);
+        put(directory, record.compressed_size);
+        put(directory, record.size);
+        put(directory, static_cast<std::uint16_t>(record.name.size()));
+        // NOTE(garrett): Extra field and comment lengths, disk number, then
+        // internal and external attributes
+        put(directory, std::uint16_t{0u});
+        put(directory, std::uint16_t{0u});
+        put(directory, std::uint16_t{0u});
+        put(directory, std::uint16_t{0u});
+        put(directory, std::uint32_t{0u});
+        put(directory, record.offset);
+        put_text(directory, record.name);
+    }
+
+    if (offset_ + directory.size() > 0xFFFFFFFFu) {
+        return std::unexpected(Error::EntryTooLarge);
+    }
+
+    const auto count = static_cast<std::uint16_t>(records_.size());
+    const auto size = static_cast<std::uint32_t>(directory.size());
+
+    put(directory, end_record_signature);
+    put(directory, std::uint16_t{0u});
+    put(directory, std::uint16_t{0u});
+    put(directory, count);
+    put(directory, count);
+    put(directory, size);
+    put(directory, static_cast<std::uint32_t>(offset_));
+    put(directory, std::uint16_t{0u});
+
+    try {
+        auto sink = kh::sinks::VectoredSink{descriptor_};
+        sink.write_bytes(directory);
+        sink.flush();
+    } catch (const std::system_error&) {
+        return std::unexpected(Error::WriteFailed);
+    }
+
+    offset_ += directory.size();
+    return {};
+}
+
+} // namespace kh::jvm::jar
@@ -0,0 +1,192 @@
+#ifndef JAR_H
+#define JAR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <filesystem>
+#include <future>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "threading.h"
+
+namespace kh::jvm::jar {
+
+enum Error {
+    ChecksumMismatch,
+    CompressionFailed,
+    DecompressionFailed,
+    EntryTooLarge,
+    InvalidArchive,
+    InvalidName,
+    ReadFailed,
+    TooManyEntries,
+    UnsupportedCompression,
+    WriteFailed
+};
+
+enum class Compression : std::uint16_t {
+    Stored = 0,
+    Deflated = 8
+};
+
+// NOTE(garrett): The most deflate can expand its input, so sizes claiming
+// more than this per compressed byte can't be genuine
+inline constexpr auto deflate_expansion = 1032u;
+
+// NOTE(garrett): Standard zlib CRC-32. Uses the ARMv8 CRC instructions when
+// compiled for them, or carry-less multiplication on x86 CPUs that support
+// it, falling back to zlib otherwise.
+auto crc32(std::span<const std::byte>, std::uint32_t crc = 0u) noexcept -> std::uint32_t;
+
+struct Entry {
+    // NOTE(garrett): Views into the archive's mapping
+    std::string_view name;
+    std::uint16_t flags;
+    Compression compression;
+    std::uint32_t crc;
+    std::uint64_t compressed_size;
+    std::uint64_t size;
+    // NOTE(garrett): Offset of the entry's data, past its local header
+    std::uint64_t offset;
+};
+
+// NOTE(garrett): Maps a ZIP archive and indexes its central directory up
+// front, so entries can be looked up and extracted from any number of threads
+// at once. ZIP64 archives are supported, encrypted entries and compression
+// methods other than deflate are not.
+class Archive {
+private:
+    std::span<const std::byte> mapping_;
+    bool owned_;
+    std::vector<Entry> entries_;
+
+    Archive(std::span<const std::byte> mapping, bool owned, std::vector<Entry>&&) noexcept;
+
+    static auto index(std::span<const std::byte>) -> std::expected<std::vector<Entry>, Error>;
+public:
+    static auto open(const std::filesystem::path&) -> std::expected<Archive, Error>;
+
+    // NOTE(garrett): Reads an archive already in memory, which must outlive
+    // the returned one
+    static auto view(std::span<const std::byte>) -> std::expected<Archive, Error>;
+
+    Archive(Archive&&) noexcept;
+    auto operator=(Archive&&) noexcept -> Archive&;
+    Archive(const Archive&) = delete;
+    auto operator=(const Archive&) -> Archive& = delete;
+    ~Archive();
+
+    auto bytes() const noexcept -> std::span<const std::byte>;
+    auto entries() const noexcept -> std::span<const Entry>;
+    auto find(std::string_view name) const noexcept -> std::optional<std::size_t>;
+
+    // NOTE(garrett): The entry's data exactly as stored, still compressed
+    // when deflated
+    auto raw(const Entry&) const noexcept -> std::span<const std::byte>;
+
+    // NOTE(garrett): Stored entries are returned in place without copying.
+    // Deflated ones are inflated into `buffer`, which is resized as needed and
+    // can be reused across calls. Checksums are verified either way.
+    auto extract(const Entry&, std::vector<std::byte>& buffer) const
+        -> std::expected<std::span<const std::byte>, Error>;
+};
+
+struct NestedEntry {
+    const Archive* archive;
+    const Entry* entry;
+    // NOTE(garrett): Names of the enclosing archives and the entry joined by
+    // "!/" as in jar URLs, e.g. `BOOT-INF/lib/a.jar!/a/A.class`
+    std::string path;
+};
+
+// NOTE(garrett): Opens an archive along with every archive nested inside it,
+// such as the `BOOT-INF/lib/*.jar` of a fat jar, and lists their entries as
+// one sequence in archive order. Stored inner archives are read in place out
+// of the outer mapping. Deflated ones need their central directory, so each is
+// inflated once into memory held by the tree, never to disk. Inner archives
+// that don't parse, or that are deeper than `depth`, are listed as plain
+// entries.
+class Tree {
+private:
+    std::deque<std::vector<std::byte>> buffers_;
+    std::deque<Archive> archives_;
+    std::vector<NestedEntry> entries_;
+
+    Tree() noexcept;
+
+    auto expand(const Archive&, std::string_view prefix, std::size_t depth) -> void;
+public:
+    static auto open(const std::filesystem::path&, std::size_t depth = 4u)
+        -> std::expected<Tree, Error>;
+
+    Tree(Tree&&) noexcept = default;
+    auto operator=(Tree&&) noexcept -> Tree& = default;
+    Tree(const Tree&) = delete;
+    auto operator=(const Tree&) -> Tree& = delete;
+
+    // NOTE(garrett): The root archive first, then nested ones as they were
+    // found
+    auto archives() const noexcept -> const std::deque<Archive>&;
+    auto entries() const noexcept -> std::span<const NestedEntry>;
+};
+
+// NOTE(garrett): Writes a ZIP archive to `descriptor`, compressing entries on
+// `pool` while earlier ones are being written. Entries keep the order they
+// were added in and carry a fixed timestamp, so identical input produces
+// identical archives. ZIP64 isn't supported, which limits archives to 65535
+// entries and 4GiB.
+class Writer {
+private:
+    struct Record {
+        std::string name;
+        Compression compression;
+        std::uint32_t crc;
+        std::uint32_t compressed_size;
+        std::uint32_t size;
+        std::uint32_t offset;
+    };
+
+    struct Compressed {
+        Record record;
+        std::vector<std::byte> data;
+    };
+
+    int descriptor_;
+    kh::threading::ThreadPool& pool_;
+    int level_;
+    std::deque<std::future<std::expected<Compressed, Error>>> pending_;
+    std::vector<Record> records_;
+    std::uint64_t offset_;
+    std::size_t entries_;
+
+    auto drain(std::size_t keep) -> std::expected<void, Error>;
+    auto reserve(std::string_view name, std::uint64_t size) -> std::expected<void, Error>;
+    auto write(Compressed&&) -> std::expected<void, Error>;
+public:
+    Writer(int descriptor, kh::threading::ThreadPool& pool, int level = 6);
+
+    // NOTE(garrett): Deflated entries that don't shrink are stored instead.
+    // Errors from compressing or writing earlier entries may surface here.
+    auto add(
+        std::string name,
+        std::vector<std::byte> data,
+        Compression compression = Compression::Deflated) -> std::expected<void, Error>;
+
+    // NOTE(garrett): Adds an entry from another archive as is, without
+    // decompressing it
+    auto copy(const Archive&, const Entry&) -> std::expected<void, Error>;
+
+    // NOTE(garrett): Writes out any remaining entries followed by the central
+    // directory. The descriptor is left open.
+    auto finish() -> std::expected<void, Error>;
+};
+
+} // namespace kh::jvm::jar
+
+#endif // JAR_H
@@ -0,0 +1,413 @@
+#include <array>
+#include <bit>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "jar.h"
+#include "jimage.h"
+
+namespace kh::jvm::jimage {
+
+namespace {
+
+constexpr auto header_size = 28uz;
+constexpr auto resource_header_size = 29uz;
+
+constexpr auto image_magic = std::uint32_t{0xCAFEDADAu};
+constexpr auto resource_magic = std::uint32_t{0xCAFEFAFAu};
+constexpr auto major_version = std::uint32_t{1u};
+
+enum Attribute : std::uint8_t {
+    End,
+    Module,
+    Parent,
+    Base,
+    Extension,
+    Offset,
+    Compressed,
+    Uncompressed,
+    Count
+};
+
+} // namespace
+
+auto Location::name() const -> std::string {
+    auto name = std::string{};
+    name.reserve(module.size() + parent.size() + base.size() + extension.size() + 4u);
+
+    if (!module.empty()) {
+        name += '/';
+        name += module;
+        name += '/';
+    }
+
+    if (!parent.empty()) {
+        name += parent;
+        name += '/';
+    }
+
+    name += base;
+
+    if (!extension.empty()) {
+        name += '.';
+        name += extension;
+    }
+
+    return name;
+}
+
+Image::Image(const std::span<const std::byte> mapping, const bool owned) noexcept
+        : mapping_(mapping)
+        , owned_(owned)
+        , swapped_(false)
+        , redirects_(std::span<const std::byte>{})
+        , offsets_(std::span<const std::byte>{})
+        , locations_(std::span<const std::byte>{})
+        , strings_(std::span<const std::byte>{})
+        , resources_(std::span<const std::byte>{}) {}
+
+Image::Image(Image&& other) noexcept
+        : mapping_(std::exchange(other.mapping_, std::span<const std::byte>{}))
+        , owned_(std::exchange(other.owned_, false))
+        , swapped_(other.swapped_)
+        , redirects_(other.redirects_)
+        , offsets_(other.offsets_)
+        , locations_(other.locations_)
+        , strings_(other.strings_)
+        , resources_(other.resources_) {}
+
+auto Image::operator=(Image&& other) noexcept -> Image& {
+    if (this != &other) {
+        if (owned_) {
+            ::munmap(const_cast<std::byte*>(mapping_.data()), mapping_.size());
+        }
+
+        mapping_ = std::exchange(other.mapping_, std::span<const std::byte>{});
+        owned_ = std::exchange(other.owned_, false);
+        swapped_ = other.swapped_;
+        redirects_ = other.redirects_;
+        offsets_ = other.offsets_;
+        locations_ = other.locations_;
+        strings_ = other.strings_;
+        resources_ = other.resources_;
+    }
+
+    return *this;
+}
+
+Image::~Image() {
+    if (owned_) {
+        ::munmap(const_cast<std::byte*>(mapping_.data()), mapping_.size());
+    }
+}
+
+auto Image::open(const std::filesystem::path& path) -> std::expected<Image, Error> {
+    const auto descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (descriptor < 0) {
+        return std::unexpected(Error::ReadFailed);
+    }
+
+    struct stat status{};
+
+    if (::fstat(descriptor, &status) < 0) {
+        ::close(descriptor);
+        return std::unexpected(Error::ReadFailed);
+    }
+
+    const auto size = static_cast<std::size_t>(status.st_size);
+
+    if (size < header_size) {
+        ::close(descriptor);
+        return std::unexpected(Error::InvalidImage);
+    }
+
+    auto* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    ::close(descriptor);
+
+    if (data == MAP_FAILED) {
+        return std::unexpected(Error::ReadFailed);
+    }
+
+    // NOTE(garrett): Unmapped by the image from here on, even if loading fails
+    auto image = Image{std::span{static_cast<const std::byte*>(data), size}, true};
+
+    if (auto loaded = image.load(); !loaded) {
+        return std::unexpected(loaded.error());
+    }
+
+    return image;
+}
+
+auto Image::view(const std::span<const std::byte> bytes) -> std::expected<Image, Error> {
+    auto image = Image{bytes, false};
+
+    if (auto loaded = image.load(); !loaded) {
+        return std::unexpected(loaded.error());
+    }
+
+    return image;
+}
+
+template <typename V>
+auto Image::value(const std::span<const std::byte> bytes, const std::size_t offset) const noexcept
+        -> V {
+    auto value = V{};
+    std::memcpy(&value, bytes.data() + offset, sizeof(V));
+
+    return swapped_ ? std::byteswap(value) : value;
+}
+
+auto Image::load() -> std::expected<void, Error> {
+    if (mapping_.size() < header_size) {
+        return std::unexpected(Error::InvalidImage);
+    }
+
+    // NOTE(garrett): The image is written in the byte order of the platform
+    // that built it, which the magic gives away
+    auto magic = std::uint32_t{};
+    std::memcpy(&magic, mapping_.data(), sizeof(magic));
+
+    if (magic != image_magic) {
+        if (std::byteswap(magic) != image_magic) {
+            return std::unexpected(Error::InvalidImage);
+        }
+
+        swapped_ = true;
+    }
+
+    if (value<std::uint32_t>(mapping_, 4u) >> 16u != major_version) {
+        return std::unexpected(Error::UnsupportedVersion);
+    }
+
+    const auto table_length = std::uint64_t{value<std::uint32_t>(mapping_, 16u)};
+    const auto locations_size = std::uint64_t{value<std::uint32_t>(mapping_, 20u)};
+    const auto strings_size = std::uint64_t{value<std::uint32_t>(mapping_, 24u)};
+    const auto index_size = header_size + table_length * 8u + locations_size + strings_size;
+
+    if (index_size > mapping_.size()) {
+        return std::unexpected(Error::InvalidImage);
+    }
+
+    auto position = header_size;
+
+    auto take = [this, &position](const std::uint64_t size) {
+        const auto taken = mapping_.subspan(position, size);
+        position += size;
+
+        return taken;
+    };
+
+    redirects_ = take(table_length * 4u);
+    offsets_ = take(table_length * 4u);
+    locations_ = take(locations_size);
+    strings_ = take(strings_size);
+    resources_ = mapping_.subspan(position);
+
+    return {};
+}
+
+auto Image::string(const std::uint64_t offset) const noexcept
+        -> std::optional<std::string_view> {
+    if (offset >= strings_.size()) {
+        return std::nullopt;
+    }
+
+    const auto* start = reinterpret_cast<const char*>(strings_.data() + offset);
+    const auto* end = static_cast<const char*>(std::memchr(start, 0, strings_.size() - offset));
+
+    if (!end) {
+        return std::nullopt;
+    }
+
+    return std::string_view{start, end};
+}
+
+auto Image::size() const noexcept -> std::size_t {
+    return offsets_.size() / 4u;
+}
+
+auto Image::location(const std::size_t index) const -> std::expected<Location, Error> {
+    if (index >= size()) {
+        return std::unexpected(Error::InvalidImage);
+    }
+
+    auto attributes = std::array<std::uint64_t, Attribute::Count>{};
+    auto position = std::size_t{value<std::uint32_t>(offsets_, index * 4u)};
+
+    // NOTE(garrett): Each attribute is a byte holding its kind and length,
+    // followed by a big endian value of up to eight bytes
+    while (true) {
+        if (position >= locations_.size()) {
+            return std::unexpected(Error::InvalidImage);
+        }
+
+        const auto header = std::to_integer<std::uint8_t>(locations_[position++]);
+        const auto kind = header >> 3u;
+        const auto length = (header & 0x07u) + 1uz;
+
+        if (kind == Attribute::End) {
+            break;
+        }
+
+        if (kind >= Attribute::Count || length > locations_.size() - position) {
+            return std::unexpected(Error::InvalidImage);
+        }
+
+        auto field = std::uint64_t{};
+
+        for (auto i = 0uz; i < length; ++i) {
+            field = field << 8u | std::to_integer<std::uint64_t>(locations_[position++]);
+        }
+
+        attributes[kind] = field;
+    }
+
+    const auto module = string(attributes[Attribute::Module]);
+    const auto parent = string(attributes[Attribute::Parent]);
+    const auto base = string(attributes[Attribute::Base]);
+    const auto extension = string(attributes[Attribute::Extension]);
+
+    if (!module || !parent || !base || !extension) {
+        return std::unexpected(Error::InvalidImage);
+    }
+
+    return Location{
+        module.value(),
+        parent.value(),
+        base.value(),
+        extension.value(),
+        attributes[Attribute::Offset],
+        attributes[Attribute::Compressed],
+        attributes[Attribute::Uncompressed]
+    };
+}
+
+auto Image::find(const std::string_view name) const -> std::optional<Location> {
+    const auto length = size();
+
+    if (!length) {
+        return std::nullopt;
+    }
+
+    // NOTE(garrett): Names that share a slot are told apart by a seed stored
+    // in it, while a slot with a single name points straight at its location
+    const auto redirect = static_cast<std::int32_t>(
+        value<std::uint32_t>(redirects_, hash(name) % length * 4u)
+    );
+
+    auto index = std::size_t{};
+
+    if (redirect > 0) {
+        index = hash(name, static_cast<std::uint32_t>(redirect)) % length;
+    } else if (redirect < 0) {
+        index = static_cast<std::size_t>(-1 - static_cast<std::int64_t>(redirect));
+    } else {
+        return std::nullopt;
+    }
+
+    auto location = this->location(index);
+
+    if (!location) {
+        return std::nullopt;
+    }
+
+    // NOTE(garrett): The hash is perfect only for names in the image, so
+    // anything else lands on some other resource and has to be compared
+    auto rest = name;
+
+    auto consume = [&rest](const std::string_view part) {
+        if (!rest.starts_with(part)) {
+            return false;
+        }
+
+        rest.remove_prefix(part.size());
+        return true;
+    };
+
+    const auto matches = (location->module.empty()
+            || (consume("/") && consume(location->module) && consume("/")))
+        && (location->parent.empty() || (consume(location->parent) && consume("/")))
+        && consume(location->base)
+        && (location->extension.empty() || (consume(".") && consume(location->extension)))
+        && rest.empty();
+
+    if (!matches) {
+        return std::nullopt;
+    }
+
+    return location.value();
+}
+
+auto Image::read(const Location& location, std::vector<std::byte>& buffer) const
+        -> std::expected<std::span<const std::byte>, Error> {
+    const auto stored = location.compressed_size ? location.compressed_size : location.size;
+
+    if (location.offset > resources_.size() || stored > resources_.size() - location.offset) {
+        return std::unexpected(Error::InvalidImage);
+    }
+
+    auto contents = resources_.subspan(location.offset, stored);
+
+    if (!location.compressed_size) {
+        return contents;
+    }
+
+    // NOTE(garrett): Compression can be stacked, with each layer behind its
+    // own header, so layers are peeled off until none is left
+    auto scratch = std::vector<std::byte>{};
+
+    while (contents.size() >= resource_header_size
+            && value<std::uint32_t>(contents, 0u) == resource_magic) {
+        const auto compressed_size = value<std::uint64_t>(contents, 4u);
+        const auto size = value<std::uint64_t>(contents, 12u);
+        const auto decompressor = string(value<std::uint32_t>(contents, 20u));
+
+        if (!decompressor || compressed_size > contents.size() - resource_header_size) {
+            return std::unexpected(Error::InvalidImage);
+        }
+
+        if (decompressor.value() != "zip") {
+            return std::unexpected(Error::UnsupportedCompression);
+        }
+
+        // NOTE(garrett): The payload lies within the mapping, so this bounds
+        // the allocation by the image rather than by whatever the header says
+        if (size / kh::jvm::jar::deflate_expansion > compressed_size) {
+            return std::unexpected(Error::InvalidImage);
+        }
+
+        scratch.resize(size);
+
+        const auto* source = reinterpret_cast<const Bytef*>(contents.data() + resource_header_size);
+        auto length = static_cast<uLongf>(size);
+
+        const auto result = ::uncompress(
+            reinterpret_cast<Bytef*>(scratch.data()),
+            &length,
+            source,
+            static_cast<uLong>(compressed_size)
+        );
+
+        if (result != Z_OK || length != size) {
+            return std::unexpected(Error::DecompressionFailed);
+        }
+
+        std::swap(buffer, scratch);
+        contents = buffer;
+    }
+
+    if (contents.size() != location.size) {
+        return std::unexpected(Error::DecompressionFailed);
+    }
+
+    return contents;
+}
+
+} // namespace kh::jvm::jimage
@@ -0,0 +1,104 @@
+#ifndef JIMAGE_H
+#define JIMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace kh::jvm::jimage {
+
+enum Error {
+    DecompressionFailed,
+    InvalidImage,
+    ReadFailed,
+    UnsupportedCompression,
+    UnsupportedVersion
+};
+
+// NOTE(garrett): The hash the image's redirect table is built with, an FNV
+// variant that is also reseeded to resolve collisions
+constexpr auto hash(const std::string_view name, const std::uint32_t seed = 0x01000193u) noexcept
+        -> std::uint32_t {
+    auto value = seed;
+
+    for (const auto character : name) {
+        value = (value * 0x01000193u) ^ static_cast<std::uint8_t>(character);
+    }
+
+    return value & 0x7FFFFFFFu;
+}
+
+struct Location {
+    // NOTE(garrett): Views into the image's string table. A resource is named
+    // `/module/parent/base.extension`, leaving out whichever parts are empty.
+    std::string_view module;
+    std::string_view parent;
+    std::string_view base;
+    std::string_view extension;
+    // NOTE(garrett): Relative to the end of the index
+    std::uint64_t offset;
+    // NOTE(garrett): Zero when the resource is stored uncompressed
+    std::uint64_t compressed_size;
+    std::uint64_t size;
+
+    auto name() const -> std::string;
+};
+
+// NOTE(garrett): Maps a JDK runtime image, `lib/modules`, and resolves
+// resources by name through its perfect hash table without scanning anything.
+// Images of either byte order are read. Only zip compression is supported;
+// resources compressed with string sharing fail to read.
+class Image {
+private:
+    std::span<const std::byte> mapping_;
+    bool owned_;
+    bool swapped_;
+    std::span<const std::byte> redirects_;
+    std::span<const std::byte> offsets_;
+    std::span<const std::byte> locations_;
+    std::span<const std::byte> strings_;
+    std::span<const std::byte> resources_;
+
+    Image(std::span<const std::byte> mapping, bool owned) noexcept;
+
+    auto load() -> std::expected<void, Error>;
+    auto string(std::uint64_t offset) const noexcept -> std::optional<std::string_view>;
+    template <typename V>
+    auto value(std::span<const std::byte>, std::size_t offset) const noexcept -> V;
+public:
+    static auto open(const std::filesystem::path&) -> std::expected<Image, Error>;
+
+    // NOTE(garrett): Reads an image already in memory, which must outlive the
+    // returned one
+    static auto view(std::span<const std::byte>) -> std::expected<Image, Error>;
+
+    Image(Image&&) noexcept;
+    auto operator=(Image&&) noexcept -> Image&;
+    Image(const Image&) = delete;
+    auto operator=(const Image&) -> Image& = delete;
+    ~Image();
+
+    // NOTE(garrett): Every location is in one slot of the table, so this also
+    // bounds iteration with `location`
+    auto size() const noexcept -> std::size_t;
+    auto location(std::size_t index) const -> std::expected<Location, Error>;
+
+    // NOTE(garrett): Takes full names such as `/java.base/java/lang/Object.class`
+    auto find(std::string_view name) const -> std::optional<Location>;
+
+    // NOTE(garrett): Uncompressed resources are returned in place without
+    // copying. Compressed ones are decompressed into `buffer`, which is resized
+    // as needed and can be reused across calls.
+    auto read(const Location&, std::vector<std::byte>& buffer) const
+        -> std::expected<std::span<const std::byte>, Error>;
+};
+
+} // namespace kh::jvm::jimage
+
+#endif // JIMAGE_H
@@ -0,0 +1,587 @@
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <optional>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+#include "loading.h"
+
+namespace kh::loading {
+
+namespace {
+
+// NOTE(garrett): Reads the whole file at `path`, into `buffer` when it fits
+// and into `large` otherwise
+auto read_file(
+        const std::filesystem::path& path,
+        std::span<std::byte> buffer,
+        std::vector<std::byte>& large) -> std::expected<std::span<const std::byte>, Error> {
+    const auto descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (descriptor < 0) {
+        return std::unexpected(Error::OpenFailed);
+    }
+
+    struct stat status{};
+
+    if (::fstat(descriptor, &status) < 0) {
+        ::close(descriptor);
+        return std::unexpected(Error::StatFailed);
+    }
+
+    const auto size = static_cast<std::size_t>(status.st_size);
+
+    if (size > buffer.size()) {
+        large.resize(size);
+        buffer = large;
+    }
+
+    auto read = 0uz;
+
+    while (read < size) {
+        const auto result = ::read(descriptor, buffer.data() + read, size - read);
+
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (result <= 0) {
+            ::close(descriptor);
+            return std::unexpected(Error::ReadFailed);
+        }
+
+        read += static_cast<std::size_t>(result);
+    }
+
+    ::close(descriptor);
+    return buffer.first(size);
+}
+
+} // namespace
+
+#if defined(__linux__)
+
+namespace {
+
+enum Operation : std::uint64_t {
+    Open,
+    Stat,
+    Read,
+    Close
+};
+
+struct Slot {
+    std::size_t index;
+    // NOTE(garrett): Open and not yet handed to a close request, unless reading
+    int descriptor = -1;
+    // NOTE(garrett): Completions still outstanding for the current phase
+    int pending;
+    bool reading;
+    std::optional<Error> error;
+    struct statx status;
+    std::vector<std::byte> large;
+};
+
+constexpr auto required_operations = std::to_array<std::uint8_t>({
+    IORING_OP_OPENAT,
+    IORING_OP_STATX,
+    IORING_OP_READ,
+    IORING_OP_READ_FIXED,
+    IORING_OP_CLOSE
+});
+
+auto setup(const unsigned entries, ::io_uring_params& parameters) -> int {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, &parameters));
+}
+
+auto enter(const int ring, const unsigned submit, const unsigned wait) -> int {
+    return static_cast<int>(::syscall(
+        __NR_io_uring_enter,
+        ring,
+        submit,
+        wait,
+        wait ? IORING_ENTER_GETEVENTS : 0u,
+        nullptr,
+        0uz
+    ));
+}
+
+auto register_ring(const int ring, const unsigned opcode, void* argument, const unsigned count)
+        -> int {
+    return static_cast<int>(::syscall(__NR_io_uring_register, ring, opcode, argument, count));
+}
+
+auto supported(const int ring) -> bool {
+    auto probe = std::vector<std::byte>(
+        sizeof(::io_uring_probe) + 256u * sizeof(::io_uring_probe_op)
+    );
+
+    auto* operations = reinterpret_cast<::io_uring_probe*>(probe.data());
+
+    if (register_ring(ring, IORING_REGISTER_PROBE, operations, 256u) < 0) {
+        return false;
+    }
+
+    for (const auto operation : required_operations) {
+        if (operation > operations->last_op
+                || !(operations->ops[operation].flags & IO_URING_OP_SUPPORTED)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+// NOTE(garrett): The rings shared with the kernel, driven through raw system
+// calls rather than liburing
+struct Loader::Ring {
+    int descriptor;
+    bool registered;
+    std::span<std::byte> rings;
+    std::span<std::byte> entries;
+    std::uint32_t* submission_tail;
+    std::uint32_t* submission_array;
+    std::uint32_t submission_mask;
+    std::uint32_t* completion_head;
+    std::uint32_t* completion_tail;
+    std::uint32_t completion_mask;
+    ::io_uring_cqe* completions;
+    // NOTE(garrett): Entries written since the tail was last published, and
+    // entries published that the kernel hasn't consumed yet
+    unsigned queued;
+    unsigned unsubmitted;
+    // NOTE(garrett): Entries handed out by `next` whose completions haven't
+    // been drained
+    unsigned outstanding;
+
+    Ring(
+            const int descriptor,
+            const ::io_uring_params& parameters,
+            std::span<std::byte> rings,
+            std::span<std::byte> entries)
+            : descriptor(descriptor)
+            , registered(false)
+            , rings(rings)
+            , entries(entries)
+            , submission_tail(at(parameters.sq_off.tail))
+            , submission_array(at(parameters.sq_off.array))
+            , submission_mask(*at(parameters.sq_off.ring_mask))
+            , completion_head(at(parameters.cq_off.head))
+            , completion_tail(at(parameters.cq_off.tail))
+            , completion_mask(*at(parameters.cq_off.ring_mask))
+            , completions(reinterpret_cast<::io_uring_cqe*>(rings.data() + parameters.cq_off.cqes))
+            , queued(0u)
+            , unsubmitted(0u)
+            , outstanding(0u) {}
+
+    Ring(const Ring&) = delete;
+    auto operator=(const Ring&) -> Ring& = delete;
+
+    ~Ring() {
+        ::munmap(entries.data(), entries.size());
+        ::munmap(rings.data(), rings.size());
+        ::close(descriptor);
+    }
+
+    auto at(const std::uint32_t offset) const noexcept -> std::uint32_t* {
+        return reinterpret_cast<std::uint32_t*>(rings.data() + offset);
+    }
+
+    // NOTE(garrett): Callers never queue more than the ring holds between
+    // calls to `submit`, so there's always room
+    auto next() noexcept -> ::io_uring_sqe& {
+        const auto tail = *submission_tail + queued++;
+        ++outstanding;
+        const auto index = tail & submission_mask;
+        auto& entry = reinterpret_cast<::io_uring_sqe*>(entries.data())[index];
+
+        entry = ::io_uring_sqe{};
+        submission_array[index] = index;
+
+        return entry;
+    }
+
+    // NOTE(garrett): Hands everything queued to the kernel and waits for at
+    // least one completion
+    auto submit() -> void {
+        publish();
+
+        while (true) {
+            const auto result = enter(descriptor, unsubmitted, 1u);
+
+            if (result >= 0) {
+                unsubmitted -= static_cast<unsigned>(result);
+                return;
+            }
+
+            if (errno != EINTR) {
+                throw std::system_error(errno, std::generic_category(), "Failed to enter io_uring");
+            }
+        }
+    }
+
+    auto publish() noexcept -> void {
+        std::atomic_ref{*submission_tail}.store(
+            *submission_tail + queued,
+            std::memory_order_release
+        );
+
+        unsubmitted += std::exchange(queued, 0u);
+    }
+
+    // NOTE(garrett): Waits out everything outstanding, so the caller can
+    // unwind without the kernel still writing into its slots and buffers.
+    // Only gives up if the ring itself stops accepting calls.
+    template <typename F>
+    auto settle(F&& complete) noexcept -> void {
+        publish();
+
+        while (outstanding) {
+            const auto result = enter(descriptor, unsubmitted, 1u);
+
+            if (result >= 0) {
+                unsubmitted -= static_cast<unsigned>(result);
+            } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                return;
+            }
+
+            drain(complete);
+        }
+    }
+
+    template <typename F>
+    auto drain(F&& complete) -> void {
+        auto head = *completion_head;
+        const auto tail = std::atomic_ref{*completion_tail}.load(std::memory_order_acquire);
+
+        for (; head != tail; ++head) {
+            const auto completion = completions[head & completion_mask];
+            std::atomic_ref{*completion_head}.store(head + 1u, std::memory_order_release);
+            --outstanding;
+
+            complete(completion.user_data, completion.res);
+        }
+    }
+};
+
+auto Loader::load_ring(std::span<const std::filesystem::path> paths, const Callback& callback)
+        -> void {
+    auto& ring = *ring_;
+    auto slots = std::vector<Slot>(depth_);
+    auto available = std::vector<std::size_t>{};
+    auto next = 0uz;
+
+    for (auto i = depth_; i > 0u; --i) {
+        available.push_back(i - 1u);
+    }
+
+    auto tag = [](const std::size_t slot, const Operation operation) {
+        return static_cast<std::uint64_t>(slot) << 2u | operation;
+    };
+
+    auto finish = [&](const std::size_t index, std::span<const std::byte> contents) {
+        auto& slot = slots[index];
+        slot.descriptor = -1;
+
+        if (slot.error) {
+            callback(slot.index, std::unexpected(slot.error.value()));
+        } else {
+            callback(slot.index, contents);
+        }
+
+        slot.large.clear();
+        available.push_back(index);
+    };
+
+    auto start_read = [&](const std::size_t index) {
+        auto& slot = slots[index];
+        const auto size = static_cast<std::size_t>(slot.status.stx_size);
+        auto buffer = std::span{buffers_}.subspan(index * slot_size_, slot_size_);
+
+        if (size > slot_size_) {
+            slot.large.resize(size);
+            buffer = slot.large;
+        }
+
+        auto& read = ring.next();
+        read.fd = slot.descriptor;
+        read.addr = reinterpret_cast<std::uint64_t>(buffer.data());
+        read.len = static_cast<std::uint32_t>(size);
+        read.user_data = tag(index, Operation::Read);
+
+        // NOTE(garrett): Registered buffers skip pinning pages on every read
+        if (ring.registered && size <= slot_size_) {
+            read.opcode = IORING_OP_READ_FIXED;
+            read.buf_index = static_cast<std::uint16_t>(index);
+        } else {
+            read.opcode = IORING_OP_READ;
+        }
+
+        // NOTE(garrett): Hard links run the close even when the read fails
+        read.flags = IOSQE_IO_HARDLINK;
+
+        auto& close = ring.next();
+        close.opcode = IORING_OP_CLOSE;
+        close.fd = slot.descriptor;
+        close.user_data = tag(index, Operation::Close);
+
+        slot.reading = true;
+        slot.pending = 2;
+    };
+
+    auto complete = [&](const std::uint64_t data, const int result) {
+        const auto index = static_cast<std::size_t>(data >> 2u);
+        auto& slot = slots[index];
+
+        switch (static_cast<Operation>(data & 0x03u)) {
+            case Operation::Open:
+                if (result < 0) {
+                    slot.error = Error::OpenFailed;
+                } else {
+                    slot.descriptor = result;
+                }
+
+                break;
+            case Operation::Stat:
+                if (result < 0 && !slot.error) {
+                    slot.error = Error::StatFailed;
+                }
+
+                break;
+            case Operation::Read:
+                if (result < 0 || static_cast<std::uint64_t>(result) != slot.status.stx_size) {
+                    slot.error = Error::ReadFailed;
+                }
+
+                break;
+            case Operation::Close:
+                break;
+        }
+
+        if (--slot.pending) {
+            return;
+        }
+
+        if (slot.reading) {
+            const auto size = static_cast<std::size_t>(slot.status.stx_size);
+            const auto contents = size > slot_size_
+                ? std::span<const std::byte>{slot.large}
+                : std::span<const std::byte>{buffers_}.subspan(index * slot_size_, size);
+
+            finish(index, contents);
+            return;
+        }
+
+        if (slot.error) {
+            if (slot.descriptor >= 0) {
+                ::close(slot.descriptor);
+            }
+
+            finish(index, {});
+            return;
+        }
+
+        // NOTE(garrett): Files too large for a single read are left to the
+        // portable path
+        if (slot.status.stx_size > 0x7FFFF000u) {
+            ::close(std::exchange(slot.descriptor, -1));
+
+            auto large = std::vector<std::byte>{};
+            const auto contents = read_file(paths[slot.index], {}, large);
+
+            callback(slot.index, contents);
+            available.push_back(index);
+
+            return;
+        }
+
+        start_read(index);
+    };
+
+    // NOTE(garrett): Anything the callback or the ring throws leaves requests
+    // in flight, which have to land before the slots they write into go away,
+    // and descriptors opened for files that were never read
+    auto abandon = [&](const std::uint64_t data, const int result) {
+        if (static_cast<Operation>(data & 0x03u) == Operation::Open && result >= 0) {
+            slots[static_cast<std::size_t>(data >> 2u)].descriptor = result;
+        }
+    };
+
+    auto active = 0uz;
+
+    try {
+        while (next < paths.size() || active) {
+            // NOTE(garrett): The open and size lookup of each file go out together
+            while (next < paths.size() && !available.empty()) {
+                const auto index = available.back();
+                available.pop_back();
+
+                auto& slot = slots[index];
+                slot.index = next;
+                slot.descriptor = -1;
+                slot.pending = 2;
+                slot.reading = false;
+                slot.error.reset();
+
+                const auto* path = paths[next].c_str();
+
+                auto& open = ring.next();
+                open.opcode = IORING_OP_OPENAT;
+                open.fd = AT_FDCWD;
+                open.addr = reinterpret_cast<std::uint64_t>(path);
+                open.open_flags = O_RDONLY | O_CLOEXEC;
+                open.user_data = tag(index, Operation::Open);
+
+                auto& stat = ring.next();
+                stat.opcode = IORING_OP_STATX;
+                stat.fd = AT_FDCWD;
+                stat.addr = reinterpret_cast<std::uint64_t>(path);
+                stat.len = STATX_SIZE;
+                stat.off = reinterpret_cast<std::uint64_t>(&slot.status);
+                stat.user_data = tag(index, Operation::Stat);
+
+                ++next;
+                ++active;
+            }
+
+            ring.submit();
+
+            const auto before = available.size();
+            ring.drain(complete);
+            active -= available.size() - before;
+        }
+    } catch (...) {
+        ring.settle(abandon);
+
+        for (auto& slot : slots) {
+            if (!slot.reading && slot.descriptor >= 0) {
+                ::close(slot.descriptor);
+            }
+        }
+
+        throw;
+    }
+}
+
+Loader::Loader(const std::size_t depth, const std::size_t slot_size, const bool accelerate)
+        : depth_(std::max(depth, 1uz))
+        , slot_size_(slot_size)
+        , buffers_(std::vector<std::byte>(depth_ * slot_size))
+        , ring_(nullptr) {
+    if (!accelerate || depth_ > 0xFFFFu) {
+        return;
+    }
+
+    // NOTE(garrett): Each file has at most two requests outstanding
+    auto parameters = ::io_uring_params{};
+    const auto descriptor = setup(static_cast<unsigned>(std::bit_ceil(depth_ * 2u)), parameters);
+
+    if (descriptor < 0) {
+        return;
+    }
+
+    if (!(parameters.features & IORING_FEAT_SINGLE_MMAP) || !supported(descriptor)) {
+        ::close(descriptor);
+        return;
+    }
+
+    const auto rings_size = std::max(
+        parameters.sq_off.array + parameters.sq_entries * sizeof(std::uint32_t),
+        parameters.cq_off.cqes + parameters.cq_entries * sizeof(::io_uring_cqe)
+    );
+
+    const auto entries_size = parameters.sq_entries * sizeof(::io_uring_sqe);
+    constexpr auto protection = PROT_READ | PROT_WRITE;
+    constexpr auto flags = MAP_SHARED | MAP_POPULATE;
+
+    auto* rings = ::mmap(nullptr, rings_size, protection, flags, descriptor, IORING_OFF_SQ_RING);
+
+    if (rings == MAP_FAILED) {
+        ::close(descriptor);
+        return;
+    }
+
+    auto* entries = ::mmap(nullptr, entries_size, protection, flags, descriptor, IORING_OFF_SQES);
+
+    if (entries == MAP_FAILED) {
+        ::munmap(rings, rings_size);
+        ::close(descriptor);
+        return;
+    }
+
+    ring_ = std::make_unique<Ring>(
+        descriptor,
+        parameters,
+        std::span{static_cast<std::byte*>(rings), rings_size},
+        std::span{static_cast<std::byte*>(entries), entries_size}
+    );
+
+    // NOTE(garrett): Registering can fail against RLIMIT_MEMLOCK on older
+    // kernels, in which case reads just don't use the registered buffers
+    auto vectors = std::vector<::iovec>(depth_);
+
+    for (auto i = 0uz; i < depth_; ++i) {
+        vectors[i] = ::iovec{buffers_.data() + i * slot_size_, slot_size_};
+    }
+
+    ring_->registered = slot_size_ > 0u && register_ring(
+        descriptor,
+        IORING_REGISTER_BUFFERS,
+        vectors.data(),
+        static_cast<unsigned>(vectors.size())
+    ) >= 0;
+}
+
+#else
+
+struct Loader::Ring {};
+
+auto Loader::load_ring(std::span<const std::filesystem::path>, const Callback&) -> void {}
+
+Loader::Loader(const std::size_t depth, const std::size_t slot_size, bool)
+        : depth_(std::max(depth, 1uz))
+        , slot_size_(slot_size)
+        , buffers_(std::vector<std::byte>(slot_size))
+        , ring_(nullptr) {}
+
+#endif
+
+Loader::~Loader() = default;
+
+auto Loader::accelerated() const noexcept -> bool {
+    return ring_ != nullptr;
+}
+
+auto Loader::load_portable(std::span<const std::filesystem::path> paths, const Callback& callback)
+        -> void {
+    auto large = std::vector<std::byte>{};
+
+    for (auto i = 0uz; i < paths.size(); ++i) {
+        callback(i, read_file(paths[i], std::span{buffers_}.first(slot_size_), large));
+    }
+}
+
+auto Loader::load(std::span<const std::filesystem::path> paths, const Callback& callback)
+        -> void {
+    if (ring_) {
+        load_ring(paths, callback);
+    } else {
+        load_portable(paths, callback);
+    }
+}
+
+} // namespace kh::loading
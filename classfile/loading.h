@@ -0,0 +1,76 @@
+#ifndef LOADING_H
+#define LOADING_H
+
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace kh::loading {
+
+enum Error {
+    OpenFailed,
+    ReadFailed,
+    StatFailed
+};
+
+constexpr auto name(const Error error) noexcept -> std::string_view {
+    switch (error) {
+        case Error::OpenFailed:
+            return "File could not be opened";
+        case Error::ReadFailed:
+            return "File could not be read";
+        case Error::StatFailed:
+            return "File size could not be determined";
+    }
+
+    return "Unknown error";
+}
+
+// NOTE(garrett): Called with the index of each file in the list given to
+// `load`. The contents are only valid until it returns.
+using Callback = std::function<void(
+    std::size_t,
+    std::expected<std::span<const std::byte>, Error>)>;
+
+// NOTE(garrett): Reads whole files, many at a time. On Linux the opens, size
+// lookups, reads and closes for up to `depth` files are queued on an io_uring
+// together, so a directory of small files costs a handful of system calls
+// rather than four per file, and files no larger than `slot_size` are read
+// straight into buffers registered with the kernel. Where io_uring isn't
+// available, because of the platform, the kernel or a sandbox, files are read
+// one at a time instead. Files are reported in the order they complete, not
+// the order given.
+class Loader {
+private:
+    struct Ring;
+
+    std::size_t depth_;
+    std::size_t slot_size_;
+    std::vector<std::byte> buffers_;
+    std::unique_ptr<Ring> ring_;
+
+    auto load_portable(std::span<const std::filesystem::path>, const Callback&) -> void;
+    auto load_ring(std::span<const std::filesystem::path>, const Callback&) -> void;
+public:
+    explicit Loader(
+        std::size_t depth = 64u,
+        std::size_t slot_size = 64u * 1024u,
+        bool accelerate = true);
+    Loader(const Loader&) = delete;
+    auto operator=(const Loader&) -> Loader& = delete;
+    ~Loader();
+
+    // NOTE(garrett): Whether files are read through io_uring
+    auto accelerated() const noexcept -> bool;
+
+    auto load(std::span<const std::filesystem::path>, const Callback&) -> void;
+};
+
+} // namespace kh::loading
+
+#endif // LOADING_H
@@ -1,6 +1,7 @@
 #ifndef METHOD_H
 #define METHOD_H
 
+#include <span>
 #include <vector>
 
 #include "attribute.h"
@@ -27,6 +28,10 @@ struct Method {
     std::uint16_t name_index;
     std::uint16_t descriptor_index;
     std::vector<kh::jvm::attribute::Attribute> attributes;
+    // NOTE(garrett): Encoded bytes this was parsed from, empty for members
+    // created from scratch. Serialization copies them through verbatim when
+    // nothing has been changed since.
+    std::span<const std::byte> source{};
 };
 
 } // namespace kh::jvm::method
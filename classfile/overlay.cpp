@@ -0,0 +1,207 @@
+#include <string>
+
+#include "overlay.h"
+
+namespace kh::jvm::overlay {
+
+Overlay::Overlay(std::shared_ptr<const kh::jvm::parsing::LoadedClass> base)
+        : base_(std::move(base))
+        , arena_(kh::arena::Arena{})
+        , entries_(std::vector<kh::jvm::constant_pool::Entry>{})
+        , indices_(std::vector<std::uint16_t>{})
+        , text_entries_(std::unordered_map<std::string_view, std::uint16_t>{})
+        , count_(base_->class_file.constant_pool.count())
+        , access_flags_(base_->class_file.access_flags)
+        , interfaces_(std::vector<std::uint16_t>{})
+        , fields_(std::vector<kh::jvm::field::Field>{})
+        , replaced_methods_(std::map<std::size_t, kh::jvm::method::Method>{})
+        , methods_(std::vector<kh::jvm::method::Method>{})
+        , attributes_(std::vector<kh::jvm::attribute::Attribute>{}) {}
+
+auto Overlay::base() const noexcept -> const kh::jvm::classfile::ClassFile& {
+    return base_->class_file;
+}
+
+auto Overlay::arena() noexcept -> kh::arena::Arena& {
+    return arena_;
+}
+
+auto Overlay::try_add(kh::jvm::constant_pool::Entry entry)
+        -> std::expected<std::uint16_t, Error> {
+    using kh::jvm::constant_pool::UTF8Entry;
+
+    if (const auto index = base().constant_pool.find_entry(entry)) {
+        return static_cast<std::uint16_t>(index.value());
+    }
+
+    if (const auto* text_entry = std::get_if<UTF8Entry>(&entry)) {
+        if (const auto search_result = text_entries_.find(text_entry->text);
+                search_result != text_entries_.end()) {
+            return search_result->second;
+        }
+    } else {
+        for (auto i = 0uz; i < entries_.size(); ++i) {
+            if (entries_[i] == entry) {
+                return indices_[i];
+            }
+        }
+    }
+
+    const auto width = kh::jvm::constant_pool::is_wide(entry) ? 2uz : 1uz;
+
+    if (count_ + width > 0xFFFF) {
+        return std::unexpected(Error::ConstantPoolOverflow);
+    }
+
+    const auto index = static_cast<std::uint16_t>(count_);
+
+    if (const auto* text_entry = std::get_if<UTF8Entry>(&entry)) {
+        entry = UTF8Entry{arena_.store(std::string{text_entry->text})};
+        text_entries_.emplace(std::get<UTF8Entry>(entry).text, index);
+    }
+
+    entries_.push_back(entry);
+    indices_.push_back(index);
+    count_ += width;
+
+    return index;
+}
+
+auto Overlay::try_add_utf8_entry(std::string_view text)
+        -> std::expected<std::uint16_t, Error> {
+    return try_add(kh::jvm::constant_pool::UTF8Entry{text});
+}
+
+auto Overlay::try_add_class_entry(std::string_view name)
+        -> std::expected<std::uint16_t, Error> {
+    const auto name_index = try_add_utf8_entry(name);
+
+    if (!name_index) {
+        return name_index;
+    }
+
+    return try_add(kh::jvm::constant_pool::ClassEntry{name_index.value()});
+}
+
+auto Overlay::try_add_name_and_type(std::string_view name, std::string_view descriptor)
+        -> std::expected<std::uint16_t, Error> {
+    const auto name_index = try_add_utf8_entry(name);
+
+    if (!name_index) {
+        return name_index;
+    }
+
+    const auto descriptor_index = try_add_utf8_entry(descriptor);
+
+    if (!descriptor_index) {
+        return descriptor_index;
+    }
+
+    return try_add(
+        kh::jvm::constant_pool::NameAndTypeEntry{name_index.value(), descriptor_index.value()}
+    );
+}
+
+auto Overlay::try_add_method_reference(
+        std::string_view class_name,
+        std::string_view name,
+        std::string_view descriptor) -> std::expected<std::uint16_t, Error> {
+    const auto class_index = try_add_class_entry(class_name);
+
+    if (!class_index) {
+        return class_index;
+    }
+
+    const auto name_and_type_index = try_add_name_and_type(name, descriptor);
+
+    if (!name_and_type_index) {
+        return name_and_type_index;
+    }
+
+    return try_add(
+        kh::jvm::constant_pool::MethodReferenceEntry{
+            class_index.value(),
+            name_and_type_index.value()
+        }
+    );
+}
+
+auto Overlay::text(const std::uint16_t index) const noexcept
+        -> std::optional<std::string_view> {
+    using kh::jvm::constant_pool::UTF8Entry;
+
+    if (const auto* entry = base().constant_pool.find<UTF8Entry>(index)) {
+        return entry->text;
+    }
+
+    for (auto i = 0uz; i < indices_.size(); ++i) {
+        if (indices_[i] == index) {
+            if (const auto* entry = std::get_if<UTF8Entry>(&entries_[i])) {
+                return entry->text;
+            }
+
+            break;
+        }
+    }
+
+    return std::nullopt;
+}
+
+auto Overlay::access_flags() const noexcept -> std::uint16_t {
+    return access_flags_;
+}
+
+auto Overlay::set_access_flags(const std::uint16_t access_flags) noexcept -> void {
+    access_flags_ = access_flags;
+}
+
+auto Overlay::add_interface(const std::uint16_t class_index) -> void {
+    interfaces_.push_back(class_index);
+}
+
+auto Overlay::add_field(kh::jvm::field::Field field) -> void {
+    fields_.push_back(std::move(field));
+}
+
+auto Overlay::add_method(kh::jvm::method::Method method) -> void {
+    methods_.push_back(std::move(method));
+}
+
+auto Overlay::add_attribute(kh::jvm::attribute::Attribute attribute) -> void {
+    attributes_.push_back(attribute);
+}
+
+auto Overlay::method_count() const noexcept -> std::size_t {
+    return base().methods.size() + methods_.size();
+}
+
+auto Overlay::method(const std::size_t index) const -> const kh::jvm::method::Method& {
+    const auto& base_methods = base().methods;
+
+    if (index >= base_methods.size()) {
+        return methods_.at(index - base_methods.size());
+    }
+
+    const auto replaced = replaced_methods_.find(index);
+
+    return replaced != replaced_methods_.end() ? replaced->second : base_methods[index];
+}
+
+auto Overlay::replace_method(const std::size_t index, kh::jvm::method::Method method)
+        -> std::expected<void, Error> {
+    const auto base_count = base().methods.size();
+
+    if (index >= method_count()) {
+        return std::unexpected(Error::InvalidMethod);
+    }
+
+    if (index >= base_count) {
+        methods_[index - base_count] = std::move(method);
+    } else {
+        replaced_methods_.insert_or_assign(index, std::move(method));
+    }
+
+    return {};
+}
+
+} // namespace kh::jvm::overlay
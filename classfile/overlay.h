@@ -0,0 +1,145 @@
+#ifndef OVERLAY_H
+#define OVERLAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "arena.h"
+#include "classfile.h"
+#include "parsing.h"
+#include "serialization.h"
+#include "sinks.h"
+
+namespace kh::jvm::overlay {
+
+enum Error {
+    ConstantPoolOverflow,
+    InvalidMethod
+};
+
+// NOTE(garrett): Records edits against a shared, immutable parsed class
+// without copying any of it. Several overlays can wrap the same base from
+// different threads, each one only paying for what it adds or replaces.
+// Output is the base class with the patch applied, and everything untouched
+// is copied through from the base's source bytes. Bases should have their
+// text indexed with `ConstantPool::index_text` before being shared, or every
+// text entry added scans the base pool.
+class Overlay {
+private:
+    std::shared_ptr<const kh::jvm::parsing::LoadedClass> base_;
+    kh::arena::Arena arena_;
+    std::vector<kh::jvm::constant_pool::Entry> entries_;
+    std::vector<std::uint16_t> indices_;
+    std::unordered_map<std::string_view, std::uint16_t> text_entries_;
+    std::size_t count_;
+    std::uint16_t access_flags_;
+    std::vector<std::uint16_t> interfaces_;
+    std::vector<kh::jvm::field::Field> fields_;
+    std::map<std::size_t, kh::jvm::method::Method> replaced_methods_;
+    std::vector<kh::jvm::method::Method> methods_;
+    std::vector<kh::jvm::attribute::Attribute> attributes_;
+public:
+    explicit Overlay(std::shared_ptr<const kh::jvm::parsing::LoadedClass>);
+
+    auto base() const noexcept -> const kh::jvm::classfile::ClassFile&;
+
+    // NOTE(garrett): Owns anything generated for this overlay, such as
+    // replacement attribute data.
+    auto arena() noexcept -> kh::arena::Arena&;
+
+    // NOTE(garrett): Entries already present in the base, or previously added
+    // here, are reused. Text is copied into the overlay's arena.
+    auto try_add(kh::jvm::constant_pool::Entry)
+        -> std::expected<std::uint16_t, Error>;
+    auto try_add_utf8_entry(std::string_view) -> std::expected<std::uint16_t, Error>;
+    auto try_add_class_entry(std::string_view) -> std::expected<std::uint16_t, Error>;
+    auto try_add_name_and_type(std::string_view name, std::string_view descriptor)
+        -> std::expected<std::uint16_t, Error>;
+    auto try_add_method_reference(
+        std::string_view class_name,
+        std::string_view name,
+        std::string_view descriptor) -> std::expected<std::uint16_t, Error>;
+
+    // NOTE(garrett): Text of an entry from either the base or the patch
+    auto text(std::uint16_t index) const noexcept -> std::optional<std::string_view>;
+
+    auto access_flags() const noexcept -> std::uint16_t;
+    auto set_access_flags(std::uint16_t) noexcept -> void;
+
+    auto add_interface(std::uint16_t class_index) -> void;
+    auto add_field(kh::jvm::field::Field) -> void;
+    auto add_method(kh::jvm::method::Method) -> void;
+    auto add_attribute(kh::jvm::attribute::Attribute) -> void;
+
+    auto method_count() const noexcept -> std::size_t;
+    auto method(std::size_t index) const -> const kh::jvm::method::Method&;
+    auto replace_method(std::size_t index, kh::jvm::method::Method)
+        -> std::expected<void, Error>;
+
+    auto write(kh::sinks::Sink auto& sink) const -> void {
+        const auto& base = this->base();
+
+        sink.write(static_cast<std::uint32_t>(0xCAFEBABE));
+        sink.write(base.version.minor);
+        sink.write(base.version.major);
+        sink.write(static_cast<std::uint16_t>(count_));
+
+        kh::jvm::serialization::serialize(sink, base.constant_pool);
+
+        for (const auto& entry : entries_) {
+            std::visit([&sink](const auto& e) {
+                kh::jvm::serialization::serialize(sink, e);
+            }, entry);
+        }
+
+        sink.write(access_flags_);
+        sink.write(base.class_index);
+        sink.write(base.superclass_index);
+        sink.write(static_cast<std::uint16_t>(base.interfaces.size() + interfaces_.size()));
+
+        for (const auto interface : base.interfaces) {
+            sink.write(interface);
+        }
+
+        for (const auto interface : interfaces_) {
+            sink.write(interface);
+        }
+
+        sink.write(static_cast<std::uint16_t>(base.fields.size() + fields_.size()));
+
+        for (const auto& field : base.fields) {
+            kh::jvm::serialization::serialize(sink, field);
+        }
+
+        for (const auto& field : fields_) {
+            kh::jvm::serialization::serialize(sink, field);
+        }
+
+        sink.write(static_cast<std::uint16_t>(method_count()));
+
+        for (auto i = 0uz; i < method_count(); ++i) {
+            kh::jvm::serialization::serialize(sink, method(i));
+        }
+
+        sink.write(static_cast<std::uint16_t>(base.attributes.size() + attributes_.size()));
+
+        for (const auto& attribute : base.attributes) {
+            kh::jvm::serialization::serialize(sink, attribute);
+        }
+
+        for (const auto& attribute : attributes_) {
+            kh::jvm::serialization::serialize(sink, attribute);
+        }
+    }
+};
+
+} // namespace kh::jvm::overlay
+
+#endif // OVERLAY_H
@@ -34,7 +34,11 @@ auto load_class_from_file(const std::filesystem::path& path)
         return std::unexpected(class_file.error());
     }
 
-    return LoadedClass{std::move(contents), class_file.value()};
+    return LoadedClass{
+        std::move(contents),
+        class_file.value(),
+        kh::arena::Arena{}
+    };
 }
 
 auto parse_attribute(reader::Reader& reader) noexcept
@@ -62,20 +66,327 @@ auto parse_attribute(reader::Reader& reader) noexcept
     };
 }
 
-auto parse_method(kh::reader::Reader& reader)
-        -> std::expected<method::Method, Error> {
-    const auto method_header = reader.read_bytes(sizeof(std::uint64_t));
+auto parse_code(kh::reader::Reader& reader)
+        -> std::expected<code::Code, Error> {
+    const auto header = reader.read_bytes(
+        2 * sizeof(std::uint16_t) + sizeof(std::uint32_t)
+    );
+
+    if (!header) {
+        return std::unexpected(Error::Truncated);
+    }
+
+    auto header_reader = kh::reader::Reader{header.value()};
+    auto result = code::Code{};
+
+    result.max_stack = header_reader.read_unchecked<std::uint16_t>();
+    result.max_locals = header_reader.read_unchecked<std::uint16_t>();
+
+    const auto bytecode = reader.read_bytes(
+        header_reader.read_unchecked<std::uint32_t>()
+    );
+
+    if (!bytecode) {
+        return std::unexpected(Error::Truncated);
+    }
+
+    result.bytecode = bytecode.value();
+
+    const auto handler_count = reader.read<std::uint16_t>();
+
+    if (!handler_count) {
+        return std::unexpected(Error::Truncated);
+    }
+
+    const auto handlers = reader.read_bytes(
+        handler_count.value() * 4 * sizeof(std::uint16_t)
+    );
+
+    if (!handlers) {
+        return std::unexpected(Error::Truncated);
+    }
+
+    auto handler_reader = kh::reader::Reader{handlers.value()};
+    result.exception_table.reserve(handler_count.value());
+
+    for (auto i = 0u; i < handler_count.value(); ++i) {
+        const auto start_pc = handler_reader.read_unchecked<std::uint16_t>();
+        const auto end_pc = handler_reader.read_unchecked<std::uint16_t>();
+        const auto handler_pc = handler_reader.read_unchecked<std::uint16_t>();
+        const auto catch_type = handler_reader.read_unchecked<std::uint16_t>();
+
+        result.exception_table.push_back(
+            code::ExceptionHandler{start_pc, end_pc, handler_pc, catch_type}
+        );
+    }
+
+    const auto attribute_count = reader.read<std::uint16_t>();
+
+    if (!attribute_count) {
+        return std::unexpected(Error::Truncated);
+    }
+
+    result.attributes.reserve(attribute_count.value());
+
+    for (auto i = 0u; i < attribute_count.value(); ++i) {
+        const auto attribute = parse_attribute(reader);
+
+        if (!attribute) {
+            return std::unexpected(Error::Truncated);
+        }
+
+        result.attributes.push_back(attribute.value());
+    }
+
+    return result;
+}
+
+auto parse_line_number_table(kh::reader::Reader& reader)
+        -> std::expected<std::vector<code::LineNumber>, Error> {
+    const auto count = reader.read<std::uint16_t>();
+
+    if (!count) {
+        return std::unexpected(Error::Truncated);
+    }
+
+    const auto contents = reader.read_bytes(count.value() * 2 * sizeof(std::uint16_t));
+
+    if (!contents) {
+        return std::unexpected(Error::Truncated);
+    }
+
+    auto entry_reader = kh::reader::Reader{contents.value()};
+    auto result = std::vector<code::LineNumber>{};
+    result.reserve(count.value());
+
+    for (auto i = 0u; i < count.value(); ++i) {
+        const auto start_pc = entry_reader.read_unchecked<std::uint16_t>();
+        const auto line_number = entry_reader.read_unchecked<std::uint16_t>();
+
+        result.push_back(code::LineNumber{start_pc, line_number});
+    }
+
+    return result;
+}
+
+auto parse_local_variable_table(kh::reader::Reader& reader)
+        -> std::expected<std::vector<code::LocalVariable>, Error> {
+    const auto count = reader.read<std::uint16_t>();
+
+    if (!count) {
+        return std::unexpected(Error::Truncated);
+    }
+
+    const auto contents = reader.read_bytes(count.value() * 5 * sizeof(std::uint16_t));
+
+    if (!contents) {
+        return std::unexpected(Error::Truncated);
+    }
+
+    auto entry_reader = kh::reader::Reader{contents.value()};
+    auto result = std::vector<code::LocalVariable>{};
+    result.reserve(count.value());
+
+    for (auto i = 0u; i < count.value(); ++i) {
+        const auto start_pc = entry_reader.read_unchecked<std::uint16_t>();
+        const auto length = entry_reader.read_unchecked<std::uint16_t>();
+        const auto name_index = entry_reader.read_unchecked<std::uint16_t>();
+        const auto descriptor_index = entry_reader.read_unchecked<std::uint16_t>();
+        const auto index = entry_reader.read_unchecked<std::uint16_t>();
+
+        result.push_back(
+            code::LocalVariable{start_pc, length, name_index, descriptor_index, index}
+        );
+    }
+
+    return result;
+}
+
+auto parse_verification_type(kh::reader::Reader& reader)
+        -> std::expected<stack_map::VerificationType, Error> {
+    using stack_map::VerificationTag;
+
+    const auto tag = reader.read<std::uint8_t>();
+
+    if (!tag) {
+        return std::unexpected(Error::Truncated);
+    }
+
+    const auto verification_tag = static_cast<VerificationTag>(tag.value());
+
+    if (verification_tag > VerificationTag::Uninitialized) {
+        return std::unexpected(Error::InvalidStackMapFrame);
+    }
+
+    if (verification_tag != VerificationTag::Object
+            && verification_tag != VerificationTag::Uninitialized) {
+        return stack_map::VerificationType{verification_tag, 0u};
+    }
+
+    const auto value = reader.read<std::uint16_t>();
+
+    if (!value) {
+        return std::unexpected(Error::Truncated);
+    }
 
-    if (!method_header) {
+    return stack_map::VerificationType{verification_tag, value.value()};
+}
+
+auto parse_verification_types(kh::reader::Reader& reader, const std::uint16_t count)
+        -> std::expected<std::vector<stack_map::VerificationType>, Error> {
+    auto result = std::vector<stack_map::VerificationType>{};
+    result.reserve(count);
+
+    for (auto i = 0u; i < count; ++i) {
+        const auto type = parse_verification_type(reader);
+
+        if (!type) {
+            return std::unexpected(type.error());
+        }
+
+        result.push_back(type.value());
+    }
+
+    return result;
+}
+
+auto parse_stack_map_table(
+        kh::reader::Reader& reader,
+        const std::vector<stack_map::VerificationType>& initial_locals)
+        -> std::expected<std::vector<stack_map::Frame>, Error> {
+    const auto count = reader.read<std::uint16_t>();
+
+    if (!count) {
         return std::unexpected(Error::Truncated);
     }
 
-    reader::Reader method_reader{method_header.value()};
+    auto frames = std::vector<stack_map::Frame>{};
+    frames.reserve(count.value());
+
+    auto locals = initial_locals;
+    auto offset = -1;
+
+    for (auto i = 0u; i < count.value(); ++i) {
+        const auto frame_type = reader.read<std::uint8_t>();
+
+        if (!frame_type) {
+            return std::unexpected(Error::Truncated);
+        }
+
+        const auto type = frame_type.value();
+        auto stack = std::vector<stack_map::VerificationType>{};
+        auto offset_delta = 0;
+
+        if (type <= 63) {
+            offset_delta = type;
+        } else if (type <= 127) {
+            offset_delta = type - 64;
+
+            const auto item = parse_verification_type(reader);
+
+            if (!item) {
+                return std::unexpected(item.error());
+            }
+
+            stack.push_back(item.value());
+        } else if (type < 247) {
+            return std::unexpected(Error::InvalidStackMapFrame);
+        } else {
+            const auto delta = reader.read<std::uint16_t>();
+
+            if (!delta) {
+                return std::unexpected(Error::Truncated);
+            }
+
+            offset_delta = delta.value();
+
+            if (type == 247) {
+                const auto item = parse_verification_type(reader);
+
+                if (!item) {
+                    return std::unexpected(item.error());
+                }
+
+                stack.push_back(item.value());
+            } else if (type <= 250) {
+                const auto chopped = 251uz - type;
+
+                if (chopped > locals.size()) {
+                    return std::unexpected(Error::InvalidStackMapFrame);
+                }
+
+                locals.resize(locals.size() - chopped);
+            } else if (type <= 254) {
+                const auto appended = parse_verification_types(reader, type - 251);
+
+                if (!appended) {
+                    return std::unexpected(appended.error());
+                }
+
+                locals.append_range(appended.value());
+            } else {
+                const auto local_count = reader.read<std::uint16_t>();
+
+                if (!local_count) {
+                    return std::unexpected(Error::Truncated);
+                }
+
+                auto full_locals = parse_verification_types(reader, local_count.value());
+
+                if (!full_locals) {
+                    return std::unexpected(full_locals.error());
+                }
+
+                const auto stack_count = reader.read<std::uint16_t>();
+
+                if (!stack_count) {
+                    return std::unexpected(Error::Truncated);
+                }
+
+                auto full_stack = parse_verification_types(reader, stack_count.value());
+
+                if (!full_stack) {
+                    return std::unexpected(full_stack.error());
+                }
+
+                locals = std::move(full_locals.value());
+                stack = std::move(full_stack.value());
+            }
+        }
+
+        offset += offset_delta + 1;
+
+        if (offset > 0xFFFF) {
+            return std::unexpected(Error::InvalidStackMapFrame);
+        }
+
+        frames.push_back(
+            stack_map::Frame{
+                static_cast<std::uint16_t>(offset),
+                locals,
+                std::move(stack)
+            }
+        );
+    }
+
+    return frames;
+}
 
-    const auto access_flags = method_reader.read_unchecked<std::uint16_t>();
-    const auto name_index = method_reader.read_unchecked<std::uint16_t>();
-    const auto descriptor_index = method_reader.read_unchecked<std::uint16_t>();
-    const auto attribute_count = method_reader.read_unchecked<std::uint16_t>();
+template <typename T>
+auto parse_member(kh::reader::Reader& reader) -> std::expected<T, Error> {
+    const auto start = reader.remaining();
+    const auto member_header = reader.read_bytes(sizeof(std::uint64_t));
+
+    if (!member_header) {
+        return std::unexpected(Error::Truncated);
+    }
+
+    reader::Reader member_reader{member_header.value()};
+
+    const auto access_flags = member_reader.read_unchecked<std::uint16_t>();
+    const auto name_index = member_reader.read_unchecked<std::uint16_t>();
+    const auto descriptor_index = member_reader.read_unchecked<std::uint16_t>();
+    const auto attribute_count = member_reader.read_unchecked<std::uint16_t>();
 
     std::vector<kh::jvm::attribute::Attribute> attributes{};
     attributes.reserve(attribute_count);
@@ -90,14 +401,25 @@ auto parse_method(kh::reader::Reader& reader)
         attributes.push_back(result.value());
     }
 
-    return kh::jvm::method::Method{
+    return T{
         access_flags,
         name_index,
         descriptor_index,
-        std::move(attributes)
+        std::move(attributes),
+        start.first(start.size() - reader.remaining().size())
     };
 }
 
+auto parse_field(kh::reader::Reader& reader)
+        -> std::expected<field::Field, Error> {
+    return parse_member<field::Field>(reader);
+}
+
+auto parse_method(kh::reader::Reader& reader)
+        -> std::expected<method::Method, Error> {
+    return parse_member<method::Method>(reader);
+}
+
 auto parse_class_info_entry(kh::reader::Reader& reader) noexcept
         -> std::expected<kh::jvm::constant_pool::ClassEntry, Error> {
     const auto index = reader.read<std::uint16_t>();
@@ -109,10 +431,9 @@ auto parse_class_info_entry(kh::reader::Reader& reader) noexcept
     return kh::jvm::constant_pool::ClassEntry{index.value()};
 }
 
-// TODO(garrett): Perhaps collapse these (any maybe others) to a generic
-// x-bytes parse
-auto parse_method_reference_entry(kh::reader::Reader& reader) noexcept
-        -> std::expected<kh::jvm::constant_pool::MethodReferenceEntry, Error> {
+template <typename T>
+auto parse_index_pair_entry(kh::reader::Reader& reader) noexcept
+        -> std::expected<T, Error> {
     const auto entry_contents = reader.read_bytes(sizeof(std::uint32_t));
 
     if (!entry_contents) {
@@ -121,15 +442,29 @@ auto parse_method_reference_entry(kh::reader::Reader& reader) noexcept
 
     kh::reader::Reader entry_reader{entry_contents.value()};
 
-    return kh::jvm::constant_pool::MethodReferenceEntry{
-        entry_reader.read_unchecked<std::uint16_t>(),
-        entry_reader.read_unchecked<std::uint16_t>()
-    };
+    const auto first = entry_reader.read_unchecked<std::uint16_t>();
+    const auto second = entry_reader.read_unchecked<std::uint16_t>();
+
+    return T{first, second};
 }
 
-auto parse_name_and_type_entry(kh::reader::Reader& reader) noexcept
-        -> std::expected<kh::jvm::constant_pool::NameAndTypeEntry, Error> {
-    const auto entry_contents = reader.read_bytes(sizeof(std::uint32_t));
+template <typename T, kh::endian::MultiByteIntegral V>
+auto parse_single_value_entry(kh::reader::Reader& reader) noexcept
+        -> std::expected<T, Error> {
+    const auto value = reader.read<V>();
+
+    if (!value) {
+        return std::unexpected(Error::Truncated);
+    }
+
+    return T{value.value()};
+}
+
+auto parse_method_handle_entry(kh::reader::Reader& reader) noexcept
+        -> std::expected<kh::jvm::constant_pool::MethodHandleEntry, Error> {
+    const auto entry_contents = reader.read_bytes(
+        sizeof(std::uint8_t) + sizeof(std::uint16_t)
+    );
 
     if (!entry_contents) {
         return std::unexpected(Error::Truncated);
@@ -137,9 +472,12 @@ auto parse_name_and_type_entry(kh::reader::Reader& reader) noexcept
 
     kh::reader::Reader entry_reader{entry_contents.value()};
 
-    return kh::jvm::constant_pool::NameAndTypeEntry{
-        entry_reader.read_unchecked<std::uint16_t>(),
-        entry_reader.read_unchecked<std::uint16_t>()
+    const auto reference_kind = entry_reader.read_unchecked<std::uint8_t>();
+    const auto reference_index = entry_reader.read_unchecked<std::uint16_t>();
+
+    return kh::jvm::constant_pool::MethodHandleEntry{
+        reference_kind,
+        reference_index
     };
 }
 
@@ -174,17 +512,58 @@ auto parse_constant_pool_entry(kh::reader::Reader& reader) noexcept
         return std::unexpected(Error::Truncated);
     }
 
-    switch (static_cast<kh::jvm::constant_pool::Tag>(tag.value())) {
-        case kh::jvm::constant_pool::Tag::Class: {
+    using namespace kh::jvm::constant_pool;
+
+    switch (static_cast<Tag>(tag.value())) {
+        case Tag::Class: {
             return parse_class_info_entry(reader);
         }
-        case kh::jvm::constant_pool::Tag::MethodReference: {
-            return parse_method_reference_entry(reader);
+        case Tag::Double: {
+            return parse_single_value_entry<DoubleEntry, std::uint64_t>(reader);
+        }
+        case Tag::Dynamic: {
+            return parse_index_pair_entry<DynamicEntry>(reader);
         }
-        case kh::jvm::constant_pool::Tag::NameAndType: {
-            return parse_name_and_type_entry(reader);
+        case Tag::FieldReference: {
+            return parse_index_pair_entry<FieldReferenceEntry>(reader);
         }
-        case kh::jvm::constant_pool::Tag::UTF8: {
+        case Tag::Float: {
+            return parse_single_value_entry<FloatEntry, std::uint32_t>(reader);
+        }
+        case Tag::Integer: {
+            return parse_single_value_entry<IntegerEntry, std::uint32_t>(reader);
+        }
+        case Tag::InterfaceMethodReference: {
+            return parse_index_pair_entry<InterfaceMethodReferenceEntry>(reader);
+        }
+        case Tag::InvokeDynamic: {
+            return parse_index_pair_entry<InvokeDynamicEntry>(reader);
+        }
+        case Tag::Long: {
+            return parse_single_value_entry<LongEntry, std::uint64_t>(reader);
+        }
+        case Tag::MethodHandle: {
+            return parse_method_handle_entry(reader);
+        }
+        case Tag::MethodReference: {
+            return parse_index_pair_entry<MethodReferenceEntry>(reader);
+        }
+        case Tag::MethodType: {
+            return parse_single_value_entry<MethodTypeEntry, std::uint16_t>(reader);
+        }
+        case Tag::Module: {
+            return parse_single_value_entry<ModuleEntry, std::uint16_t>(reader);
+        }
+        case Tag::NameAndType: {
+            return parse_index_pair_entry<NameAndTypeEntry>(reader);
+        }
+        case Tag::Package: {
+            return parse_single_value_entry<PackageEntry, std::uint16_t>(reader);
+        }
+        case Tag::String: {
+            return parse_single_value_entry<StringEntry, std::uint16_t>(reader);
+        }
+        case Tag::UTF8: {
             return parse_utf8_entry(reader);
         }
         default:
@@ -195,8 +574,11 @@ auto parse_constant_pool_entry(kh::reader::Reader& reader) noexcept
 auto parse_constant_pool(kh::reader::Reader& reader, std::uint16_t count)
         -> std::expected<kh::jvm::constant_pool::ConstantPool, Error> {
     kh::jvm::constant_pool::ConstantPool pool{};
+    const auto start = reader.remaining();
 
-    for (auto i = 0uz; i < count; ++i) {
+    // NOTE(garrett): Count is in terms of slots rather than entries, as wide
+    // entries consume two of them
+    while (pool.count() <= count) {
         const auto entry = parse_constant_pool_entry(reader);
 
         if (!entry) {
@@ -206,6 +588,7 @@ auto parse_constant_pool(kh::reader::Reader& reader, std::uint16_t count)
         pool.add(entry.value());
     }
 
+    pool.set_source(start.first(start.size() - reader.remaining().size()));
     return pool;
 }
 
@@ -253,19 +636,35 @@ auto parse_class_file(kh::reader::Reader& reader)
     result.superclass_index = metadata_reader.read_unchecked<std::uint16_t>();
 
     const auto interface_count = metadata_reader.read_unchecked<std::uint16_t>();
+    const auto interfaces = reader.read_bytes(interface_count * sizeof(std::uint16_t));
 
-    // TODO(garrett): Interface parsing
-    if (interface_count > 0) {
-        return std::unexpected(Error::NotImplemented);
+    if (!interfaces) {
+        return std::unexpected(Error::Truncated);
+    }
+
+    auto interface_reader = kh::reader::Reader{interfaces.value()};
+    result.interfaces.reserve(interface_count);
+
+    for (auto i = 0u; i < interface_count; ++i) {
+        result.interfaces.push_back(interface_reader.read_unchecked<std::uint16_t>());
     }
 
     const auto fields_count = reader.read<std::uint16_t>();
 
-    // TODO(garrett): Field parsing
     if (!fields_count) {
         return std::unexpected(Error::Truncated);
-    } else if (fields_count.value() > 0) {
-        return std::unexpected(Error::NotImplemented);
+    }
+
+    result.fields.reserve(fields_count.value());
+
+    for (auto i = 0u; i < fields_count.value(); ++i) {
+        const auto field = parse_field(reader);
+
+        if (!field) {
+            return std::unexpected(Error::Truncated);
+        }
+
+        result.fields.push_back(field.value());
     }
 
     const auto methods_count = reader.read<std::uint16_t>();
@@ -4,17 +4,22 @@
 #include <expected>
 #include <filesystem>
 
+#include "arena.h"
 #include "attribute.h"
 #include "classfile.h"
+#include "code.h"
 #include "constant_pool.h"
+#include "field.h"
 #include "method.h"
 #include "reader.h"
+#include "stack_map.h"
 
 namespace kh::jvm::parsing {
 
 enum Error {
     InvalidConstantPoolTag,
     InvalidMagic,
+    InvalidStackMapFrame,
     NotImplemented,
     Truncated
 };
@@ -22,6 +27,7 @@ enum Error {
 struct LoadedClass {
     std::vector<std::byte> raw;
     kh::jvm::classfile::ClassFile class_file;
+    kh::arena::Arena arena;
 };
 
 auto load_class_from_file(const std::filesystem::path& path)
@@ -30,6 +36,9 @@ auto load_class_from_file(const std::filesystem::path& path)
 auto parse_attribute(kh::reader::Reader&) noexcept
         -> std::expected<attribute::Attribute, Error>;
 
+auto parse_code(kh::reader::Reader&)
+        -> std::expected<kh::jvm::code::Code, Error>;
+
 auto parse_class_file(kh::reader::Reader&)
         -> std::expected<classfile::ClassFile, Error>;
 
@@ -39,9 +48,23 @@ auto parse_constant_pool(kh::reader::Reader&, uint16_t count)
 auto parse_constant_pool_entry(kh::reader::Reader&) noexcept
         -> std::expected<constant_pool::Entry, Error>;
 
+auto parse_field(kh::reader::Reader&)
+        -> std::expected<kh::jvm::field::Field, Error>;
+
+auto parse_line_number_table(kh::reader::Reader&)
+        -> std::expected<std::vector<kh::jvm::code::LineNumber>, Error>;
+
+auto parse_local_variable_table(kh::reader::Reader&)
+        -> std::expected<std::vector<kh::jvm::code::LocalVariable>, Error>;
+
 auto parse_method(kh::reader::Reader&)
         -> std::expected<kh::jvm::method::Method, Error>;
 
+auto parse_stack_map_table(
+        kh::reader::Reader&,
+        const std::vector<kh::jvm::stack_map::VerificationType>& initial_locals)
+        -> std::expected<std::vector<kh::jvm::stack_map::Frame>, Error>;
+
 } // namespace kh::jvm::parsing
 
 #endif // PARSING_H
@@ -16,4 +16,8 @@ auto Reader::read_bytes(std::uint32_t count)
     return result;
 }
 
+auto Reader::remaining() const noexcept -> std::span<const std::byte> {
+    return remaining_;
+}
+
 } // namespace kh::reader
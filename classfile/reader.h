@@ -21,6 +21,7 @@ public:
 
     auto read_bytes(uint32_t)
         -> std::expected<std::span<const std::byte>, Error>;
+    auto remaining() const noexcept -> std::span<const std::byte>;
 
     template <kh::endian::MultiByteIntegral V>
     auto read_unchecked() -> V {
@@ -0,0 +1,258 @@
+#include <bit>
+#include <memory>
+#include <optional>
+#include <span>
+
+#include "hashing.h"
+#include "parsing.h"
+#include "reader.h"
+#include "registry.h"
+
+namespace kh::jvm::registry {
+
+namespace {
+
+// NOTE(garrett): Buckets are doubled once they average this many entries
+constexpr auto load_factor = 2uz;
+
+constexpr auto reverse(std::uint64_t value) noexcept -> std::uint64_t {
+    value = (value >> 1u & 0x5555555555555555u) | (value & 0x5555555555555555u) << 1u;
+    value = (value >> 2u & 0x3333333333333333u) | (value & 0x3333333333333333u) << 2u;
+    value = (value >> 4u & 0x0F0F0F0F0F0F0F0Fu) | (value & 0x0F0F0F0F0F0F0F0Fu) << 4u;
+
+    return std::byteswap(value);
+}
+
+// NOTE(garrett): Entries get odd keys and bucket markers even ones, so every
+// marker sorts directly ahead of the entries in its bucket
+constexpr auto entry_key(const std::uint64_t hash) noexcept -> std::uint64_t {
+    return reverse(hash | 1ull << 63u);
+}
+
+constexpr auto marker_key(const std::size_t bucket) noexcept -> std::uint64_t {
+    return reverse(bucket);
+}
+
+// NOTE(garrett): A bucket is split off from the one without its highest bit
+constexpr auto parent(const std::size_t bucket) noexcept -> std::size_t {
+    return bucket & ~std::bit_floor(bucket);
+}
+
+constexpr auto segment_start(const std::size_t segment) noexcept -> std::size_t {
+    return segment ? 1uz << (segment - 1u) : 0uz;
+}
+
+constexpr auto segment_size(const std::size_t segment) noexcept -> std::size_t {
+    return segment ? 1uz << (segment - 1u) : 1uz;
+}
+
+auto hash(const LoaderId loader, const std::string_view name) noexcept -> std::uint64_t {
+    return kh::hashing::xxh64(std::as_bytes(std::span{name}), loader);
+}
+
+auto class_name(const kh::jvm::classfile::ClassFile& klass) noexcept
+        -> std::optional<std::string_view> {
+    const auto& pool = klass.constant_pool;
+    const auto* entry = pool.find<constant_pool::ClassEntry>(klass.class_index);
+
+    if (!entry) {
+        return std::nullopt;
+    }
+
+    const auto* text = pool.find<constant_pool::UTF8Entry>(entry->name_index);
+
+    if (!text) {
+        return std::nullopt;
+    }
+
+    return text->text;
+}
+
+} // namespace
+
+struct Registry::Node {
+    std::uint64_t key;
+    std::atomic<Node*> next;
+    // NOTE(garrett): Empty for bucket markers
+    std::optional<Entry> entry;
+};
+
+Registry::Registry()
+        : segments_()
+        , buckets_(1uz)
+        , size_(0uz) {
+    auto* first = new std::atomic<Node*>[1u]{};
+    first->store(new Node{marker_key(0u), nullptr, std::nullopt});
+
+    segments_[0].store(first);
+}
+
+Registry::~Registry() {
+    auto* node = segments_[0].load()->load();
+
+    while (node) {
+        delete std::exchange(node, node->next.load());
+    }
+
+    for (auto& segment : segments_) {
+        delete[] segment.load();
+    }
+}
+
+auto Registry::slot(const std::size_t bucket) const noexcept -> std::atomic<Node*>* {
+    const auto segment = static_cast<std::size_t>(std::bit_width(bucket));
+    auto* slots = segments_[segment].load(std::memory_order_acquire);
+
+    return slots ? &slots[bucket - segment_start(segment)] : nullptr;
+}
+
+auto Registry::bucket(const std::size_t bucket) -> Node* {
+    const auto segment = static_cast<std::size_t>(std::bit_width(bucket));
+
+    if (!segments_[segment].load(std::memory_order_acquire)) {
+        auto* slots = new std::atomic<Node*>[segment_size(segment)]{};
+        auto* expected = static_cast<std::atomic<Node*>*>(nullptr);
+
+        if (!segments_[segment].compare_exchange_strong(
+                expected,
+                slots,
+                std::memory_order_acq_rel)) {
+            delete[] slots;
+        }
+    }
+
+    auto* slot = this->slot(bucket);
+
+    if (auto* marker = slot->load(std::memory_order_acquire)) {
+        return marker;
+    }
+
+    // NOTE(garrett): Racing threads may each link a marker, but only one makes
+    // it into the list and every thread publishes that one
+    auto marker = std::make_unique<Node>(marker_key(bucket), nullptr, std::nullopt);
+    const auto [linked, inserted] = link(this->bucket(parent(bucket)), marker.get());
+
+    if (inserted) {
+        marker.release();
+    }
+
+    slot->store(linked, std::memory_order_release);
+    return linked;
+}
+
+auto Registry::start(std::size_t bucket) const noexcept -> const Node* {
+    // NOTE(garrett): Readers never add markers, but start from the nearest
+    // ancestor bucket that has one, whose entries are a superset
+    while (true) {
+        if (const auto* slot = this->slot(bucket)) {
+            if (const auto* marker = slot->load(std::memory_order_acquire)) {
+                return marker;
+            }
+        }
+
+        bucket = parent(bucket);
+    }
+}
+
+auto Registry::link(Node* start, Node* node) -> std::pair<Node*, bool> {
+    auto same = [node](const Node& other) {
+        return !node->entry
+            || (other.entry
+                && other.entry->loader == node->entry->loader
+                && other.entry->name == node->entry->name);
+    };
+
+    auto* previous = start;
+    auto* current = previous->next.load(std::memory_order_acquire);
+
+    // NOTE(garrett): Nodes are never unlinked, so a failed swap only means a
+    // node was added after `previous`, and the search resumes from there
+    while (true) {
+        while (current
+                && (current->key < node->key || (current->key == node->key && !same(*current)))) {
+            previous = current;
+            current = current->next.load(std::memory_order_acquire);
+        }
+
+        if (current && current->key == node->key) {
+            return {current, false};
+        }
+
+        node->next.store(current, std::memory_order_relaxed);
+
+        if (previous->next.compare_exchange_weak(
+                current,
+                node,
+                std::memory_order_release,
+                std::memory_order_acquire)) {
+            return {node, true};
+        }
+    }
+}
+
+auto Registry::insert(const LoaderId loader, std::vector<std::byte>&& raw)
+        -> std::expected<std::pair<const Entry*, bool>, Error> {
+    auto reader = kh::reader::Reader{raw};
+    auto parsed = kh::jvm::parsing::parse_class_file(reader);
+
+    if (!parsed) {
+        return std::unexpected(Error::ParseFailed);
+    }
+
+    const auto name = class_name(parsed.value());
+
+    if (!name) {
+        return std::unexpected(Error::ParseFailed);
+    }
+
+    // NOTE(garrett): Parsed ahead of touching the list, so the only work left
+    // that races other threads is the swap itself. Moving the bytes keeps
+    // their address, and with it the parsed class' views into them.
+    const auto hashed = hash(loader, name.value());
+
+    auto node = std::make_unique<Node>(
+        entry_key(hashed),
+        nullptr,
+        Entry{loader, std::move(raw), std::move(parsed.value()), name.value()}
+    );
+
+    auto buckets = buckets_.load(std::memory_order_acquire);
+    const auto [linked, inserted] = link(bucket(hashed & (buckets - 1u)), node.get());
+
+    if (!inserted) {
+        return std::pair{&linked->entry.value(), false};
+    }
+
+    node.release();
+
+    const auto size = size_.fetch_add(1u, std::memory_order_relaxed) + 1u;
+
+    if (size > buckets * load_factor && buckets < segment_start(max_segments - 1u)) {
+        buckets_.compare_exchange_strong(buckets, buckets * 2u, std::memory_order_release);
+    }
+
+    return std::pair{&linked->entry.value(), true};
+}
+
+auto Registry::find(const LoaderId loader, const std::string_view name) const noexcept
+        -> const Entry* {
+    const auto hashed = hash(loader, name);
+    const auto key = entry_key(hashed);
+    const auto buckets = buckets_.load(std::memory_order_acquire);
+
+    for (auto* node = start(hashed & (buckets - 1u));
+            node && node->key <= key;
+            node = node->next.load(std::memory_order_acquire)) {
+        if (node->key == key && node->entry->loader == loader && node->entry->name == name) {
+            return &node->entry.value();
+        }
+    }
+
+    return nullptr;
+}
+
+auto Registry::size() const noexcept -> std::size_t {
+    return size_.load(std::memory_order_relaxed);
+}
+
+} // namespace kh::jvm::registry
@@ -0,0 +1,89 @@
+#ifndef REGISTRY_H
+#define REGISTRY_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "classfile.h"
+
+namespace kh::jvm::registry {
+
+enum Error {
+    ParseFailed
+};
+
+constexpr auto name(const Error error) noexcept -> std::string_view {
+    switch (error) {
+        case Error::ParseFailed:
+            return "Class file could not be parsed";
+    }
+
+    return "Unknown error";
+}
+
+// NOTE(garrett): Identifies the class loader that defined a class, such as the
+// tag or address of its loader object. The same name can be registered once
+// per loader.
+using LoaderId = std::uint64_t;
+
+struct Entry {
+    LoaderId loader;
+    std::vector<std::byte> raw;
+    kh::jvm::classfile::ClassFile class_file;
+    // NOTE(garrett): A view into `raw`
+    std::string_view name;
+};
+
+// NOTE(garrett): Holds classes as they're loaded, for class load hooks that
+// run on whichever application thread triggered the load. Lookups never take a
+// lock, write or retry, and inserts only ever retry a compare and swap, so no
+// loading thread waits on another. Entries are never removed or moved until the
+// registry is destroyed, so their addresses can be handed out freely.
+//
+// This is a split-ordered list: every entry sits in a single linked list sorted
+// by its bit-reversed hash, and each bucket is a marker node somewhere along
+// it. Doubling the buckets only adds markers, so existing nodes never move and
+// no resize has to stop the world.
+class Registry {
+private:
+    struct Node;
+
+    // NOTE(garrett): Segment `s` holds buckets [2^(s-1), 2^s), except the
+    // first, which holds bucket 0 alone, so the bucket array grows without
+    // being copied
+    static constexpr auto max_segments = 33uz;
+
+    std::array<std::atomic<std::atomic<Node*>*>, max_segments> segments_;
+    std::atomic<std::size_t> buckets_;
+    std::atomic<std::size_t> size_;
+
+    auto slot(std::size_t bucket) const noexcept -> std::atomic<Node*>*;
+    auto bucket(std::size_t bucket) -> Node*;
+    auto start(std::size_t bucket) const noexcept -> const Node*;
+    auto link(Node* start, Node* node) -> std::pair<Node*, bool>;
+public:
+    Registry();
+    Registry(const Registry&) = delete;
+    auto operator=(const Registry&) -> Registry& = delete;
+    ~Registry();
+
+    // NOTE(garrett): Parses and registers a class unless its loader already
+    // registered one by that name. Either way the registered entry is returned,
+    // along with whether it was this call that registered it, so of any number
+    // of threads racing to register the same class exactly one wins.
+    auto insert(LoaderId, std::vector<std::byte>&& raw)
+        -> std::expected<std::pair<const Entry*, bool>, Error>;
+
+    auto find(LoaderId, std::string_view name) const noexcept -> const Entry*;
+    auto size() const noexcept -> std::size_t;
+};
+
+} // namespace kh::jvm::registry
+
+#endif // REGISTRY_H
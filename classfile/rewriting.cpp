@@ -0,0 +1,744 @@
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+#include "descriptor.h"
+#include "parsing.h"
+#include "rewriting.h"
+#include "serialization.h"
+
+namespace kh::jvm::rewriting {
+
+namespace {
+
+using kh::jvm::bytecode::Opcode;
+using kh::jvm::stack_map::VerificationTag;
+using kh::jvm::stack_map::VerificationType;
+
+constexpr auto unmapped = std::numeric_limits<std::uint32_t>::max();
+
+auto read_u16(std::span<const std::byte> code, const std::uint32_t offset)
+        -> std::uint16_t {
+    auto reader = kh::reader::Reader{code.subspan(offset, sizeof(std::uint16_t))};
+    return reader.read_unchecked<std::uint16_t>();
+}
+
+auto read_u32(std::span<const std::byte> code, const std::uint32_t offset)
+        -> std::uint32_t {
+    auto reader = kh::reader::Reader{code.subspan(offset, sizeof(std::uint32_t))};
+    return reader.read_unchecked<std::uint32_t>();
+}
+
+auto write_u16(std::vector<std::byte>& out, const std::uint16_t value) -> void {
+    out.push_back(static_cast<std::byte>(value >> 8));
+    out.push_back(static_cast<std::byte>(value & 0xFF));
+}
+
+auto write_u32(std::vector<std::byte>& out, const std::uint32_t value) -> void {
+    write_u16(out, static_cast<std::uint16_t>(value >> 16));
+    write_u16(out, static_cast<std::uint16_t>(value & 0xFFFF));
+}
+
+auto name_of(
+        const kh::jvm::constant_pool::ConstantPool& pool,
+        const kh::jvm::attribute::Attribute& attribute) -> std::string_view {
+    return pool.resolve<kh::jvm::constant_pool::UTF8Entry>(
+        attribute.name_index
+    ).text;
+}
+
+auto verification_type(
+        kh::jvm::constant_pool::ConstantPool& pool,
+        std::string_view field_type) -> VerificationType {
+    switch (field_type.front()) {
+        case 'B':
+        case 'C':
+        case 'I':
+        case 'S':
+        case 'Z':
+            return VerificationType{VerificationTag::Integer, 0u};
+        case 'F':
+            return VerificationType{VerificationTag::Float, 0u};
+        case 'J':
+            return VerificationType{VerificationTag::Long, 0u};
+        case 'D':
+            return VerificationType{VerificationTag::Double, 0u};
+        case 'L': {
+            const auto name = field_type.substr(1, field_type.size() - 2);
+            const auto index = pool.try_add_class_entry(name);
+
+            return VerificationType{
+                VerificationTag::Object,
+                static_cast<std::uint16_t>(index)
+            };
+        }
+        default: {
+            const auto index = pool.try_add_class_entry(field_type);
+
+            return VerificationType{
+                VerificationTag::Object,
+                static_cast<std::uint16_t>(index)
+            };
+        }
+    }
+}
+
+auto store(kh::arena::Arena& arena, kh::sinks::VectorSink& sink)
+        -> std::span<const std::byte> {
+    return arena.store(sink.take());
+}
+
+} // namespace
+
+auto method_entry_locals(
+        kh::jvm::classfile::ClassFile& klass,
+        const kh::jvm::method::Method& method)
+        -> std::expected<std::vector<VerificationType>, Error> {
+    auto& pool = klass.constant_pool;
+    auto locals = std::vector<VerificationType>{};
+
+    const auto name = pool.resolve<kh::jvm::constant_pool::UTF8Entry>(
+        method.name_index
+    ).text;
+
+    const auto descriptor = kh::jvm::descriptor::parse_method_descriptor(
+        pool.resolve<kh::jvm::constant_pool::UTF8Entry>(
+            method.descriptor_index
+        ).text
+    );
+
+    if (!descriptor) {
+        return std::unexpected(Error::InvalidDescriptor);
+    }
+
+    const auto is_static = method.access_flags
+        & static_cast<std::uint16_t>(kh::jvm::method::AccessFlags::ACC_STATIC);
+
+    if (!is_static) {
+        const auto& class_entry = pool.resolve<kh::jvm::constant_pool::ClassEntry>(
+            klass.class_index
+        );
+
+        const auto class_name = pool.resolve<kh::jvm::constant_pool::UTF8Entry>(
+            class_entry.name_index
+        ).text;
+
+        if (name == "<init>" && class_name != "java/lang/Object") {
+            locals.push_back(VerificationType{VerificationTag::UninitializedThis, 0u});
+        } else {
+            locals.push_back(VerificationType{VerificationTag::Object, klass.class_index});
+        }
+    }
+
+    for (const auto parameter : descriptor.value().parameters) {
+        locals.push_back(verification_type(pool, parameter));
+    }
+
+    return locals;
+}
+
+CodeEditor::CodeEditor(
+        kh::jvm::classfile::ClassFile& klass,
+        kh::arena::Arena& arena,
+        std::size_t method_index,
+        std::size_t attribute_index,
+        kh::jvm::code::Code&& code,
+        std::vector<kh::jvm::bytecode::Instruction>&& instructions)
+    : klass_(klass)
+    , arena_(arena)
+    , method_index_(method_index)
+    , attribute_index_(attribute_index)
+    , code_(std::move(code))
+    , instructions_(std::move(instructions))
+    , frames_(std::nullopt)
+    , entry_locals_(std::vector<VerificationType>{})
+    , added_locals_(std::vector<VerificationType>{})
+    , prologue_(std::vector<std::byte>{})
+    , guarded_from_(std::nullopt)
+    , before_(std::map<std::uint32_t, std::vector<std::byte>>{})
+    , after_(std::map<std::uint32_t, std::vector<std::byte>>{})
+    , handlers_(std::vector<Handler>{})
+    , extra_stack_(0u) {}
+
+auto CodeEditor::open(
+        kh::jvm::classfile::ClassFile& klass,
+        kh::arena::Arena& arena,
+        std::size_t method_index) -> std::expected<CodeEditor, Error> {
+    const auto& method = klass.methods[method_index];
+    auto attribute_index = std::optional<std::size_t>{};
+
+    for (auto i = 0uz; i < method.attributes.size(); ++i) {
+        if (name_of(klass.constant_pool, method.attributes[i]) == "Code") {
+            attribute_index = i;
+            break;
+        }
+    }
+
+    if (!attribute_index) {
+        return std::unexpected(Error::MissingCode);
+    }
+
+    auto reader = kh::reader::Reader{method.attributes[attribute_index.value()].data};
+    auto code = kh::jvm::parsing::parse_code(reader);
+
+    if (!code) {
+        return std::unexpected(Error::Truncated);
+    }
+
+    auto instructions = kh::jvm::bytecode::decode(code.value().bytecode);
+
+    if (!instructions) {
+        return std::unexpected(Error::InvalidBytecode);
+    }
+
+    auto editor = CodeEditor{
+        klass,
+        arena,
+        method_index,
+        attribute_index.value(),
+        std::move(code.value()),
+        std::move(instructions.value())
+    };
+
+    for (const auto& attribute : editor.code_.attributes) {
+        if (name_of(klass.constant_pool, attribute) != "StackMapTable") {
+            continue;
+        }
+
+        auto entry_locals = method_entry_locals(klass, method);
+
+        if (!entry_locals) {
+            return std::unexpected(entry_locals.error());
+        }
+
+        auto table_reader = kh::reader::Reader{attribute.data};
+        auto frames = kh::jvm::parsing::parse_stack_map_table(
+            table_reader,
+            entry_locals.value()
+        );
+
+        if (!frames) {
+            return std::unexpected(Error::InvalidStackMapFrame);
+        }
+
+        editor.entry_locals_ = std::move(entry_locals.value());
+        editor.frames_ = std::move(frames.value());
+    }
+
+    return editor;
+}
+
+auto CodeEditor::code() const noexcept -> const kh::jvm::code::Code& {
+    return code_;
+}
+
+auto CodeEditor::instructions() const noexcept
+        -> std::span<const kh::jvm::bytecode::Instruction> {
+    return instructions_;
+}
+
+auto CodeEditor::needs_frames() const noexcept -> bool {
+    return klass_.version.major >= 50 && (frames_.has_value() || !handlers_.empty());
+}
+
+auto CodeEditor::add_local(const VerificationType type) -> std::uint16_t {
+    const auto index = code_.max_locals + kh::jvm::stack_map::slot_count(added_locals_);
+    added_locals_.push_back(type);
+
+    return static_cast<std::uint16_t>(index);
+}
+
+auto CodeEditor::reserve_stack(const std::uint16_t slots) -> void {
+    extra_stack_ = std::max(extra_stack_, slots);
+}
+
+auto CodeEditor::prologue(std::span<const std::byte> code) -> void {
+    prologue_.append_range(code);
+}
+
+auto CodeEditor::guard_prologue() -> void {
+    guarded_from_ = static_cast<std::uint32_t>(prologue_.size());
+}
+
+auto CodeEditor::insert_before(const std::uint32_t offset, std::span<const std::byte> code)
+        -> void {
+    before_[offset].append_range(code);
+}
+
+auto CodeEditor::insert_after(const std::uint32_t offset, std::span<const std::byte> code)
+        -> void {
+    after_[offset].append_range(code);
+}
+
+auto CodeEditor::append_handler(
+        std::span<const std::byte> code,
+        const std::uint32_t start,
+        const std::uint32_t end,
+        const std::uint16_t catch_type,
+        std::vector<VerificationType> stack,
+        std::vector<std::uint32_t> gaps) -> void {
+    std::ranges::sort(gaps);
+
+    handlers_.push_back(
+        Handler{
+            std::vector<std::byte>{code.begin(), code.end()},
+            start,
+            end,
+            catch_type,
+            std::move(stack),
+            std::move(gaps)
+        }
+    );
+}
+
+auto CodeEditor::commit() -> std::expected<void, Error> {
+    const auto original = code_.bytecode;
+    auto& pool = klass_.constant_pool;
+
+    auto group_of = std::vector<std::uint32_t>(original.size() + 1, unmapped);
+    auto range_start_of = std::vector<std::uint32_t>(original.size() + 1, unmapped);
+    auto instruction_at = std::vector<std::uint32_t>(original.size(), unmapped);
+    auto new_offsets = std::vector<std::uint32_t>(instructions_.size());
+    auto position = static_cast<std::uint32_t>(prologue_.size());
+    auto trailing = unmapped;
+
+    for (auto i = 0uz; i < instructions_.size(); ++i) {
+        const auto& instruction = instructions_[i];
+        const auto offset = instruction.offset;
+
+        group_of[offset] = position;
+        range_start_of[offset] = trailing != unmapped ? trailing : position;
+
+        if (const auto before = before_.find(offset); before != before_.end()) {
+            position += before->second.size();
+        }
+
+        new_offsets[i] = position;
+        instruction_at[offset] = position;
+
+        auto length = instruction.length;
+
+        if (kh::jvm::bytecode::is_switch(instruction.opcode)) {
+            length = length
+                - kh::jvm::bytecode::switch_padding(offset)
+                + kh::jvm::bytecode::switch_padding(position);
+        }
+
+        position += length;
+        trailing = unmapped;
+
+        if (const auto after = after_.find(offset); after != after_.end()) {
+            trailing = position;
+            position += after->second.size();
+        }
+    }
+
+    group_of[original.size()] = position;
+    range_start_of[original.size()] = position;
+
+    auto handler_offsets = std::vector<std::uint32_t>{};
+
+    for (const auto& handler : handlers_) {
+        handler_offsets.push_back(position);
+        position += handler.code.size();
+    }
+
+    if (position > std::numeric_limits<std::uint16_t>::max()) {
+        return std::unexpected(Error::CodeTooLarge);
+    }
+
+    const auto max_stack = code_.max_stack + extra_stack_;
+    const auto max_locals = code_.max_locals + kh::jvm::stack_map::slot_count(added_locals_);
+
+    if (max_stack > std::numeric_limits<std::uint16_t>::max()
+            || max_locals > std::numeric_limits<std::uint16_t>::max()) {
+        return std::unexpected(Error::FrameTooLarge);
+    }
+
+    const auto target_of = [&group_of, &original](const std::int64_t target)
+            -> std::expected<std::uint32_t, Error> {
+        if (target < 0
+                || target >= static_cast<std::int64_t>(original.size())
+                || group_of[target] == unmapped) {
+            return std::unexpected(Error::InvalidBytecode);
+        }
+
+        return group_of[target];
+    };
+
+    auto out = std::vector<std::byte>{};
+    out.reserve(position);
+    out.append_range(prologue_);
+
+    for (auto i = 0uz; i < instructions_.size(); ++i) {
+        const auto& instruction = instructions_[i];
+        const auto offset = instruction.offset;
+        const auto new_offset = static_cast<std::int64_t>(new_offsets[i]);
+        const auto bytes = original.subspan(offset, instruction.length);
+
+        if (const auto before = before_.find(offset); before != before_.end()) {
+            out.append_range(before->second);
+        }
+
+        if (instruction.opcode == Opcode::GOTO_W || instruction.opcode == Opcode::JSR_W) {
+            const auto relative = static_cast<std::int32_t>(read_u32(original, offset + 1));
+            const auto target = target_of(offset + static_cast<std::int64_t>(relative));
+
+            if (!target) {
+                return std::unexpected(target.error());
+            }
+
+            out.push_back(bytes.front());
+            write_u32(out, static_cast<std::uint32_t>(target.value() - new_offset));
+        } else if (kh::jvm::bytecode::is_branch(instruction.opcode)) {
+            const auto relative = static_cast<std::int16_t>(read_u16(original, offset + 1));
+            const auto target = target_of(offset + static_cast<std::int64_t>(relative));
+
+            if (!target) {
+                return std::unexpected(target.error());
+            }
+
+            const auto updated = static_cast<std::int64_t>(target.value()) - new_offset;
+
+            if (updated < std::numeric_limits<std::int16_t>::min()
+                    || updated > std::numeric_limits<std::int16_t>::max()) {
+                return std::unexpected(Error::BranchOutOfRange);
+            }
+
+            out.push_back(bytes.front());
+            write_u16(out, std::bit_cast<std::uint16_t>(static_cast<std::int16_t>(updated)));
+        } else if (kh::jvm::bytecode::is_switch(instruction.opcode)) {
+            auto operand = offset + 1 + kh::jvm::bytecode::switch_padding(offset);
+
+            out.push_back(bytes.front());
+
+            for (auto p = 0u; p < kh::jvm::bytecode::switch_padding(new_offset); ++p) {
+                out.push_back(std::byte{0x00});
+            }
+
+            const auto remap = [&](const std::uint32_t at) -> std::expected<void, Error> {
+                const auto relative = static_cast<std::int32_t>(read_u32(original, at));
+                const auto target = target_of(offset + static_cast<std::int64_t>(relative));
+
+                if (!target) {
+                    return std::unexpected(target.error());
+                }
+
+                write_u32(out, static_cast<std::uint32_t>(target.value() - new_offset));
+                return {};
+            };
+
+            if (const auto result = remap(operand); !result) {
+                return result;
+            }
+
+            operand += sizeof(std::uint32_t);
+
+            if (instruction.opcode == Opcode::TABLESWITCH) {
+                const auto low = static_cast<std::int32_t>(read_u32(original, operand));
+                const auto high = static_cast<std::int32_t>(read_u32(original, operand + 4));
+
+                write_u32(out, static_cast<std::uint32_t>(low));
+                write_u32(out, static_cast<std::uint32_t>(high));
+                operand += 2 * sizeof(std::uint32_t);
+
+                for (auto k = static_cast<std::int64_t>(low); k <= high; ++k) {
+                    if (const auto result = remap(operand); !result) {
+                        return result;
+                    }
+
+                    operand += sizeof(std::uint32_t);
+                }
+            } else {
+                const auto pairs = read_u32(original, operand);
+                write_u32(out, pairs);
+                operand += sizeof(std::uint32_t);
+
+                for (auto k = 0u; k < pairs; ++k) {
+                    write_u32(out, read_u32(original, operand));
+
+                    if (const auto result = remap(operand + 4); !result) {
+                        return result;
+                    }
+
+                    operand += 2 * sizeof(std::uint32_t);
+                }
+            }
+        } else {
+            out.append_range(bytes);
+        }
+
+        if (const auto after = after_.find(offset); after != after_.end()) {
+            out.append_range(after->second);
+        }
+    }
+
+    for (const auto& handler : handlers_) {
+        out.append_range(handler.code);
+    }
+
+    const auto boundary_of = [&group_of](const std::uint32_t offset)
+            -> std::expected<std::uint16_t, Error> {
+        if (offset >= group_of.size() || group_of[offset] == unmapped) {
+            return std::unexpected(Error::InvalidBytecode);
+        }
+
+        return static_cast<std::uint16_t>(group_of[offset]);
+    };
+
+    const auto range_start = [&range_start_of](const std::uint32_t offset)
+            -> std::expected<std::uint16_t, Error> {
+        if (offset >= range_start_of.size() || range_start_of[offset] == unmapped) {
+            return std::unexpected(Error::InvalidBytecode);
+        }
+
+        return static_cast<std::uint16_t>(range_start_of[offset]);
+    };
+
+    auto updated = kh::jvm::code::Code{
+        static_cast<std::uint16_t>(max_stack),
+        static_cast<std::uint16_t>(max_locals),
+        out,
+        std::vector<kh::jvm::code::ExceptionHandler>{},
+        std::vector<kh::jvm::attribute::Attribute>{}
+    };
+
+    for (const auto& handler : code_.exception_table) {
+        const auto start = range_start(handler.start_pc);
+        const auto end = boundary_of(handler.end_pc);
+        const auto target = boundary_of(handler.handler_pc);
+
+        if (!start || !end || !target) {
+            return std::unexpected(Error::InvalidBytecode);
+        }
+
+        updated.exception_table.push_back(
+            kh::jvm::code::ExceptionHandler{
+                start.value(),
+                end.value(),
+                target.value(),
+                handler.catch_type
+            }
+        );
+    }
+
+    for (auto i = 0uz; i < handlers_.size(); ++i) {
+        const auto& handler = handlers_[i];
+
+        const auto cover = [&](const std::uint32_t from, const std::uint32_t to)
+                -> std::expected<void, Error> {
+            const auto start = !from && guarded_from_
+                ? std::expected<std::uint16_t, Error>{
+                    static_cast<std::uint16_t>(guarded_from_.value())
+                }
+                : range_start(from);
+            const auto end = boundary_of(to);
+
+            if (!start || !end) {
+                return std::unexpected(Error::InvalidBytecode);
+            }
+
+            if (start.value() < end.value()) {
+                updated.exception_table.push_back(
+                    kh::jvm::code::ExceptionHandler{
+                        start.value(),
+                        end.value(),
+                        static_cast<std::uint16_t>(handler_offsets[i]),
+                        handler.catch_type
+                    }
+                );
+            }
+
+            return {};
+        };
+
+        // NOTE(garrett): Every gap splits the range in two, so the handler
+        // ends up with one entry per covered stretch
+        auto from = handler.start;
+
+        for (const auto gap : handler.gaps) {
+            if (gap < from || gap >= handler.end) {
+                continue;
+            }
+
+            const auto instruction = std::ranges::lower_bound(
+                instructions_,
+                gap,
+                {},
+                &kh::jvm::bytecode::Instruction::offset
+            );
+
+            if (instruction == instructions_.end() || instruction->offset != gap) {
+                return std::unexpected(Error::InvalidBytecode);
+            }
+
+            if (const auto covered = cover(from, gap); !covered) {
+                return covered;
+            }
+
+            from = gap + instruction->length;
+        }
+
+        if (const auto covered = cover(from, handler.end); !covered) {
+            return covered;
+        }
+    }
+
+    for (const auto& attribute : code_.attributes) {
+        const auto name = name_of(pool, attribute);
+
+        if (name == "StackMapTable"
+                || name == "RuntimeVisibleTypeAnnotations"
+                || name == "RuntimeInvisibleTypeAnnotations") {
+            // NOTE(garrett): Type annotations can target code offsets, and
+            // are dropped rather than relocated as nothing requires them.
+            continue;
+        }
+
+        auto reader = kh::reader::Reader{attribute.data};
+        auto sink = kh::sinks::VectorSink{};
+
+        if (name == "LineNumberTable") {
+            auto table = kh::jvm::parsing::parse_line_number_table(reader);
+
+            if (!table) {
+                return std::unexpected(Error::Truncated);
+            }
+
+            for (auto& entry : table.value()) {
+                const auto start = boundary_of(entry.start_pc);
+
+                if (!start) {
+                    return std::unexpected(start.error());
+                }
+
+                entry.start_pc = start.value();
+            }
+
+            kh::jvm::serialization::serialize(sink, table.value());
+        } else if (name == "LocalVariableTable" || name == "LocalVariableTypeTable") {
+            auto table = kh::jvm::parsing::parse_local_variable_table(reader);
+
+            if (!table) {
+                return std::unexpected(Error::Truncated);
+            }
+
+            for (auto& entry : table.value()) {
+                const auto start = boundary_of(entry.start_pc);
+                const auto end = boundary_of(entry.start_pc + entry.length);
+
+                if (!start || !end) {
+                    return std::unexpected(Error::InvalidBytecode);
+                }
+
+                entry.start_pc = start.value();
+                entry.length = end.value() - start.value();
+            }
+
+            kh::jvm::serialization::serialize(sink, table.value());
+        } else {
+            updated.attributes.push_back(attribute);
+            continue;
+        }
+
+        updated.attributes.push_back(
+            kh::jvm::attribute::Attribute{attribute.name_index, store(arena_, sink)}
+        );
+    }
+
+    if (needs_frames()) {
+        if (!frames_) {
+            auto entry_locals = method_entry_locals(klass_, klass_.methods[method_index_]);
+
+            if (!entry_locals) {
+                return std::unexpected(entry_locals.error());
+            }
+
+            entry_locals_ = std::move(entry_locals.value());
+        }
+
+        const auto relocate = [&instruction_at](VerificationType& type)
+                -> std::expected<void, Error> {
+            if (type.tag != VerificationTag::Uninitialized) {
+                return {};
+            }
+
+            if (type.value >= instruction_at.size()
+                    || instruction_at[type.value] == unmapped) {
+                return std::unexpected(Error::InvalidStackMapFrame);
+            }
+
+            type.value = static_cast<std::uint16_t>(instruction_at[type.value]);
+            return {};
+        };
+
+        auto frames = frames_.value_or(std::vector<kh::jvm::stack_map::Frame>{});
+
+        for (auto& frame : frames) {
+            const auto offset = boundary_of(frame.offset);
+
+            if (!offset) {
+                return std::unexpected(Error::InvalidStackMapFrame);
+            }
+
+            frame.offset = offset.value();
+
+            for (auto& type : frame.locals) {
+                if (const auto result = relocate(type); !result) {
+                    return result;
+                }
+            }
+
+            for (auto& type : frame.stack) {
+                if (const auto result = relocate(type); !result) {
+                    return result;
+                }
+            }
+
+            if (!added_locals_.empty()) {
+                for (auto slots = kh::jvm::stack_map::slot_count(frame.locals);
+                        slots < code_.max_locals;
+                        ++slots) {
+                    frame.locals.push_back(VerificationType{VerificationTag::Top, 0u});
+                }
+
+                frame.locals.append_range(added_locals_);
+            }
+        }
+
+        for (auto i = 0uz; i < handlers_.size(); ++i) {
+            auto locals = std::vector<VerificationType>(
+                code_.max_locals,
+                VerificationType{VerificationTag::Top, 0u}
+            );
+
+            locals.append_range(added_locals_);
+
+            frames.push_back(
+                kh::jvm::stack_map::Frame{
+                    static_cast<std::uint16_t>(handler_offsets[i]),
+                    std::move(locals),
+                    handlers_[i].stack
+                }
+            );
+        }
+
+        auto sink = kh::sinks::VectorSink{};
+        kh::jvm::serialization::serialize(sink, frames, entry_locals_);
+
+        updated.attributes.push_back(
+            kh::jvm::attribute::Attribute{
+                static_cast<std::uint16_t>(pool.try_add_utf8_entry("StackMapTable")),
+                store(arena_, sink)
+            }
+        );
+    }
+
+    auto sink = kh::sinks::VectorSink{};
+    kh::jvm::serialization::serialize(sink, updated);
+
+    klass_.methods[method_index_].attributes[attribute_index_].data = store(arena_, sink);
+    return {};
+}
+
+} // namespace kh::jvm::rewriting
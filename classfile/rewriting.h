@@ -0,0 +1,118 @@
+#ifndef REWRITING_H
+#define REWRITING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <map>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "arena.h"
+#include "bytecode.h"
+#include "classfile.h"
+#include "code.h"
+#include "stack_map.h"
+
+namespace kh::jvm::rewriting {
+
+enum Error {
+    BranchOutOfRange,
+    CodeTooLarge,
+    FrameTooLarge,
+    InvalidBytecode,
+    InvalidDescriptor,
+    InvalidStackMapFrame,
+    MissingCode,
+    Truncated
+};
+
+auto method_entry_locals(
+        kh::jvm::classfile::ClassFile&,
+        const kh::jvm::method::Method&)
+        -> std::expected<std::vector<kh::jvm::stack_map::VerificationType>, Error>;
+
+// NOTE(garrett): Edits are expressed against the original instruction offsets
+// and only laid out once `commit` is called, so branch targets, handler
+// ranges, debug tables and stack map frames can all be relocated in a single
+// pass. Code inserted before an instruction is treated as part of it, meaning
+// jumps to the instruction land on the inserted code instead.
+class CodeEditor {
+private:
+    struct Handler {
+        std::vector<std::byte> code;
+        std::uint32_t start;
+        std::uint32_t end;
+        std::uint16_t catch_type;
+        std::vector<kh::jvm::stack_map::VerificationType> stack;
+        std::vector<std::uint32_t> gaps;
+    };
+
+    kh::jvm::classfile::ClassFile& klass_;
+    kh::arena::Arena& arena_;
+    std::size_t method_index_;
+    std::size_t attribute_index_;
+    kh::jvm::code::Code code_;
+    std::vector<kh::jvm::bytecode::Instruction> instructions_;
+    std::optional<std::vector<kh::jvm::stack_map::Frame>> frames_;
+    std::vector<kh::jvm::stack_map::VerificationType> entry_locals_;
+    std::vector<kh::jvm::stack_map::VerificationType> added_locals_;
+    std::vector<std::byte> prologue_;
+    std::optional<std::uint32_t> guarded_from_;
+    std::map<std::uint32_t, std::vector<std::byte>> before_;
+    std::map<std::uint32_t, std::vector<std::byte>> after_;
+    std::vector<Handler> handlers_;
+    std::uint16_t extra_stack_;
+
+    CodeEditor(
+        kh::jvm::classfile::ClassFile&,
+        kh::arena::Arena&,
+        std::size_t method_index,
+        std::size_t attribute_index,
+        kh::jvm::code::Code&&,
+        std::vector<kh::jvm::bytecode::Instruction>&&);
+
+    auto needs_frames() const noexcept -> bool;
+public:
+    static auto open(
+            kh::jvm::classfile::ClassFile&,
+            kh::arena::Arena&,
+            std::size_t method_index) -> std::expected<CodeEditor, Error>;
+
+    auto code() const noexcept -> const kh::jvm::code::Code&;
+    auto instructions() const noexcept
+        -> std::span<const kh::jvm::bytecode::Instruction>;
+
+    // NOTE(garrett): New locals are placed after the existing ones and are
+    // assumed to be initialized by the prologue.
+    auto add_local(kh::jvm::stack_map::VerificationType) -> std::uint16_t;
+    auto reserve_stack(std::uint16_t) -> void;
+
+    auto prologue(std::span<const std::byte>) -> void;
+    // NOTE(garrett): Handlers appended from offset zero also cover whatever
+    // is added to the prologue after this point
+    auto guard_prologue() -> void;
+    auto insert_before(std::uint32_t offset, std::span<const std::byte>) -> void;
+    // NOTE(garrett): Handler ranges that start at the next instruction cover
+    // code inserted here as well, just as the instruction's own range would
+    auto insert_after(std::uint32_t offset, std::span<const std::byte>) -> void;
+
+    // NOTE(garrett): Handlers are placed at the end of the method and take
+    // lowest priority. Their frame only carries the locals introduced via
+    // `add_local`. Instructions listed in `gaps` are left out of the range,
+    // together with the code inserted before them.
+    auto append_handler(
+        std::span<const std::byte> code,
+        std::uint32_t start,
+        std::uint32_t end,
+        std::uint16_t catch_type,
+        std::vector<kh::jvm::stack_map::VerificationType> stack,
+        std::vector<std::uint32_t> gaps = {}) -> void;
+
+    auto commit() -> std::expected<void, Error>;
+};
+
+} // namespace kh::jvm::rewriting
+
+#endif // REWRITING_H
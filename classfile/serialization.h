@@ -1,15 +1,21 @@
 #ifndef SERIALIZATION_H
 #define SERIALIZATION_H
 
+#include <algorithm>
+
 #include "attribute.h"
 #include "classfile.h"
+#include "code.h"
 #include "constant_pool.h"
+#include "field.h"
 #include "method.h"
+#include "reader.h"
 #include "sinks.h"
+#include "stack_map.h"
 
 namespace kh::jvm::serialization {
 
-auto serialize(
+constexpr auto serialize(
         kh::sinks::Sink auto& sink,
         const kh::jvm::attribute::Attribute& attribute) -> void {
     sink.write(attribute.name_index);
@@ -17,9 +23,212 @@ auto serialize(
     sink.write_bytes(attribute.data);
 }
 
-auto serialize(
+constexpr auto serialize(
+        kh::sinks::Sink auto& sink,
+        const kh::jvm::code::Code& code) -> void {
+    sink.write(code.max_stack);
+    sink.write(code.max_locals);
+    sink.write(static_cast<std::uint32_t>(code.bytecode.size()));
+    sink.write_bytes(code.bytecode);
+    sink.write(static_cast<std::uint16_t>(code.exception_table.size()));
+
+    for (const auto& handler : code.exception_table) {
+        sink.write(handler.start_pc);
+        sink.write(handler.end_pc);
+        sink.write(handler.handler_pc);
+        sink.write(handler.catch_type);
+    }
+
+    sink.write(static_cast<std::uint16_t>(code.attributes.size()));
+
+    for (const auto& attribute : code.attributes) {
+        serialize(sink, attribute);
+    }
+}
+
+constexpr auto serialize(
+        kh::sinks::Sink auto& sink,
+        const std::vector<kh::jvm::code::LineNumber>& line_numbers) -> void {
+    sink.write(static_cast<std::uint16_t>(line_numbers.size()));
+
+    for (const auto& line_number : line_numbers) {
+        sink.write(line_number.start_pc);
+        sink.write(line_number.line_number);
+    }
+}
+
+constexpr auto serialize(
+        kh::sinks::Sink auto& sink,
+        const std::vector<kh::jvm::code::LocalVariable>& variables) -> void {
+    sink.write(static_cast<std::uint16_t>(variables.size()));
+
+    for (const auto& variable : variables) {
+        sink.write(variable.start_pc);
+        sink.write(variable.length);
+        sink.write(variable.name_index);
+        sink.write(variable.descriptor_index);
+        sink.write(variable.index);
+    }
+}
+
+constexpr auto serialize(
+        kh::sinks::Sink auto& sink,
+        const kh::jvm::stack_map::VerificationType type) -> void {
+    using kh::jvm::stack_map::VerificationTag;
+
+    sink.write(static_cast<std::uint8_t>(type.tag));
+
+    if (type.tag == VerificationTag::Object
+            || type.tag == VerificationTag::Uninitialized) {
+        sink.write(type.value);
+    }
+}
+
+// NOTE(garrett): Frames are compressed against their predecessor where
+// possible, falling back to full frames for anything more involved.
+constexpr auto serialize(
+        kh::sinks::Sink auto& sink,
+        const std::vector<kh::jvm::stack_map::Frame>& frames,
+        const std::vector<kh::jvm::stack_map::VerificationType>& initial_locals)
+        -> void {
+    sink.write(static_cast<std::uint16_t>(frames.size()));
+
+    const auto* previous_locals = &initial_locals;
+    auto previous_offset = -1;
+
+    for (const auto& frame : frames) {
+        const auto delta = static_cast<std::uint16_t>(
+            frame.offset - previous_offset - 1
+        );
+
+        const auto& locals = frame.locals;
+        const auto& previous = *previous_locals;
+        const auto same_locals = locals == previous;
+
+        const auto is_prefix = [](const auto& shorter, const auto& longer) {
+            return shorter.size() < longer.size()
+                && longer.size() - shorter.size() <= 3
+                && std::equal(shorter.begin(), shorter.end(), longer.begin());
+        };
+
+        if (same_locals && frame.stack.empty()) {
+            if (delta <= 63) {
+                sink.write(static_cast<std::uint8_t>(delta));
+            } else {
+                sink.write(static_cast<std::uint8_t>(251));
+                sink.write(delta);
+            }
+        } else if (same_locals && frame.stack.size() == 1) {
+            if (delta <= 63) {
+                sink.write(static_cast<std::uint8_t>(64 + delta));
+            } else {
+                sink.write(static_cast<std::uint8_t>(247));
+                sink.write(delta);
+            }
+
+            serialize(sink, frame.stack.front());
+        } else if (frame.stack.empty() && is_prefix(locals, previous)) {
+            sink.write(static_cast<std::uint8_t>(251 - (previous.size() - locals.size())));
+            sink.write(delta);
+        } else if (frame.stack.empty() && is_prefix(previous, locals)) {
+            sink.write(static_cast<std::uint8_t>(251 + (locals.size() - previous.size())));
+            sink.write(delta);
+
+            for (auto i = previous.size(); i < locals.size(); ++i) {
+                serialize(sink, locals[i]);
+            }
+        } else {
+            sink.write(static_cast<std::uint8_t>(255));
+            sink.write(delta);
+            sink.write(static_cast<std::uint16_t>(locals.size()));
+
+            for (const auto type : locals) {
+                serialize(sink, type);
+            }
+
+            sink.write(static_cast<std::uint16_t>(frame.stack.size()));
+
+            for (const auto type : frame.stack) {
+                serialize(sink, type);
+            }
+        }
+
+        previous_locals = &frame.locals;
+        previous_offset = frame.offset;
+    }
+}
+
+// NOTE(garrett): Rather than relying on every edit to flag what it touched, a
+// member counts as unmodified when its fields still match its source bytes and
+// every attribute still points at the data it was parsed from. Replaced
+// attributes live elsewhere (usually an arena), so this catches any change.
+template <typename T>
+constexpr auto is_unmodified(const T& member) -> bool {
+    if (member.source.empty()) {
+        return false;
+    }
+
+    auto reader = kh::reader::Reader{member.source};
+
+    const auto access_flags = reader.read<std::uint16_t>();
+    const auto name_index = reader.read<std::uint16_t>();
+    const auto descriptor_index = reader.read<std::uint16_t>();
+    const auto attribute_count = reader.read<std::uint16_t>();
+
+    if (!attribute_count
+            || access_flags.value() != member.access_flags
+            || name_index.value() != member.name_index
+            || descriptor_index.value() != member.descriptor_index
+            || attribute_count.value() != member.attributes.size()) {
+        return false;
+    }
+
+    for (const auto& attribute : member.attributes) {
+        const auto attribute_name = reader.read<std::uint16_t>();
+        const auto length = reader.read<std::uint32_t>();
+
+        if (!length || attribute_name.value() != attribute.name_index) {
+            return false;
+        }
+
+        const auto data = reader.read_bytes(length.value());
+
+        if (!data
+                || data.value().data() != attribute.data.data()
+                || data.value().size() != attribute.data.size()) {
+            return false;
+        }
+    }
+
+    return reader.remaining().empty();
+}
+
+constexpr auto serialize(
+        kh::sinks::Sink auto& sink,
+        const kh::jvm::field::Field& field) -> void {
+    if (is_unmodified(field)) {
+        sink.write_bytes(field.source);
+        return;
+    }
+
+    sink.write(field.access_flags);
+    sink.write(field.name_index);
+    sink.write(field.descriptor_index);
+    sink.write(static_cast<std::uint16_t>(field.attributes.size()));
+
+    for (const auto& attribute : field.attributes) {
+        serialize(sink, attribute);
+    }
+}
+
+constexpr auto serialize(
         kh::sinks::Sink auto& sink,
         const kh::jvm::method::Method& method) -> void {
+    if (is_unmodified(method)) {
+        sink.write_bytes(method.source);
+        return;
+    }
+
     sink.write(method.access_flags);
     sink.write(method.name_index);
     sink.write(method.descriptor_index);
@@ -30,14 +239,82 @@ auto serialize(
     }
 }
 
-auto serialize(
+constexpr auto serialize(
         kh::sinks::Sink auto& sink,
         const kh::jvm::constant_pool::ClassEntry entry) -> void {
     sink.write(static_cast<std::uint8_t>(constant_pool::tag(entry)));
     sink.write(entry.name_index);
 }
 
-auto serialize(
+constexpr auto serialize(
+        kh::sinks::Sink auto& sink,
+        const kh::jvm::constant_pool::DoubleEntry entry) -> void {
+    sink.write(static_cast<std::uint8_t>(constant_pool::tag(entry)));
+    sink.write(entry.bits);
+}
+
+constexpr auto serialize(
+        kh::sinks::Sink auto& sink,
+        const kh::jvm::constant_pool::DynamicEntry entry) -> void {
+    sink.write(static_cast<std::uint8_t>(constant_pool::tag(entry)));
+    sink.write(entry.bootstrap_method_attr_index);
+    sink.write(entry.name_and_type_index);
+}
+
+constexpr auto serialize(
+        kh::sinks::Sink auto& sink,
+        const kh::jvm::constant_pool::FieldReferenceEntry entry) -> void {
+    sink.write(static_cast<std::uint8_t>(constant_pool::tag(entry)));
+    sink.write(entry.class_index);
+    sink.write(entry.name_and_type_index);
+}
+
+constexpr auto serialize(
+        kh::sinks::Sink auto& sink,
+        const kh::jvm::constant_pool::FloatEntry entry) -> void {
+    sink.write(static_cast<std::uint8_t>(constant_pool::tag(entry)));
+    sink.write(entry.bits);
+}
+
+constexpr auto serialize(
+        kh::sinks::Sink auto& sink,
+        const kh::jvm::constant_pool::IntegerEntry entry) -> void {
+    sink.write(static_cast<std::uint8_t>(constant_pool::tag(entry)));
+    sink.write(entry.value);
+}
+
+constexpr auto serialize(
+        kh::sinks::Sink auto& sink,
+        const kh::jvm::constant_pool::InterfaceMethodReferenceEntry entry) -> void {
+    sink.write(static_cast<std::uint8_t>(constant_pool::tag(entry)));
+    sink.write(entry.class_index);
+    sink.write(entry.name_and_type_index);
+}
+
+constexpr auto serialize(
+        kh::sinks::Sink auto& sink,
+        const kh::jvm::constant_pool::InvokeDynamicEntry entry) -> void {
+    sink.write(static_cast<std::uint8_t>(constant_pool::tag(entry)));
+    sink.write(entry.bootstrap_method_attr_index);
+    sink.write(entry.name_and_type_index);
+}
+
+constexpr auto serialize(
+        kh::sinks::Sink auto& sink,
+        const kh::jvm::constant_pool::LongEntry entry) -> void {
+    sink.write(static_cast<std::uint8_t>(constant_pool::tag(entry)));
+    sink.write(entry.value);
+}
+
+constexpr auto serialize(
+        kh::sinks::Sink auto& sink,
+        const kh::jvm::constant_pool::MethodHandleEntry entry) -> void {
+    sink.write(static_cast<std::uint8_t>(constant_pool::tag(entry)));
+    sink.write(entry.reference_kind);
+    sink.write(entry.reference_index);
+}
+
+constexpr auto serialize(
         kh::sinks::Sink auto& sink,
         const kh::jvm::constant_pool::MethodReferenceEntry entry) -> void {
     sink.write(static_cast<std::uint8_t>(constant_pool::tag(entry)));
@@ -45,7 +322,21 @@ auto serialize(
     sink.write(entry.name_and_type_index);
 }
 
-auto serialize(
+constexpr auto serialize(
+        kh::sinks::Sink auto& sink,
+        const kh::jvm::constant_pool::MethodTypeEntry entry) -> void {
+    sink.write(static_cast<std::uint8_t>(constant_pool::tag(entry)));
+    sink.write(entry.descriptor_index);
+}
+
+constexpr auto serialize(
+        kh::sinks::Sink auto& sink,
+        const kh::jvm::constant_pool::ModuleEntry entry) -> void {
+    sink.write(static_cast<std::uint8_t>(constant_pool::tag(entry)));
+    sink.write(entry.name_index);
+}
+
+constexpr auto serialize(
         kh::sinks::Sink auto& sink,
         kh::jvm::constant_pool::NameAndTypeEntry entry) -> void {
     sink.write(static_cast<uint8_t>(constant_pool::tag(entry)));
@@ -53,34 +344,56 @@ auto serialize(
     sink.write(entry.descriptor_index);
 }
 
-auto serialize(
+constexpr auto serialize(
+        kh::sinks::Sink auto& sink,
+        const kh::jvm::constant_pool::PackageEntry entry) -> void {
+    sink.write(static_cast<std::uint8_t>(constant_pool::tag(entry)));
+    sink.write(entry.name_index);
+}
+
+constexpr auto serialize(
+        kh::sinks::Sink auto& sink,
+        const kh::jvm::constant_pool::StringEntry entry) -> void {
+    sink.write(static_cast<std::uint8_t>(constant_pool::tag(entry)));
+    sink.write(entry.string_index);
+}
+
+constexpr auto serialize(
         kh::sinks::Sink auto& sink,
         kh::jvm::constant_pool::UTF8Entry entry) -> void {
     sink.write(static_cast<uint8_t>(constant_pool::tag(entry)));
     sink.write(static_cast<uint16_t>(entry.text.size()));
 
-    for (const auto byte : entry.text) {
-        sink.write(static_cast<uint8_t>(byte));
+    if consteval {
+        for (const auto byte : entry.text) {
+            sink.write(static_cast<uint8_t>(byte));
+        }
+    } else {
+        sink.write_bytes(std::as_bytes(std::span{entry.text}));
     }
 }
 
-auto serialize(
+constexpr auto serialize(
         kh::sinks::Sink auto& sink,
         const kh::jvm::constant_pool::ConstantPool& pool) -> void {
-    for (const auto& entry : pool.entries()) {
+    sink.write_bytes(pool.source());
+
+    const auto& entries = pool.entries();
+
+    for (auto i = pool.source_entries(); i < entries.size(); ++i) {
         std::visit([&sink](const auto& e){
             serialize(sink, e);
-        }, entry);
+        }, entries[i]);
     }
 }
 
-auto serialize(
+constexpr auto serialize(
         kh::sinks::Sink auto& sink,
         const kh::jvm::classfile::ClassFile& klass) -> void {
     sink.write(static_cast<std::uint32_t>(0xCAFEBABE));
     sink.write(static_cast<std::uint16_t>(klass.version.minor));
     sink.write(static_cast<std::uint16_t>(klass.version.major));
-    sink.write(static_cast<std::uint16_t>(klass.constant_pool.entries().size() + 1));
+    sink.write(static_cast<std::uint16_t>(klass.constant_pool.count()));
 
     serialize(sink, klass.constant_pool);
 
@@ -88,11 +401,17 @@ auto serialize(
     sink.write(static_cast<std::uint16_t>(klass.class_index));
     sink.write(static_cast<std::uint16_t>(klass.superclass_index));
 
-    // TODO(garrett): Write interface entries
-    sink.write(static_cast<std::uint16_t>(0x0000));
+    sink.write(static_cast<std::uint16_t>(klass.interfaces.size()));
 
-    // TODO(garrett): Write field entries
-    sink.write(static_cast<std::uint16_t>(0x0000));
+    for (const auto interface : klass.interfaces) {
+        sink.write(interface);
+    }
+
+    sink.write(static_cast<std::uint16_t>(klass.fields.size()));
+
+    for (const auto& field : klass.fields) {
+        serialize(sink, field);
+    }
 
     sink.write(static_cast<std::uint16_t>(klass.methods.size()));
 
@@ -107,6 +426,17 @@ auto serialize(
     }
 }
 
+
+// NOTE(garrett): Runs the regular serializer against a counting sink, so the
+// result is exact for anything `serialize` accepts.
+template <typename T>
+constexpr auto serialized_size(const T& value) -> std::size_t {
+    auto sink = kh::sinks::CountingSink{};
+    serialize(sink, value);
+
+    return sink.size();
+}
+
 } // namespace kh::jvm::serialization
 
 #endif // SERIALIZATION_H
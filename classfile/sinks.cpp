@@ -1,5 +1,14 @@
 #include "sinks.h"
 
+#include <cerrno>
+#include <climits>
+#include <system_error>
+#include <utility>
+
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
 namespace kh::sinks {
 
 FileSink::FileSink(std::ofstream& target) : target_(target) {}
@@ -12,6 +21,10 @@ VectorSink::VectorSink() : buffer_(std::vector<std::byte>()) {}
 
 VectorSink::VectorSink(std::vector<std::byte>& buffer) noexcept : buffer_(buffer) {}
 
+auto VectorSink::take() noexcept -> std::vector<std::byte> {
+    return std::move(buffer_);
+}
+
 auto VectorSink::view() const noexcept -> std::span<const std::byte> {
     return buffer_;
 }
@@ -20,4 +33,151 @@ auto VectorSink::write_bytes(const std::span<const std::byte> bytes) -> void {
     buffer_.append_range(bytes);
 }
 
+MappedSink::MappedSink(const int descriptor, const std::size_t size)
+        : mapping_(std::span<std::byte>{})
+        , sink_(SpanSink{std::span<std::byte>{}}) {
+    if (::ftruncate(descriptor, static_cast<off_t>(size)) < 0) {
+        throw std::system_error(errno, std::generic_category(), "Failed to resize output");
+    }
+
+    // NOTE(garrett): Zero length mappings are rejected by mmap, and there is
+    // nothing to write into anyway.
+    if (!size) {
+        return;
+    }
+
+    auto* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+
+    if (data == MAP_FAILED) {
+        throw std::system_error(errno, std::generic_category(), "Failed to map output");
+    }
+
+    mapping_ = std::span{static_cast<std::byte*>(data), size};
+    sink_ = SpanSink{mapping_};
+}
+
+MappedSink::~MappedSink() {
+    if (!mapping_.empty()) {
+        ::munmap(mapping_.data(), mapping_.size());
+    }
+}
+
+auto MappedSink::size() const noexcept -> std::size_t {
+    return sink_.size();
+}
+
+auto MappedSink::write_bytes(const std::span<const std::byte> bytes) noexcept -> void {
+    sink_.write_bytes(bytes);
+}
+
+VectoredSink::VectoredSink(
+        const int descriptor,
+        const std::optional<off_t> offset,
+        const std::size_t threshold)
+        : descriptor_(descriptor)
+        , offset_(offset)
+        , threshold_(threshold)
+        , staging_(std::vector<std::byte>{})
+        , segments_(std::vector<Segment>{})
+        , size_(0) {}
+
+auto VectoredSink::stage(const std::span<const std::byte> bytes) -> void {
+    if (bytes.empty()) {
+        return;
+    }
+
+    // NOTE(garrett): The staging buffer only grows at the end, so consecutive
+    // staged writes always extend the previous segment.
+    if (!segments_.empty() && !segments_.back().data) {
+        segments_.back().size += bytes.size();
+    } else {
+        segments_.push_back(Segment{nullptr, staging_.size(), bytes.size()});
+    }
+
+    staging_.append_range(bytes);
+    size_ += bytes.size();
+}
+
+auto VectoredSink::flush() -> void {
+    const auto staging = std::exchange(staging_, std::vector<std::byte>{});
+    const auto segments = std::exchange(segments_, std::vector<Segment>{});
+    size_ = 0;
+
+    auto vectors = std::vector<iovec>{};
+    vectors.reserve(segments.size());
+
+    for (const auto& segment : segments) {
+        const auto* data = segment.data ? segment.data : staging.data() + segment.offset;
+        vectors.push_back(iovec{const_cast<std::byte*>(data), segment.size});
+    }
+
+    auto remaining = std::span{vectors};
+
+    while (!remaining.empty()) {
+        const auto count = static_cast<int>(
+            std::min(remaining.size(), static_cast<std::size_t>(IOV_MAX))
+        );
+
+        const auto written = offset_
+            ? ::pwritev(descriptor_, remaining.data(), count, *offset_)
+            : ::writev(descriptor_, remaining.data(), count);
+
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (written <= 0) {
+            throw std::system_error(
+                written < 0 ? errno : EIO,
+                std::generic_category(),
+                "Failed to write vectored output"
+            );
+        }
+
+        if (offset_) {
+            *offset_ += written;
+        }
+
+        auto consumed = static_cast<std::size_t>(written);
+
+        while (!remaining.empty() && consumed >= remaining.front().iov_len) {
+            consumed -= remaining.front().iov_len;
+            remaining = remaining.subspan(1);
+        }
+
+        if (consumed) {
+            remaining.front().iov_base = static_cast<std::byte*>(remaining.front().iov_base)
+                + consumed;
+            remaining.front().iov_len -= consumed;
+        }
+    }
+}
+
+auto VectoredSink::segments() const noexcept -> std::size_t {
+    return segments_.size();
+}
+
+auto VectoredSink::size() const noexcept -> std::size_t {
+    return size_;
+}
+
+auto VectoredSink::write_bytes(const std::span<const std::byte> bytes) -> void {
+    if (bytes.size() < threshold_ || bytes.empty()) {
+        stage(bytes);
+        return;
+    }
+
+    // NOTE(garrett): Members copied through from the same source buffer tend
+    // to sit back to back, in which case they share a single iovec.
+    if (!segments_.empty()
+            && segments_.back().data
+            && segments_.back().data + segments_.back().size == bytes.data()) {
+        segments_.back().size += bytes.size();
+    } else {
+        segments_.push_back(Segment{bytes.data(), 0, bytes.size()});
+    }
+
+    size_ += bytes.size();
+}
+
 } // namespace kh::sinks
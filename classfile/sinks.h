@@ -1,10 +1,17 @@
 #ifndef SINKS_H
 #define SINKS_H
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <fstream>
+#include <optional>
+#include <stdexcept>
 #include <span>
 #include <vector>
 
+#include <sys/types.h>
+
 #include "endian.h"
 
 namespace kh::sinks {
@@ -15,13 +22,123 @@ concept Sink = requires(
         const uint8_t u8,
         const uint16_t u16,
         const uint32_t u32,
+        const uint64_t u64,
         const std::span<const std::byte> bytes) {
     { sink.write(u8) } -> std::same_as<void>;
     { sink.write(u16) } -> std::same_as<void>;
     { sink.write(u32) } -> std::same_as<void>;
+    { sink.write(u64) } -> std::same_as<void>;
     { sink.write_bytes(bytes) } -> std::same_as<void>;
 };
 
+// NOTE(garrett): Measures serialized output without storing it, mostly so that
+// compile time serialization can size its array up front.
+class CountingSink {
+private:
+    std::size_t size_;
+public:
+    constexpr CountingSink() noexcept : size_(0) {}
+
+    template <kh::endian::MultiByteIntegral V>
+    constexpr auto write(const V) noexcept -> void {
+        size_ += sizeof(V);
+    }
+
+    constexpr auto size() const noexcept -> std::size_t {
+        return size_;
+    }
+
+    constexpr auto write_bytes(const std::span<const std::byte> bytes) noexcept -> void {
+        size_ += bytes.size();
+    }
+};
+
+template <std::size_t N>
+class ArraySink {
+private:
+    std::array<std::byte, N> buffer_;
+    std::size_t position_;
+public:
+    constexpr ArraySink() noexcept : buffer_(std::array<std::byte, N>{}), position_(0) {}
+
+    template <kh::endian::MultiByteIntegral V>
+    constexpr auto write(const V value) -> void {
+        const auto bytes = std::bit_cast<std::array<std::byte, sizeof(V)>>(
+            kh::endian::big(value)
+        );
+
+        write_bytes(bytes);
+    }
+
+    constexpr auto size() const noexcept -> std::size_t {
+        return position_;
+    }
+
+    constexpr auto take() const noexcept -> std::array<std::byte, N> {
+        return buffer_;
+    }
+
+    constexpr auto write_bytes(const std::span<const std::byte> bytes) -> void {
+        if (bytes.size() > N - position_) {
+            throw std::length_error("ArraySink capacity exceeded");
+        }
+
+        std::ranges::copy(bytes, buffer_.begin() + position_);
+        position_ += bytes.size();
+    }
+};
+
+// NOTE(garrett): Writes into caller-provided storage without bounds checks.
+// The buffer must be sized up front, usually with `serialized_size`.
+class SpanSink {
+private:
+    std::span<std::byte> buffer_;
+    std::size_t position_;
+public:
+    constexpr explicit SpanSink(std::span<std::byte> buffer) noexcept
+        : buffer_(buffer), position_(0) {}
+
+    template <kh::endian::MultiByteIntegral V>
+    constexpr auto write(const V value) noexcept -> void {
+        const auto bytes = std::bit_cast<std::array<std::byte, sizeof(V)>>(
+            kh::endian::big(value)
+        );
+
+        write_bytes(bytes);
+    }
+
+    constexpr auto size() const noexcept -> std::size_t {
+        return position_;
+    }
+
+    constexpr auto write_bytes(const std::span<const std::byte> bytes) noexcept -> void {
+        std::ranges::copy(bytes, buffer_.begin() + position_);
+        position_ += bytes.size();
+    }
+};
+
+// NOTE(garrett): Resizes the file behind `descriptor` to exactly `size` bytes
+// and maps it, so output is serialized straight into the page cache. Writing
+// past `size` is not checked, as with `SpanSink`.
+class MappedSink {
+private:
+    std::span<std::byte> mapping_;
+    SpanSink sink_;
+public:
+    MappedSink(int descriptor, std::size_t size);
+    MappedSink(const MappedSink&) = delete;
+    auto operator=(const MappedSink&) -> MappedSink& = delete;
+    ~MappedSink();
+
+    template <kh::endian::MultiByteIntegral V>
+    auto write(const V value) noexcept -> void {
+        sink_.write(value);
+    }
+
+    auto size() const noexcept -> std::size_t;
+    auto write_bytes(const std::span<const std::byte> bytes) noexcept -> void;
+};
+
 class FileSink {
 private:
     std::ofstream& target_;
@@ -56,10 +173,59 @@ public:
         buffer_.insert(buffer_.end(), bytes.begin(), bytes.end());
     }
 
+    auto take() noexcept -> std::vector<std::byte>;
     auto view() const noexcept -> std::span<const std::byte>;
     auto write_bytes(const std::span<const std::byte> bytes) -> void;
 };
 
+// NOTE(garrett): Gathers output into an iovec list that `flush` hands to
+// writev (or pwritev when given an offset). Integers and short spans are
+// coalesced into a staging buffer, while spans of at least `threshold` bytes
+// are referenced in place, so they must outlive the call to `flush`. Nothing
+// is written until then.
+class VectoredSink {
+private:
+    // NOTE(garrett): Staged segments are stored as offsets, since the staging
+    // buffer may reallocate before the list is flushed.
+    struct Segment {
+        const std::byte* data;
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    int descriptor_;
+    std::optional<off_t> offset_;
+    std::size_t threshold_;
+    std::vector<std::byte> staging_;
+    std::vector<Segment> segments_;
+    std::size_t size_;
+
+    auto stage(const std::span<const std::byte> bytes) -> void;
+public:
+    static constexpr auto default_threshold = 64uz;
+
+    explicit VectoredSink(
+        int descriptor,
+        std::optional<off_t> offset = std::nullopt,
+        std::size_t threshold = default_threshold);
+
+    template <kh::endian::MultiByteIntegral V>
+    auto write(const V value) -> void {
+        const auto bytes = std::bit_cast<std::array<std::byte, sizeof(V)>>(
+            kh::endian::big(value)
+        );
+
+        stage(bytes);
+    }
+
+    // NOTE(garrett): Throws `std::system_error` if the descriptor rejects the
+    // write, in which case any pending output is discarded.
+    auto flush() -> void;
+    auto segments() const noexcept -> std::size_t;
+    auto size() const noexcept -> std::size_t;
+    auto write_bytes(const std::span<const std::byte> bytes) -> void;
+};
+
 } // namespace kh::sinks
 
 #endif // SINKS_H
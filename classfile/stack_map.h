@@ -0,0 +1,57 @@
+#ifndef STACK_MAP_H
+#define STACK_MAP_H
+
+#include <cstdint>
+#include <vector>
+
+namespace kh::jvm::stack_map {
+
+enum class VerificationTag : uint8_t {
+    Top = 0,
+    Integer = 1,
+    Float = 2,
+    Double = 3,
+    Long = 4,
+    Null = 5,
+    UninitializedThis = 6,
+    Object = 7,
+    Uninitialized = 8
+};
+
+struct VerificationType {
+    VerificationTag tag;
+    // NOTE(garrett): Constant pool index for objects, code offset of the
+    // originating `new` for uninitialized values, otherwise unused.
+    std::uint16_t value;
+
+    friend auto operator==(
+        const VerificationType&,
+        const VerificationType&) -> bool = default;
+};
+
+// NOTE(garrett): Frames are kept fully expanded with absolute code offsets, the
+// compressed forms only exist in serialized output.
+struct Frame {
+    std::uint16_t offset;
+    std::vector<VerificationType> locals;
+    std::vector<VerificationType> stack;
+};
+
+constexpr auto is_wide(const VerificationType type) noexcept -> bool {
+    return type.tag == VerificationTag::Long || type.tag == VerificationTag::Double;
+}
+
+constexpr auto slot_count(const std::vector<VerificationType>& types) noexcept
+        -> std::size_t {
+    auto slots = 0uz;
+
+    for (const auto type : types) {
+        slots += is_wide(type) ? 2 : 1;
+    }
+
+    return slots;
+}
+
+} // namespace kh::jvm::stack_map
+
+#endif // STACK_MAP_H
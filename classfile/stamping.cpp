@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <limits>
+
+#include "serialization.h"
+#include "stamping.h"
+
+namespace kh::jvm::stamping {
+
+namespace {
+
+constexpr auto header_size = sizeof(std::uint32_t) + 3 * sizeof(std::uint16_t);
+constexpr auto no_entry = std::numeric_limits<std::size_t>::max();
+
+} // namespace
+
+Template::Template(
+        std::vector<std::byte>&& bytes,
+        std::vector<std::size_t>&& entry_offsets,
+        std::vector<kh::jvm::constant_pool::Tag>&& entry_tags)
+        : bytes_(std::move(bytes))
+        , entry_offsets_(std::move(entry_offsets))
+        , entry_tags_(std::move(entry_tags))
+        , holes_(std::vector<Hole>{})
+        , order_(std::vector<std::size_t>{}) {}
+
+auto Template::create(const kh::jvm::classfile::ClassFile& klass) -> Template {
+    auto bytes = std::vector<std::byte>(kh::jvm::serialization::serialized_size(klass));
+    auto sink = kh::sinks::SpanSink{bytes};
+    kh::jvm::serialization::serialize(sink, klass);
+
+    // NOTE(garrett): Index zero and the second half of wide entries have no
+    // encoding of their own.
+    auto entry_offsets = std::vector<std::size_t>{no_entry};
+    auto entry_tags = std::vector<kh::jvm::constant_pool::Tag>{
+        kh::jvm::constant_pool::Tag::UTF8
+    };
+
+    auto offset = header_size;
+
+    for (const auto& entry : klass.constant_pool.entries()) {
+        entry_offsets.push_back(offset);
+        entry_tags.push_back(kh::jvm::constant_pool::tag(entry));
+
+        if (kh::jvm::constant_pool::is_wide(entry)) {
+            entry_offsets.push_back(no_entry);
+            entry_tags.push_back(entry_tags.back());
+        }
+
+        offset += std::visit([](const auto& e) {
+            return kh::jvm::serialization::serialized_size(e);
+        }, entry);
+    }
+
+    return Template{std::move(bytes), std::move(entry_offsets), std::move(entry_tags)};
+}
+
+auto Template::bytes() const noexcept -> std::span<const std::byte> {
+    return bytes_;
+}
+
+auto Template::add_hole(const Hole hole) -> std::expected<std::size_t, Error> {
+    const auto overlaps = std::ranges::any_of(holes_, [&hole](const auto& existing) {
+        return hole.offset < existing.offset + existing.length
+            && existing.offset < hole.offset + hole.length;
+    });
+
+    if (overlaps) {
+        return std::unexpected(Error::OverlappingSlot);
+    }
+
+    const auto index = holes_.size();
+    holes_.push_back(hole);
+
+    const auto position = std::ranges::upper_bound(
+        order_,
+        hole.offset,
+        std::less{},
+        [this](const auto i) { return holes_[i].offset; }
+    );
+
+    order_.insert(position, index);
+    return index;
+}
+
+auto Template::text(const std::uint16_t pool_index) -> std::expected<std::size_t, Error> {
+    if (pool_index >= entry_offsets_.size()
+            || entry_offsets_[pool_index] == no_entry
+            || entry_tags_[pool_index] != kh::jvm::constant_pool::Tag::UTF8) {
+        return std::unexpected(Error::InvalidSlot);
+    }
+
+    // NOTE(garrett): The hole spans the length prefix as well as the text,
+    // skipping only the tag byte.
+    const auto offset = entry_offsets_[pool_index] + 1u;
+    const auto length = (std::to_integer<std::size_t>(bytes_[offset]) << 8)
+        | std::to_integer<std::size_t>(bytes_[offset + 1u]);
+
+    return add_hole(Hole{offset, sizeof(std::uint16_t) + length, 0u});
+}
+
+auto Template::constant(const std::uint16_t pool_index) -> std::expected<std::size_t, Error> {
+    using kh::jvm::constant_pool::Tag;
+
+    if (pool_index >= entry_offsets_.size() || entry_offsets_[pool_index] == no_entry) {
+        return std::unexpected(Error::InvalidSlot);
+    }
+
+    const auto tag = entry_tags_[pool_index];
+    auto width = std::uint8_t{8u};
+
+    if (tag == Tag::Integer || tag == Tag::Float) {
+        width = 4u;
+    } else if (tag != Tag::Long && tag != Tag::Double) {
+        return std::unexpected(Error::InvalidSlot);
+    }
+
+    return add_hole(Hole{entry_offsets_[pool_index] + 1u, width, width});
+}
+
+auto Template::value(const std::size_t offset, const std::uint8_t width)
+        -> std::expected<std::size_t, Error> {
+    if ((width != 1u && width != 2u && width != 4u && width != 8u)
+            || offset > bytes_.size()
+            || width > bytes_.size() - offset) {
+        return std::unexpected(Error::InvalidSlot);
+    }
+
+    return add_hole(Hole{offset, width, width});
+}
+
+auto Template::validate(std::span<const Argument> arguments) const noexcept
+        -> std::expected<void, Error> {
+    if (arguments.size() != holes_.size()) {
+        return std::unexpected(Error::ArgumentCount);
+    }
+
+    for (auto i = 0uz; i < holes_.size(); ++i) {
+        const auto width = holes_[i].width;
+
+        if (!width) {
+            const auto* text = std::get_if<std::string_view>(&arguments[i]);
+
+            if (!text || text->size() > std::numeric_limits<std::uint16_t>::max()) {
+                return std::unexpected(Error::InvalidArgument);
+            }
+
+            continue;
+        }
+
+        const auto* value = std::get_if<std::uint64_t>(&arguments[i]);
+
+        if (!value || (width < sizeof(std::uint64_t) && *value >> (8u * width))) {
+            return std::unexpected(Error::InvalidArgument);
+        }
+    }
+
+    return {};
+}
+
+auto Template::stamped_size(std::span<const Argument> arguments) const noexcept
+        -> std::expected<std::size_t, Error> {
+    if (const auto result = validate(arguments); !result) {
+        return std::unexpected(result.error());
+    }
+
+    auto size = bytes_.size();
+
+    for (auto i = 0uz; i < holes_.size(); ++i) {
+        if (!holes_[i].width) {
+            size = size - holes_[i].length + sizeof(std::uint16_t)
+                + std::get<std::string_view>(arguments[i]).size();
+        }
+    }
+
+    return size;
+}
+
+} // namespace kh::jvm::stamping
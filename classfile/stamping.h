@@ -0,0 +1,118 @@
+#ifndef STAMPING_H
+#define STAMPING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "classfile.h"
+#include "sinks.h"
+
+namespace kh::jvm::stamping {
+
+enum Error {
+    ArgumentCount,
+    InvalidArgument,
+    InvalidSlot,
+    OverlappingSlot
+};
+
+// NOTE(garrett): Text for UTF8 slots, an unsigned value of the slot's width
+// otherwise. Float and double constants are passed as their raw bits.
+using Argument = std::variant<std::string_view, std::uint64_t>;
+
+// NOTE(garrett): A class serialized once with a set of holes that are filled
+// in for every instance. Holes are either whole UTF8 entries, which may change
+// length, numeric constant pool entries, or fixed width values at arbitrary
+// offsets in the serialized bytes. Stamping only copies the bytes between
+// holes, so no `ClassFile` is built and nothing is re-serialized. A UTF8 entry
+// shared by several references changes for all of them.
+class Template {
+private:
+    struct Hole {
+        std::size_t offset;
+        std::size_t length;
+        // NOTE(garrett): Zero for text holes
+        std::uint8_t width;
+    };
+
+    std::vector<std::byte> bytes_;
+    std::vector<std::size_t> entry_offsets_;
+    std::vector<kh::jvm::constant_pool::Tag> entry_tags_;
+    std::vector<Hole> holes_;
+    std::vector<std::size_t> order_;
+
+    Template(
+        std::vector<std::byte>&&,
+        std::vector<std::size_t>&&,
+        std::vector<kh::jvm::constant_pool::Tag>&&);
+
+    auto add_hole(Hole) -> std::expected<std::size_t, Error>;
+    auto validate(std::span<const Argument>) const noexcept -> std::expected<void, Error>;
+public:
+    static auto create(const kh::jvm::classfile::ClassFile&) -> Template;
+
+    // NOTE(garrett): Serialized bytes of the template, used to locate offsets
+    // for `value`
+    auto bytes() const noexcept -> std::span<const std::byte>;
+
+    // NOTE(garrett): Each of these returns the position of the hole within
+    // the arguments passed to `stamp`.
+    auto text(std::uint16_t pool_index) -> std::expected<std::size_t, Error>;
+    auto constant(std::uint16_t pool_index) -> std::expected<std::size_t, Error>;
+    auto value(std::size_t offset, std::uint8_t width) -> std::expected<std::size_t, Error>;
+
+    auto stamped_size(std::span<const Argument>) const noexcept
+        -> std::expected<std::size_t, Error>;
+
+    auto stamp(kh::sinks::Sink auto& sink, std::span<const Argument> arguments) const
+            -> std::expected<void, Error> {
+        if (const auto result = validate(arguments); !result) {
+            return result;
+        }
+
+        const auto bytes = std::span{bytes_};
+        auto position = 0uz;
+
+        for (const auto index : order_) {
+            const auto& hole = holes_[index];
+            sink.write_bytes(bytes.subspan(position, hole.offset - position));
+
+            if (!hole.width) {
+                const auto text = std::get<std::string_view>(arguments[index]);
+
+                sink.write(static_cast<std::uint16_t>(text.size()));
+                sink.write_bytes(std::as_bytes(std::span{text}));
+            } else {
+                const auto value = std::get<std::uint64_t>(arguments[index]);
+
+                switch (hole.width) {
+                    case 1u:
+                        sink.write(static_cast<std::uint8_t>(value));
+                        break;
+                    case 2u:
+                        sink.write(static_cast<std::uint16_t>(value));
+                        break;
+                    case 4u:
+                        sink.write(static_cast<std::uint32_t>(value));
+                        break;
+                    default:
+                        sink.write(value);
+                }
+            }
+
+            position = hole.offset + hole.length;
+        }
+
+        sink.write_bytes(bytes.subspan(position));
+        return {};
+    }
+};
+
+} // namespace kh::jvm::stamping
+
+#endif // STAMPING_H
@@ -0,0 +1,239 @@
+#include <algorithm>
+#include <cerrno>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "jar.h"
+#include "parsing.h"
+#include "reader.h"
+#include "streaming.h"
+
+namespace kh::jvm::streaming {
+
+namespace {
+
+// NOTE(garrett): Owns its descriptor, so files still in the window are closed
+// when the consumer stops early
+struct Pending {
+    std::string name;
+    int descriptor;
+
+    Pending(std::string&& name, const int descriptor) noexcept
+            : name(std::move(name))
+            , descriptor(descriptor) {}
+
+    Pending(Pending&& other) noexcept
+            : name(std::move(other.name))
+            , descriptor(std::exchange(other.descriptor, -1)) {}
+
+    auto operator=(Pending&&) -> Pending& = delete;
+
+    ~Pending() {
+        if (descriptor >= 0) {
+            ::close(descriptor);
+        }
+    }
+};
+
+// NOTE(garrett): Opened as soon as the file enters the window, so the advice
+// can be given against the descriptor
+auto open_ahead(const std::filesystem::path& path) -> int {
+    const auto descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (descriptor < 0) {
+        return descriptor;
+    }
+
+#if defined(__linux__)
+    ::posix_fadvise(descriptor, 0, 0, POSIX_FADV_WILLNEED);
+#elif defined(__APPLE__)
+    struct stat status{};
+
+    if (::fstat(descriptor, &status) == 0) {
+        auto advice = ::radvisory{0, static_cast<int>(status.st_size)};
+        ::fcntl(descriptor, F_RDADVISE, &advice);
+    }
+#endif
+
+    return descriptor;
+}
+
+auto read_all(const int descriptor, std::vector<std::byte>& buffer) -> bool {
+    struct stat status{};
+
+    if (::fstat(descriptor, &status) < 0) {
+        return false;
+    }
+
+    buffer.resize(static_cast<std::size_t>(status.st_size));
+
+    for (auto read = 0uz; read < buffer.size();) {
+        const auto result = ::read(descriptor, buffer.data() + read, buffer.size() - read);
+
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (result <= 0) {
+            return false;
+        }
+
+        read += static_cast<std::size_t>(result);
+    }
+
+    return true;
+}
+
+auto advise(std::span<const std::byte> bytes) -> void {
+    static const auto page = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+
+    if (bytes.empty()) {
+        return;
+    }
+
+    const auto start = reinterpret_cast<std::uintptr_t>(bytes.data()) & ~(page - 1u);
+    const auto end = reinterpret_cast<std::uintptr_t>(bytes.data() + bytes.size());
+
+    ::posix_madvise(reinterpret_cast<void*>(start), end - start, POSIX_MADV_WILLNEED);
+}
+
+auto parse(std::span<const std::byte> bytes)
+        -> std::expected<kh::jvm::classfile::ClassFile, Error> {
+    auto reader = kh::reader::Reader{bytes};
+    auto klass = kh::jvm::parsing::parse_class_file(reader);
+
+    if (!klass) {
+        return std::unexpected(Error::ParseFailed);
+    }
+
+    return std::move(klass.value());
+}
+
+} // namespace
+
+auto stream(const std::filesystem::path input, const std::size_t window)
+        -> kh::generator::Generator<const Streamed&> {
+    auto buffer = std::vector<std::byte>{};
+    auto streamed = Streamed{{}, {}, std::unexpected(Error::ReadFailed)};
+
+    if (!std::filesystem::is_directory(input)) {
+        auto tree = kh::jvm::jar::Tree::open(input);
+
+        if (!tree) {
+            const auto name = input.filename().string();
+
+            streamed.name = name;
+            co_yield streamed;
+            co_return;
+        }
+
+        const auto entries = tree->entries();
+        auto advised = 0uz;
+
+        for (auto i = 0uz; i < entries.size(); ++i) {
+            for (; advised < entries.size() && advised <= i + window; ++advised) {
+                advise(entries[advised].archive->raw(*entries[advised].entry));
+            }
+
+            const auto& entry = entries[i];
+
+            if (!entry.path.ends_with(".class")) {
+                continue;
+            }
+
+            const auto bytes = entry.archive->extract(*entry.entry, buffer);
+
+            streamed.name = entry.path;
+            streamed.bytes = bytes ? bytes.value() : std::span<const std::byte>{};
+            streamed.klass = bytes ? parse(bytes.value()) : std::unexpected(Error::ReadFailed);
+
+            co_yield streamed;
+        }
+
+        co_return;
+    }
+
+    auto directories = std::vector<std::filesystem::directory_iterator>{};
+    auto pending = std::deque<Pending>{};
+
+    // NOTE(garrett): Directories that can't be listed are yielded as read
+    // failures under their own name, and the walk carries on past them
+    auto unlisted = [&](const std::filesystem::path& directory) {
+        pending.push_back(Pending{
+            directory == input
+                ? input.filename().generic_string()
+                : directory.lexically_relative(input).generic_string(),
+            -1
+        });
+    };
+
+    auto descend = [&](const std::filesystem::path& directory) {
+        auto error = std::error_code{};
+        auto iterator = std::filesystem::directory_iterator{directory, error};
+
+        if (error) {
+            unlisted(directory);
+        } else {
+            directories.push_back(std::move(iterator));
+        }
+    };
+
+    // NOTE(garrett): Keeps `window` files open and advised past the one being
+    // yielded, walking the directory only as far as that needs
+    auto fill = [&] {
+        while (pending.size() <= window && !directories.empty()) {
+            auto& iterator = directories.back();
+
+            if (iterator == std::filesystem::end(iterator)) {
+                directories.pop_back();
+                continue;
+            }
+
+            const auto entry = *iterator;
+            auto error = std::error_code{};
+            iterator.increment(error);
+
+            if (error) {
+                directories.pop_back();
+                unlisted(entry.path().parent_path());
+            }
+
+            auto ignored = std::error_code{};
+
+            if (entry.is_directory(ignored) && !entry.is_symlink(ignored)) {
+                descend(entry.path());
+            } else if (entry.is_regular_file(ignored) && entry.path().extension() == ".class") {
+                pending.push_back(Pending{
+                    entry.path().lexically_relative(input).generic_string(),
+                    open_ahead(entry.path())
+                });
+            }
+        }
+    };
+
+    descend(input);
+    fill();
+
+    while (!pending.empty()) {
+        const auto current = std::move(pending.front());
+        pending.pop_front();
+        fill();
+
+        const auto read = current.descriptor >= 0 && read_all(current.descriptor, buffer);
+
+        streamed.name = current.name;
+        streamed.bytes = read ? std::span<const std::byte>{buffer} : std::span<const std::byte>{};
+        streamed.klass = read ? parse(buffer) : std::unexpected(Error::ReadFailed);
+
+        co_yield streamed;
+    }
+}
+
+} // namespace kh::jvm::streaming
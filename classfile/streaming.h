@@ -0,0 +1,52 @@
+#ifndef STREAMING_H
+#define STREAMING_H
+
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <span>
+#include <string_view>
+
+#include "classfile.h"
+#include "generator.h"
+
+namespace kh::jvm::streaming {
+
+enum Error {
+    ParseFailed,
+    ReadFailed
+};
+
+constexpr auto name(const Error error) noexcept -> std::string_view {
+    switch (error) {
+        case Error::ParseFailed:
+            return "Class file could not be parsed";
+        case Error::ReadFailed:
+            return "Class file could not be read";
+    }
+
+    return "Unknown error";
+}
+
+struct Streamed {
+    // NOTE(garrett): Relative to a directory, or the entry's path in an
+    // archive including any nested archives
+    std::string_view name;
+    std::span<const std::byte> bytes;
+    std::expected<kh::jvm::classfile::ClassFile, Error> klass;
+};
+
+// NOTE(garrett): Lazily walks a directory or jar, parsing each class file only
+// when the consumer asks for it, on the consumer's thread. The kernel is told
+// to start reading the next `window` classes ahead of the consumer, so I/O
+// overlaps with whatever the consumer does in between. Every yielded class
+// shares one buffer that's reused for the next, so memory stays constant
+// however large the corpus, and nothing yielded outlives the next step.
+// Directories that can't be listed are yielded as read failures, named like
+// the classes in them would be, and the rest of the tree is still walked.
+auto stream(std::filesystem::path input, std::size_t window = 16u)
+    -> kh::generator::Generator<const Streamed&>;
+
+} // namespace kh::jvm::streaming
+
+#endif // STREAMING_H
@@ -0,0 +1,240 @@
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "batch.h"
+#include "tests/helpers.h"
+#include "views.h"
+
+namespace kh::jvm::batch {
+
+namespace {
+
+using fixtures::class_bytes;
+using fixtures::write_file;
+
+auto read_archive(const int descriptor) -> std::vector<unsigned char> {
+    const auto size = ::lseek(descriptor, 0, SEEK_END);
+    auto archive = std::vector<unsigned char>(static_cast<std::size_t>(size));
+
+    EXPECT_EQ(size, ::pread(descriptor, archive.data(), archive.size(), 0));
+    return archive;
+}
+
+// NOTE(garrett): Names from the central directory, in archive order
+auto entry_names(const int descriptor) -> std::vector<std::string> {
+    const auto archive = read_archive(descriptor);
+
+    auto read_u16 = [&archive](const std::size_t offset) {
+        return static_cast<std::size_t>(archive[offset] | archive[offset + 1u] << 8u);
+    };
+
+    const auto end = archive.size() - 22u;
+    auto position = read_u16(end + 16u) | read_u16(end + 18u) << 16u;
+    auto names = std::vector<std::string>{};
+
+    for (auto i = 0uz; i < read_u16(end + 10u); ++i) {
+        const auto length = read_u16(position + 28u);
+        const auto name = reinterpret_cast<const char*>(archive.data() + position + 46u);
+
+        names.emplace_back(name, length);
+        position += 46u + length;
+    }
+
+    return names;
+}
+
+} // namespace
+
+TEST(Batch, TransformsDirectoryInSortedOrder) {
+    const auto directory = std::filesystem::temp_directory_path()
+        / ("kh-batch-" + std::to_string(::getpid()));
+
+    write_file(directory / "b" / "Second.class", class_bytes("b/Second"));
+    write_file(directory / "a" / "First.class", class_bytes("a/First"));
+    write_file(directory / "c" / "Rejected.class", class_bytes("c/Rejected"));
+    write_file(directory / "d" / "Throwing.class", class_bytes("d/Throwing"));
+    write_file(directory / "README.txt", class_bytes("ignored"));
+    std::ofstream{directory / "Broken.class"} << "not a class";
+
+    const auto transforms = std::to_array<Transform>({
+        Transform{
+            "final",
+            [](classfile::ClassFile& klass, arena::Arena&) {
+                klass.access_flags |= 0x0010u;
+                return true;
+            }
+        },
+        Transform{
+            "reject",
+            [](classfile::ClassFile& klass, arena::Arena&) {
+                return views::ClassView{klass}.name() != "c/Rejected";
+            }
+        },
+        Transform{
+            "throw",
+            [](classfile::ClassFile& klass, arena::Arena&) {
+                if (views::ClassView{klass}.name() == "d/Throwing") {
+                    throw std::runtime_error("Malformed constant pool");
+                }
+
+                return true;
+            }
+        }
+    });
+
+    auto file = std::tmpfile();
+    ASSERT_NE(nullptr, file);
+
+    auto pool = kh::threading::ThreadPool{2u};
+    auto writer = jar::Writer{::fileno(file), pool};
+    const auto report = run(directory, transforms, writer, pool);
+
+    ASSERT_TRUE(report);
+    ASSERT_TRUE(writer.finish());
+    std::filesystem::remove_all(directory);
+
+    EXPECT_EQ(2u, report->classes);
+    EXPECT_LT(0u, report->input_bytes);
+    EXPECT_EQ(report->input_bytes, report->output_bytes);
+
+    ASSERT_EQ(3u, report->failures.size());
+    EXPECT_EQ("Broken.class", report->failures[0].name);
+    EXPECT_EQ(Error::ParseFailed, report->failures[0].error);
+    EXPECT_EQ("c/Rejected.class", report->failures[1].name);
+    EXPECT_EQ(Error::TransformFailed, report->failures[1].error);
+    EXPECT_EQ(1u, report->failures[1].transform);
+    EXPECT_EQ("d/Throwing.class", report->failures[2].name);
+    EXPECT_EQ(Error::TransformFailed, report->failures[2].error);
+    EXPECT_EQ(2u, report->failures[2].transform);
+
+    // NOTE(garrett): Failed classes are still carried over unmodified
+    const auto expected = std::vector<std::string>{
+        "Broken.class",
+        "a/First.class",
+        "b/Second.class",
+        "c/Rejected.class",
+        "d/Throwing.class"
+    };
+
+    EXPECT_EQ(expected, entry_names(::fileno(file)));
+    std::fclose(file);
+}
+
+TEST(Batch, TransformsJarEntriesInArchiveOrder) {
+    const auto path = std::filesystem::temp_directory_path()
+        / ("kh-batch-" + std::to_string(::getpid()) + ".jar");
+
+    auto pool = kh::threading::ThreadPool{2u};
+
+    {
+        auto file = std::fopen(path.c_str(), "wb");
+        ASSERT_NE(nullptr, file);
+
+        auto writer = jar::Writer{::fileno(file), pool};
+        const auto manifest = std::as_bytes(std::span{std::string_view{"Manifest-Version: 1.0"}});
+
+        ASSERT_TRUE(writer.add("META-INF/", {}));
+        ASSERT_TRUE(writer.add(
+            "META-INF/MANIFEST.MF",
+            std::vector<std::byte>(manifest.begin(), manifest.end())
+        ));
+        ASSERT_TRUE(writer.add("b/Second.class", class_bytes("b/Second")));
+        ASSERT_TRUE(writer.add("a/First.class", class_bytes("a/First"), jar::Compression::Stored));
+        ASSERT_TRUE(writer.finish());
+
+        std::fclose(file);
+    }
+
+    const auto transforms = std::to_array<Transform>({
+        Transform{
+            "final",
+            [](classfile::ClassFile& klass, arena::Arena&) {
+                klass.access_flags |= 0x0010u;
+                return true;
+            }
+        }
+    });
+
+    auto file = std::tmpfile();
+    ASSERT_NE(nullptr, file);
+
+    auto writer = jar::Writer{::fileno(file), pool};
+    const auto report = run(path, transforms, writer, pool);
+
+    ASSERT_TRUE(report);
+    ASSERT_TRUE(writer.finish());
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(2u, report->classes);
+    EXPECT_TRUE(report->failures.empty());
+
+    const auto expected = std::vector<std::string>{
+        "META-INF/",
+        "META-INF/MANIFEST.MF",
+        "b/Second.class",
+        "a/First.class"
+    };
+
+    EXPECT_EQ(expected, entry_names(::fileno(file)));
+    std::fclose(file);
+}
+
+TEST(Batch, ReusesCachedOutput) {
+    const auto directory = std::filesystem::temp_directory_path()
+        / ("kh-batch-cached-" + std::to_string(::getpid()));
+
+    write_file(directory / "a" / "First.class", class_bytes("a/First"));
+    write_file(directory / "b" / "Second.class", class_bytes("b/Second"));
+
+    auto applied = std::atomic<std::size_t>{0u};
+    auto transforms = std::to_array<Transform>({
+        Transform{
+            "final",
+            [&applied](classfile::ClassFile& klass, arena::Arena&) {
+                klass.access_flags |= 0x0010u;
+                ++applied;
+
+                return true;
+            },
+            1u
+        }
+    });
+
+    auto pool = kh::threading::ThreadPool{2u};
+    auto cache = kh::cache::Cache{directory / "cache", 1u << 20u};
+    auto outputs = std::vector<std::vector<unsigned char>>{};
+    auto cached = std::vector<std::size_t>{};
+
+    for (const auto fingerprint : {1u, 1u, 2u}) {
+        transforms[0].fingerprint = fingerprint;
+
+        auto file = std::tmpfile();
+        ASSERT_NE(nullptr, file);
+
+        auto writer = jar::Writer{::fileno(file), pool};
+        const auto report = run(directory / "a", transforms, writer, pool, &cache);
+
+        ASSERT_TRUE(report);
+        ASSERT_TRUE(writer.finish());
+        EXPECT_EQ(1u, report->classes);
+
+        cached.push_back(report->cached);
+        outputs.push_back(read_archive(::fileno(file)));
+        std::fclose(file);
+    }
+
+    // NOTE(garrett): Only the second run matches the first's fingerprint
+    EXPECT_EQ(2u, applied.load());
+    EXPECT_EQ((std::vector<std::size_t>{0u, 1u, 0u}), cached);
+    EXPECT_EQ(outputs[0], outputs[1]);
+
+    std::filesystem::remove_all(directory);
+}
+
+} // namespace kh::jvm::batch
@@ -0,0 +1,98 @@
+#include "gtest/gtest.h"
+
+#include "builder.h"
+#include "parsing.h"
+#include "verification.h"
+#include "views.h"
+
+namespace kh::jvm::builder {
+
+namespace {
+
+constexpr auto counters = embed<[] {
+    using bytecode::Opcode;
+
+    constexpr auto public_static = static_cast<std::uint16_t>(method::AccessFlags::ACC_PUBLIC)
+        | static_cast<std::uint16_t>(method::AccessFlags::ACC_STATIC);
+
+    auto klass = ClassBuilder{"kh/runtime/Counters"};
+    const auto counts = klass.field_reference("kh/runtime/Counters", "counts", "[J");
+
+    klass.field(
+        public_static | static_cast<std::uint16_t>(field::AccessFlags::ACC_FINAL),
+        "counts",
+        "[J"
+    );
+
+    auto initializer = bytecode::Assembler{};
+    initializer.push_short(64)
+        .op(Opcode::NEWARRAY, static_cast<std::uint8_t>(bytecode::ArrayType::T_LONG))
+        .op(Opcode::PUTSTATIC, counts)
+        .op(Opcode::RETURN);
+
+    klass.method(
+        static_cast<std::uint16_t>(method::AccessFlags::ACC_STATIC),
+        "<clinit>",
+        "()V",
+        1u,
+        0u,
+        std::move(initializer)
+    );
+
+    auto add = bytecode::Assembler{};
+    add.op(Opcode::GETSTATIC, counts)
+        .op(Opcode::ILOAD_0)
+        .op(Opcode::DUP2)
+        .op(Opcode::LALOAD)
+        .op(Opcode::LLOAD_1)
+        .op(Opcode::LADD)
+        .op(Opcode::LASTORE)
+        .op(Opcode::RETURN);
+
+    klass.method(public_static, "add", "(IJ)V", 6u, 3u, std::move(add));
+
+    return klass;
+}>();
+
+static_assert(counters[0] == std::byte{0xCA} && counters[3] == std::byte{0xBE});
+
+} // namespace
+
+TEST(Builder, EmbedsClassesBuiltAtCompileTime) {
+    auto reader = kh::reader::Reader{counters};
+    const auto parsed = parsing::parse_class_file(reader);
+
+    ASSERT_TRUE(parsed);
+
+    const auto& klass = parsed.value();
+    const auto view = views::ClassView{klass};
+
+    EXPECT_EQ("kh/runtime/Counters", view.name());
+    EXPECT_EQ("java/lang/Object", view.superclass());
+    EXPECT_EQ(1u, klass.fields.size());
+    EXPECT_EQ(2u, klass.methods.size());
+    EXPECT_TRUE(view.method("add"));
+    EXPECT_TRUE(verification::verify(klass).empty());
+}
+
+TEST(Builder, CountingSinkMatchesArraySink) {
+    constexpr auto build = [] {
+        auto klass = ClassBuilder{"kh/runtime/Empty"};
+        klass.interface("java/io/Serializable");
+
+        return klass;
+    };
+
+    kh::sinks::CountingSink counting{};
+    build().write(counting);
+
+    constexpr auto bytes = embed<build>();
+    EXPECT_EQ(bytes.size(), counting.size());
+
+    kh::sinks::VectorSink vector{};
+    build().write(vector);
+
+    EXPECT_TRUE(std::ranges::equal(bytes, vector.view()));
+}
+
+} // namespace kh::jvm::builder
@@ -0,0 +1,151 @@
+#include <fstream>
+#include <string>
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "cache.h"
+
+namespace kh::cache {
+
+namespace {
+
+auto bytes(const std::size_t size, const std::uint8_t value) -> std::vector<std::byte> {
+    return std::vector<std::byte>(size, std::byte{value});
+}
+
+auto cache_directory(const std::string& name) -> std::filesystem::path {
+    const auto directory = std::filesystem::temp_directory_path()
+        / ("kh-cache-" + name + "-" + std::to_string(::getpid()));
+
+    std::filesystem::remove_all(directory);
+    return directory;
+}
+
+} // namespace
+
+TEST(Cache, PersistsEntriesAcrossInstances) {
+    const auto directory = cache_directory("persist");
+    const auto input = bytes(64u, 1u);
+    const auto output = bytes(100u, 2u);
+
+    {
+        auto cache = Cache{directory, 1024u};
+
+        EXPECT_FALSE(cache.find(key(input, 7u)));
+        ASSERT_TRUE(cache.insert(key(input, 7u), output));
+        ASSERT_TRUE(cache.find(key(input, 7u)));
+    }
+
+    {
+        auto cache = Cache{directory, 1024u};
+        const auto found = cache.find(key(input, 7u));
+
+        ASSERT_TRUE(found);
+        EXPECT_TRUE(std::ranges::equal(output, found.value()));
+
+        // NOTE(garrett): A different fingerprint or input must miss
+        EXPECT_FALSE(cache.find(key(input, 8u)));
+        EXPECT_FALSE(cache.find(key(bytes(64u, 3u), 7u)));
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(Cache, EvictsLeastRecentlyUsedEntries) {
+    const auto directory = cache_directory("evict");
+    auto cache = Cache{directory, 1000u};
+
+    const auto first = key(bytes(1u, 1u), 0u);
+    const auto second = key(bytes(1u, 2u), 0u);
+    const auto third = key(bytes(1u, 3u), 0u);
+    const auto fourth = key(bytes(1u, 4u), 0u);
+
+    ASSERT_TRUE(cache.insert(first, bytes(300u, 1u)));
+    ASSERT_TRUE(cache.insert(second, bytes(300u, 2u)));
+    ASSERT_TRUE(cache.insert(third, bytes(300u, 3u)));
+
+    // NOTE(garrett): Entries found before the eviction are copies of their own
+    const auto held = cache.find(first);
+    ASSERT_TRUE(held);
+
+    ASSERT_TRUE(cache.insert(fourth, bytes(300u, 4u)));
+
+    EXPECT_TRUE(cache.find(first));
+    EXPECT_FALSE(cache.find(second));
+    EXPECT_FALSE(cache.find(third));
+    EXPECT_TRUE(cache.find(fourth));
+    EXPECT_EQ(600u, cache.size());
+    EXPECT_EQ(bytes(300u, 1u), held.value());
+    EXPECT_EQ(bytes(300u, 1u), cache.find(first).value());
+
+    // NOTE(garrett): The replaced pack is deleted rather than kept mapped
+    EXPECT_FALSE(std::filesystem::exists(directory / "pack-0"));
+    EXPECT_TRUE(std::filesystem::exists(directory / "pack-1"));
+
+    const auto too_large = cache.insert(key(bytes(1u, 5u), 0u), bytes(1001u, 5u));
+    EXPECT_EQ(Error::EntryTooLarge, too_large.error());
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(Cache, IgnoresIndexWithCorruptCount) {
+    const auto directory = cache_directory("corrupt");
+    const auto input = bytes(64u, 1u);
+
+    {
+        auto cache = Cache{directory, 1024u};
+        ASSERT_TRUE(cache.insert(key(input, 7u), bytes(100u, 2u)));
+    }
+
+    // NOTE(garrett): Claims far more records than the file holds
+    {
+        auto file = std::fstream{
+            directory / "index",
+            std::ios::binary | std::ios::in | std::ios::out
+        };
+        const auto count = std::uint64_t{1u} << 60u;
+
+        file.seekp(4 * sizeof(std::uint64_t));
+        file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    }
+
+    auto cache = Cache{directory, 1024u};
+    EXPECT_FALSE(cache.find(key(input, 7u)));
+    EXPECT_EQ(0u, cache.count());
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(Cache, IgnoresRecordsPastTheEndOfThePack) {
+    const auto directory = cache_directory("wrapping");
+    const auto input = bytes(64u, 1u);
+
+    {
+        auto cache = Cache{directory, 1024u};
+        ASSERT_TRUE(cache.insert(key(input, 7u), bytes(100u, 2u)));
+    }
+
+    // NOTE(garrett): An offset and size that wrap around to within the pack
+    {
+        auto file = std::fstream{
+            directory / "index",
+            std::ios::binary | std::ios::in | std::ios::out
+        };
+        const auto offset = ~std::uint64_t{0u};
+        const auto size = std::uint64_t{2u};
+
+        file.seekp(7 * sizeof(std::uint64_t));
+        file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+        file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    }
+
+    auto cache = Cache{directory, 1024u};
+    EXPECT_FALSE(cache.find(key(input, 7u)));
+    EXPECT_EQ(0u, cache.count());
+
+    std::filesystem::remove_all(directory);
+}
+
+} // namespace kh::cache
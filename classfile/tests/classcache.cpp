@@ -0,0 +1,144 @@
+#include <fstream>
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "classcache.h"
+#include "serialization.h"
+#include "sinks.h"
+
+namespace kh::jvm::classcache {
+
+namespace {
+
+class Classes {
+private:
+    std::filesystem::path directory_;
+public:
+    explicit Classes(const std::size_t count)
+            : directory_(
+                std::filesystem::temp_directory_path()
+                    / ("kh-classcache-" + std::to_string(::getpid()))
+            ) {
+        std::filesystem::remove_all(directory_);
+        std::filesystem::create_directories(directory_);
+
+        static const auto superclass_name = std::string{"java/lang/Object"};
+
+        for (auto i = 0uz; i < count; ++i) {
+            const auto name = "C" + std::to_string(i);
+            const auto klass = classfile::ClassFile{name, superclass_name};
+
+            kh::sinks::VectorSink sink{};
+            serialization::serialize(sink, klass);
+            const auto bytes = sink.take();
+
+            auto file = std::ofstream{path(i), std::ios::binary};
+            file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        }
+    }
+
+    ~Classes() {
+        std::filesystem::remove_all(directory_);
+    }
+
+    auto path(const std::size_t index) const -> std::filesystem::path {
+        return directory_ / ("C" + std::to_string(index) + ".class");
+    }
+};
+
+// NOTE(garrett): Every class written here has much the same footprint
+auto class_size(const Classes& classes) -> std::size_t {
+    auto loaded = parsing::load_class_from_file(classes.path(0u)).value();
+    loaded.class_file.constant_pool.index_text();
+
+    return footprint(loaded) + 8u;
+}
+
+} // namespace
+
+TEST(ClassCache, CountsTheTextIndex) {
+    const auto classes = Classes{1u};
+    auto loaded = parsing::load_class_from_file(classes.path(0u)).value();
+    const auto unindexed = footprint(loaded);
+
+    loaded.class_file.constant_pool.index_text();
+    EXPECT_LT(unindexed, footprint(loaded));
+
+    auto cache = ClassCache{class_size(classes)};
+    cache.load(classes.path(0u)).value();
+
+    EXPECT_EQ(footprint(loaded), cache.size());
+}
+
+TEST(ClassCache, RepeatedQueriesHit) {
+    const auto classes = Classes{8u};
+    auto cache = ClassCache{class_size(classes) * 8u};
+
+    auto first = std::vector<const parsing::LoadedClass*>{};
+
+    for (auto i = 0uz; i < 8u; ++i) {
+        first.push_back(cache.load(classes.path(i)).value().get());
+    }
+
+    for (auto round = 0u; round < 3u; ++round) {
+        for (auto i = 0uz; i < 8u; ++i) {
+            EXPECT_EQ(first[i], cache.load(classes.path(i)).value().get());
+        }
+    }
+
+    EXPECT_EQ(8u, cache.misses());
+    EXPECT_EQ(24u, cache.hits());
+    EXPECT_EQ(8u, cache.count());
+    EXPECT_LE(cache.size(), class_size(classes) * 8u);
+}
+
+TEST(ClassCache, ResistsScans) {
+    const auto classes = Classes{40u};
+    auto cache = ClassCache{class_size(classes) * 6u};
+
+    // NOTE(garrett): A working set used throughout a pass over far more
+    // classes than fit, each of which is only loaded once
+    for (auto i = 0uz; i < 3u; ++i) {
+        cache.load(classes.path(i)).value();
+        cache.load(classes.path(i)).value();
+    }
+
+    for (auto i = 3uz; i < 40u; ++i) {
+        cache.load(classes.path(i)).value();
+        ASSERT_LE(cache.size(), class_size(classes) * 6u);
+    }
+
+    const auto misses = cache.misses();
+
+    for (auto i = 0uz; i < 3u; ++i) {
+        cache.load(classes.path(i)).value();
+    }
+
+    EXPECT_EQ(misses, cache.misses());
+}
+
+TEST(ClassCache, PinsClassesInUse) {
+    const auto classes = Classes{16u};
+    auto cache = ClassCache{class_size(classes) * 2u};
+
+    const auto pinned = cache.load(classes.path(0u)).value();
+
+    for (auto i = 1uz; i < 16u; ++i) {
+        cache.load(classes.path(i)).value();
+    }
+
+    const auto misses = cache.misses();
+
+    EXPECT_EQ(pinned, cache.load(classes.path(0u)).value());
+    EXPECT_EQ(misses, cache.misses());
+    EXPECT_LE(cache.size(), class_size(classes) * 2u);
+
+    cache.invalidate(classes.path(0u));
+
+    EXPECT_NE(pinned, cache.load(classes.path(0u)).value());
+    EXPECT_EQ(misses + 1u, cache.misses());
+}
+
+} // namespace kh::jvm::classcache
@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "classindex.h"
+#include "jar.h"
+#include "tests/helpers.h"
+
+namespace kh::jvm::classindex {
+
+namespace {
+
+using fixtures::write_file;
+
+auto class_bytes(
+        const std::string_view name,
+        const std::string_view superclass = "java/lang/Object") -> std::vector<std::byte> {
+    return fixtures::built_class_bytes(name, superclass, {"java/lang/Runnable"});
+}
+
+auto write_jar(
+        const std::filesystem::path& path,
+        const std::vector<std::pair<std::string, jar::Compression>>& classes) -> void {
+    auto pool = kh::threading::ThreadPool{1u};
+    auto file = std::fopen(path.c_str(), "wb");
+    ASSERT_NE(nullptr, file);
+
+    auto writer = jar::Writer{::fileno(file), pool};
+    ASSERT_TRUE(writer.add("META-INF/MANIFEST.MF", {}));
+
+    for (const auto& [name, compression] : classes) {
+        ASSERT_TRUE(writer.add(name + ".class", class_bytes(name), compression));
+    }
+
+    ASSERT_TRUE(writer.finish());
+    std::fclose(file);
+}
+
+// NOTE(garrett): Makes changes visible whatever the timestamp resolution
+auto touch(const std::filesystem::path& path) -> void {
+    std::filesystem::last_write_time(
+        path,
+        std::filesystem::last_write_time(path) + std::chrono::seconds{2}
+    );
+}
+
+class Classpath {
+private:
+    std::filesystem::path directory_;
+public:
+    Classpath()
+            : directory_(
+                std::filesystem::temp_directory_path()
+                    / ("kh-classindex-" + std::to_string(::getpid()))
+            ) {
+        std::filesystem::remove_all(directory_);
+        std::filesystem::create_directories(directory_ / "classes");
+
+        write_jar(directory_ / "library.jar", {
+            {"lib/Stored", jar::Compression::Stored},
+            {"lib/Deflated", jar::Compression::Deflated},
+            {"app/Main", jar::Compression::Deflated}
+        });
+
+        write_file(directory_ / "classes/app/Main.class", class_bytes("app/Main"));
+        write_file(directory_ / "classes/app/Helper.class", class_bytes("app/Helper", "app/Main"));
+    }
+
+    ~Classpath() {
+        std::filesystem::remove_all(directory_);
+    }
+
+    auto path(const std::string_view name) const -> std::filesystem::path {
+        return directory_ / name;
+    }
+
+    auto elements() const -> std::vector<std::filesystem::path> {
+        return {directory_ / "classes", directory_ / "library.jar", directory_ / "missing.jar"};
+    }
+};
+
+} // namespace
+
+TEST(ClassIndex, IndexesJarsAndDirectories) {
+    const auto classpath = Classpath{};
+    const auto bytes = build(classpath.elements());
+    const auto index = Index::view(bytes);
+
+    ASSERT_TRUE(index);
+    EXPECT_EQ(5u, index->size());
+
+    const auto helper = index->find("app/Helper");
+
+    ASSERT_TRUE(helper);
+    EXPECT_EQ("app/Main", helper->superclass);
+    ASSERT_EQ(1u, helper->interface_count);
+    EXPECT_EQ("java/lang/Runnable", index->interface(helper.value(), 0u));
+    ASSERT_EQ(1u, helper->method_count);
+    EXPECT_EQ("run", index->method(helper.value(), 0u).name);
+    EXPECT_EQ("()V", index->method(helper.value(), 0u).descriptor);
+    EXPECT_EQ("", index->interface(helper.value(), 1u));
+
+    // NOTE(garrett): The directory comes first on the classpath, so its copy
+    // of the class is the one found
+    const auto main = index->find("app/Main");
+
+    ASSERT_TRUE(main);
+    EXPECT_EQ(classpath.path("classes/app/Main.class").string(), index->file(main->file).path);
+    EXPECT_EQ(0u, main->offset);
+    EXPECT_EQ(std::filesystem::file_size(classpath.path("classes/app/Main.class")), main->size);
+
+    const auto archive = jar::Archive::open(classpath.path("library.jar"));
+    ASSERT_TRUE(archive);
+
+    for (const auto name : {"lib/Stored", "lib/Deflated"}) {
+        const auto klass = index->find(name);
+        const auto& entry = archive->entries()[archive->find(std::string{name} + ".class").value()];
+
+        ASSERT_TRUE(klass) << name;
+        EXPECT_EQ(classpath.path("library.jar").string(), index->file(klass->file).path);
+        EXPECT_EQ(static_cast<std::uint16_t>(entry.compression), klass->compression);
+        EXPECT_EQ(entry.offset, klass->offset);
+        EXPECT_EQ(entry.compressed_size, klass->stored_size);
+        EXPECT_EQ(entry.size, klass->size);
+    }
+
+    EXPECT_FALSE(index->find("app/Missing"));
+    EXPECT_FALSE(index->find("META-INF/MANIFEST"));
+    EXPECT_TRUE(index->changed().empty());
+}
+
+TEST(ClassIndex, RefreshesIncrementally) {
+    const auto classpath = Classpath{};
+    const auto path = classpath.path("classpath.index");
+
+    ASSERT_TRUE(write(path, build(classpath.elements())));
+
+    auto index = Index::open(path);
+
+    ASSERT_TRUE(index);
+    EXPECT_TRUE(index->changed().empty());
+
+    // NOTE(garrett): A jar rewritten with the same contents, a class changed in
+    // place and a class added in a new package
+    const auto jar = classpath.path("library.jar");
+    auto contents = std::vector<std::byte>(std::filesystem::file_size(jar));
+    std::ifstream{jar, std::ios::binary}.read(
+        reinterpret_cast<char*>(contents.data()),
+        static_cast<std::streamsize>(contents.size())
+    );
+
+    write_file(jar, contents);
+    touch(jar);
+
+    const auto helper = classpath.path("classes/app/Helper.class");
+    write_file(helper, class_bytes("app/Helper", "lib/Stored"));
+    touch(helper);
+
+    write_file(classpath.path("classes/app/extra/Added.class"), class_bytes("app/extra/Added"));
+    touch(classpath.path("classes/app"));
+
+    auto changed = std::vector<std::string>{};
+
+    for (const auto file : index->changed()) {
+        changed.emplace_back(index->file(file).path);
+    }
+
+    std::ranges::sort(changed);
+
+    EXPECT_EQ(
+        (std::vector{classpath.path("classes/app").string(), helper.string(), jar.string()}),
+        changed
+    );
+
+    ASSERT_TRUE(write(path, build(classpath.elements(), &index.value())));
+    index = Index::open(path);
+
+    ASSERT_TRUE(index);
+    EXPECT_TRUE(index->changed().empty());
+    EXPECT_EQ(6u, index->size());
+    EXPECT_TRUE(index->find("app/extra/Added"));
+    EXPECT_EQ("lib/Stored", index->find("app/Helper")->superclass);
+
+    const auto deflated = index->find("lib/Deflated");
+
+    ASSERT_TRUE(deflated);
+    EXPECT_EQ(jar.string(), index->file(deflated->file).path);
+    EXPECT_EQ("run", index->method(deflated.value(), 0u).name);
+}
+
+TEST(ClassIndex, RejectsInvalidIndexes) {
+    const auto classpath = Classpath{};
+    auto bytes = build(classpath.elements());
+
+    EXPECT_EQ(Error::InvalidIndex, Index::view(std::span{bytes}.first(16u)).error());
+    EXPECT_EQ(Error::InvalidIndex, Index::view(std::span{bytes}.first(bytes.size() - 1u)).error());
+    EXPECT_EQ(Error::ReadFailed, Index::open(classpath.path("missing.index")).error());
+
+    bytes[8] = std::byte{2u};
+    EXPECT_EQ(Error::UnsupportedVersion, Index::view(bytes).error());
+
+    bytes[0] = std::byte{0u};
+    EXPECT_EQ(Error::InvalidIndex, Index::view(bytes).error());
+}
+
+TEST(ClassIndex, ClampsOutOfRangeRecords) {
+    const auto classpath = Classpath{};
+    auto bytes = build(classpath.elements());
+    const auto file_count = Index::view(bytes)->file_count();
+
+    // NOTE(garrett): Header, then file records whose last two fields are the
+    // first class and class count
+    constexpr auto header_size = 40uz;
+    constexpr auto file_size = 40uz;
+
+    for (auto i = 0uz; i < file_count; ++i) {
+        const auto range = std::to_array<std::uint32_t>({0xFFFFFFF0u, 0xFFFFFFFFu});
+        std::memcpy(bytes.data() + header_size + i * file_size + 32u, range.data(), 8u);
+    }
+
+    const auto index = Index::view(bytes);
+    ASSERT_TRUE(index);
+
+    for (auto i = 0uz; i < index->file_count(); ++i) {
+        const auto file = index->file(i);
+        EXPECT_LE(std::uint64_t{file.first_class} + file.class_count, index->size());
+    }
+
+    EXPECT_TRUE(index->file(index->file_count()).path.empty());
+    EXPECT_TRUE(index->entry(index->size()).name.empty());
+
+    // NOTE(garrett): Carrying the damaged files over mustn't read past the end
+    const auto rebuilt = build(classpath.elements(), &index.value());
+    EXPECT_TRUE(Index::view(rebuilt));
+}
+
+} // namespace kh::jvm::classindex
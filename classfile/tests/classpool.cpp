@@ -0,0 +1,98 @@
+#include "gtest/gtest.h"
+
+#include "classpool.h"
+#include "tests/helpers.h"
+#include "views.h"
+
+namespace kh::jvm::classpool {
+
+namespace {
+
+// NOTE(garrett): Overloads of `run` share their name within the class too
+auto class_bytes(
+        const std::string_view name,
+        const std::string_view superclass = "java/lang/Object") -> std::vector<std::byte> {
+    return fixtures::built_class_bytes(name, superclass, {}, {"()V", "(I)V"});
+}
+
+} // namespace
+
+TEST(ClassPool, InternsTextAcrossClasses) {
+    auto pool = ClassPool{};
+
+    const auto* base = pool.add(class_bytes("a/Base")).value();
+    const auto* derived = pool.add(class_bytes("a/Derived", "a/Base")).value();
+
+    ASSERT_EQ(2u, pool.size());
+    EXPECT_EQ(pool.symbols().find("java/lang/Object"), base->superclass);
+    EXPECT_EQ(base->name, derived->superclass);
+    EXPECT_NE(base->name, derived->name);
+    EXPECT_EQ("a/Derived", pool.symbols().text(derived->name));
+
+    // NOTE(garrett): Text shared by both classes is interned once
+    const auto before = pool.symbols().size();
+    pool.add(class_bytes("a/Other", "a/Derived")).value();
+    EXPECT_EQ(before + 1u, pool.symbols().size());
+
+    EXPECT_EQ(no_symbol, base->symbols[0]);
+    EXPECT_EQ(no_symbol, base->symbols[base->class_file.class_index]);
+}
+
+TEST(ClassPool, FindsClassesBySymbol) {
+    auto pool = ClassPool{};
+
+    const auto* base = pool.add(class_bytes("a/Base")).value();
+    const auto* derived = pool.add(class_bytes("a/Derived", "a/Base")).value();
+
+    EXPECT_EQ(base, pool.find("a/Base"));
+    EXPECT_EQ(derived, pool.find(derived->name));
+    EXPECT_EQ(base, pool.superclass(*derived));
+    EXPECT_EQ(nullptr, pool.superclass(*base));
+    EXPECT_EQ(nullptr, pool.find("java/lang/Object"));
+    EXPECT_EQ(nullptr, pool.find("a/Missing"));
+    EXPECT_EQ(nullptr, pool.find(no_symbol));
+
+    // NOTE(garrett): Rejected classes leave nothing interned behind
+    const auto symbols = pool.symbols().size();
+
+    EXPECT_EQ(Error::DuplicateClass, pool.add(class_bytes("a/Base", "a/Fresh")).error());
+    EXPECT_EQ(symbols, pool.symbols().size());
+    EXPECT_FALSE(pool.symbols().find("a/Fresh"));
+    EXPECT_EQ(Error::ParseFailed, pool.add(std::vector<std::byte>(16u)).error());
+    EXPECT_EQ(2u, pool.size());
+    EXPECT_EQ(base, pool.find("a/Base"));
+}
+
+TEST(ClassPool, FindsMethodsBySymbol) {
+    auto pool = ClassPool{};
+
+    const auto* klass = pool.add(class_bytes("a/Base")).value();
+    const auto run = pool.symbols().find("run").value();
+    const auto descriptor = pool.symbols().find("(I)V").value();
+
+    const auto* any = find_method(*klass, run);
+    const auto* overload = find_method(*klass, run, descriptor);
+
+    ASSERT_NE(nullptr, any);
+    ASSERT_NE(nullptr, overload);
+    EXPECT_EQ(&klass->class_file.methods[0], any);
+    EXPECT_EQ(&klass->class_file.methods[1], overload);
+    EXPECT_EQ(nullptr, find_method(*klass, descriptor));
+    EXPECT_EQ(nullptr, find_method(*klass, run, run));
+}
+
+TEST(ClassPool, ViewsLookUpMethodsBySymbol) {
+    auto pool = ClassPool{};
+
+    const auto* klass = pool.add(class_bytes("a/Base")).value();
+    const auto view = views::ClassView{*klass, pool.symbols()};
+
+    const auto run = view.method("run");
+
+    ASSERT_TRUE(run);
+    EXPECT_EQ(&klass->class_file.methods[0], &run->method);
+    EXPECT_FALSE(view.method("missing"));
+    EXPECT_FALSE(view.method("(I)V"));
+}
+
+} // namespace kh::jvm::classpool
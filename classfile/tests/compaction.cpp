@@ -0,0 +1,217 @@
+#include <algorithm>
+
+#include "gtest/gtest.h"
+
+#include "bytecode.h"
+#include "compaction.h"
+#include "parsing.h"
+#include "serialization.h"
+#include "views.h"
+
+namespace kh::jvm::compaction {
+
+namespace {
+
+using bytecode::Opcode;
+
+auto big_endian(const std::uint16_t value) -> std::array<std::byte, 2> {
+    return {static_cast<std::byte>(value >> 8), static_cast<std::byte>(value & 0xFF)};
+}
+
+// NOTE(garrett): Builds a class whose pool has unused entries ahead of
+// everything the method and debug attributes refer to, so compaction has to
+// renumber all of them.
+auto example_class(arena::Arena& arena) -> classfile::ClassFile {
+    static const auto class_name = std::string{"Example"};
+    static const auto superclass_name = std::string{"java/lang/Object"};
+    auto klass = classfile::ClassFile{class_name, superclass_name};
+    auto& pool = klass.constant_pool;
+
+    pool.try_add_utf8_entry("Unused");
+    pool.add(constant_pool::LongEntry{42u});
+    pool.try_add_class_entry("example/Unused");
+
+    const auto greeting = static_cast<std::uint8_t>(pool.try_add_string_entry("hello"));
+    const auto helper = static_cast<std::uint16_t>(
+        pool.try_add_method_reference("Example", "helper", "()V")
+    );
+
+    auto assembler = bytecode::Assembler{};
+    assembler.op(Opcode::LDC, greeting)
+        .op(Opcode::POP)
+        .op(Opcode::INVOKESTATIC, helper)
+        .op(Opcode::RETURN);
+
+    const auto bytecode = arena.store(assembler.take());
+
+    // NOTE(garrett): A single entry mapping offset 0 to line 7
+    auto line_numbers = std::vector<std::byte>{
+        std::byte{0x00}, std::byte{0x01},
+        std::byte{0x00}, std::byte{0x00},
+        std::byte{0x00}, std::byte{0x07}
+    };
+
+    const auto code = code::Code{
+        .max_stack = 1u,
+        .max_locals = 0u,
+        .bytecode = bytecode,
+        .exception_table = std::vector<code::ExceptionHandler>{},
+        .attributes = std::vector<attribute::Attribute>{
+            attribute::Attribute{
+                static_cast<std::uint16_t>(pool.try_add_utf8_entry("LineNumberTable")),
+                arena.store(std::move(line_numbers))
+            }
+        }
+    };
+
+    kh::sinks::VectorSink sink{};
+    serialization::serialize(sink, code);
+
+    klass.methods.push_back(
+        method::Method{
+            .access_flags = static_cast<std::uint16_t>(method::AccessFlags::ACC_STATIC),
+            .name_index = static_cast<std::uint16_t>(pool.try_add_utf8_entry("run")),
+            .descriptor_index = static_cast<std::uint16_t>(pool.try_add_utf8_entry("()V")),
+            .attributes = std::vector<attribute::Attribute>{
+                attribute::Attribute{
+                    static_cast<std::uint16_t>(pool.try_add_utf8_entry("Code")),
+                    arena.store(sink.take())
+                }
+            }
+        }
+    );
+
+    const auto source_file = big_endian(
+        static_cast<std::uint16_t>(pool.try_add_utf8_entry("Example.java"))
+    );
+
+    klass.attributes.push_back(
+        attribute::Attribute{
+            static_cast<std::uint16_t>(pool.try_add_utf8_entry("SourceFile")),
+            arena.store(std::vector<std::byte>{source_file.begin(), source_file.end()})
+        }
+    );
+
+    return klass;
+}
+
+auto code_of(const views::MethodView& method) -> code::Code {
+    auto reader = kh::reader::Reader{method.attribute("Code").value().attribute.data};
+    return parsing::parse_code(reader).value();
+}
+
+auto operand(std::span<const std::byte> bytecode, const std::size_t offset) -> std::uint16_t {
+    return static_cast<std::uint16_t>(
+        (std::to_integer<std::uint16_t>(bytecode[offset]) << 8)
+            | std::to_integer<std::uint16_t>(bytecode[offset + 1])
+    );
+}
+
+auto has_text(const constant_pool::ConstantPool& pool, std::string_view text) -> bool {
+    return std::ranges::any_of(pool.entries(), [text](const auto& entry) {
+        const auto* utf8 = std::get_if<constant_pool::UTF8Entry>(&entry);
+        return utf8 && utf8->text == text;
+    });
+}
+
+} // namespace
+
+TEST(Compaction, RemovesUnusedEntriesAndRenumbers) {
+    auto arena = arena::Arena{};
+    auto klass = example_class(arena);
+    const auto original_count = klass.constant_pool.count();
+
+    const auto statistics = compact(klass, arena);
+
+    ASSERT_TRUE(statistics);
+    EXPECT_EQ(4u, statistics->removed_entries);
+    EXPECT_EQ(0u, statistics->removed_attributes);
+    EXPECT_EQ(original_count - 5u, klass.constant_pool.count());
+    EXPECT_FALSE(has_text(klass.constant_pool, "Unused"));
+
+    const auto& pool = klass.constant_pool;
+    const auto view = views::ClassView{klass};
+
+    EXPECT_EQ("Example", view.name());
+    EXPECT_EQ("java/lang/Object", view.superclass());
+
+    const auto method = view.method("run");
+    ASSERT_TRUE(method);
+
+    const auto code = code_of(method.value());
+    const auto& string = pool.resolve<constant_pool::StringEntry>(
+        std::to_integer<std::uint16_t>(code.bytecode[1])
+    );
+
+    EXPECT_EQ("hello", pool.resolve<constant_pool::UTF8Entry>(string.string_index).text);
+
+    const auto& helper = pool.resolve<constant_pool::MethodReferenceEntry>(
+        operand(code.bytecode, 4u)
+    );
+    const auto& name_and_type = pool.resolve<constant_pool::NameAndTypeEntry>(
+        helper.name_and_type_index
+    );
+
+    EXPECT_EQ("helper", pool.resolve<constant_pool::UTF8Entry>(name_and_type.name_index).text);
+    ASSERT_EQ(1u, code.attributes.size());
+    EXPECT_EQ(
+        "LineNumberTable",
+        pool.resolve<constant_pool::UTF8Entry>(code.attributes[0].name_index).text
+    );
+
+    EXPECT_EQ(
+        "Example.java",
+        pool.resolve<constant_pool::UTF8Entry>(operand(klass.attributes[0].data, 0u)).text
+    );
+
+    kh::sinks::VectorSink sink{};
+    serialization::serialize(sink, klass);
+
+    auto reader = kh::reader::Reader{sink.view()};
+    EXPECT_TRUE(parsing::parse_class_file(reader));
+
+    const auto again = compact(klass, arena);
+
+    ASSERT_TRUE(again);
+    EXPECT_EQ(0u, again->removed_entries);
+}
+
+TEST(Compaction, StripsDebugAttributes) {
+    auto arena = arena::Arena{};
+    auto klass = example_class(arena);
+
+    const auto statistics = compact(klass, arena, Options{.strip_debug_info = true});
+
+    ASSERT_TRUE(statistics);
+    EXPECT_EQ(2u, statistics->removed_attributes);
+    EXPECT_TRUE(klass.attributes.empty());
+    EXPECT_FALSE(has_text(klass.constant_pool, "SourceFile"));
+    EXPECT_FALSE(has_text(klass.constant_pool, "Example.java"));
+    EXPECT_FALSE(has_text(klass.constant_pool, "LineNumberTable"));
+
+    const auto method = views::ClassView{klass}.method("run");
+
+    ASSERT_TRUE(method);
+    EXPECT_TRUE(code_of(method.value()).attributes.empty());
+}
+
+TEST(Compaction, LeavesUnknownAttributesAlone) {
+    auto arena = arena::Arena{};
+    auto klass = example_class(arena);
+    const auto original_count = klass.constant_pool.count();
+
+    klass.attributes.push_back(
+        attribute::Attribute{
+            static_cast<std::uint16_t>(klass.constant_pool.try_add_utf8_entry("Custom")),
+            std::span<const std::byte>{}
+        }
+    );
+
+    const auto statistics = compact(klass, arena);
+
+    ASSERT_FALSE(statistics);
+    EXPECT_EQ(Error::UnsupportedAttribute, statistics.error());
+    EXPECT_EQ(original_count + 1u, klass.constant_pool.count());
+}
+
+} // namespace kh::jvm::compaction
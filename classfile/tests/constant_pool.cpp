@@ -67,4 +67,17 @@ TEST(ConstantPool, AddingNewUTF8EntryCachesAppropriately) {
     ASSERT_EQ(2uz, entry_idx);
 }
 
+TEST(ConstantPool, FindsIndexedTextThroughConstReference) {
+    auto pool = ConstantPool{UTF8Entry{"First"}, UTF8Entry{"Second"}};
+    pool.index_text();
+
+    const auto& shared = pool;
+
+    ASSERT_EQ(2uz, shared.find_entry(UTF8Entry{"Second"}));
+    ASSERT_FALSE(shared.find_entry(UTF8Entry{"Third"}));
+
+    pool.add(UTF8Entry{"Third"});
+    ASSERT_EQ(3uz, shared.find_entry(UTF8Entry{"Third"}));
+}
+
 } // namespace kh::jvm::constant_pool
@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "corpus.h"
+#include "jar.h"
+#include "tests/helpers.h"
+#include "views.h"
+
+namespace kh::jvm::corpus {
+
+namespace {
+
+using fixtures::class_bytes;
+using fixtures::write_file;
+
+} // namespace
+
+TEST(Corpus, ParsesDirectoriesAndArchives) {
+    const auto root = std::filesystem::temp_directory_path()
+        / ("kh-corpus-" + std::to_string(::getpid()));
+
+    std::filesystem::remove_all(root);
+
+    for (auto i = 0u; i < 20u; ++i) {
+        const auto name = "p" + std::to_string(i % 4u) + "/C" + std::to_string(i);
+        write_file(root / "classes" / (name + ".class"), class_bytes(name));
+    }
+
+    write_file(root / "classes" / "Broken.class", std::as_bytes(std::span{"broken", 6u}));
+    write_file(root / "Single.class", class_bytes("Single"));
+
+    auto pool = kh::threading::ThreadPool{4u};
+
+    {
+        auto file = std::fopen((root / "library.jar").c_str(), "wb");
+        ASSERT_NE(nullptr, file);
+
+        auto writer = jar::Writer{::fileno(file), pool};
+
+        ASSERT_TRUE(writer.add("META-INF/MANIFEST.MF", {}));
+        ASSERT_TRUE(writer.add("a/Archived.class", class_bytes("a/Archived")));
+        ASSERT_TRUE(writer.finish());
+
+        std::fclose(file);
+    }
+
+    const auto inputs = std::to_array<std::filesystem::path>({
+        root / "classes",
+        root / "Single.class",
+        root / "library.jar",
+        root / "missing.jar"
+    });
+
+    auto mutex = std::mutex{};
+    auto seen = std::vector<std::pair<std::size_t, std::string>>{};
+
+    const auto report = parse(inputs, pool, [&](const Source& source, auto& klass, auto&) {
+        const auto lock = std::lock_guard{mutex};
+
+        if (klass) {
+            EXPECT_EQ(
+                std::string{source.name}.substr(0u, source.name.size() - 6u),
+                views::ClassView{klass.value()}.name()
+            );
+        }
+
+        seen.emplace_back(source.input, std::string{source.name});
+    });
+
+    std::filesystem::remove_all(root);
+
+    EXPECT_EQ(22u, report.classes);
+    EXPECT_EQ(2u, report.failures);
+    EXPECT_LT(0u, report.bytes);
+
+    std::ranges::sort(seen);
+
+    ASSERT_EQ(23u, seen.size());
+    EXPECT_EQ((std::pair<std::size_t, std::string>{0u, "Broken.class"}), seen[0]);
+    EXPECT_EQ((std::pair<std::size_t, std::string>{0u, "p0/C0.class"}), seen[1]);
+    EXPECT_EQ((std::pair<std::size_t, std::string>{1u, "Single.class"}), seen[21]);
+    EXPECT_EQ((std::pair<std::size_t, std::string>{2u, "a/Archived.class"}), seen[22]);
+}
+
+} // namespace kh::jvm::corpus
@@ -0,0 +1,26 @@
+#include <string_view>
+
+#include "gtest/gtest.h"
+
+#include "hashing.h"
+
+namespace kh::hashing {
+
+namespace {
+
+auto xxh64(const std::string_view text, const std::uint64_t seed = 0u) -> std::uint64_t {
+    return hashing::xxh64(std::as_bytes(std::span{text}), seed);
+}
+
+} // namespace
+
+TEST(Hashing, MatchesReferenceXxh64) {
+    EXPECT_EQ(0xEF46DB3751D8E999u, xxh64(""));
+    EXPECT_EQ(0xD24EC4F1A98C6E5Bu, xxh64("a"));
+    EXPECT_EQ(0x44BC2CF5AD770999u, xxh64("abc"));
+    EXPECT_EQ(0xFBCEA83C8A378BF1u, xxh64("Nobody inspects the spammish repetition"));
+
+    EXPECT_NE(xxh64("abc"), xxh64("abc", 1u));
+}
+
+} // namespace kh::hashing
@@ -1,8 +1,24 @@
 #ifndef HELPERS_H
 #define HELPERS_H
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include "gmock/gmock.h"
 
+#include "arena.h"
+#include "builder.h"
+#include "classfile.h"
+#include "serialization.h"
+#include "sinks.h"
+
 MATCHER_P(EqualsBinary, expected, "Binary elements are equal in size and value") {
     if (arg.size() != expected.size()) {
         *result_listener << "Size of spans did not match: "
@@ -26,4 +42,130 @@ MATCHER_P(EqualsBinary, expected, "Binary elements are equal in size and value")
     return true;
 }
 
+namespace kh::jvm::fixtures {
+
+inline constexpr auto branching_bytecode = std::to_array<const std::byte>({
+    // iload_0, ifeq +5
+    std::byte{0x1A}, std::byte{0x99}, std::byte{0x00}, std::byte{0x05},
+    // iconst_1, ireturn
+    std::byte{0x04}, std::byte{0xAC},
+    // iconst_0, ireturn
+    std::byte{0x03}, std::byte{0xAC}
+});
+
+// NOTE(garrett): An empty class extending `java/lang/Object`
+inline auto class_bytes(const std::string& name) -> std::vector<std::byte> {
+    static const auto superclass_name = std::string{"java/lang/Object"};
+    const auto klass = classfile::ClassFile{name, superclass_name};
+
+    kh::sinks::VectorSink sink{};
+    serialization::serialize(sink, klass);
+
+    return sink.take();
+}
+
+// NOTE(garrett): A class with a public `run` method for each descriptor, none
+// of which do anything but return
+inline auto built_class_bytes(
+        const std::string_view name,
+        const std::string_view superclass = "java/lang/Object",
+        const std::vector<std::string_view>& interfaces = {},
+        const std::vector<std::string_view>& descriptors = {"()V"}) -> std::vector<std::byte> {
+    auto klass = builder::ClassBuilder{name, superclass};
+
+    for (const auto interface : interfaces) {
+        klass.interface(interface);
+    }
+
+    for (const auto descriptor : descriptors) {
+        auto code = bytecode::Assembler{};
+        code.op(bytecode::Opcode::RETURN);
+
+        klass.method(
+            static_cast<std::uint16_t>(method::AccessFlags::ACC_PUBLIC),
+            "run",
+            descriptor,
+            0u,
+            2u,
+            std::move(code)
+        );
+    }
+
+    auto sink = kh::sinks::VectorSink{};
+    klass.write(sink);
+
+    return sink.take();
+}
+
+inline auto write_file(const std::filesystem::path& path, std::span<const std::byte> bytes)
+        -> void {
+    std::filesystem::create_directories(path.parent_path());
+
+    auto file = std::ofstream{path, std::ios::binary};
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+// NOTE(garrett): Frames are encoded against a single int local, which is all
+// that the methods given frames take
+inline auto add_static_method(
+        classfile::ClassFile& klass,
+        arena::Arena& arena,
+        std::string_view name,
+        std::string_view descriptor,
+        std::span<const std::byte> bytecode,
+        const std::vector<stack_map::Frame>& frames = {},
+        const std::uint16_t max_stack = 1u) -> void {
+    auto attributes = std::vector<attribute::Attribute>{};
+
+    if (!frames.empty()) {
+        kh::sinks::VectorSink frame_sink{};
+
+        serialization::serialize(
+            frame_sink,
+            frames,
+            std::vector{stack_map::VerificationType{stack_map::VerificationTag::Integer, 0u}}
+        );
+
+        attributes.push_back(
+            attribute::Attribute{
+                static_cast<std::uint16_t>(
+                    klass.constant_pool.try_add_utf8_entry("StackMapTable")
+                ),
+                arena.store(frame_sink.take())
+            }
+        );
+    }
+
+    const auto code = code::Code{
+        .max_stack = max_stack,
+        .max_locals = 1u,
+        .bytecode = bytecode,
+        .exception_table = std::vector<code::ExceptionHandler>{},
+        .attributes = std::move(attributes)
+    };
+
+    kh::sinks::VectorSink sink{};
+    serialization::serialize(sink, code);
+
+    klass.methods.push_back(
+        method::Method{
+            .access_flags = static_cast<std::uint16_t>(method::AccessFlags::ACC_STATIC),
+            .name_index = static_cast<std::uint16_t>(
+                klass.constant_pool.try_add_utf8_entry(name)
+            ),
+            .descriptor_index = static_cast<std::uint16_t>(
+                klass.constant_pool.try_add_utf8_entry(descriptor)
+            ),
+            .attributes = std::vector<attribute::Attribute>{
+                attribute::Attribute{
+                    static_cast<std::uint16_t>(klass.constant_pool.try_add_utf8_entry("Code")),
+                    arena.store(sink.take())
+                }
+            }
+        }
+    );
+}
+
+} // namespace kh::jvm::fixtures
+
 #endif // HELPERS_H
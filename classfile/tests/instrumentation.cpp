@@ -0,0 +1,321 @@
+#include <algorithm>
+
+#include "gtest/gtest.h"
+
+#include "instrumentation.h"
+#include "parsing.h"
+#include "serialization.h"
+#include "tests/helpers.h"
+#include "views.h"
+
+namespace kh::jvm::instrumentation {
+
+namespace {
+
+using fixtures::add_static_method;
+using fixtures::branching_bytecode;
+
+auto code_of(const views::MethodView& method) -> code::Code {
+    auto reader = kh::reader::Reader{method.attribute("Code").value().attribute.data};
+    return parsing::parse_code(reader).value();
+}
+
+} // namespace
+
+TEST(Instrumentation, AddsLatencyProbesToSelectedMethods) {
+    const auto class_name = std::string{"Example"};
+    const auto superclass_name = std::string{"java/lang/Object"};
+    auto klass = classfile::ClassFile{class_name, superclass_name};
+    auto arena = arena::Arena{};
+
+    add_static_method(klass, arena, "run", "(I)I", branching_bytecode);
+    add_static_method(klass, arena, "skip", "(I)I", branching_bytecode);
+
+    const auto probes = add_latency_probes(
+        klass,
+        arena,
+        LatencyOptions{.methods = {"run"}}
+    );
+
+    ASSERT_TRUE(probes);
+    ASSERT_EQ(1u, probes.value().size());
+    EXPECT_EQ(0u, probes.value().front().method_index);
+    EXPECT_EQ(0u, probes.value().front().slot);
+
+    ASSERT_EQ(1u, klass.fields.size());
+
+    EXPECT_EQ(
+        "$kh$latency",
+        klass.constant_pool.resolve<constant_pool::UTF8Entry>(
+            klass.fields.front().name_index
+        ).text
+    );
+
+    const auto view = views::ClassView{klass};
+    ASSERT_TRUE(view.method("<clinit>"));
+
+    const auto run = code_of(view.method("run").value());
+
+    EXPECT_EQ(3u, run.max_locals);
+
+    // NOTE(garrett): One stretch before each return, with both exit probes
+    // left uncovered
+    ASSERT_EQ(2u, run.exception_table.size());
+    EXPECT_EQ(0u, run.exception_table.front().catch_type);
+    EXPECT_EQ(5u, run.exception_table.front().start_pc);
+    EXPECT_LT(run.exception_table.front().end_pc, run.exception_table.back().start_pc);
+    EXPECT_EQ(run.exception_table.back().start_pc + 1u, run.exception_table.back().end_pc);
+
+    EXPECT_EQ(
+        run.exception_table.front().handler_pc,
+        run.exception_table.back().handler_pc
+    );
+    EXPECT_EQ(std::byte{0xB8}, run.bytecode.front());
+    EXPECT_EQ(std::byte{0xBF}, run.bytecode.back());
+
+    const auto skip = code_of(view.method("skip").value());
+    EXPECT_EQ(branching_bytecode.size(), skip.bytecode.size());
+}
+
+TEST(Instrumentation, ProbesRepeatedLatencyMethodsOnce) {
+    const auto class_name = std::string{"Example"};
+    const auto superclass_name = std::string{"java/lang/Object"};
+    auto klass = classfile::ClassFile{class_name, superclass_name};
+    auto arena = arena::Arena{};
+
+    add_static_method(klass, arena, "run", "(I)I", branching_bytecode);
+
+    const auto probes = add_latency_probes(
+        klass,
+        arena,
+        LatencyOptions{.methods = {"run", "run"}}
+    );
+
+    ASSERT_TRUE(probes);
+    ASSERT_EQ(1u, probes.value().size());
+
+    const auto run = code_of(views::ClassView{klass}.method("run").value());
+    EXPECT_EQ(2u, run.exception_table.size());
+}
+
+TEST(Instrumentation, InstrumentedClassRoundTrips) {
+    const auto class_name = std::string{"Example"};
+    const auto superclass_name = std::string{"java/lang/Object"};
+    auto klass = classfile::ClassFile{class_name, superclass_name};
+    auto arena = arena::Arena{};
+
+    add_static_method(klass, arena, "run", "(I)I", branching_bytecode);
+    ASSERT_TRUE(add_latency_probes(klass, arena, LatencyOptions{.methods = {"run"}}));
+
+    kh::sinks::VectorSink sink{};
+    serialization::serialize(sink, klass);
+
+    auto reader = kh::reader::Reader{sink.view()};
+    const auto parsed = parsing::parse_class_file(reader);
+
+    ASSERT_TRUE(parsed);
+    EXPECT_EQ(klass.constant_pool.count(), parsed.value().constant_pool.count());
+    EXPECT_EQ(1u, parsed.value().fields.size());
+    EXPECT_EQ(2u, parsed.value().methods.size());
+}
+
+TEST(Instrumentation, SamplesAllocationSites) {
+    const auto class_name = std::string{"Example"};
+    const auto superclass_name = std::string{"java/lang/Object"};
+    auto klass = classfile::ClassFile{class_name, superclass_name};
+    auto arena = arena::Arena{};
+
+    const auto object_class = static_cast<std::uint8_t>(
+        klass.constant_pool.try_add_class_entry("java/lang/Object")
+    );
+
+    const auto allocating_bytecode = std::to_array<const std::byte>({
+        // new java/lang/Object, pop
+        std::byte{0xBB}, std::byte{0x00}, std::byte{object_class}, std::byte{0x57},
+        // iconst_5, newarray int, pop
+        std::byte{0x08}, std::byte{0xBC}, std::byte{0x0A}, std::byte{0x57},
+        // return
+        std::byte{0xB1}
+    });
+
+    add_static_method(klass, arena, "run", "()V", allocating_bytecode);
+
+    const auto sites = add_allocation_sampling(
+        klass,
+        arena,
+        AllocationOptions{.callback_class = "example/Profiler"}
+    );
+
+    ASSERT_TRUE(sites);
+    ASSERT_EQ(2u, sites.value().size());
+    EXPECT_EQ(0u, sites.value()[0].bci);
+    EXPECT_EQ(bytecode::Opcode::NEW, sites.value()[0].opcode);
+    EXPECT_EQ(object_class, sites.value()[0].type);
+    EXPECT_EQ(5u, sites.value()[1].bci);
+    EXPECT_EQ(bytecode::Opcode::NEWARRAY, sites.value()[1].opcode);
+    EXPECT_EQ(10u, sites.value()[1].type);
+
+    // NOTE(garrett): The striped countdowns live in a final array that the
+    // class initializer allocates
+    ASSERT_EQ(1u, klass.fields.size());
+    EXPECT_NE(0u, klass.fields.front().access_flags & 0x0010u);
+
+    const auto view = views::ClassView{klass};
+    ASSERT_TRUE(view.method("$kh$allocation"));
+    ASSERT_TRUE(view.method("<clinit>"));
+
+    EXPECT_EQ(
+        "[I",
+        klass.constant_pool.resolve<constant_pool::UTF8Entry>(
+            klass.fields.front().descriptor_index
+        ).text
+    );
+
+    const auto run = code_of(view.method("run").value());
+    EXPECT_EQ(3u, run.max_stack);
+
+    const auto instructions = bytecode::decode(run.bytecode);
+    ASSERT_TRUE(instructions);
+
+    const auto samples = std::ranges::count_if(
+        instructions.value(),
+        [](const auto& instruction) {
+            return instruction.opcode == bytecode::Opcode::INVOKESTATIC;
+        }
+    );
+
+    EXPECT_EQ(2, samples);
+
+    const auto again = add_allocation_sampling(
+        klass,
+        arena,
+        AllocationOptions{.callback_class = "example/Profiler"}
+    );
+
+    ASSERT_FALSE(again);
+    EXPECT_EQ(Error::AlreadyInstrumented, again.error());
+}
+
+TEST(Instrumentation, LeavesClassesWithoutAllocationsUntouched) {
+    const auto class_name = std::string{"Example"};
+    const auto superclass_name = std::string{"java/lang/Object"};
+    auto klass = classfile::ClassFile{class_name, superclass_name};
+    auto arena = arena::Arena{};
+
+    const auto return_bytecode = std::to_array<const std::byte>({std::byte{0xB1}});
+    add_static_method(klass, arena, "run", "()V", return_bytecode);
+
+    const auto count = klass.constant_pool.count();
+    const auto sites = add_allocation_sampling(
+        klass,
+        arena,
+        AllocationOptions{.callback_class = "example/Profiler"}
+    );
+
+    ASSERT_TRUE(sites);
+    EXPECT_TRUE(sites.value().empty());
+    EXPECT_EQ(count, klass.constant_pool.count());
+    EXPECT_TRUE(klass.fields.empty());
+    EXPECT_EQ(1u, klass.methods.size());
+}
+
+TEST(Instrumentation, ProbesMonitorsAndSynchronizedMethods) {
+    const auto class_name = std::string{"Example"};
+    const auto superclass_name = std::string{"java/lang/Object"};
+    auto klass = classfile::ClassFile{class_name, superclass_name};
+    auto arena = arena::Arena{};
+
+    const auto monitor_bytecode = std::to_array<const std::byte>({
+        // aload_0, monitorenter, aload_0, monitorexit, return
+        std::byte{0x2A}, std::byte{0xC2}, std::byte{0x2A}, std::byte{0xC3}, std::byte{0xB1}
+    });
+
+    const auto return_bytecode = std::to_array<const std::byte>({std::byte{0xB1}});
+
+    add_static_method(klass, arena, "guarded", "(Ljava/lang/Object;)V", monitor_bytecode);
+    add_static_method(klass, arena, "locked", "()V", return_bytecode);
+    klass.methods.back().access_flags = static_cast<std::uint16_t>(
+        method::AccessFlags::ACC_SYNCHRONIZED
+    );
+
+    const auto sites = add_lock_probes(
+        klass,
+        arena,
+        LockOptions{.callback_class = "example/Profiler"}
+    );
+
+    ASSERT_TRUE(sites);
+    ASSERT_EQ(3u, sites.value().size());
+    EXPECT_EQ(LockSiteKind::MonitorEnter, sites.value()[0].kind);
+    EXPECT_EQ(1u, sites.value()[0].bci);
+    EXPECT_EQ(LockSiteKind::MonitorExit, sites.value()[1].kind);
+    EXPECT_EQ(3u, sites.value()[1].bci);
+    EXPECT_EQ(LockSiteKind::SynchronizedMethod, sites.value()[2].kind);
+    EXPECT_EQ(1u, sites.value()[2].method_index);
+
+    EXPECT_EQ(0u, klass.methods[1].access_flags & 0x0020u);
+
+    ASSERT_EQ(1u, klass.fields.size());
+    EXPECT_EQ(
+        "[I",
+        klass.constant_pool.resolve<constant_pool::UTF8Entry>(
+            klass.fields.front().descriptor_index
+        ).text
+    );
+
+    const auto view = views::ClassView{klass};
+    EXPECT_TRUE(view.method("$kh$lockSample"));
+    EXPECT_TRUE(view.method("$kh$lockAcquired"));
+    EXPECT_TRUE(view.method("$kh$lockReleased"));
+
+    const auto locked = code_of(view.method("locked").value());
+    ASSERT_EQ(1u, locked.exception_table.size());
+    EXPECT_EQ(0u, locked.exception_table.front().catch_type);
+
+    // NOTE(garrett): Covers the acquire probe right after the monitorenter,
+    // up to the lload that starts the exit sequence
+    const auto& handler = locked.exception_table.front();
+    ASSERT_GT(handler.start_pc, 0u);
+    EXPECT_EQ(std::byte{0xC2}, locked.bytecode[handler.start_pc - 1u]);
+    EXPECT_EQ(std::byte{0x16}, locked.bytecode[handler.end_pc]);
+
+    const auto instructions = bytecode::decode(locked.bytecode);
+    ASSERT_TRUE(instructions);
+
+    const auto monitors = std::ranges::count_if(
+        instructions.value(),
+        [](const auto& instruction) {
+            return instruction.opcode == bytecode::Opcode::MONITORENTER
+                || instruction.opcode == bytecode::Opcode::MONITOREXIT;
+        }
+    );
+
+    EXPECT_EQ(3, monitors);
+
+    kh::sinks::VectorSink sink{};
+    serialization::serialize(sink, klass);
+
+    auto reader = kh::reader::Reader{sink.view()};
+    const auto parsed = parsing::parse_class_file(reader);
+
+    ASSERT_TRUE(parsed);
+    EXPECT_EQ(6u, parsed.value().methods.size());
+}
+
+TEST(Instrumentation, RejectsMissingMethods) {
+    const auto class_name = std::string{"Example"};
+    const auto superclass_name = std::string{"java/lang/Object"};
+    auto klass = classfile::ClassFile{class_name, superclass_name};
+    auto arena = arena::Arena{};
+
+    const auto probes = add_latency_probes(
+        klass,
+        arena,
+        LatencyOptions{.methods = {"missing"}}
+    );
+
+    ASSERT_FALSE(probes);
+    EXPECT_EQ(Error::MethodNotFound, probes.error());
+}
+
+} // namespace kh::jvm::instrumentation
@@ -0,0 +1,400 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <unistd.h>
+#include <zlib.h>
+
+#include "gtest/gtest.h"
+
+#include "jar.h"
+
+namespace kh::jvm::jar {
+
+namespace {
+
+struct ParsedEntry {
+    std::string name;
+    std::uint16_t method;
+    std::vector<std::byte> data;
+};
+
+auto read_u16(std::span<const std::byte> bytes, const std::size_t offset) -> std::uint16_t {
+    return static_cast<std::uint16_t>(
+        std::to_integer<std::uint16_t>(bytes[offset])
+            | std::to_integer<std::uint16_t>(bytes[offset + 1u]) << 8u
+    );
+}
+
+auto read_u32(std::span<const std::byte> bytes, const std::size_t offset) -> std::uint32_t {
+    return read_u16(bytes, offset) | std::uint32_t{read_u16(bytes, offset + 2u)} << 16u;
+}
+
+auto inflate(std::span<const std::byte> data, const std::size_t size) -> std::vector<std::byte> {
+    auto output = std::vector<std::byte>(size);
+    auto stream = z_stream{};
+
+    ::inflateInit2(&stream, -15);
+
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<std::byte*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(output.data());
+    stream.avail_out = static_cast<uInt>(output.size());
+
+    const auto result = ::inflate(&stream, Z_FINISH);
+    ::inflateEnd(&stream);
+
+    EXPECT_EQ(Z_STREAM_END, result);
+    return output;
+}
+
+// NOTE(garrett): Walks the central directory and reads each entry through its
+// local header, checking both agree
+auto read_archive(std::span<const std::byte> archive) -> std::vector<ParsedEntry> {
+    auto entries = std::vector<ParsedEntry>{};
+    const auto end = archive.size() - 22u;
+
+    EXPECT_EQ(0x06054B50u, read_u32(archive, end));
+
+    const auto count = read_u16(archive, end + 10u);
+    auto position = std::size_t{read_u32(archive, end + 16u)};
+
+    EXPECT_EQ(end, position + read_u32(archive, end + 12u));
+
+    for (auto i = 0u; i < count; ++i) {
+        EXPECT_EQ(0x02014B50u, read_u32(archive, position));
+
+        const auto method = read_u16(archive, position + 10u);
+        const auto crc = read_u32(archive, position + 16u);
+        const auto compressed_size = read_u32(archive, position + 20u);
+        const auto size = read_u32(archive, position + 24u);
+        const auto name_length = read_u16(archive, position + 28u);
+        const auto offset = read_u32(archive, position + 42u);
+        const auto name = archive.subspan(position + 46u, name_length);
+
+        EXPECT_EQ(0x04034B50u, read_u32(archive, offset));
+        EXPECT_EQ(method, read_u16(archive, offset + 8u));
+        EXPECT_EQ(crc, read_u32(archive, offset + 14u));
+        EXPECT_EQ(name_length, read_u16(archive, offset + 26u));
+
+        const auto data = archive.subspan(offset + 30u + name_length, compressed_size);
+        auto contents = method == 8u
+            ? inflate(data, size)
+            : std::vector<std::byte>(data.begin(), data.end());
+
+        EXPECT_EQ(crc, ::crc32(0u, reinterpret_cast<const Bytef*>(contents.data()), size));
+
+        entries.push_back(ParsedEntry{
+            std::string{reinterpret_cast<const char*>(name.data()), name.size()},
+            method,
+            std::move(contents)
+        });
+
+        position += 46u + name_length;
+    }
+
+    return entries;
+}
+
+auto read_file(const int descriptor) -> std::vector<std::byte> {
+    const auto size = ::lseek(descriptor, 0, SEEK_END);
+    auto contents = std::vector<std::byte>(static_cast<std::size_t>(size));
+
+    EXPECT_EQ(size, ::pread(descriptor, contents.data(), contents.size(), 0));
+    return contents;
+}
+
+auto pattern(const std::size_t size, const std::size_t seed) -> std::vector<std::byte> {
+    auto bytes = std::vector<std::byte>(size);
+
+    for (auto i = 0uz; i < size; ++i) {
+        bytes[i] = static_cast<std::byte>((i * 31u + seed) % 7u + (i >> 5u));
+    }
+
+    return bytes;
+}
+
+} // namespace
+
+TEST(Jar, ComputesStandardCrc32) {
+    auto bytes = std::vector<std::byte>(4096u);
+
+    for (auto i = 0uz; i < bytes.size(); ++i) {
+        bytes[i] = static_cast<std::byte>(i * 2654435761u >> 13u);
+    }
+
+    for (const auto size : {0uz, 1uz, 15uz, 63uz, 64uz, 65uz, 127uz, 128uz, 1000uz, 4096uz}) {
+        for (const auto offset : {0uz, 3uz}) {
+            const auto length = std::min(size, bytes.size() - offset);
+            const auto data = std::span<const std::byte>{bytes}.subspan(offset, length);
+            const auto expected = ::crc32(
+                0u, reinterpret_cast<const Bytef*>(data.data()), static_cast<uInt>(data.size())
+            );
+
+            EXPECT_EQ(expected, jar::crc32(data)) << size << " bytes at offset " << offset;
+        }
+    }
+
+    const auto all = std::span<const std::byte>{bytes};
+    EXPECT_EQ(jar::crc32(all), jar::crc32(all.subspan(100u), jar::crc32(all.first(100u))));
+}
+
+TEST(Jar, WritesStoredAndDeflatedEntries) {
+    auto file = std::tmpfile();
+    ASSERT_NE(nullptr, file);
+
+    const auto expected = std::to_array<ParsedEntry>({
+        ParsedEntry{"META-INF/MANIFEST.MF", 0u, pattern(40u, 1u)},
+        ParsedEntry{"example/Large.class", 8u, pattern(100000u, 2u)},
+        ParsedEntry{"example/Empty.class", 0u, std::vector<std::byte>{}},
+        ParsedEntry{"example/Small.class", 8u, pattern(5000u, 3u)}
+    });
+
+    {
+        auto pool = kh::threading::ThreadPool{2u};
+        auto writer = Writer{::fileno(file), pool};
+
+        ASSERT_EQ(Error::InvalidName, writer.add("", {}).error());
+
+        for (const auto& entry : expected) {
+            const auto compression = entry.method == 8u
+                ? Compression::Deflated
+                : Compression::Stored;
+
+            ASSERT_TRUE(writer.add(entry.name, entry.data, compression));
+        }
+
+        ASSERT_TRUE(writer.finish());
+    }
+
+    const auto archive = read_file(::fileno(file));
+    std::fclose(file);
+
+    const auto entries = read_archive(archive);
+    ASSERT_EQ(expected.size(), entries.size());
+
+    for (auto i = 0uz; i < entries.size(); ++i) {
+        EXPECT_EQ(expected[i].name, entries[i].name);
+        EXPECT_EQ(expected[i].method, entries[i].method);
+        EXPECT_EQ(expected[i].data, entries[i].data);
+    }
+}
+
+TEST(Jar, ReadsAndCopiesEntries) {
+    const auto path = std::filesystem::temp_directory_path()
+        / ("kh-jar-" + std::to_string(::getpid()) + ".jar");
+
+    const auto stored = pattern(300u, 4u);
+    const auto deflated = pattern(20000u, 5u);
+    auto pool = kh::threading::ThreadPool{2u};
+
+    {
+        auto file = std::fopen(path.c_str(), "wb");
+        ASSERT_NE(nullptr, file);
+
+        auto writer = Writer{::fileno(file), pool};
+
+        ASSERT_TRUE(writer.add("META-INF/", {}, Compression::Stored));
+        ASSERT_TRUE(writer.add("example/Stored.class", stored, Compression::Stored));
+        ASSERT_TRUE(writer.add("example/Deflated.class", deflated));
+        ASSERT_TRUE(writer.finish());
+
+        std::fclose(file);
+    }
+
+    const auto archive = Archive::open(path);
+    std::filesystem::remove(path);
+
+    ASSERT_TRUE(archive);
+    ASSERT_EQ(3u, archive->entries().size());
+    EXPECT_FALSE(archive->find("example/Missing.class"));
+
+    const auto& stored_entry = archive->entries()[archive->find("example/Stored.class").value()];
+    const auto& deflated_entry = archive->entries()[2u];
+
+    EXPECT_EQ("example/Deflated.class", deflated_entry.name);
+    EXPECT_EQ(Compression::Deflated, deflated_entry.compression);
+    EXPECT_GT(deflated.size(), deflated_entry.compressed_size);
+
+    auto buffer = std::vector<std::byte>{};
+    const auto stored_contents = archive->extract(stored_entry, buffer);
+
+    // NOTE(garrett): Stored entries come straight out of the mapping
+    ASSERT_TRUE(stored_contents);
+    EXPECT_TRUE(std::ranges::equal(stored, stored_contents.value()));
+    EXPECT_TRUE(buffer.empty());
+    EXPECT_EQ(archive->raw(stored_entry).data(), stored_contents->data());
+
+    const auto deflated_contents = archive->extract(deflated_entry, buffer);
+
+    ASSERT_TRUE(deflated_contents);
+    EXPECT_TRUE(std::ranges::equal(deflated, deflated_contents.value()));
+
+    // NOTE(garrett): Copying every entry reproduces the archive exactly
+    auto file = std::tmpfile();
+    ASSERT_NE(nullptr, file);
+
+    {
+        auto writer = Writer{::fileno(file), pool};
+
+        for (const auto& entry : archive->entries()) {
+            ASSERT_TRUE(writer.copy(archive.value(), entry));
+        }
+
+        ASSERT_TRUE(writer.finish());
+    }
+
+    const auto copied = read_file(::fileno(file));
+    std::fclose(file);
+
+    EXPECT_TRUE(std::ranges::equal(archive->bytes(), copied));
+}
+
+TEST(Jar, TraversesNestedArchives) {
+    auto pool = kh::threading::ThreadPool{2u};
+
+    auto build = [&pool](auto&& add) {
+        auto file = std::tmpfile();
+        EXPECT_NE(nullptr, file);
+
+        auto writer = Writer{::fileno(file), pool};
+        add(writer);
+        EXPECT_TRUE(writer.finish());
+
+        auto contents = read_file(::fileno(file));
+        std::fclose(file);
+
+        return contents;
+    };
+
+    const auto first = pattern(300u, 6u);
+    const auto second = pattern(20000u, 7u);
+
+    const auto stored_jar = build([&first](Writer& writer) {
+        ASSERT_TRUE(writer.add("a/A.class", first, Compression::Stored));
+    });
+
+    const auto deflated_jar = build([&second](Writer& writer) {
+        ASSERT_TRUE(writer.add("b/B.class", second, Compression::Stored));
+    });
+
+    const auto broken = pattern(100u, 8u);
+    const auto path = std::filesystem::temp_directory_path()
+        / ("kh-jar-nested-" + std::to_string(::getpid()) + ".jar");
+
+    {
+        const auto outer = build([&](Writer& writer) {
+            ASSERT_TRUE(writer.add("Main.class", first, Compression::Stored));
+            ASSERT_TRUE(writer.add("BOOT-INF/lib/a.jar", stored_jar, Compression::Stored));
+            ASSERT_TRUE(writer.add("BOOT-INF/lib/b.jar", deflated_jar));
+            ASSERT_TRUE(writer.add("BOOT-INF/lib/broken.jar", broken, Compression::Stored));
+        });
+
+        auto file = std::fopen(path.c_str(), "wb");
+        ASSERT_NE(nullptr, file);
+        ASSERT_EQ(outer.size(), std::fwrite(outer.data(), 1u, outer.size(), file));
+        std::fclose(file);
+    }
+
+    const auto tree = Tree::open(path);
+    const auto flat = Tree::open(path, 0u);
+    std::filesystem::remove(path);
+
+    ASSERT_TRUE(tree);
+    ASSERT_EQ(3u, tree->archives().size());
+    ASSERT_EQ(4u, tree->entries().size());
+
+    const auto& root = tree->archives().front();
+    const auto entries = tree->entries();
+
+    EXPECT_EQ("Main.class", entries[0].path);
+    EXPECT_EQ("BOOT-INF/lib/a.jar!/a/A.class", entries[1].path);
+    EXPECT_EQ("BOOT-INF/lib/b.jar!/b/B.class", entries[2].path);
+    EXPECT_EQ("BOOT-INF/lib/broken.jar", entries[3].path);
+    EXPECT_EQ(&root, entries[3].archive);
+
+    // NOTE(garrett): The stored inner jar is read in place from the outer
+    // mapping
+    const auto& nested = tree->archives()[1u];
+    const auto outer_bytes = root.bytes();
+    const auto nested_bytes = nested.bytes();
+
+    EXPECT_GE(nested_bytes.data(), outer_bytes.data());
+    EXPECT_LE(&nested_bytes.back(), &outer_bytes.back());
+
+    auto buffer = std::vector<std::byte>{};
+    const auto stored_contents = entries[1].archive->extract(*entries[1].entry, buffer);
+    const auto deflated_contents = entries[2].archive->extract(*entries[2].entry, buffer);
+
+    ASSERT_TRUE(stored_contents);
+    EXPECT_TRUE(std::ranges::equal(first, stored_contents.value()));
+    ASSERT_TRUE(deflated_contents);
+    EXPECT_TRUE(std::ranges::equal(second, deflated_contents.value()));
+
+    // NOTE(garrett): Without any depth to spare nested jars are plain entries
+    ASSERT_TRUE(flat);
+    EXPECT_EQ(1u, flat->archives().size());
+    EXPECT_EQ(4u, flat->entries().size());
+    EXPECT_EQ("BOOT-INF/lib/b.jar", flat->entries()[2].path);
+    EXPECT_EQ(Compression::Deflated, flat->entries()[2].entry->compression);
+}
+
+TEST(Jar, RejectsCorruptArchives) {
+    auto file = std::tmpfile();
+    ASSERT_NE(nullptr, file);
+
+    {
+        auto pool = kh::threading::ThreadPool{1u};
+        auto writer = Writer{::fileno(file), pool};
+
+        ASSERT_TRUE(writer.add("example/Stored.class", pattern(100u, 6u), Compression::Stored));
+        ASSERT_TRUE(writer.finish());
+    }
+
+    auto bytes = read_file(::fileno(file));
+    std::fclose(file);
+
+    const auto truncated = std::span<const std::byte>{bytes}.first(bytes.size() - 1u);
+    EXPECT_EQ(Error::InvalidArchive, Archive::view(truncated).error());
+
+    // NOTE(garrett): First byte of the entry's data, right after its name
+    bytes[30u + std::string_view{"example/Stored.class"}.size()] ^= std::byte{0xFF};
+
+    const auto archive = Archive::view(bytes);
+    auto buffer = std::vector<std::byte>{};
+
+    ASSERT_TRUE(archive);
+    EXPECT_EQ(Error::ChecksumMismatch, archive->extract(archive->entries()[0], buffer).error());
+}
+
+TEST(Jar, RejectsImplausibleEntrySizes) {
+    auto file = std::tmpfile();
+    ASSERT_NE(nullptr, file);
+
+    {
+        auto pool = kh::threading::ThreadPool{1u};
+        auto writer = Writer{::fileno(file), pool};
+
+        ASSERT_TRUE(writer.add("example/Small.class", pattern(100u, 7u), Compression::Deflated));
+        ASSERT_TRUE(writer.finish());
+    }
+
+    auto bytes = read_file(::fileno(file));
+    std::fclose(file);
+
+    // NOTE(garrett): Claims close to 4 GiB in the central directory
+    const auto central = read_u32(bytes, bytes.size() - 22u + 16u);
+
+    for (auto i = 0u; i < 4u; ++i) {
+        bytes[central + 24u + i] = std::byte{0xFEu};
+    }
+
+    const auto archive = Archive::view(bytes);
+    auto buffer = std::vector<std::byte>{};
+
+    ASSERT_TRUE(archive);
+    EXPECT_EQ(Error::EntryTooLarge, archive->extract(archive->entries()[0], buffer).error());
+    EXPECT_TRUE(buffer.empty());
+}
+
+} // namespace kh::jvm::jar
@@ -0,0 +1,309 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <map>
+#include <optional>
+#include <string>
+
+#include <zlib.h>
+
+#include "gtest/gtest.h"
+
+#include "jimage.h"
+
+namespace kh::jvm::jimage {
+
+namespace {
+
+struct Resource {
+    std::string module;
+    std::string parent;
+    std::string base;
+    std::string extension;
+    std::vector<std::byte> contents;
+    std::string compression;
+
+    auto name() const -> std::string {
+        return Location{module, parent, base, extension, 0u, 0u, 0u}.name();
+    }
+};
+
+// NOTE(garrett): Lays out an image the way jlink does, in either byte order
+class Builder {
+private:
+    bool swapped_;
+    std::vector<std::byte> strings_;
+    std::map<std::string, std::uint32_t> offsets_;
+
+    template <typename V>
+    auto put(std::vector<std::byte>& buffer, V value) const -> void {
+        if (swapped_) {
+            value = std::byteswap(value);
+        }
+
+        const auto bytes = std::as_bytes(std::span{&value, 1u});
+        buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+    }
+
+    auto intern(const std::string& string) -> std::uint32_t {
+        const auto [existing, inserted] = offsets_.try_emplace(string, strings_.size());
+
+        if (inserted) {
+            const auto bytes = std::as_bytes(std::span{string.c_str(), string.size() + 1u});
+            strings_.insert(strings_.end(), bytes.begin(), bytes.end());
+        }
+
+        return existing->second;
+    }
+
+    static auto attribute(
+            std::vector<std::byte>& buffer,
+            const std::uint8_t kind,
+            const std::uint64_t value) -> void {
+        const auto length = std::max(1, (64 - std::countl_zero(value) + 7) / 8);
+        buffer.push_back(static_cast<std::byte>(kind << 3u | (length - 1)));
+
+        for (auto i = length - 1; i >= 0; --i) {
+            buffer.push_back(static_cast<std::byte>(value >> (i * 8)));
+        }
+    }
+public:
+    explicit Builder(const bool swapped)
+            : swapped_(swapped)
+            , strings_(std::vector<std::byte>{})
+            , offsets_(std::map<std::string, std::uint32_t>{}) {
+        intern("");
+    }
+
+    auto build(const std::vector<Resource>& resources) -> std::vector<std::byte> {
+        auto locations = std::vector<std::byte>{};
+        auto location_offsets = std::vector<std::uint32_t>{};
+        auto data = std::vector<std::byte>{};
+
+        for (const auto& resource : resources) {
+            auto stored = resource.contents;
+            auto compressed_size = 0uz;
+
+            if (!resource.compression.empty()) {
+                auto length = ::compressBound(resource.contents.size());
+                auto payload = std::vector<std::byte>(length);
+
+                EXPECT_EQ(Z_OK, ::compress(
+                    reinterpret_cast<Bytef*>(payload.data()),
+                    &length,
+                    reinterpret_cast<const Bytef*>(resource.contents.data()),
+                    resource.contents.size()
+                ));
+
+                stored.clear();
+                put(stored, std::uint32_t{0xCAFEFAFAu});
+                put(stored, std::uint64_t{length});
+                put(stored, std::uint64_t{resource.contents.size()});
+                put(stored, intern(resource.compression));
+                put(stored, intern(""));
+                stored.push_back(std::byte{1u});
+                stored.insert(stored.end(), payload.begin(), payload.begin() + length);
+
+                compressed_size = stored.size();
+            }
+
+            location_offsets.push_back(locations.size());
+            attribute(locations, 1u, intern(resource.module));
+            attribute(locations, 2u, intern(resource.parent));
+            attribute(locations, 3u, intern(resource.base));
+            attribute(locations, 4u, intern(resource.extension));
+            attribute(locations, 5u, data.size());
+            attribute(locations, 6u, compressed_size);
+            attribute(locations, 7u, resource.contents.size());
+            locations.push_back(std::byte{0u});
+
+            data.insert(data.end(), stored.begin(), stored.end());
+        }
+
+        // NOTE(garrett): Slots shared by several names get the first seed that
+        // spreads them over free slots, largest groups first, then every other
+        // name takes whichever slot is left
+        const auto length = resources.size();
+        auto buckets = std::vector<std::vector<std::size_t>>(length);
+
+        for (auto i = 0uz; i < length; ++i) {
+            buckets[hash(resources[i].name()) % length].push_back(i);
+        }
+
+        auto order = std::vector<std::size_t>(length);
+        std::ranges::generate(order, [i = 0uz]() mutable { return i++; });
+        std::ranges::stable_sort(order, std::ranges::greater{}, [&buckets](const auto bucket) {
+            return buckets[bucket].size();
+        });
+
+        auto redirects = std::vector<std::int32_t>(length, 0);
+        auto slots = std::vector<std::optional<std::size_t>>(length);
+
+        for (const auto bucket : order) {
+            const auto& names = buckets[bucket];
+
+            if (names.size() > 1u) {
+                for (auto seed = 1u;; ++seed) {
+                    auto chosen = std::vector<std::size_t>{};
+
+                    for (const auto name : names) {
+                        const auto slot = hash(resources[name].name(), seed) % length;
+
+                        if (slots[slot] || std::ranges::find(chosen, slot) != chosen.end()) {
+                            break;
+                        }
+
+                        chosen.push_back(slot);
+                    }
+
+                    if (chosen.size() == names.size()) {
+                        for (auto i = 0uz; i < names.size(); ++i) {
+                            slots[chosen[i]] = names[i];
+                        }
+
+                        redirects[bucket] = static_cast<std::int32_t>(seed);
+                        break;
+                    }
+                }
+            } else if (names.size() == 1u) {
+                const auto free = std::ranges::find_if(slots, [](const auto& slot) {
+                    return !slot;
+                });
+
+                const auto slot = free - slots.begin();
+
+                slots[slot] = names.front();
+                redirects[bucket] = static_cast<std::int32_t>(-1 - slot);
+            }
+        }
+
+        auto image = std::vector<std::byte>{};
+
+        put(image, std::uint32_t{0xCAFEDADAu});
+        put(image, std::uint32_t{1u << 16u});
+        put(image, std::uint32_t{0u});
+        put(image, static_cast<std::uint32_t>(length));
+        put(image, static_cast<std::uint32_t>(length));
+        put(image, static_cast<std::uint32_t>(locations.size()));
+        put(image, static_cast<std::uint32_t>(strings_.size()));
+
+        for (const auto redirect : redirects) {
+            put(image, static_cast<std::uint32_t>(redirect));
+        }
+
+        for (const auto& slot : slots) {
+            put(image, location_offsets[slot.value()]);
+        }
+
+        image.insert(image.end(), locations.begin(), locations.end());
+        image.insert(image.end(), strings_.begin(), strings_.end());
+        image.insert(image.end(), data.begin(), data.end());
+
+        return image;
+    }
+};
+
+auto contents(const std::string_view text) -> std::vector<std::byte> {
+    const auto bytes = std::as_bytes(std::span{text});
+    return std::vector<std::byte>(bytes.begin(), bytes.end());
+}
+
+} // namespace
+
+TEST(JImage, ResolvesResourcesByName) {
+    const auto repeated = std::string(4096u, 'x');
+
+    auto resources = std::vector<Resource>{
+        Resource{"java.base", "java/lang", "Object", "class", contents("object"), ""},
+        Resource{"java.base", "java/lang", "String", "class", contents(repeated), "zip"},
+        Resource{"java.base", "", "module-info", "class", contents("module"), ""},
+        Resource{"jdk.shared", "a", "Shared", "class", contents("shared"), "compact-cp"}
+    };
+
+    // NOTE(garrett): Enough names that some share a slot and need a seed
+    for (auto i = 0u; i < 64u; ++i) {
+        const auto name = "C" + std::to_string(i);
+        resources.push_back(Resource{"m", "p", name, "class", contents(name), ""});
+    }
+
+    for (const auto swapped : {false, true}) {
+        const auto bytes = Builder{swapped}.build(resources);
+        const auto image = Image::view(bytes);
+
+        ASSERT_TRUE(image);
+        ASSERT_EQ(resources.size(), image->size());
+
+        auto buffer = std::vector<std::byte>{};
+
+        for (const auto& resource : resources) {
+            const auto location = image->find(resource.name());
+
+            ASSERT_TRUE(location) << resource.name();
+            EXPECT_EQ(resource.name(), location->name());
+
+            const auto read = image->read(location.value(), buffer);
+
+            if (resource.compression == "compact-cp") {
+                EXPECT_EQ(Error::UnsupportedCompression, read.error());
+            } else {
+                ASSERT_TRUE(read);
+                EXPECT_TRUE(std::ranges::equal(resource.contents, read.value()));
+            }
+        }
+
+        // NOTE(garrett): Uncompressed resources come straight out of the image
+        const auto object = image->find("/java.base/java/lang/Object.class");
+        const auto read = image->read(object.value(), buffer);
+
+        ASSERT_TRUE(read);
+        EXPECT_GE(read->data(), bytes.data());
+        EXPECT_LT(read->data(), bytes.data() + bytes.size());
+
+        EXPECT_FALSE(image->find("/java.base/java/lang/Missing.class"));
+        EXPECT_FALSE(image->find("/java.base/java/lang/Object"));
+        EXPECT_FALSE(image->find("java.base/java/lang/Object.class"));
+    }
+}
+
+TEST(JImage, RejectsInvalidImages) {
+    auto bytes = Builder{false}.build({
+        Resource{"java.base", "java/lang", "Object", "class", contents("object"), ""}
+    });
+
+    EXPECT_EQ(Error::InvalidImage, Image::view(std::span{bytes}.first(20u)).error());
+    EXPECT_EQ(Error::InvalidImage, Image::view(std::span{bytes}.first(40u)).error());
+
+    std::ranges::fill(std::span{bytes}.subspan(4u, 4u), std::byte{2u});
+    EXPECT_EQ(Error::UnsupportedVersion, Image::view(bytes).error());
+
+    bytes[0] = std::byte{0u};
+    EXPECT_EQ(Error::InvalidImage, Image::view(bytes).error());
+}
+
+TEST(JImage, RejectsImplausibleDecompressedSizes) {
+    auto bytes = Builder{false}.build({
+        Resource{"java.base", "java/lang", "String", "class", contents("string"), "zip"}
+    });
+
+    const auto value = std::uint32_t{0xCAFEFAFAu};
+    auto magic = std::array<std::byte, sizeof(value)>{};
+    std::memcpy(magic.data(), &value, sizeof(value));
+
+    const auto header = std::ranges::search(bytes, magic);
+    ASSERT_FALSE(header.empty());
+
+    const auto size = std::uint64_t{1u} << 40u;
+    std::memcpy(std::to_address(header.begin()) + 12u, &size, sizeof(size));
+
+    const auto image = Image::view(bytes);
+    ASSERT_TRUE(image);
+
+    auto buffer = std::vector<std::byte>{};
+    const auto location = image->find("/java.base/java/lang/String.class");
+
+    ASSERT_TRUE(location);
+    EXPECT_EQ(Error::InvalidImage, image->read(location.value(), buffer).error());
+}
+
+} // namespace kh::jvm::jimage
@@ -0,0 +1,111 @@
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "loading.h"
+
+namespace kh::loading {
+
+TEST(Loading, ReadsWholeFiles) {
+    const auto directory = std::filesystem::temp_directory_path()
+        / ("kh-loading-" + std::to_string(::getpid()));
+
+    std::filesystem::create_directories(directory);
+
+    auto paths = std::vector<std::filesystem::path>{};
+    auto expected = std::vector<std::string>{};
+
+    // NOTE(garrett): More files than the loader's depth, with some larger than
+    // its buffers and one empty
+    for (auto i = 0u; i < 40u; ++i) {
+        const auto contents = std::string(i * 37u, static_cast<char>('a' + i % 26u));
+
+        paths.push_back(directory / (std::to_string(i) + ".class"));
+        expected.push_back(contents);
+
+        std::ofstream{paths.back(), std::ios::binary} << contents;
+    }
+
+    paths.push_back(directory / "missing.class");
+
+    for (const auto accelerate : {true, false}) {
+        auto loader = Loader{8u, 1024u, accelerate};
+        auto loaded = std::map<std::size_t, std::expected<std::string, Error>>{};
+
+        loader.load(paths, [&loaded](const std::size_t index, const auto contents) {
+            if (contents) {
+                const auto* data = reinterpret_cast<const char*>(contents->data());
+                loaded.emplace(index, std::string{data, contents->size()});
+            } else {
+                loaded.emplace(index, std::unexpected(contents.error()));
+            }
+        });
+
+        ASSERT_EQ(paths.size(), loaded.size());
+
+        for (auto i = 0uz; i < expected.size(); ++i) {
+            ASSERT_TRUE(loaded.at(i)) << i;
+            EXPECT_EQ(expected[i], loaded.at(i).value()) << i;
+        }
+
+        EXPECT_EQ(Error::OpenFailed, loaded.at(expected.size()).error());
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(Loading, SurvivesThrowingCallbacks) {
+    const auto directory = std::filesystem::temp_directory_path()
+        / ("kh-loading-throwing-" + std::to_string(::getpid()));
+
+    std::filesystem::create_directories(directory);
+
+    auto paths = std::vector<std::filesystem::path>{};
+
+    for (auto i = 0u; i < 40u; ++i) {
+        paths.push_back(directory / (std::to_string(i) + ".class"));
+        std::ofstream{paths.back(), std::ios::binary} << std::string(i * 61u, 'k');
+    }
+
+    const auto descriptors = [] {
+        auto error = std::error_code{};
+        const auto entries = std::filesystem::directory_iterator{"/proc/self/fd", error};
+
+        return std::distance(std::filesystem::begin(entries), std::filesystem::end(entries));
+    };
+
+    for (const auto accelerate : {true, false}) {
+        auto loader = Loader{8u, 1024u, accelerate};
+        const auto open = descriptors();
+        auto calls = 0uz;
+
+        EXPECT_THROW(
+            loader.load(paths, [&calls](std::size_t, auto) {
+                if (++calls == 3u) {
+                    throw std::runtime_error{"callback failed"};
+                }
+            }),
+            std::runtime_error
+        );
+
+        EXPECT_EQ(open, descriptors());
+
+        auto loaded = 0uz;
+
+        loader.load(paths, [&loaded](std::size_t, const auto contents) {
+            loaded += contents.has_value();
+        });
+
+        EXPECT_EQ(paths.size(), loaded);
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+} // namespace kh::loading
@@ -0,0 +1,166 @@
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "overlay.h"
+#include "tests/helpers.h"
+#include "views.h"
+
+namespace kh::jvm::overlay {
+
+namespace {
+
+constexpr auto return_bytecode = std::to_array<const std::byte>({
+    // return
+    std::byte{0xB1}
+});
+
+auto code_attribute(arena::Arena& arena) -> std::span<const std::byte> {
+    kh::sinks::VectorSink sink{};
+
+    serialization::serialize(
+        sink,
+        code::Code{
+            .max_stack = 0u,
+            .max_locals = 0u,
+            .bytecode = return_bytecode,
+            .exception_table = std::vector<code::ExceptionHandler>{},
+            .attributes = std::vector<attribute::Attribute>{}
+        }
+    );
+
+    return arena.store(sink.take());
+}
+
+auto load_base() -> std::shared_ptr<const parsing::LoadedClass> {
+    static const auto class_name = std::string{"Example"};
+    static const auto superclass_name = std::string{"java/lang/Object"};
+    auto klass = classfile::ClassFile{class_name, superclass_name};
+    auto arena = arena::Arena{};
+
+    klass.methods.push_back(
+        method::Method{
+            .access_flags = static_cast<std::uint16_t>(method::AccessFlags::ACC_STATIC),
+            .name_index = static_cast<std::uint16_t>(
+                klass.constant_pool.try_add_utf8_entry("run")
+            ),
+            .descriptor_index = static_cast<std::uint16_t>(
+                klass.constant_pool.try_add_utf8_entry("()V")
+            ),
+            .attributes = std::vector<attribute::Attribute>{
+                attribute::Attribute{
+                    static_cast<std::uint16_t>(klass.constant_pool.try_add_utf8_entry("Code")),
+                    code_attribute(arena)
+                }
+            }
+        }
+    );
+
+    kh::sinks::VectorSink sink{};
+    serialization::serialize(sink, klass);
+
+    auto raw = sink.take();
+    auto reader = kh::reader::Reader{raw};
+    auto parsed = parsing::parse_class_file(reader);
+    parsed->constant_pool.index_text();
+
+    return std::make_shared<const parsing::LoadedClass>(
+        parsing::LoadedClass{std::move(raw), std::move(parsed.value()), arena::Arena{}}
+    );
+}
+
+// NOTE(garrett): Parsed classes only view their input, so the serialized
+// bytes are kept in `storage`
+auto reparse(const Overlay& overlay, std::vector<std::byte>& storage)
+        -> classfile::ClassFile {
+    kh::sinks::VectorSink sink{};
+    overlay.write(sink);
+
+    storage = sink.take();
+    auto reader = kh::reader::Reader{storage};
+
+    return parsing::parse_class_file(reader).value();
+}
+
+} // namespace
+
+TEST(Overlay, WritesUneditedBaseVerbatim) {
+    const auto base = load_base();
+    const auto overlay = Overlay{base};
+
+    kh::sinks::VectorSink sink{};
+    overlay.write(sink);
+
+    EXPECT_THAT(std::span<const std::byte>{base->raw}, EqualsBinary(sink.view()));
+}
+
+TEST(Overlay, AppliesIndependentVariantsToSharedBase) {
+    const auto base = load_base();
+    const auto base_count = base->class_file.constant_pool.count();
+
+    auto added = Overlay{base};
+    auto replaced = Overlay{base};
+
+    auto add_probe = std::jthread{[&added] {
+        const auto name = added.try_add_utf8_entry("probe");
+        const auto descriptor = added.try_add_utf8_entry("()V");
+        const auto code = added.try_add_utf8_entry("Code");
+
+        added.add_method(
+            method::Method{
+                .access_flags = static_cast<std::uint16_t>(method::AccessFlags::ACC_STATIC),
+                .name_index = name.value(),
+                .descriptor_index = descriptor.value(),
+                .attributes = std::vector<attribute::Attribute>{
+                    attribute::Attribute{code.value(), code_attribute(added.arena())}
+                }
+            }
+        );
+    }};
+
+    auto replace_run = std::jthread{[&replaced] {
+        auto method = replaced.method(0u);
+        method.access_flags |= static_cast<std::uint16_t>(method::AccessFlags::ACC_FINAL);
+
+        ASSERT_TRUE(replaced.replace_method(0u, std::move(method)));
+        replaced.add_interface(replaced.try_add_class_entry("java/io/Serializable").value());
+    }};
+
+    add_probe.join();
+    replace_run.join();
+
+    auto storage = std::array<std::vector<std::byte>, 2>{};
+    const auto with_probe = reparse(added, storage[0]);
+    const auto probe_view = views::ClassView{with_probe};
+
+    // NOTE(garrett): Only the new name is added, "()V" and "Code" are reused
+    EXPECT_EQ(base_count + 1u, with_probe.constant_pool.count());
+    EXPECT_EQ(2u, with_probe.methods.size());
+    EXPECT_TRUE(probe_view.method("probe"));
+    EXPECT_TRUE(probe_view.method("run"));
+
+    const auto with_interface = reparse(replaced, storage[1]);
+
+    ASSERT_EQ(1u, with_interface.interfaces.size());
+    EXPECT_EQ(1u, with_interface.methods.size());
+    EXPECT_TRUE(
+        with_interface.methods[0].access_flags
+            & static_cast<std::uint16_t>(method::AccessFlags::ACC_FINAL)
+    );
+
+    EXPECT_EQ(1u, base->class_file.methods.size());
+    EXPECT_FALSE(
+        base->class_file.methods[0].access_flags
+            & static_cast<std::uint16_t>(method::AccessFlags::ACC_FINAL)
+    );
+}
+
+TEST(Overlay, RejectsUnknownMethods) {
+    auto overlay = Overlay{load_base()};
+    const auto result = overlay.replace_method(1u, overlay.method(0u));
+
+    ASSERT_FALSE(result);
+    EXPECT_EQ(Error::InvalidMethod, result.error());
+}
+
+} // namespace kh::jvm::overlay
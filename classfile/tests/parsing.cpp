@@ -154,6 +154,29 @@ TEST(Parsing, ParsesConstantPool) {
     ASSERT_EQ(2uz, pool_parse_result.value().entries().size());
 }
 
+TEST(Parsing, ParsesWideConstantPoolEntries) {
+    constexpr auto input = std::array<std::byte, 12>{
+        // Long entry
+        std::byte{0x05},
+        std::byte{0x00}, std::byte{0x00}, std::byte{0x00}, std::byte{0x00},
+        std::byte{0x00}, std::byte{0x00}, std::byte{0x00}, std::byte{0x2A},
+        // String entry
+        std::byte{0x08},
+        std::byte{0x00}, std::byte{0x01}
+    };
+
+    kh::reader::Reader reader{input};
+    const auto pool = parse_constant_pool(reader, 3);
+
+    ASSERT_TRUE(pool);
+    ASSERT_EQ(2uz, pool.value().entries().size());
+    ASSERT_EQ(4uz, pool.value().count());
+
+    EXPECT_EQ(42u, pool.value().resolve<constant_pool::LongEntry>(1u).value);
+    EXPECT_ANY_THROW(pool.value().resolve<constant_pool::LongEntry>(2u));
+    EXPECT_EQ(1u, pool.value().resolve<constant_pool::StringEntry>(3u).string_index);
+}
+
 TEST(Parsing, ParsesMethod) {
     constexpr auto input = std::array<const std::byte, 15>{
         // Access
@@ -0,0 +1,120 @@
+#include <atomic>
+#include <latch>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "registry.h"
+#include "tests/helpers.h"
+
+namespace kh::jvm::registry {
+
+namespace {
+
+using fixtures::class_bytes;
+
+} // namespace
+
+TEST(Registry, KeysClassesByLoaderAndName) {
+    auto registry = Registry{};
+
+    const auto first = registry.insert(1u, class_bytes("a/Base"));
+    const auto other = registry.insert(2u, class_bytes("a/Base"));
+    const auto again = registry.insert(1u, class_bytes("a/Base"));
+
+    ASSERT_TRUE(first && other && again);
+    EXPECT_TRUE(first->second);
+    EXPECT_TRUE(other->second);
+    EXPECT_FALSE(again->second);
+    EXPECT_EQ(first->first, again->first);
+    EXPECT_NE(first->first, other->first);
+
+    EXPECT_EQ(first->first, registry.find(1u, "a/Base"));
+    EXPECT_EQ(other->first, registry.find(2u, "a/Base"));
+    EXPECT_EQ("a/Base", registry.find(2u, "a/Base")->name);
+    EXPECT_EQ(nullptr, registry.find(3u, "a/Base"));
+    EXPECT_EQ(nullptr, registry.find(1u, "a/Missing"));
+
+    EXPECT_EQ(Error::ParseFailed, registry.insert(1u, std::vector<std::byte>(16u)).error());
+    EXPECT_EQ(2u, registry.size());
+}
+
+TEST(Registry, RegistersEachClassOnceUnderContention) {
+    constexpr auto threads = 8u;
+    constexpr auto classes = 2048u;
+    constexpr auto loaders = 2u;
+
+    auto names = std::vector<std::string>{};
+    auto bytes = std::vector<std::vector<std::byte>>{};
+
+    for (auto i = 0u; i < classes; ++i) {
+        names.push_back("p" + std::to_string(i % 16u) + "/C" + std::to_string(i));
+        bytes.push_back(class_bytes(names.back()));
+    }
+
+    auto registry = Registry{};
+    auto wins = std::vector<std::atomic<std::size_t>>(classes * loaders);
+    auto entries = std::vector<std::atomic<const Entry*>>(classes * loaders);
+    auto mismatches = std::atomic<std::size_t>{0u};
+    auto ready = std::latch{threads};
+
+    // NOTE(garrett): Every thread registers every class under every loader,
+    // each starting at a different point, while looking up classes others are
+    // still registering, so the buckets split underneath all of them
+    auto register_all = [&](const std::size_t thread) {
+        ready.arrive_and_wait();
+
+        for (auto i = 0uz; i < classes * loaders; ++i) {
+            const auto index = (i + thread * classes / threads) % (classes * loaders);
+            const auto klass = index % classes;
+            const auto loader = LoaderId{index / classes};
+
+            const auto inserted = registry.insert(loader, std::vector{bytes[klass]});
+
+            if (!inserted) {
+                ++mismatches;
+                continue;
+            }
+
+            const auto [entry, won] = inserted.value();
+
+            if (won) {
+                ++wins[index];
+            }
+
+            auto* expected = static_cast<const Entry*>(nullptr);
+
+            if (!entries[index].compare_exchange_strong(expected, entry) && expected != entry) {
+                ++mismatches;
+            }
+
+            const auto* seen = registry.find(loader, names[(klass + 1u) % classes]);
+
+            if (seen && (seen->loader != loader || seen->name != names[(klass + 1u) % classes])) {
+                ++mismatches;
+            }
+        }
+    };
+
+    auto workers = std::vector<std::jthread>{};
+
+    for (auto thread = 0u; thread < threads; ++thread) {
+        workers.emplace_back(register_all, thread);
+    }
+
+    workers.clear();
+
+    EXPECT_EQ(0u, mismatches.load());
+    EXPECT_EQ(classes * loaders, registry.size());
+
+    for (auto index = 0uz; index < classes * loaders; ++index) {
+        const auto* entry = registry.find(index / classes, names[index % classes]);
+
+        EXPECT_EQ(1u, wins[index].load());
+        ASSERT_NE(nullptr, entry);
+        EXPECT_EQ(entries[index].load(), entry);
+        EXPECT_EQ(names[index % classes], entry->name);
+    }
+}
+
+} // namespace kh::jvm::registry
@@ -0,0 +1,295 @@
+#include "gtest/gtest.h"
+
+#include "parsing.h"
+#include "rewriting.h"
+#include "serialization.h"
+#include "tests/helpers.h"
+
+namespace kh::jvm::rewriting {
+
+namespace {
+
+auto add_code_method(
+        classfile::ClassFile& klass,
+        arena::Arena& arena,
+        std::span<const std::byte> bytecode,
+        std::vector<attribute::Attribute> attributes = {},
+        std::vector<code::ExceptionHandler> exception_table = {}) -> std::size_t {
+    const auto code = code::Code{
+        .max_stack = 2u,
+        .max_locals = 1u,
+        .bytecode = bytecode,
+        .exception_table = std::move(exception_table),
+        .attributes = std::move(attributes)
+    };
+
+    kh::sinks::VectorSink sink{};
+    serialization::serialize(sink, code);
+
+    klass.methods.push_back(
+        method::Method{
+            .access_flags = static_cast<std::uint16_t>(method::AccessFlags::ACC_STATIC),
+            .name_index = static_cast<std::uint16_t>(
+                klass.constant_pool.try_add_utf8_entry("run")
+            ),
+            .descriptor_index = static_cast<std::uint16_t>(
+                klass.constant_pool.try_add_utf8_entry("(I)I")
+            ),
+            .attributes = std::vector<attribute::Attribute>{
+                attribute::Attribute{
+                    static_cast<std::uint16_t>(klass.constant_pool.try_add_utf8_entry("Code")),
+                    arena.store(sink.take())
+                }
+            }
+        }
+    );
+
+    return klass.methods.size() - 1;
+}
+
+auto committed_code(const classfile::ClassFile& klass, std::size_t method_index)
+        -> code::Code {
+    auto reader = kh::reader::Reader{klass.methods[method_index].attributes.front().data};
+    return parsing::parse_code(reader).value();
+}
+
+} // namespace
+
+TEST(Rewriting, RetargetsBranchesToInsertedCode) {
+    const auto class_name = std::string{"Example"};
+    const auto superclass_name = std::string{"java/lang/Object"};
+    auto klass = classfile::ClassFile{class_name, superclass_name};
+    klass.version = classfile::Version{49u, 0u};
+    auto arena = arena::Arena{};
+
+    constexpr auto bytecode = std::to_array<const std::byte>({
+        // iload_0, ifeq +5
+        std::byte{0x1A}, std::byte{0x99}, std::byte{0x00}, std::byte{0x05},
+        // iconst_1, ireturn
+        std::byte{0x04}, std::byte{0xAC},
+        // iconst_0, ireturn
+        std::byte{0x03}, std::byte{0xAC}
+    });
+
+    const auto method_index = add_code_method(klass, arena, bytecode);
+    auto editor = CodeEditor::open(klass, arena, method_index);
+
+    ASSERT_TRUE(editor);
+
+    constexpr auto nop = std::to_array({std::byte{0x00}});
+    editor.value().insert_before(5u, nop);
+    editor.value().insert_before(7u, nop);
+
+    ASSERT_TRUE(editor.value().commit());
+
+    constexpr auto expected = std::to_array<const std::byte>({
+        std::byte{0x1A}, std::byte{0x99}, std::byte{0x00}, std::byte{0x06},
+        std::byte{0x04}, std::byte{0x00}, std::byte{0xAC},
+        std::byte{0x03}, std::byte{0x00}, std::byte{0xAC}
+    });
+
+    EXPECT_THAT(expected, EqualsBinary(committed_code(klass, method_index).bytecode));
+}
+
+TEST(Rewriting, SplitsHandlerRangesAroundGaps) {
+    const auto class_name = std::string{"Example"};
+    const auto superclass_name = std::string{"java/lang/Object"};
+    auto klass = classfile::ClassFile{class_name, superclass_name};
+    klass.version = classfile::Version{49u, 0u};
+    auto arena = arena::Arena{};
+
+    const auto method_index = add_code_method(klass, arena, fixtures::branching_bytecode);
+    auto editor = CodeEditor::open(klass, arena, method_index);
+
+    ASSERT_TRUE(editor);
+
+    constexpr auto nop = std::to_array({std::byte{0x00}});
+    editor.value().insert_before(5u, nop);
+    editor.value().insert_before(7u, nop);
+
+    constexpr auto rethrow = std::to_array({std::byte{0xBF}});
+    editor.value().append_handler(rethrow, 0u, 8u, 0u, {}, {7u, 5u});
+
+    ASSERT_TRUE(editor.value().commit());
+
+    const auto code = committed_code(klass, method_index);
+
+    ASSERT_EQ(2u, code.exception_table.size());
+    EXPECT_EQ(0u, code.exception_table[0].start_pc);
+    EXPECT_EQ(5u, code.exception_table[0].end_pc);
+    EXPECT_EQ(7u, code.exception_table[1].start_pc);
+    EXPECT_EQ(8u, code.exception_table[1].end_pc);
+    EXPECT_EQ(10u, code.exception_table[0].handler_pc);
+    EXPECT_EQ(10u, code.exception_table[1].handler_pc);
+}
+
+TEST(Rewriting, StartsHandlerRangesBeforeCodeInsertedAfter) {
+    const auto class_name = std::string{"Example"};
+    const auto superclass_name = std::string{"java/lang/Object"};
+    auto klass = classfile::ClassFile{class_name, superclass_name};
+    klass.version = classfile::Version{49u, 0u};
+    auto arena = arena::Arena{};
+
+    const auto method_index = add_code_method(
+        klass,
+        arena,
+        fixtures::branching_bytecode,
+        {},
+        {code::ExceptionHandler{4u, 6u, 6u, 0u}}
+    );
+
+    auto editor = CodeEditor::open(klass, arena, method_index);
+
+    ASSERT_TRUE(editor);
+
+    constexpr auto nop = std::to_array({std::byte{0x00}});
+    editor.value().insert_after(1u, nop);
+
+    ASSERT_TRUE(editor.value().commit());
+
+    const auto code = committed_code(klass, method_index);
+
+    ASSERT_EQ(1u, code.exception_table.size());
+    EXPECT_EQ(4u, code.exception_table.front().start_pc);
+    EXPECT_EQ(7u, code.exception_table.front().end_pc);
+    EXPECT_EQ(7u, code.exception_table.front().handler_pc);
+}
+
+TEST(Rewriting, RejectsOversizedFrames) {
+    const auto class_name = std::string{"Example"};
+    const auto superclass_name = std::string{"java/lang/Object"};
+    auto klass = classfile::ClassFile{class_name, superclass_name};
+    klass.version = classfile::Version{49u, 0u};
+    auto arena = arena::Arena{};
+
+    const auto method_index = add_code_method(klass, arena, fixtures::branching_bytecode);
+    auto editor = CodeEditor::open(klass, arena, method_index);
+
+    ASSERT_TRUE(editor);
+
+    editor.value().reserve_stack(0xFFFFu);
+
+    const auto result = editor.value().commit();
+
+    ASSERT_FALSE(result);
+    EXPECT_EQ(Error::FrameTooLarge, result.error());
+}
+
+TEST(Rewriting, RealignsSwitchPadding) {
+    const auto class_name = std::string{"Example"};
+    const auto superclass_name = std::string{"java/lang/Object"};
+    auto klass = classfile::ClassFile{class_name, superclass_name};
+    klass.version = classfile::Version{49u, 0u};
+    auto arena = arena::Arena{};
+
+    constexpr auto bytecode = std::to_array<const std::byte>({
+        // iload_0, tableswitch + padding
+        std::byte{0x1A}, std::byte{0xAA}, std::byte{0x00}, std::byte{0x00},
+        // Default
+        std::byte{0x00}, std::byte{0x00}, std::byte{0x00}, std::byte{0x13},
+        // Low, high
+        std::byte{0x00}, std::byte{0x00}, std::byte{0x00}, std::byte{0x00},
+        std::byte{0x00}, std::byte{0x00}, std::byte{0x00}, std::byte{0x00},
+        // Case 0
+        std::byte{0x00}, std::byte{0x00}, std::byte{0x00}, std::byte{0x13},
+        // iconst_0, ireturn
+        std::byte{0x03}, std::byte{0xAC}
+    });
+
+    const auto method_index = add_code_method(klass, arena, bytecode);
+    auto editor = CodeEditor::open(klass, arena, method_index);
+
+    ASSERT_TRUE(editor);
+
+    constexpr auto nop = std::to_array({std::byte{0x00}});
+    editor.value().prologue(nop);
+
+    ASSERT_TRUE(editor.value().commit());
+
+    constexpr auto expected = std::to_array<const std::byte>({
+        std::byte{0x00},
+        std::byte{0x1A}, std::byte{0xAA}, std::byte{0x00},
+        std::byte{0x00}, std::byte{0x00}, std::byte{0x00}, std::byte{0x12},
+        std::byte{0x00}, std::byte{0x00}, std::byte{0x00}, std::byte{0x00},
+        std::byte{0x00}, std::byte{0x00}, std::byte{0x00}, std::byte{0x00},
+        std::byte{0x00}, std::byte{0x00}, std::byte{0x00}, std::byte{0x12},
+        std::byte{0x03}, std::byte{0xAC}
+    });
+
+    EXPECT_THAT(expected, EqualsBinary(committed_code(klass, method_index).bytecode));
+}
+
+TEST(Rewriting, RelocatesStackMapFramesAndAddsLocals) {
+    const auto class_name = std::string{"Example"};
+    const auto superclass_name = std::string{"java/lang/Object"};
+    auto klass = classfile::ClassFile{class_name, superclass_name};
+    klass.version = classfile::Version{52u, 0u};
+    auto arena = arena::Arena{};
+
+    constexpr auto bytecode = std::to_array<const std::byte>({
+        std::byte{0x1A}, std::byte{0x99}, std::byte{0x00}, std::byte{0x05},
+        std::byte{0x04}, std::byte{0xAC},
+        std::byte{0x03}, std::byte{0xAC}
+    });
+
+    // NOTE(garrett): A single same_frame at offset 6
+    constexpr auto stack_map = std::to_array<const std::byte>({
+        std::byte{0x00}, std::byte{0x01}, std::byte{0x06}
+    });
+
+    const auto method_index = add_code_method(
+        klass,
+        arena,
+        bytecode,
+        std::vector<attribute::Attribute>{
+            attribute::Attribute{
+                static_cast<std::uint16_t>(
+                    klass.constant_pool.try_add_utf8_entry("StackMapTable")
+                ),
+                stack_map
+            }
+        }
+    );
+
+    auto editor = CodeEditor::open(klass, arena, method_index);
+    ASSERT_TRUE(editor);
+
+    const auto local = editor.value().add_local(
+        stack_map::VerificationType{stack_map::VerificationTag::Long, 0u}
+    );
+
+    EXPECT_EQ(1u, local);
+
+    constexpr auto prologue = std::to_array({
+        // lconst_0, lstore_1
+        std::byte{0x09}, std::byte{0x40}
+    });
+
+    editor.value().prologue(prologue);
+    ASSERT_TRUE(editor.value().commit());
+
+    const auto code = committed_code(klass, method_index);
+
+    EXPECT_EQ(3u, code.max_locals);
+    ASSERT_EQ(1u, code.attributes.size());
+
+    auto reader = kh::reader::Reader{code.attributes.front().data};
+    const auto frames = parsing::parse_stack_map_table(
+        reader,
+        std::vector<stack_map::VerificationType>{
+            stack_map::VerificationType{stack_map::VerificationTag::Integer, 0u}
+        }
+    );
+
+    ASSERT_TRUE(frames);
+    ASSERT_EQ(1u, frames.value().size());
+    EXPECT_EQ(8u, frames.value().front().offset);
+    ASSERT_EQ(2u, frames.value().front().locals.size());
+
+    EXPECT_EQ(
+        stack_map::VerificationTag::Long,
+        frames.value().front().locals.back().tag
+    );
+}
+
+} // namespace kh::jvm::rewriting
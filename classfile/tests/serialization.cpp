@@ -1,5 +1,10 @@
+#include <cstdio>
+
+#include <unistd.h>
+
 #include "gtest/gtest.h"
 
+#include "parsing.h"
 #include "serialization.h"
 #include "tests/helpers.h"
 
@@ -278,4 +283,140 @@ TEST(Serialization, SerializesClassFile) {
     EXPECT_THAT(expected, EqualsBinary(actual));
 }
 
+TEST(Serialization, CopiesUnmodifiedClassFilesThrough) {
+    const auto class_name = std::string{"MyClass"};
+    const auto superclass_name = std::string{"java/lang/Object"};
+    auto original = classfile::ClassFile(class_name, superclass_name);
+
+    original.fields.push_back(
+        field::Field{
+            .access_flags = static_cast<std::uint16_t>(field::AccessFlags::ACC_PRIVATE),
+            .name_index = static_cast<std::uint16_t>(
+                original.constant_pool.try_add_utf8_entry("count")
+            ),
+            .descriptor_index = static_cast<std::uint16_t>(
+                original.constant_pool.try_add_utf8_entry("I")
+            ),
+            .attributes = std::vector<attribute::Attribute>{}
+        }
+    );
+
+    kh::sinks::VectorSink original_sink{};
+    serialize(original_sink, original);
+
+    const auto bytes = original_sink.take();
+    auto reader = kh::reader::Reader{bytes};
+    auto parsed = parsing::parse_class_file(reader);
+
+    ASSERT_TRUE(parsed);
+    EXPECT_EQ(bytes.size(), parsed->constant_pool.source().size() + 32u);
+    EXPECT_EQ(8u, parsed->fields[0].source.size());
+
+    kh::sinks::VectorSink unchanged{};
+    serialize(unchanged, parsed.value());
+
+    EXPECT_THAT(bytes, EqualsBinary(unchanged.view()));
+
+    parsed->fields[0].access_flags = static_cast<std::uint16_t>(field::AccessFlags::ACC_PUBLIC);
+    parsed->constant_pool.try_add_utf8_entry("Added");
+
+    kh::sinks::VectorSink changed{};
+    serialize(changed, parsed.value());
+
+    auto changed_reader = kh::reader::Reader{changed.view()};
+    const auto reparsed = parsing::parse_class_file(changed_reader);
+
+    ASSERT_TRUE(reparsed);
+    EXPECT_EQ(
+        static_cast<std::uint16_t>(field::AccessFlags::ACC_PUBLIC),
+        reparsed->fields[0].access_flags
+    );
+    EXPECT_EQ(parsed->constant_pool.count(), reparsed->constant_pool.count());
+}
+
+TEST(Serialization, GathersLargeSpansWithoutCopying) {
+    auto payload = std::vector<std::byte>(256u, std::byte{0x2A});
+    const auto method = method::Method{
+        .access_flags = static_cast<std::uint16_t>(method::AccessFlags::ACC_PUBLIC),
+        .name_index = 3u,
+        .descriptor_index = 4u,
+        .attributes = std::vector<attribute::Attribute>{
+            attribute::Attribute{5u, payload},
+            attribute::Attribute{6u, std::span{payload}.first(8u)}
+        }
+    };
+
+    auto* file = std::tmpfile();
+    ASSERT_NE(nullptr, file);
+
+    kh::sinks::VectoredSink sink{::fileno(file), off_t{0}};
+    serialize(sink, method);
+
+    // NOTE(garrett): Header fields, the referenced payload, then the short
+    // attribute staged together with the header before it.
+    EXPECT_EQ(3u, sink.segments());
+
+    kh::sinks::VectorSink expected{};
+    serialize(expected, method);
+
+    EXPECT_EQ(expected.view().size(), sink.size());
+    sink.flush();
+    EXPECT_EQ(0u, sink.size());
+
+    auto actual = std::vector<std::byte>(expected.view().size() + 1u);
+    const auto read = ::pread(::fileno(file), actual.data(), actual.size(), 0);
+    std::fclose(file);
+
+    ASSERT_EQ(static_cast<ssize_t>(expected.view().size()), read);
+    actual.resize(static_cast<std::size_t>(read));
+
+    EXPECT_THAT(expected.view(), EqualsBinary(actual));
+}
+
+TEST(Serialization, SerializesIntoPresizedBuffers) {
+    const auto class_name = std::string{"MyClass"};
+    const auto superclass_name = std::string{"java/lang/Object"};
+    auto klass = classfile::ClassFile(class_name, superclass_name);
+
+    const auto payload = std::vector<std::byte>(100u, std::byte{0x11});
+
+    klass.attributes.push_back(
+        attribute::Attribute{
+            static_cast<std::uint16_t>(klass.constant_pool.try_add_utf8_entry("Custom")),
+            payload
+        }
+    );
+
+    kh::sinks::VectorSink expected{};
+    serialize(expected, klass);
+
+    const auto size = serialized_size(klass);
+    ASSERT_EQ(expected.view().size(), size);
+
+    auto buffer = std::vector<std::byte>(size);
+    kh::sinks::SpanSink span_sink{buffer};
+    serialize(span_sink, klass);
+
+    EXPECT_EQ(size, span_sink.size());
+    EXPECT_THAT(expected.view(), EqualsBinary(buffer));
+
+    auto* file = std::tmpfile();
+    ASSERT_NE(nullptr, file);
+
+    {
+        kh::sinks::MappedSink mapped_sink{::fileno(file), size};
+        serialize(mapped_sink, klass);
+        EXPECT_EQ(size, mapped_sink.size());
+    }
+
+    auto actual = std::vector<std::byte>(size + 1u);
+    const auto read = ::pread(::fileno(file), actual.data(), actual.size(), 0);
+    std::fclose(file);
+
+    ASSERT_EQ(static_cast<ssize_t>(size), read);
+    actual.resize(size);
+
+    EXPECT_THAT(expected.view(), EqualsBinary(actual));
+}
+
 } // namespace kh::jvm::serialization
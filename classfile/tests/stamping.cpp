@@ -0,0 +1,146 @@
+#include "gtest/gtest.h"
+
+#include "bytecode.h"
+#include "parsing.h"
+#include "serialization.h"
+#include "stamping.h"
+#include "views.h"
+
+namespace kh::jvm::stamping {
+
+namespace {
+
+struct Example {
+    classfile::ClassFile klass;
+    std::uint16_t constant;
+    std::size_t access_flags_offset;
+};
+
+auto example_class(arena::Arena& arena) -> Example {
+    static const auto class_name = std::string{"example/Proxy$Template"};
+    static const auto superclass_name = std::string{"java/lang/Object"};
+    auto klass = classfile::ClassFile{class_name, superclass_name};
+
+    const auto constant = static_cast<std::uint16_t>(
+        klass.constant_pool.add(constant_pool::IntegerEntry{0u})
+    );
+
+    auto assembler = bytecode::Assembler{};
+    assembler.op(bytecode::Opcode::LDC, static_cast<std::uint8_t>(constant))
+        .op(bytecode::Opcode::IRETURN);
+
+    kh::sinks::VectorSink sink{};
+
+    serialization::serialize(
+        sink,
+        code::Code{
+            .max_stack = 1u,
+            .max_locals = 0u,
+            .bytecode = arena.store(assembler.take()),
+            .exception_table = std::vector<code::ExceptionHandler>{},
+            .attributes = std::vector<attribute::Attribute>{}
+        }
+    );
+
+    klass.methods.push_back(
+        method::Method{
+            .access_flags = static_cast<std::uint16_t>(method::AccessFlags::ACC_STATIC),
+            .name_index = static_cast<std::uint16_t>(
+                klass.constant_pool.try_add_utf8_entry("id")
+            ),
+            .descriptor_index = static_cast<std::uint16_t>(
+                klass.constant_pool.try_add_utf8_entry("()I")
+            ),
+            .attributes = std::vector<attribute::Attribute>{
+                attribute::Attribute{
+                    static_cast<std::uint16_t>(klass.constant_pool.try_add_utf8_entry("Code")),
+                    arena.store(sink.take())
+                }
+            }
+        }
+    );
+
+    // NOTE(garrett): Magic, version and pool count precede the pool
+    const auto access_flags_offset = 10u + serialization::serialized_size(klass.constant_pool);
+
+    return Example{std::move(klass), constant, access_flags_offset};
+}
+
+} // namespace
+
+TEST(Stamping, StampsInstancesFromTemplate) {
+    auto arena = arena::Arena{};
+    const auto example = example_class(arena);
+    auto stamp_template = Template::create(example.klass);
+
+    ASSERT_EQ(0u, stamp_template.text(1u));
+    ASSERT_EQ(1u, stamp_template.constant(example.constant));
+    ASSERT_EQ(2u, stamp_template.value(example.access_flags_offset, 2u));
+
+    for (auto i = 0u; i < 3u; ++i) {
+        const auto name = "example/Proxy$" + std::to_string(i * 1000u);
+        const auto arguments = std::to_array<Argument>({
+            std::string_view{name},
+            std::uint64_t{i + 7u},
+            std::uint64_t{0x0011u}
+        });
+
+        kh::sinks::VectorSink sink{};
+        ASSERT_TRUE(stamp_template.stamp(sink, arguments));
+        EXPECT_EQ(stamp_template.stamped_size(arguments), sink.view().size());
+
+        auto reader = kh::reader::Reader{sink.view()};
+        const auto parsed = parsing::parse_class_file(reader);
+
+        ASSERT_TRUE(parsed);
+
+        const auto view = views::ClassView{parsed.value()};
+
+        EXPECT_EQ(name, view.name());
+        EXPECT_TRUE(view.method("id"));
+        EXPECT_EQ(0x0011u, parsed->access_flags);
+        EXPECT_EQ(
+            i + 7u,
+            parsed->constant_pool.resolve<constant_pool::IntegerEntry>(example.constant).value
+        );
+    }
+}
+
+TEST(Stamping, RejectsInvalidSlotsAndArguments) {
+    auto arena = arena::Arena{};
+    const auto example = example_class(arena);
+    auto stamp_template = Template::create(example.klass);
+
+    EXPECT_EQ(Error::InvalidSlot, stamp_template.text(example.constant).error());
+    EXPECT_EQ(Error::InvalidSlot, stamp_template.constant(1u).error());
+    EXPECT_EQ(Error::InvalidSlot, stamp_template.value(stamp_template.bytes().size(), 1u).error());
+
+    ASSERT_TRUE(stamp_template.constant(example.constant));
+    ASSERT_TRUE(stamp_template.value(example.access_flags_offset, 2u));
+    EXPECT_EQ(
+        Error::OverlappingSlot,
+        stamp_template.value(example.access_flags_offset + 1u, 2u).error()
+    );
+    EXPECT_EQ(Error::OverlappingSlot, stamp_template.constant(example.constant).error());
+
+    kh::sinks::VectorSink sink{};
+
+    EXPECT_EQ(Error::ArgumentCount, stamp_template.stamp(sink, {}).error());
+    EXPECT_EQ(
+        Error::InvalidArgument,
+        stamp_template.stamp(
+            sink,
+            std::to_array<Argument>({std::string_view{"text"}, std::uint64_t{0u}})
+        ).error()
+    );
+    EXPECT_EQ(
+        Error::InvalidArgument,
+        stamp_template.stamp(
+            sink,
+            std::to_array<Argument>({std::uint64_t{1ull << 32}, std::uint64_t{0u}})
+        ).error()
+    );
+    EXPECT_TRUE(sink.view().empty());
+}
+
+} // namespace kh::jvm::stamping
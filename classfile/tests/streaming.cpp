@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cstdio>
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "jar.h"
+#include "streaming.h"
+#include "tests/helpers.h"
+#include "views.h"
+
+namespace kh::jvm::streaming {
+
+namespace {
+
+using fixtures::class_bytes;
+using fixtures::write_file;
+
+// NOTE(garrett): Names and class names, or the error, of everything streamed
+auto summarize(const std::filesystem::path& input, const std::size_t window)
+        -> std::vector<std::pair<std::string, std::string>> {
+    auto streamed = std::vector<std::pair<std::string, std::string>>{};
+
+    for (const auto& klass : stream(input, window)) {
+        streamed.emplace_back(
+            std::string{klass.name},
+            klass.klass ? std::string{views::ClassView{klass.klass.value()}.name()}
+                : std::string{name(klass.klass.error())}
+        );
+    }
+
+    return streamed;
+}
+
+} // namespace
+
+TEST(Streaming, StreamsDirectoriesLazily) {
+    const auto directory = std::filesystem::temp_directory_path()
+        / ("kh-streaming-" + std::to_string(::getpid()));
+
+    std::filesystem::remove_all(directory);
+
+    for (auto i = 0u; i < 10u; ++i) {
+        const auto name = "p" + std::to_string(i % 3u) + "/C" + std::to_string(i);
+        write_file(directory / (name + ".class"), class_bytes(name));
+    }
+
+    write_file(directory / "Broken.class", std::as_bytes(std::span{"broken", 6u}));
+    write_file(directory / "README.txt", std::as_bytes(std::span{"ignored", 7u}));
+
+    // NOTE(garrett): Windows both smaller and larger than the directory
+    for (const auto window : {0uz, 2uz, 64uz}) {
+        auto streamed = summarize(directory, window);
+        std::ranges::sort(streamed);
+
+        ASSERT_EQ(11u, streamed.size());
+        EXPECT_EQ("Broken.class", streamed[0].first);
+        EXPECT_EQ(name(Error::ParseFailed), streamed[0].second);
+        EXPECT_EQ("p0/C0.class", streamed[1].first);
+        EXPECT_EQ("p0/C0", streamed[1].second);
+        EXPECT_EQ("p2/C8.class", streamed[10].first);
+        EXPECT_EQ("p2/C8", streamed[10].second);
+    }
+
+    // NOTE(garrett): Stopping early releases everything still in the window
+    for (const auto& klass : stream(directory, 4u)) {
+        EXPECT_FALSE(klass.name.empty());
+        break;
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(Streaming, ReportsUnlistableDirectoriesAndCarriesOn) {
+    if (::geteuid() == 0) {
+        GTEST_SKIP() << "Permissions don't stop root from listing directories";
+    }
+
+    const auto directory = std::filesystem::temp_directory_path()
+        / ("kh-streaming-unlistable-" + std::to_string(::getpid()));
+
+    std::filesystem::remove_all(directory);
+    write_file(directory / "a/First.class", class_bytes("a/First"));
+    write_file(directory / "b/Hidden.class", class_bytes("b/Hidden"));
+    write_file(directory / "c/Last.class", class_bytes("c/Last"));
+
+    std::filesystem::permissions(directory / "b", std::filesystem::perms::none);
+
+    auto streamed = summarize(directory, 1u);
+    std::ranges::sort(streamed);
+
+    std::filesystem::permissions(directory / "b", std::filesystem::perms::owner_all);
+    std::filesystem::remove_all(directory);
+
+    const auto expected = std::vector<std::pair<std::string, std::string>>{
+        {"a/First.class", "a/First"},
+        {"b", std::string{name(Error::ReadFailed)}},
+        {"c/Last.class", "c/Last"}
+    };
+
+    EXPECT_EQ(expected, streamed);
+}
+
+TEST(Streaming, StreamsArchivesInOrder) {
+    const auto path = std::filesystem::temp_directory_path()
+        / ("kh-streaming-" + std::to_string(::getpid()) + ".jar");
+
+    {
+        auto pool = kh::threading::ThreadPool{1u};
+        auto file = std::fopen(path.c_str(), "wb");
+        ASSERT_NE(nullptr, file);
+
+        auto writer = jar::Writer{::fileno(file), pool};
+
+        ASSERT_TRUE(writer.add("META-INF/MANIFEST.MF", {}));
+        ASSERT_TRUE(writer.add("b/Second.class", class_bytes("b/Second")));
+        ASSERT_TRUE(writer.add("a/First.class", class_bytes("a/First"), jar::Compression::Stored));
+        ASSERT_TRUE(writer.finish());
+
+        std::fclose(file);
+    }
+
+    const auto streamed = summarize(path, 1u);
+    const auto missing = summarize(path.string() + ".missing", 1u);
+    std::filesystem::remove(path);
+
+    const auto expected = std::vector<std::pair<std::string, std::string>>{
+        {"b/Second.class", "b/Second"},
+        {"a/First.class", "a/First"}
+    };
+
+    EXPECT_EQ(expected, streamed);
+    ASSERT_EQ(1u, missing.size());
+    EXPECT_EQ(name(Error::ReadFailed), missing[0].second);
+}
+
+} // namespace kh::jvm::streaming
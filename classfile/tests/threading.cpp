@@ -0,0 +1,79 @@
+#include <atomic>
+#include <latch>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "threading.h"
+
+namespace kh::threading {
+
+TEST(ThreadPool, RunsSubmittedTasks) {
+    auto pool = ThreadPool{4u};
+    auto futures = std::vector<std::future<std::size_t>>{};
+
+    for (auto i = 0uz; i < 64uz; ++i) {
+        futures.push_back(pool.submit([i] { return i * i; }));
+    }
+
+    ASSERT_EQ(4u, pool.size());
+
+    for (auto i = 0uz; i < futures.size(); ++i) {
+        EXPECT_EQ(i * i, futures[i].get());
+    }
+}
+
+TEST(ThreadPool, FinishesQueuedTasksOnDestruction) {
+    auto counter = std::atomic<std::size_t>{0u};
+
+    {
+        auto pool = ThreadPool{1u};
+
+        for (auto i = 0u; i < 32u; ++i) {
+            pool.submit([&counter, value = std::make_unique<std::size_t>(1u)] {
+                counter += *value;
+            });
+        }
+    }
+
+    EXPECT_EQ(32u, counter.load());
+}
+
+TEST(ThreadPool, StealsTasksFromBlockedWorkers) {
+    auto pool = ThreadPool{4u};
+    auto finished = std::latch{64};
+
+    // NOTE(garrett): Children land on the blocked parent's own queue, so only
+    // stealing lets them run
+    auto parent = pool.submit([&pool, &finished] {
+        for (auto i = 0u; i < 64u; ++i) {
+            pool.post([&finished] { finished.count_down(); });
+        }
+
+        finished.wait();
+        return true;
+    });
+
+    EXPECT_TRUE(parent.get());
+}
+
+TEST(ThreadPool, RunsOutsideTasksInOrder) {
+    auto order = std::vector<std::size_t>{};
+    auto release = std::latch{1};
+
+    {
+        auto pool = ThreadPool{1u};
+        pool.post([&release] { release.wait(); });
+
+        for (auto i = 0uz; i < 8uz; ++i) {
+            pool.post([&order, i] { order.push_back(i); });
+        }
+
+        release.count_down();
+    }
+
+    EXPECT_EQ((std::vector<std::size_t>{0u, 1u, 2u, 3u, 4u, 5u, 6u, 7u}), order);
+}
+
+} // namespace kh::threading
@@ -0,0 +1,172 @@
+#include "gtest/gtest.h"
+
+#include "instrumentation.h"
+#include "serialization.h"
+#include "tests/helpers.h"
+#include "verification.h"
+
+namespace kh::jvm::verification {
+
+namespace {
+
+using fixtures::add_static_method;
+using fixtures::branching_bytecode;
+
+auto branching_frames() -> std::vector<stack_map::Frame> {
+    return {
+        stack_map::Frame{
+            6u,
+            {stack_map::VerificationType{stack_map::VerificationTag::Integer, 0u}},
+            {}
+        }
+    };
+}
+
+} // namespace
+
+TEST(Verification, AcceptsMethodsWithStackMapFrames) {
+    const auto class_name = std::string{"Example"};
+    const auto superclass_name = std::string{"java/lang/Object"};
+    auto klass = classfile::ClassFile{class_name, superclass_name};
+    auto arena = arena::Arena{};
+
+    add_static_method(klass, arena, "run", "(I)I", branching_bytecode, branching_frames());
+
+    EXPECT_TRUE(verify_method(klass, 0u));
+    EXPECT_TRUE(verify(klass).empty());
+}
+
+TEST(Verification, RejectsBranchesWithoutFrames) {
+    const auto class_name = std::string{"Example"};
+    const auto superclass_name = std::string{"java/lang/Object"};
+    auto klass = classfile::ClassFile{class_name, superclass_name};
+    auto arena = arena::Arena{};
+
+    add_static_method(klass, arena, "run", "(I)I", branching_bytecode);
+
+    const auto result = verify_method(klass, 0u);
+
+    ASSERT_FALSE(result);
+    EXPECT_EQ(Error::MissingFrame, result.error().error);
+    EXPECT_EQ(1u, result.error().offset);
+}
+
+TEST(Verification, RejectsIncompatibleOperands) {
+    const auto class_name = std::string{"Example"};
+    const auto superclass_name = std::string{"java/lang/Object"};
+    auto klass = classfile::ClassFile{class_name, superclass_name};
+    auto arena = arena::Arena{};
+
+    // NOTE(garrett): iload_0, lreturn
+    constexpr auto wrong_return = std::to_array({std::byte{0x1A}, std::byte{0xAD}});
+    // NOTE(garrett): iload_0, iload_0, iadd, ireturn
+    constexpr auto too_deep = std::to_array({
+        std::byte{0x1A}, std::byte{0x1A}, std::byte{0x60}, std::byte{0xAC}
+    });
+
+    add_static_method(klass, arena, "wrong", "(I)J", wrong_return, {}, 2u);
+    add_static_method(klass, arena, "deep", "(I)I", too_deep);
+
+    const auto failures = verify(klass, 2u);
+
+    ASSERT_EQ(2u, failures.size());
+    EXPECT_EQ(0u, failures[0].method_index);
+    EXPECT_EQ(Error::IncompatibleType, failures[0].error);
+    EXPECT_EQ(1u, failures[1].method_index);
+    EXPECT_EQ(Error::StackOverflow, failures[1].error);
+    EXPECT_EQ(1u, failures[1].offset);
+}
+
+TEST(Verification, RejectsDynamicConstantsWithBadDescriptors) {
+    const auto class_name = std::string{"Example"};
+    const auto superclass_name = std::string{"java/lang/Object"};
+    auto klass = classfile::ClassFile{class_name, superclass_name};
+    auto arena = arena::Arena{};
+    auto& pool = klass.constant_pool;
+
+    using constant_pool::DynamicEntry;
+    using constant_pool::NameAndTypeEntry;
+    using constant_pool::UTF8Entry;
+
+    const auto missing = static_cast<std::uint16_t>(pool.add(DynamicEntry{0u, 0xFFFFu}));
+
+    const auto name = static_cast<std::uint16_t>(pool.add(UTF8Entry{"value"}));
+    const auto empty = static_cast<std::uint16_t>(pool.add(UTF8Entry{""}));
+    const auto name_and_type = static_cast<std::uint16_t>(
+        pool.add(NameAndTypeEntry{name, empty})
+    );
+    const auto nameless = static_cast<std::uint16_t>(pool.add(DynamicEntry{0u, name_and_type}));
+
+    // NOTE(garrett): ldc2_w, lreturn
+    const auto wide = std::to_array({
+        std::byte{0x14},
+        static_cast<std::byte>(missing >> 8u),
+        static_cast<std::byte>(missing & 0xFFu),
+        std::byte{0xAD}
+    });
+
+    // NOTE(garrett): ldc, ireturn
+    const auto narrow = std::to_array({
+        std::byte{0x12}, static_cast<std::byte>(nameless), std::byte{0xAC}
+    });
+
+    add_static_method(klass, arena, "wide", "()J", wide, {}, 2u);
+    add_static_method(klass, arena, "narrow", "()I", narrow);
+
+    const auto failures = verify(klass);
+
+    ASSERT_EQ(2u, failures.size());
+    EXPECT_EQ(Error::InvalidConstant, failures[0].error);
+    EXPECT_EQ(Error::InvalidDescriptor, failures[1].error);
+}
+
+TEST(Verification, AcceptsInstrumentedMethods) {
+    const auto class_name = std::string{"Example"};
+    const auto superclass_name = std::string{"java/lang/Object"};
+    auto klass = classfile::ClassFile{class_name, superclass_name};
+    auto arena = arena::Arena{};
+
+    add_static_method(klass, arena, "run", "(I)I", branching_bytecode, branching_frames());
+
+    // NOTE(garrett): iload_0, newarray int, monitorenter, return
+    constexpr auto locking_bytecode = std::to_array({
+        std::byte{0x1A}, std::byte{0xBC}, std::byte{0x0A}, std::byte{0xC2}, std::byte{0xB1}
+    });
+
+    add_static_method(klass, arena, "lock", "(I)V", locking_bytecode);
+    klass.methods.back().access_flags |= static_cast<std::uint16_t>(
+        method::AccessFlags::ACC_SYNCHRONIZED
+    );
+
+    ASSERT_TRUE(
+        instrumentation::add_latency_probes(
+            klass,
+            arena,
+            instrumentation::LatencyOptions{.methods = {"run"}}
+        )
+    );
+
+    ASSERT_TRUE(
+        instrumentation::add_allocation_sampling(
+            klass,
+            arena,
+            instrumentation::AllocationOptions{.callback_class = "example/Profiler"}
+        )
+    );
+
+    ASSERT_TRUE(
+        instrumentation::add_lock_probes(
+            klass,
+            arena,
+            instrumentation::LockOptions{.callback_class = "example/Profiler"}
+        )
+    );
+
+    for (const auto& failure : verify(klass)) {
+        ADD_FAILURE() << "Method " << failure.method_index
+            << " failed at offset " << failure.offset
+            << ": " << name(failure.error);
+    }
+}
+
+} // namespace kh::jvm::verification
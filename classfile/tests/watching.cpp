@@ -0,0 +1,81 @@
+#include <fstream>
+#include <string>
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "watching.h"
+
+namespace kh::watching {
+
+TEST(Watching, ReportsChangesBelowRoot) {
+    const auto root = std::filesystem::temp_directory_path()
+        / ("kh-watching-" + std::to_string(::getpid()));
+
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root / "a");
+    std::ofstream{root / "a" / "Removed.class"} << "removed";
+    std::ofstream{root / "a" / "Changed.class"} << "before";
+
+    auto watcher = Watcher{root};
+
+    // NOTE(garrett): Written repeatedly so the burst is only reported once,
+    // and in a new directory to make sure it's picked up
+    for (auto i = 0u; i < 3u; ++i) {
+        std::ofstream{root / "a" / "Changed.class"} << "after " << i;
+    }
+
+    std::filesystem::create_directories(root / "b" / "c");
+    std::ofstream{root / "b" / "c" / "Added.class"} << "added";
+    std::filesystem::remove(root / "a" / "Removed.class");
+
+    const auto changes = watcher.wait(std::chrono::milliseconds{50});
+    std::filesystem::remove_all(root);
+
+    ASSERT_EQ(3u, changes.size());
+
+    EXPECT_EQ(std::filesystem::path{"a/Changed.class"}, changes[0].path);
+    EXPECT_EQ(ChangeKind::Modified, changes[0].kind);
+    EXPECT_EQ(std::filesystem::path{"a/Removed.class"}, changes[1].path);
+    EXPECT_EQ(ChangeKind::Removed, changes[1].kind);
+    EXPECT_EQ(std::filesystem::path{"b/c/Added.class"}, changes[2].path);
+    EXPECT_EQ(ChangeKind::Modified, changes[2].kind);
+}
+
+TEST(Watching, ReportsFilesBelowDirectoriesMovedAway) {
+    const auto base = std::filesystem::temp_directory_path()
+        / ("kh-watching-moved-" + std::to_string(::getpid()));
+
+    const auto root = base / "root";
+
+    std::filesystem::remove_all(base);
+    std::filesystem::create_directories(root / "a" / "b");
+    std::ofstream{root / "a" / "First.class"} << "first";
+    std::ofstream{root / "a" / "b" / "Second.class"} << "second";
+    std::ofstream{root / "Kept.class"} << "kept";
+
+    auto watcher = Watcher{root};
+    std::filesystem::rename(root / "a", base / "a");
+
+    const auto changes = watcher.wait(std::chrono::milliseconds{50});
+
+    // NOTE(garrett): Writes below the moved directory are no longer in the tree
+    std::ofstream{base / "a" / "First.class"} << "changed";
+    std::ofstream{root / "Kept.class"} << "changed";
+
+    const auto later = watcher.wait(std::chrono::milliseconds{50});
+    std::filesystem::remove_all(base);
+
+    ASSERT_EQ(2u, changes.size());
+
+    EXPECT_EQ(std::filesystem::path{"a/First.class"}, changes[0].path);
+    EXPECT_EQ(ChangeKind::Removed, changes[0].kind);
+    EXPECT_EQ(std::filesystem::path{"a/b/Second.class"}, changes[1].path);
+    EXPECT_EQ(ChangeKind::Removed, changes[1].kind);
+
+    ASSERT_EQ(1u, later.size());
+    EXPECT_EQ(std::filesystem::path{"Kept.class"}, later[0].path);
+}
+
+} // namespace kh::watching
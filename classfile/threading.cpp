@@ -0,0 +1,106 @@
+#include <algorithm>
+
+#include "threading.h"
+
+namespace kh::threading {
+
+namespace {
+
+// NOTE(garrett): Lets `push` tell whether it's being called from one of the
+// pool's own workers, and which
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local auto current_index = 0uz;
+
+} // namespace
+
+ThreadPool::ThreadPool(const unsigned int concurrency)
+        : mutex_()
+        , available_()
+        , pending_(0u)
+        , next_(0u)
+        , queues_(std::max(concurrency, 1u))
+        , workers_(std::vector<std::jthread>{}) {
+    workers_.reserve(queues_.size());
+
+    for (auto i = 0uz; i < queues_.size(); ++i) {
+        workers_.emplace_back([this, i](std::stop_token stop) { work(stop, i); });
+    }
+}
+
+auto ThreadPool::size() const noexcept -> std::size_t {
+    return workers_.size();
+}
+
+auto ThreadPool::push(Task&& task) -> void {
+    const auto local = current_pool == this;
+    const auto index = local
+        ? current_index
+        : next_.fetch_add(1u, std::memory_order_relaxed) % queues_.size();
+
+    // NOTE(garrett): Counted under the lock sleeping workers check it with, so
+    // none of them can miss the wakeup, and before the task is queued so the
+    // count never drops below zero
+    {
+        const auto lock = std::lock_guard{mutex_};
+        pending_.fetch_add(1u, std::memory_order_relaxed);
+    }
+
+    {
+        const auto lock = std::lock_guard{queues_[index].mutex};
+        (local ? queues_[index].tasks : queues_[index].injected).push_back(std::move(task));
+    }
+
+    available_.notify_one();
+}
+
+auto ThreadPool::take(const std::size_t index) -> std::optional<Task> {
+    for (auto i = 0uz; i < queues_.size(); ++i) {
+        auto& queue = queues_[(index + i) % queues_.size()];
+        const auto lock = std::lock_guard{queue.mutex};
+
+        auto task = std::optional<Task>{};
+
+        if (!queue.tasks.empty() && !i) {
+            task.emplace(std::move(queue.tasks.back()));
+            queue.tasks.pop_back();
+        } else if (!queue.tasks.empty()) {
+            task.emplace(std::move(queue.tasks.front()));
+            queue.tasks.pop_front();
+        } else if (!queue.injected.empty()) {
+            task.emplace(std::move(queue.injected.front()));
+            queue.injected.pop_front();
+        } else {
+            continue;
+        }
+
+        pending_.fetch_sub(1u, std::memory_order_relaxed);
+        return task;
+    }
+
+    return std::nullopt;
+}
+
+auto ThreadPool::work(std::stop_token stop, const std::size_t index) -> void {
+    current_pool = this;
+    current_index = index;
+
+    while (true) {
+        if (auto task = take(index)) {
+            (*task)();
+            continue;
+        }
+
+        auto lock = std::unique_lock{mutex_};
+
+        // NOTE(garrett): Only gives up once stopped with nothing left anywhere
+        const auto woken = available_.wait(lock, stop, [this] {
+            return pending_.load(std::memory_order_relaxed) > 0u;
+        });
+
+        if (!woken) {
+            return;
+        }
+    }
+}
+
+} // namespace kh::threading
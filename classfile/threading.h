@@ -0,0 +1,72 @@
+#ifndef THREADING_H
+#define THREADING_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace kh::threading {
+
+// NOTE(garrett): A fixed set of workers, each with its own queue. Tasks
+// submitted from a worker go on that worker's queue and are run newest first,
+// so recursive work stays hot in its cache, while idle workers steal the
+// oldest tasks from the others. Tasks from other threads are spread across the
+// queues in turn and kept apart, running oldest first once a worker has none
+// of its own. Tasks still queued on destruction are run before the workers
+// exit, so futures handed out by `submit` are always satisfied.
+class ThreadPool {
+private:
+    using Task = std::move_only_function<void()>;
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::deque<Task> injected;
+    };
+
+    std::mutex mutex_;
+    std::condition_variable_any available_;
+    std::atomic<std::size_t> pending_;
+    std::atomic<std::size_t> next_;
+    std::vector<Queue> queues_;
+    std::vector<std::jthread> workers_;
+
+    auto push(Task&&) -> void;
+    auto take(std::size_t index) -> std::optional<Task>;
+    auto work(std::stop_token, std::size_t index) -> void;
+public:
+    explicit ThreadPool(unsigned int concurrency = std::thread::hardware_concurrency());
+    ThreadPool(const ThreadPool&) = delete;
+    auto operator=(const ThreadPool&) -> ThreadPool& = delete;
+
+    auto size() const noexcept -> std::size_t;
+
+    template <typename F>
+    auto submit(F&& task) -> std::future<std::invoke_result_t<F>> {
+        auto packaged = std::packaged_task<std::invoke_result_t<F>()>{std::forward<F>(task)};
+        auto future = packaged.get_future();
+
+        push(Task{std::move(packaged)});
+        return future;
+    }
+
+    // NOTE(garrett): Like `submit` without the cost of a future, for tasks
+    // that report back some other way. Exceptions escaping `task` terminate.
+    template <typename F>
+    auto post(F&& task) -> void {
+        push(Task{std::forward<F>(task)});
+    }
+};
+
+} // namespace kh::threading
+
+#endif // THREADING_H
@@ -0,0 +1,1644 @@
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <optional>
+#include <string>
+
+#include "bytecode.h"
+#include "descriptor.h"
+#include "parsing.h"
+#include "verification.h"
+
+namespace kh::jvm::verification {
+
+namespace {
+
+using kh::jvm::bytecode::Opcode;
+using kh::jvm::stack_map::VerificationTag;
+using kh::jvm::stack_map::VerificationType;
+
+// NOTE(garrett): Unlike stack map entries, verifier types occupy one slot each
+// with long and double values followed by a Top for their second half.
+// References carry an internal class name or an array descriptor.
+enum class Kind : std::uint8_t {
+    Top,
+    Integer,
+    Float,
+    Long,
+    Double,
+    Null,
+    UninitializedThis,
+    Uninitialized,
+    Reference
+};
+
+struct Type {
+    Kind kind;
+    std::string_view name;
+    std::uint32_t offset;
+
+    friend auto operator==(const Type&, const Type&) -> bool = default;
+};
+
+struct State {
+    std::vector<Type> locals;
+    std::vector<Type> stack;
+};
+
+constexpr auto top = Type{Kind::Top, {}, 0u};
+constexpr auto integer = Type{Kind::Integer, {}, 0u};
+constexpr auto float_type = Type{Kind::Float, {}, 0u};
+constexpr auto long_type = Type{Kind::Long, {}, 0u};
+constexpr auto double_type = Type{Kind::Double, {}, 0u};
+constexpr auto null = Type{Kind::Null, {}, 0u};
+
+constexpr auto reference(std::string_view name) noexcept -> Type {
+    return Type{Kind::Reference, name, 0u};
+}
+
+constexpr auto is_wide(const Type type) noexcept -> bool {
+    return type.kind == Kind::Long || type.kind == Kind::Double;
+}
+
+constexpr auto is_array(const Type type) noexcept -> bool {
+    return type.kind == Kind::Reference && type.name.starts_with('[');
+}
+
+constexpr auto is_initialized_reference(const Type type) noexcept -> bool {
+    return type.kind == Kind::Reference || type.kind == Kind::Null;
+}
+
+constexpr auto is_any_reference(const Type type) noexcept -> bool {
+    return is_initialized_reference(type)
+        || type.kind == Kind::Uninitialized
+        || type.kind == Kind::UninitializedThis;
+}
+
+auto is_assignable_reference(std::string_view from, std::string_view to) -> bool {
+    if (from == to || to == "java/lang/Object") {
+        return true;
+    }
+
+    if (!from.starts_with('[')) {
+        // NOTE(garrett): Needs the class hierarchy, which isn't available
+        return !to.starts_with('[');
+    }
+
+    if (!to.starts_with('[')) {
+        return to == "java/lang/Cloneable" || to == "java/io/Serializable";
+    }
+
+    const auto from_component = from.substr(1);
+    const auto to_component = to.substr(1);
+
+    const auto is_reference_component = [](std::string_view component) {
+        return component.starts_with('L') || component.starts_with('[');
+    };
+
+    if (!is_reference_component(from_component) || !is_reference_component(to_component)) {
+        return from_component == to_component;
+    }
+
+    const auto strip = [](std::string_view component) {
+        return component.starts_with('L')
+            ? component.substr(1, component.size() - 2)
+            : component;
+    };
+
+    return is_assignable_reference(strip(from_component), strip(to_component));
+}
+
+auto is_assignable(const Type from, const Type to) -> bool {
+    if (from == to || to.kind == Kind::Top) {
+        return true;
+    }
+
+    if (to.kind != Kind::Reference) {
+        return false;
+    }
+
+    if (from.kind == Kind::Null) {
+        return true;
+    }
+
+    return from.kind == Kind::Reference && is_assignable_reference(from.name, to.name);
+}
+
+constexpr auto is_assignable_type = [](const Type from, const Type to) {
+    return is_assignable(from, to);
+};
+
+auto is_assignable_frame(const State& from, const State& to) -> bool {
+    return from.locals.size() == to.locals.size()
+        && from.stack.size() == to.stack.size()
+        && std::ranges::equal(from.locals, to.locals, is_assignable_type)
+        && std::ranges::equal(from.stack, to.stack, is_assignable_type);
+}
+
+auto field_type(std::string_view descriptor) -> Type {
+    switch (descriptor.front()) {
+        case 'B':
+        case 'C':
+        case 'I':
+        case 'S':
+        case 'Z':
+            return integer;
+        case 'F':
+            return float_type;
+        case 'J':
+            return long_type;
+        case 'D':
+            return double_type;
+        case 'L':
+            return reference(descriptor.substr(1, descriptor.size() - 2));
+        default:
+            return reference(descriptor);
+    }
+}
+
+auto read_u8(std::span<const std::byte> code, const std::uint32_t offset) -> std::uint8_t {
+    return std::to_integer<std::uint8_t>(code[offset]);
+}
+
+auto read_u16(std::span<const std::byte> code, const std::uint32_t offset)
+        -> std::uint16_t {
+    auto reader = kh::reader::Reader{code.subspan(offset, sizeof(std::uint16_t))};
+    return reader.read_unchecked<std::uint16_t>();
+}
+
+auto read_s32(std::span<const std::byte> code, const std::uint32_t offset)
+        -> std::int32_t {
+    auto reader = kh::reader::Reader{code.subspan(offset, sizeof(std::uint32_t))};
+    return static_cast<std::int32_t>(reader.read_unchecked<std::uint32_t>());
+}
+
+constexpr auto implicit_local(const Opcode opcode, const Opcode base) noexcept
+        -> std::uint16_t {
+    return static_cast<std::uint16_t>(
+        static_cast<std::uint8_t>(opcode) - static_cast<std::uint8_t>(base)
+    );
+}
+
+// NOTE(garrett): Errors are sticky rather than threaded through every stack
+// operation, each instruction is checked for one once it has been simulated.
+class MethodVerifier {
+private:
+    const kh::jvm::classfile::ClassFile& klass_;
+    const kh::jvm::constant_pool::ConstantPool& pool_;
+    const kh::jvm::method::Method& method_;
+    kh::jvm::code::Code code_;
+    std::vector<kh::jvm::bytecode::Instruction> instructions_;
+    std::vector<bool> starts_;
+    std::map<std::uint32_t, State> frames_;
+    std::deque<std::string> names_;
+    std::string_view class_name_;
+    std::string_view return_type_;
+    bool is_initializer_;
+    State state_;
+    std::optional<Error> error_;
+    bool falls_through_;
+
+    auto fail(const Error error) -> void {
+        if (!error_) {
+            error_ = error;
+        }
+    }
+
+    auto utf8(const std::uint16_t index) -> std::string_view {
+        const auto* entry = pool_.find<kh::jvm::constant_pool::UTF8Entry>(index);
+
+        if (entry == nullptr) {
+            fail(Error::InvalidConstant);
+            return {};
+        }
+
+        return entry->text;
+    }
+
+    auto class_name(const std::uint16_t index) -> std::string_view {
+        const auto* entry = pool_.find<kh::jvm::constant_pool::ClassEntry>(index);
+
+        if (entry == nullptr) {
+            fail(Error::InvalidConstant);
+            return "java/lang/Object";
+        }
+
+        const auto name = utf8(entry->name_index);
+        return name.empty() ? "java/lang/Object" : name;
+    }
+
+    auto name_and_type(const std::uint16_t index)
+            -> std::pair<std::string_view, std::string_view> {
+        const auto* entry = pool_.find<kh::jvm::constant_pool::NameAndTypeEntry>(index);
+
+        if (entry == nullptr) {
+            fail(Error::InvalidConstant);
+            return {};
+        }
+
+        return {utf8(entry->name_index), utf8(entry->descriptor_index)};
+    }
+
+    auto array_of(std::string_view component) -> Type {
+        if (component.starts_with('[')) {
+            return reference(names_.emplace_back("[" + std::string{component}));
+        }
+
+        return reference(
+            names_.emplace_back("[L" + std::string{component} + ";")
+        );
+    }
+
+    auto component_of(const Type array) -> Type {
+        if (array.kind == Kind::Null) {
+            return null;
+        }
+
+        return field_type(array.name.substr(1));
+    }
+
+    auto push(const Type type) -> void {
+        state_.stack.push_back(type);
+
+        if (is_wide(type)) {
+            state_.stack.push_back(top);
+        }
+
+        if (state_.stack.size() > code_.max_stack) {
+            fail(Error::StackOverflow);
+        }
+    }
+
+    auto pop() -> Type {
+        if (state_.stack.empty()) {
+            fail(Error::StackUnderflow);
+            return top;
+        }
+
+        const auto type = state_.stack.back();
+        state_.stack.pop_back();
+
+        if (type.kind != Kind::Top) {
+            return type;
+        }
+
+        if (state_.stack.empty() || !is_wide(state_.stack.back())) {
+            fail(Error::IncompatibleType);
+            return top;
+        }
+
+        const auto wide = state_.stack.back();
+        state_.stack.pop_back();
+
+        return wide;
+    }
+
+    auto pop(const Type expected) -> Type {
+        const auto type = pop();
+
+        if (!is_assignable(type, expected)) {
+            fail(Error::IncompatibleType);
+        }
+
+        return type;
+    }
+
+    auto pop_reference() -> Type {
+        const auto type = pop();
+
+        if (!is_initialized_reference(type)) {
+            fail(Error::IncompatibleType);
+        }
+
+        return type;
+    }
+
+    auto pop_array(std::initializer_list<std::string_view> names) -> Type {
+        const auto type = pop_reference();
+
+        if (type.kind == Kind::Reference
+                && std::ranges::find(names, type.name) == names.end()) {
+            fail(Error::IncompatibleType);
+        }
+
+        return type;
+    }
+
+    // NOTE(garrett): Checks that the top `count` slots can be moved as a unit
+    // without splitting a long or double
+    auto check_window(const std::size_t count) -> bool {
+        if (state_.stack.size() < count) {
+            fail(Error::StackUnderflow);
+            return false;
+        }
+
+        if (state_.stack[state_.stack.size() - count].kind == Kind::Top) {
+            fail(Error::IncompatibleType);
+            return false;
+        }
+
+        return true;
+    }
+
+    auto duplicate(const std::size_t count, const std::size_t depth) -> void {
+        if (!check_window(count) || !check_window(count + depth)) {
+            return;
+        }
+
+        const auto copied = std::vector<Type>{state_.stack.end() - count, state_.stack.end()};
+        const auto position = state_.stack.end() - static_cast<std::ptrdiff_t>(count + depth);
+
+        state_.stack.insert(position, copied.begin(), copied.end());
+
+        if (state_.stack.size() > code_.max_stack) {
+            fail(Error::StackOverflow);
+        }
+    }
+
+    auto load(const std::uint16_t index, const Type expected) -> void {
+        const auto width = is_wide(expected) ? 2u : 1u;
+
+        if (index + width > state_.locals.size()) {
+            fail(Error::InvalidLocal);
+            return;
+        }
+
+        const auto type = state_.locals[index];
+
+        if (expected.kind == Kind::Reference) {
+            if (!is_any_reference(type)) {
+                fail(Error::InvalidLocal);
+            }
+
+            push(type);
+            return;
+        }
+
+        if (type != expected) {
+            fail(Error::InvalidLocal);
+        }
+
+        push(expected);
+    }
+
+    auto store(const std::uint16_t index, const Type type) -> void {
+        const auto width = is_wide(type) ? 2u : 1u;
+
+        if (index + width > state_.locals.size()) {
+            fail(Error::InvalidLocal);
+            return;
+        }
+
+        if (index > 0 && is_wide(state_.locals[index - 1])) {
+            state_.locals[index - 1] = top;
+        }
+
+        state_.locals[index] = type;
+
+        if (width == 2) {
+            state_.locals[index + 1] = top;
+        }
+    }
+
+    auto store(const std::uint16_t index, const Kind kind) -> void {
+        if (kind == Kind::Reference) {
+            const auto type = pop();
+
+            if (!is_any_reference(type)) {
+                fail(Error::IncompatibleType);
+            }
+
+            store(index, type);
+            return;
+        }
+
+        store(index, pop(Type{kind, {}, 0u}));
+    }
+
+    auto branch(const std::uint32_t offset, const std::int64_t delta) -> void {
+        const auto target = static_cast<std::int64_t>(offset) + delta;
+
+        if (target < 0
+                || target >= static_cast<std::int64_t>(code_.bytecode.size())
+                || !starts_[static_cast<std::size_t>(target)]) {
+            fail(Error::InvalidBranchTarget);
+            return;
+        }
+
+        const auto frame = frames_.find(static_cast<std::uint32_t>(target));
+
+        if (frame == frames_.end()) {
+            fail(Error::MissingFrame);
+            return;
+        }
+
+        if (!is_assignable_frame(state_, frame->second)) {
+            fail(Error::FrameMismatch);
+        }
+    }
+
+    auto check_handlers(const std::uint32_t offset, const std::vector<Type>& locals) -> void {
+        for (const auto& handler : code_.exception_table) {
+            if (offset < handler.start_pc || offset >= handler.end_pc) {
+                continue;
+            }
+
+            const auto frame = frames_.find(handler.handler_pc);
+
+            if (frame == frames_.end()) {
+                fail(Error::MissingFrame);
+                return;
+            }
+
+            const auto caught = reference(
+                handler.catch_type == 0
+                    ? std::string_view{"java/lang/Throwable"}
+                    : class_name(handler.catch_type)
+            );
+
+            const auto incoming = State{locals, {caught}};
+
+            if (!is_assignable_frame(incoming, frame->second)) {
+                fail(Error::FrameMismatch);
+            }
+        }
+    }
+
+    auto invoke(const Opcode opcode, const std::uint32_t offset) -> void {
+        const auto index = read_u16(code_.bytecode, offset + 1);
+        auto owner = std::string_view{};
+        auto nat_index = std::uint16_t{};
+
+        if (opcode == Opcode::INVOKEDYNAMIC) {
+            const auto* entry = pool_.find<kh::jvm::constant_pool::InvokeDynamicEntry>(index);
+
+            if (entry == nullptr) {
+                fail(Error::InvalidConstant);
+                return;
+            }
+
+            nat_index = entry->name_and_type_index;
+        } else if (const auto* method = pool_.find<
+                kh::jvm::constant_pool::MethodReferenceEntry>(index);
+                method != nullptr && opcode != Opcode::INVOKEINTERFACE) {
+            owner = class_name(method->class_index);
+            nat_index = method->name_and_type_index;
+        } else if (const auto* interface_method = pool_.find<
+                kh::jvm::constant_pool::InterfaceMethodReferenceEntry>(index);
+                interface_method != nullptr && opcode != Opcode::INVOKEVIRTUAL) {
+            owner = class_name(interface_method->class_index);
+            nat_index = interface_method->name_and_type_index;
+        } else {
+            fail(Error::InvalidConstant);
+            return;
+        }
+
+        const auto [name, descriptor_text] = name_and_type(nat_index);
+        const auto descriptor = kh::jvm::descriptor::parse_method_descriptor(descriptor_text);
+
+        if (!descriptor) {
+            fail(Error::InvalidDescriptor);
+            return;
+        }
+
+        const auto is_constructor = name == "<init>";
+
+        if ((is_constructor && opcode != Opcode::INVOKESPECIAL) || name == "<clinit>") {
+            fail(Error::InvalidInstruction);
+            return;
+        }
+
+        if (is_constructor && descriptor.value().return_type != "V") {
+            fail(Error::InvalidDescriptor);
+            return;
+        }
+
+        const auto& parameters = descriptor.value().parameters;
+
+        for (auto parameter = parameters.rbegin(); parameter != parameters.rend(); ++parameter) {
+            pop(field_type(*parameter));
+        }
+
+        if (opcode != Opcode::INVOKESTATIC && opcode != Opcode::INVOKEDYNAMIC) {
+            const auto receiver = pop();
+
+            if (is_constructor) {
+                initialize(receiver);
+            } else if (!is_initialized_reference(receiver)) {
+                fail(Error::IncompatibleType);
+            }
+        }
+
+        if (descriptor.value().return_type != "V") {
+            push(field_type(descriptor.value().return_type));
+        }
+    }
+
+    auto initialize(const Type receiver) -> void {
+        auto initialized = Type{};
+
+        if (receiver.kind == Kind::UninitializedThis) {
+            initialized = reference(class_name_);
+        } else if (receiver.kind == Kind::Uninitialized) {
+            initialized = reference(
+                class_name(read_u16(code_.bytecode, receiver.offset + 1))
+            );
+        } else {
+            fail(Error::IncompatibleType);
+            return;
+        }
+
+        std::ranges::replace(state_.locals, receiver, initialized);
+        std::ranges::replace(state_.stack, receiver, initialized);
+    }
+
+    auto return_value(const Type type) -> void {
+        if (return_type_ == "V" || field_type(return_type_).kind != type.kind) {
+            fail(Error::IncompatibleType);
+            return;
+        }
+
+        pop(field_type(return_type_));
+    }
+
+    auto constant(const std::uint16_t index, const bool wide) -> void {
+        using namespace kh::jvm::constant_pool;
+
+        if (wide) {
+            if (pool_.find<LongEntry>(index) != nullptr) {
+                push(long_type);
+            } else if (pool_.find<DoubleEntry>(index) != nullptr) {
+                push(double_type);
+            } else if (const auto* dynamic = pool_.find<DynamicEntry>(index);
+                    dynamic != nullptr) {
+                const auto descriptor = name_and_type(dynamic->name_and_type_index).second;
+
+                if (!kh::jvm::descriptor::parse_field_type(descriptor)) {
+                    fail(Error::InvalidDescriptor);
+                    return;
+                }
+
+                const auto type = field_type(descriptor);
+                is_wide(type) ? push(type) : fail(Error::InvalidConstant);
+            } else {
+                fail(Error::InvalidConstant);
+            }
+
+            return;
+        }
+
+        if (pool_.find<IntegerEntry>(index) != nullptr) {
+            push(integer);
+        } else if (pool_.find<FloatEntry>(index) != nullptr) {
+            push(float_type);
+        } else if (pool_.find<StringEntry>(index) != nullptr) {
+            push(reference("java/lang/String"));
+        } else if (pool_.find<ClassEntry>(index) != nullptr) {
+            push(reference("java/lang/Class"));
+        } else if (pool_.find<MethodTypeEntry>(index) != nullptr) {
+            push(reference("java/lang/invoke/MethodType"));
+        } else if (pool_.find<MethodHandleEntry>(index) != nullptr) {
+            push(reference("java/lang/invoke/MethodHandle"));
+        } else if (const auto* dynamic = pool_.find<DynamicEntry>(index); dynamic != nullptr) {
+            const auto descriptor = name_and_type(dynamic->name_and_type_index).second;
+
+            if (!kh::jvm::descriptor::parse_field_type(descriptor)) {
+                fail(Error::InvalidDescriptor);
+                return;
+            }
+
+            const auto type = field_type(descriptor);
+            !is_wide(type) ? push(type) : fail(Error::InvalidConstant);
+        } else {
+            fail(Error::InvalidConstant);
+        }
+    }
+
+    auto field(const Opcode opcode, const std::uint32_t offset) -> void {
+        const auto* entry = pool_.find<kh::jvm::constant_pool::FieldReferenceEntry>(
+            read_u16(code_.bytecode, offset + 1)
+        );
+
+        if (entry == nullptr) {
+            fail(Error::InvalidConstant);
+            return;
+        }
+
+        const auto owner = class_name(entry->class_index);
+        const auto descriptor = name_and_type(entry->name_and_type_index).second;
+
+        if (!kh::jvm::descriptor::parse_field_type(descriptor)) {
+            fail(Error::InvalidDescriptor);
+            return;
+        }
+
+        const auto type = field_type(descriptor);
+
+        switch (opcode) {
+            case Opcode::GETSTATIC:
+                push(type);
+                break;
+            case Opcode::PUTSTATIC:
+                pop(type);
+                break;
+            case Opcode::GETFIELD:
+                pop_reference();
+                push(type);
+                break;
+            default: {
+                pop(type);
+                const auto object = pop();
+
+                // NOTE(garrett): Constructors may assign their own fields
+                // before calling the superclass constructor
+                const auto is_own_field = object.kind == Kind::UninitializedThis
+                    && owner == class_name_;
+
+                if (!is_initialized_reference(object) && !is_own_field) {
+                    fail(Error::IncompatibleType);
+                }
+            }
+        }
+    }
+
+    auto switch_targets(const std::uint32_t offset) -> void {
+        const auto opcode = static_cast<Opcode>(code_.bytecode[offset]);
+        const auto operands = offset + 1 + kh::jvm::bytecode::switch_padding(offset);
+
+        pop(integer);
+        branch(offset, read_s32(code_.bytecode, operands));
+
+        if (opcode == Opcode::TABLESWITCH) {
+            const auto low = read_s32(code_.bytecode, operands + 4);
+            const auto high = read_s32(code_.bytecode, operands + 8);
+
+            for (auto i = 0ll; i <= static_cast<std::int64_t>(high) - low; ++i) {
+                branch(offset, read_s32(code_.bytecode, operands + 12 + 4 * i));
+            }
+        } else {
+            const auto pairs = read_s32(code_.bytecode, operands + 4);
+
+            for (auto i = 0; i < pairs; ++i) {
+                branch(offset, read_s32(code_.bytecode, operands + 12 + 8 * i));
+            }
+        }
+
+        falls_through_ = false;
+    }
+
+    auto execute(const kh::jvm::bytecode::Instruction& instruction) -> void;
+    auto load_frames(const std::vector<Type>& entry_locals) -> void;
+public:
+    MethodVerifier(
+            const kh::jvm::classfile::ClassFile& klass,
+            const kh::jvm::method::Method& method,
+            kh::jvm::code::Code&& code)
+        : klass_(klass)
+        , pool_(klass.constant_pool)
+        , method_(method)
+        , code_(std::move(code))
+        , instructions_(std::vector<kh::jvm::bytecode::Instruction>{})
+        , starts_(std::vector<bool>{})
+        , frames_(std::map<std::uint32_t, State>{})
+        , names_(std::deque<std::string>{})
+        , class_name_(std::string_view{})
+        , return_type_(std::string_view{})
+        , is_initializer_(false)
+        , state_(State{})
+        , error_(std::nullopt)
+        , falls_through_(true) {}
+
+    auto run() -> std::expected<void, std::pair<std::uint32_t, Error>>;
+};
+
+auto MethodVerifier::load_frames(const std::vector<Type>& entry_locals) -> void {
+    auto attribute_data = std::optional<std::span<const std::byte>>{};
+
+    for (const auto& attribute : code_.attributes) {
+        if (utf8(attribute.name_index) == "StackMapTable") {
+            attribute_data = attribute.data;
+        }
+    }
+
+    if (!attribute_data) {
+        return;
+    }
+
+    // NOTE(garrett): Entry locals only exist as verifier types, so references
+    // among them are parsed as Object entries pointing at the reserved index
+    // zero. Frames only ever carry those over positionally, letting them be
+    // mapped back afterwards.
+    auto initial = std::vector<VerificationType>{};
+
+    for (auto i = 0uz; i < entry_locals.size(); ++i) {
+        const auto type = entry_locals[i];
+
+        switch (type.kind) {
+            case Kind::Integer:
+                initial.push_back(VerificationType{VerificationTag::Integer, 0u});
+                break;
+            case Kind::Float:
+                initial.push_back(VerificationType{VerificationTag::Float, 0u});
+                break;
+            case Kind::Long:
+                initial.push_back(VerificationType{VerificationTag::Long, 0u});
+                ++i;
+                break;
+            case Kind::Double:
+                initial.push_back(VerificationType{VerificationTag::Double, 0u});
+                ++i;
+                break;
+            case Kind::UninitializedThis:
+                initial.push_back(VerificationType{VerificationTag::UninitializedThis, 0u});
+                break;
+            case Kind::Reference:
+                initial.push_back(VerificationType{VerificationTag::Object, 0u});
+                break;
+            default:
+                break;
+        }
+    }
+
+    auto reader = kh::reader::Reader{attribute_data.value()};
+    const auto frames = kh::jvm::parsing::parse_stack_map_table(reader, initial);
+
+    if (!frames) {
+        fail(Error::InvalidStackMapFrame);
+        return;
+    }
+
+    const auto convert = [this, &initial, &entry_locals](
+            const VerificationType type,
+            const std::size_t position) -> std::optional<Type> {
+        switch (type.tag) {
+            case VerificationTag::Top:
+                return top;
+            case VerificationTag::Integer:
+                return integer;
+            case VerificationTag::Float:
+                return float_type;
+            case VerificationTag::Long:
+                return long_type;
+            case VerificationTag::Double:
+                return double_type;
+            case VerificationTag::Null:
+                return null;
+            case VerificationTag::UninitializedThis:
+                return Type{Kind::UninitializedThis, {}, 0u};
+            case VerificationTag::Uninitialized:
+                if (type.value >= starts_.size()
+                        || !starts_[type.value]
+                        || static_cast<Opcode>(code_.bytecode[type.value]) != Opcode::NEW) {
+                    return std::nullopt;
+                }
+
+                return Type{Kind::Uninitialized, {}, type.value};
+            case VerificationTag::Object: {
+                if (type.value != 0) {
+                    return reference(class_name(type.value));
+                }
+
+                if (position >= initial.size()) {
+                    return std::nullopt;
+                }
+
+                // NOTE(garrett): Walk the entry locals to the slot matching
+                // this entry's position in the frame
+                auto slot = 0uz;
+
+                for (auto i = 0uz; i < position; ++i) {
+                    slot += kh::jvm::stack_map::is_wide(initial[i]) ? 2 : 1;
+                }
+
+                return entry_locals[slot];
+            }
+        }
+
+        return std::nullopt;
+    };
+
+    const auto expand = [&convert](
+            const std::vector<VerificationType>& types,
+            std::vector<Type>& out,
+            const bool is_locals) -> bool {
+        for (auto i = 0uz; i < types.size(); ++i) {
+            const auto type = convert(types[i], is_locals ? i : types.size());
+
+            if (!type) {
+                return false;
+            }
+
+            out.push_back(type.value());
+
+            if (is_wide(type.value())) {
+                out.push_back(top);
+            }
+        }
+
+        return true;
+    };
+
+    for (const auto& frame : frames.value()) {
+        auto state = State{};
+
+        if (!expand(frame.locals, state.locals, true)
+                || !expand(frame.stack, state.stack, false)
+                || state.locals.size() > code_.max_locals
+                || state.stack.size() > code_.max_stack
+                || frame.offset >= starts_.size()
+                || !starts_[frame.offset]) {
+            fail(Error::InvalidStackMapFrame);
+            return;
+        }
+
+        state.locals.resize(code_.max_locals, top);
+        frames_.insert_or_assign(frame.offset, std::move(state));
+    }
+}
+
+auto MethodVerifier::run() -> std::expected<void, std::pair<std::uint32_t, Error>> {
+    const auto decoded = kh::jvm::bytecode::decode(code_.bytecode);
+
+    if (!decoded || code_.bytecode.empty()) {
+        return std::unexpected(std::pair{0u, Error::InvalidInstruction});
+    }
+
+    instructions_ = decoded.value();
+    starts_.assign(code_.bytecode.size(), false);
+
+    for (const auto& instruction : instructions_) {
+        starts_[instruction.offset] = true;
+    }
+
+    const auto this_class = pool_.find<kh::jvm::constant_pool::ClassEntry>(klass_.class_index);
+
+    if (this_class == nullptr) {
+        return std::unexpected(std::pair{0u, Error::InvalidConstant});
+    }
+
+    class_name_ = utf8(this_class->name_index);
+
+    const auto name = utf8(method_.name_index);
+    const auto descriptor = kh::jvm::descriptor::parse_method_descriptor(
+        utf8(method_.descriptor_index)
+    );
+
+    if (!descriptor || error_) {
+        return std::unexpected(std::pair{0u, Error::InvalidDescriptor});
+    }
+
+    return_type_ = descriptor.value().return_type;
+    is_initializer_ = name == "<init>";
+
+    auto entry_locals = std::vector<Type>{};
+    const auto is_static = method_.access_flags
+        & static_cast<std::uint16_t>(kh::jvm::method::AccessFlags::ACC_STATIC);
+
+    if (!is_static) {
+        entry_locals.push_back(
+            is_initializer_ && class_name_ != "java/lang/Object"
+                ? Type{Kind::UninitializedThis, {}, 0u}
+                : reference(class_name_)
+        );
+    }
+
+    for (const auto parameter : descriptor.value().parameters) {
+        const auto type = field_type(parameter);
+        entry_locals.push_back(type);
+
+        if (is_wide(type)) {
+            entry_locals.push_back(top);
+        }
+    }
+
+    if (entry_locals.size() > code_.max_locals) {
+        return std::unexpected(std::pair{0u, Error::InvalidLocal});
+    }
+
+    load_frames(entry_locals);
+
+    if (error_) {
+        return std::unexpected(std::pair{0u, error_.value()});
+    }
+
+    for (const auto& handler : code_.exception_table) {
+        if (handler.start_pc >= handler.end_pc
+                || handler.start_pc >= starts_.size()
+                || !starts_[handler.start_pc]
+                || (handler.end_pc < starts_.size() && !starts_[handler.end_pc])
+                || handler.end_pc > starts_.size()
+                || handler.handler_pc >= starts_.size()
+                || !starts_[handler.handler_pc]) {
+            return std::unexpected(std::pair{0u, Error::InvalidBranchTarget});
+        }
+    }
+
+    state_ = State{std::move(entry_locals), {}};
+    state_.locals.resize(code_.max_locals, top);
+
+    auto reachable = true;
+
+    for (const auto& instruction : instructions_) {
+        const auto frame = frames_.find(instruction.offset);
+
+        if (frame != frames_.end()) {
+            if (reachable && !is_assignable_frame(state_, frame->second)) {
+                return std::unexpected(std::pair{instruction.offset, Error::FrameMismatch});
+            }
+
+            state_ = frame->second;
+        } else if (!reachable) {
+            return std::unexpected(std::pair{instruction.offset, Error::MissingFrame});
+        }
+
+        const auto locals_before = state_.locals;
+        falls_through_ = true;
+
+        execute(instruction);
+        check_handlers(instruction.offset, locals_before);
+        check_handlers(instruction.offset, state_.locals);
+
+        if (error_) {
+            return std::unexpected(std::pair{instruction.offset, error_.value()});
+        }
+
+        reachable = falls_through_;
+    }
+
+    if (reachable) {
+        return std::unexpected(std::pair{instructions_.back().offset, Error::FallsOffEnd});
+    }
+
+    return {};
+}
+
+auto MethodVerifier::execute(const kh::jvm::bytecode::Instruction& instruction) -> void {
+    const auto& code = code_.bytecode;
+    const auto offset = instruction.offset;
+    auto opcode = instruction.opcode;
+    auto local_index = std::uint16_t{};
+
+    if (opcode == Opcode::WIDE) {
+        opcode = static_cast<Opcode>(code[offset + 1]);
+        local_index = read_u16(code, offset + 2);
+    } else if ((opcode >= Opcode::ILOAD && opcode <= Opcode::ALOAD)
+            || (opcode >= Opcode::ISTORE && opcode <= Opcode::ASTORE)
+            || opcode == Opcode::IINC
+            || opcode == Opcode::RET) {
+        local_index = read_u8(code, offset + 1);
+    }
+
+    const auto binary = [this](const Type type) {
+        pop(type);
+        pop(type);
+        push(type);
+    };
+
+    const auto unary = [this](const Type from, const Type to) {
+        pop(from);
+        push(to);
+    };
+
+    const auto compare = [this](const Type type) {
+        pop(type);
+        pop(type);
+        push(integer);
+    };
+
+    switch (opcode) {
+        case Opcode::NOP:
+            break;
+        case Opcode::ACONST_NULL:
+            push(null);
+            break;
+        case Opcode::ICONST_M1:
+        case Opcode::ICONST_0:
+        case Opcode::ICONST_1:
+        case Opcode::ICONST_2:
+        case Opcode::ICONST_3:
+        case Opcode::ICONST_4:
+        case Opcode::ICONST_5:
+        case Opcode::BIPUSH:
+        case Opcode::SIPUSH:
+            push(integer);
+            break;
+        case Opcode::LCONST_0:
+        case Opcode::LCONST_1:
+            push(long_type);
+            break;
+        case Opcode::FCONST_0:
+        case Opcode::FCONST_1:
+        case Opcode::FCONST_2:
+            push(float_type);
+            break;
+        case Opcode::DCONST_0:
+        case Opcode::DCONST_1:
+            push(double_type);
+            break;
+        case Opcode::LDC:
+            constant(read_u8(code, offset + 1), false);
+            break;
+        case Opcode::LDC_W:
+            constant(read_u16(code, offset + 1), false);
+            break;
+        case Opcode::LDC2_W:
+            constant(read_u16(code, offset + 1), true);
+            break;
+        case Opcode::ILOAD:
+            load(local_index, integer);
+            break;
+        case Opcode::LLOAD:
+            load(local_index, long_type);
+            break;
+        case Opcode::FLOAD:
+            load(local_index, float_type);
+            break;
+        case Opcode::DLOAD:
+            load(local_index, double_type);
+            break;
+        case Opcode::ALOAD:
+            load(local_index, reference("java/lang/Object"));
+            break;
+        case Opcode::ILOAD_0:
+        case Opcode::ILOAD_1:
+        case Opcode::ILOAD_2:
+        case Opcode::ILOAD_3:
+            load(implicit_local(opcode, Opcode::ILOAD_0), integer);
+            break;
+        case Opcode::LLOAD_0:
+        case Opcode::LLOAD_1:
+        case Opcode::LLOAD_2:
+        case Opcode::LLOAD_3:
+            load(implicit_local(opcode, Opcode::LLOAD_0), long_type);
+            break;
+        case Opcode::FLOAD_0:
+        case Opcode::FLOAD_1:
+        case Opcode::FLOAD_2:
+        case Opcode::FLOAD_3:
+            load(implicit_local(opcode, Opcode::FLOAD_0), float_type);
+            break;
+        case Opcode::DLOAD_0:
+        case Opcode::DLOAD_1:
+        case Opcode::DLOAD_2:
+        case Opcode::DLOAD_3:
+            load(implicit_local(opcode, Opcode::DLOAD_0), double_type);
+            break;
+        case Opcode::ALOAD_0:
+        case Opcode::ALOAD_1:
+        case Opcode::ALOAD_2:
+        case Opcode::ALOAD_3:
+            load(
+                implicit_local(opcode, Opcode::ALOAD_0),
+                reference("java/lang/Object")
+            );
+            break;
+        case Opcode::IALOAD:
+            pop(integer);
+            pop_array({"[I"});
+            push(integer);
+            break;
+        case Opcode::LALOAD:
+            pop(integer);
+            pop_array({"[J"});
+            push(long_type);
+            break;
+        case Opcode::FALOAD:
+            pop(integer);
+            pop_array({"[F"});
+            push(float_type);
+            break;
+        case Opcode::DALOAD:
+            pop(integer);
+            pop_array({"[D"});
+            push(double_type);
+            break;
+        case Opcode::AALOAD: {
+            pop(integer);
+            const auto array = pop_reference();
+
+            if (array.kind == Kind::Reference
+                    && !(array.name.starts_with("[L") || array.name.starts_with("[["))) {
+                fail(Error::IncompatibleType);
+                break;
+            }
+
+            push(component_of(array));
+            break;
+        }
+        case Opcode::BALOAD:
+            pop(integer);
+            pop_array({"[B", "[Z"});
+            push(integer);
+            break;
+        case Opcode::CALOAD:
+            pop(integer);
+            pop_array({"[C"});
+            push(integer);
+            break;
+        case Opcode::SALOAD:
+            pop(integer);
+            pop_array({"[S"});
+            push(integer);
+            break;
+        case Opcode::ISTORE:
+            store(local_index, Kind::Integer);
+            break;
+        case Opcode::LSTORE:
+            store(local_index, Kind::Long);
+            break;
+        case Opcode::FSTORE:
+            store(local_index, Kind::Float);
+            break;
+        case Opcode::DSTORE:
+            store(local_index, Kind::Double);
+            break;
+        case Opcode::ASTORE:
+            store(local_index, Kind::Reference);
+            break;
+        case Opcode::ISTORE_0:
+        case Opcode::ISTORE_1:
+        case Opcode::ISTORE_2:
+        case Opcode::ISTORE_3:
+            store(implicit_local(opcode, Opcode::ISTORE_0), Kind::Integer);
+            break;
+        case Opcode::LSTORE_0:
+        case Opcode::LSTORE_1:
+        case Opcode::LSTORE_2:
+        case Opcode::LSTORE_3:
+            store(implicit_local(opcode, Opcode::LSTORE_0), Kind::Long);
+            break;
+        case Opcode::FSTORE_0:
+        case Opcode::FSTORE_1:
+        case Opcode::FSTORE_2:
+        case Opcode::FSTORE_3:
+            store(implicit_local(opcode, Opcode::FSTORE_0), Kind::Float);
+            break;
+        case Opcode::DSTORE_0:
+        case Opcode::DSTORE_1:
+        case Opcode::DSTORE_2:
+        case Opcode::DSTORE_3:
+            store(implicit_local(opcode, Opcode::DSTORE_0), Kind::Double);
+            break;
+        case Opcode::ASTORE_0:
+        case Opcode::ASTORE_1:
+        case Opcode::ASTORE_2:
+        case Opcode::ASTORE_3:
+            store(implicit_local(opcode, Opcode::ASTORE_0), Kind::Reference);
+            break;
+        case Opcode::IASTORE:
+            pop(integer);
+            pop(integer);
+            pop_array({"[I"});
+            break;
+        case Opcode::LASTORE:
+            pop(long_type);
+            pop(integer);
+            pop_array({"[J"});
+            break;
+        case Opcode::FASTORE:
+            pop(float_type);
+            pop(integer);
+            pop_array({"[F"});
+            break;
+        case Opcode::DASTORE:
+            pop(double_type);
+            pop(integer);
+            pop_array({"[D"});
+            break;
+        case Opcode::AASTORE: {
+            pop_reference();
+            pop(integer);
+            const auto array = pop_reference();
+
+            if (array.kind == Kind::Reference
+                    && !(array.name.starts_with("[L") || array.name.starts_with("[["))) {
+                fail(Error::IncompatibleType);
+            }
+
+            break;
+        }
+        case Opcode::BASTORE:
+            pop(integer);
+            pop(integer);
+            pop_array({"[B", "[Z"});
+            break;
+        case Opcode::CASTORE:
+            pop(integer);
+            pop(integer);
+            pop_array({"[C"});
+            break;
+        case Opcode::SASTORE:
+            pop(integer);
+            pop(integer);
+            pop_array({"[S"});
+            break;
+        case Opcode::POP:
+            if (check_window(1)) {
+                state_.stack.pop_back();
+            }
+
+            break;
+        case Opcode::POP2:
+            if (check_window(2)) {
+                state_.stack.resize(state_.stack.size() - 2);
+            }
+
+            break;
+        case Opcode::DUP:
+            duplicate(1, 0);
+            break;
+        case Opcode::DUP_X1:
+            duplicate(1, 1);
+            break;
+        case Opcode::DUP_X2:
+            duplicate(1, 2);
+            break;
+        case Opcode::DUP2:
+            duplicate(2, 0);
+            break;
+        case Opcode::DUP2_X1:
+            duplicate(2, 1);
+            break;
+        case Opcode::DUP2_X2:
+            duplicate(2, 2);
+            break;
+        case Opcode::SWAP:
+            if (check_window(1) && check_window(2)) {
+                std::iter_swap(state_.stack.end() - 1, state_.stack.end() - 2);
+            }
+
+            break;
+        case Opcode::IADD:
+        case Opcode::ISUB:
+        case Opcode::IMUL:
+        case Opcode::IDIV:
+        case Opcode::IREM:
+        case Opcode::ISHL:
+        case Opcode::ISHR:
+        case Opcode::IUSHR:
+        case Opcode::IAND:
+        case Opcode::IOR:
+        case Opcode::IXOR:
+            binary(integer);
+            break;
+        case Opcode::LADD:
+        case Opcode::LSUB:
+        case Opcode::LMUL:
+        case Opcode::LDIV:
+        case Opcode::LREM:
+        case Opcode::LAND:
+        case Opcode::LOR:
+        case Opcode::LXOR:
+            binary(long_type);
+            break;
+        case Opcode::FADD:
+        case Opcode::FSUB:
+        case Opcode::FMUL:
+        case Opcode::FDIV:
+        case Opcode::FREM:
+            binary(float_type);
+            break;
+        case Opcode::DADD:
+        case Opcode::DSUB:
+        case Opcode::DMUL:
+        case Opcode::DDIV:
+        case Opcode::DREM:
+            binary(double_type);
+            break;
+        case Opcode::LSHL:
+        case Opcode::LSHR:
+        case Opcode::LUSHR:
+            pop(integer);
+            pop(long_type);
+            push(long_type);
+            break;
+        case Opcode::INEG:
+            unary(integer, integer);
+            break;
+        case Opcode::LNEG:
+            unary(long_type, long_type);
+            break;
+        case Opcode::FNEG:
+            unary(float_type, float_type);
+            break;
+        case Opcode::DNEG:
+            unary(double_type, double_type);
+            break;
+        case Opcode::IINC:
+            if (local_index >= state_.locals.size() || state_.locals[local_index] != integer) {
+                fail(Error::InvalidLocal);
+            }
+
+            break;
+        case Opcode::I2L:
+            unary(integer, long_type);
+            break;
+        case Opcode::I2F:
+            unary(integer, float_type);
+            break;
+        case Opcode::I2D:
+            unary(integer, double_type);
+            break;
+        case Opcode::L2I:
+            unary(long_type, integer);
+            break;
+        case Opcode::L2F:
+            unary(long_type, float_type);
+            break;
+        case Opcode::L2D:
+            unary(long_type, double_type);
+            break;
+        case Opcode::F2I:
+            unary(float_type, integer);
+            break;
+        case Opcode::F2L:
+            unary(float_type, long_type);
+            break;
+        case Opcode::F2D:
+            unary(float_type, double_type);
+            break;
+        case Opcode::D2I:
+            unary(double_type, integer);
+            break;
+        case Opcode::D2L:
+            unary(double_type, long_type);
+            break;
+        case Opcode::D2F:
+            unary(double_type, float_type);
+            break;
+        case Opcode::I2B:
+        case Opcode::I2C:
+        case Opcode::I2S:
+            unary(integer, integer);
+            break;
+        case Opcode::LCMP:
+            compare(long_type);
+            break;
+        case Opcode::FCMPL:
+        case Opcode::FCMPG:
+            compare(float_type);
+            break;
+        case Opcode::DCMPL:
+        case Opcode::DCMPG:
+            compare(double_type);
+            break;
+        case Opcode::IFEQ:
+        case Opcode::IFNE:
+        case Opcode::IFLT:
+        case Opcode::IFGE:
+        case Opcode::IFGT:
+        case Opcode::IFLE:
+            pop(integer);
+            branch(offset, static_cast<std::int16_t>(read_u16(code, offset + 1)));
+            break;
+        case Opcode::IF_ICMPEQ:
+        case Opcode::IF_ICMPNE:
+        case Opcode::IF_ICMPLT:
+        case Opcode::IF_ICMPGE:
+        case Opcode::IF_ICMPGT:
+        case Opcode::IF_ICMPLE:
+            pop(integer);
+            pop(integer);
+            branch(offset, static_cast<std::int16_t>(read_u16(code, offset + 1)));
+            break;
+        case Opcode::IF_ACMPEQ:
+        case Opcode::IF_ACMPNE:
+            pop_reference();
+            pop_reference();
+            branch(offset, static_cast<std::int16_t>(read_u16(code, offset + 1)));
+            break;
+        case Opcode::IFNULL:
+        case Opcode::IFNONNULL:
+            pop_reference();
+            branch(offset, static_cast<std::int16_t>(read_u16(code, offset + 1)));
+            break;
+        case Opcode::GOTO:
+            branch(offset, static_cast<std::int16_t>(read_u16(code, offset + 1)));
+            falls_through_ = false;
+            break;
+        case Opcode::GOTO_W:
+            branch(offset, read_s32(code, offset + 1));
+            falls_through_ = false;
+            break;
+        case Opcode::TABLESWITCH:
+        case Opcode::LOOKUPSWITCH:
+            switch_targets(offset);
+            break;
+        case Opcode::IRETURN:
+            return_value(integer);
+            falls_through_ = false;
+            break;
+        case Opcode::LRETURN:
+            return_value(long_type);
+            falls_through_ = false;
+            break;
+        case Opcode::FRETURN:
+            return_value(float_type);
+            falls_through_ = false;
+            break;
+        case Opcode::DRETURN:
+            return_value(double_type);
+            falls_through_ = false;
+            break;
+        case Opcode::ARETURN:
+            return_value(reference("java/lang/Object"));
+            falls_through_ = false;
+            break;
+        case Opcode::RETURN:
+            if (return_type_ != "V") {
+                fail(Error::IncompatibleType);
+            }
+
+            if (is_initializer_
+                    && std::ranges::find(state_.locals, Kind::UninitializedThis, &Type::kind)
+                        != state_.locals.end()) {
+                fail(Error::IncompatibleType);
+            }
+
+            falls_through_ = false;
+            break;
+        case Opcode::GETSTATIC:
+        case Opcode::PUTSTATIC:
+        case Opcode::GETFIELD:
+        case Opcode::PUTFIELD:
+            field(opcode, offset);
+            break;
+        case Opcode::INVOKEVIRTUAL:
+        case Opcode::INVOKESPECIAL:
+        case Opcode::INVOKESTATIC:
+        case Opcode::INVOKEINTERFACE:
+        case Opcode::INVOKEDYNAMIC:
+            invoke(opcode, offset);
+            break;
+        case Opcode::NEW:
+            class_name(read_u16(code, offset + 1));
+            push(Type{Kind::Uninitialized, {}, offset});
+            break;
+        case Opcode::NEWARRAY: {
+            constexpr auto names = std::to_array<std::string_view>({
+                "[Z", "[C", "[F", "[D", "[B", "[S", "[I", "[J"
+            });
+
+            const auto type = read_u8(code, offset + 1);
+
+            if (type < 4 || type > 11) {
+                fail(Error::InvalidInstruction);
+                break;
+            }
+
+            pop(integer);
+            push(reference(names[type - 4]));
+            break;
+        }
+        case Opcode::ANEWARRAY:
+            pop(integer);
+            push(array_of(class_name(read_u16(code, offset + 1))));
+            break;
+        case Opcode::ARRAYLENGTH: {
+            const auto array = pop_reference();
+
+            if (array.kind == Kind::Reference && !is_array(array)) {
+                fail(Error::IncompatibleType);
+            }
+
+            push(integer);
+            break;
+        }
+        case Opcode::ATHROW:
+            pop_reference();
+            falls_through_ = false;
+            break;
+        case Opcode::CHECKCAST:
+            pop_reference();
+            push(reference(class_name(read_u16(code, offset + 1))));
+            break;
+        case Opcode::INSTANCEOF:
+            pop_reference();
+            class_name(read_u16(code, offset + 1));
+            push(integer);
+            break;
+        case Opcode::MONITORENTER:
+        case Opcode::MONITOREXIT:
+            pop_reference();
+            break;
+        case Opcode::MULTIANEWARRAY: {
+            const auto name = class_name(read_u16(code, offset + 1));
+            const auto dimensions = read_u8(code, offset + 3);
+
+            if (dimensions == 0
+                    || name.find_first_not_of('[') < dimensions) {
+                fail(Error::InvalidInstruction);
+                break;
+            }
+
+            for (auto i = 0u; i < dimensions; ++i) {
+                pop(integer);
+            }
+
+            push(reference(name));
+            break;
+        }
+        default:
+            // NOTE(garrett): Subroutines are forbidden from version 50 onwards
+            fail(Error::InvalidInstruction);
+            break;
+    }
+}
+
+} // namespace
+
+auto verify_method(const kh::jvm::classfile::ClassFile& klass, const std::size_t method_index)
+        -> std::expected<void, Failure> {
+    const auto index = static_cast<std::uint16_t>(method_index);
+
+    if (klass.version.major < 50) {
+        return std::unexpected(Failure{index, 0u, Error::UnsupportedVersion});
+    }
+
+    const auto& method = klass.methods[method_index];
+    const auto flags = method.access_flags;
+
+    using kh::jvm::method::AccessFlags;
+
+    if ((flags & static_cast<std::uint16_t>(AccessFlags::ACC_ABSTRACT))
+            || (flags & static_cast<std::uint16_t>(AccessFlags::ACC_NATIVE))) {
+        return {};
+    }
+
+    for (const auto& attribute : method.attributes) {
+        const auto* name = klass.constant_pool.find<kh::jvm::constant_pool::UTF8Entry>(
+            attribute.name_index
+        );
+
+        if (name == nullptr || name->text != "Code") {
+            continue;
+        }
+
+        auto reader = kh::reader::Reader{attribute.data};
+        auto code = kh::jvm::parsing::parse_code(reader);
+
+        if (!code) {
+            return std::unexpected(Failure{index, 0u, Error::MissingCode});
+        }
+
+        auto verifier = MethodVerifier{klass, method, std::move(code.value())};
+        const auto result = verifier.run();
+
+        if (!result) {
+            return std::unexpected(
+                Failure{index, result.error().first, result.error().second}
+            );
+        }
+
+        return {};
+    }
+
+    return std::unexpected(Failure{index, 0u, Error::MissingCode});
+}
+
+auto verify(const kh::jvm::classfile::ClassFile& klass, const unsigned int concurrency)
+        -> std::vector<Failure> {
+    const auto method_count = klass.methods.size();
+    auto results = std::vector<std::optional<Failure>>(method_count);
+    auto next = std::atomic<std::size_t>{0};
+
+    const auto worker = [&klass, &results, &next, method_count]() {
+        for (auto i = next.fetch_add(1, std::memory_order_relaxed);
+                i < method_count;
+                i = next.fetch_add(1, std::memory_order_relaxed)) {
+            const auto result = verify_method(klass, i);
+
+            if (!result) {
+                results[i] = result.error();
+            }
+        }
+    };
+
+    const auto thread_count = std::min<std::size_t>(
+        std::max(concurrency, 1u),
+        method_count
+    );
+
+    {
+        auto threads = std::vector<std::jthread>{};
+
+        for (auto i = 1uz; i < thread_count; ++i) {
+            threads.emplace_back(worker);
+        }
+
+        worker();
+    }
+
+    auto failures = std::vector<Failure>{};
+
+    for (const auto& result : results) {
+        if (result) {
+            failures.push_back(result.value());
+        }
+    }
+
+    return failures;
+}
+
+} // namespace kh::jvm::verification
@@ -0,0 +1,92 @@
+#ifndef VERIFICATION_H
+#define VERIFICATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "classfile.h"
+
+namespace kh::jvm::verification {
+
+enum Error {
+    FallsOffEnd,
+    FrameMismatch,
+    IncompatibleType,
+    InvalidBranchTarget,
+    InvalidConstant,
+    InvalidDescriptor,
+    InvalidInstruction,
+    InvalidLocal,
+    InvalidStackMapFrame,
+    MissingCode,
+    MissingFrame,
+    StackOverflow,
+    StackUnderflow,
+    UnsupportedVersion
+};
+
+struct Failure {
+    std::uint16_t method_index;
+    // NOTE(garrett): Offset of the offending instruction, zero when the method
+    // is rejected as a whole
+    std::uint32_t offset;
+    Error error;
+};
+
+constexpr auto name(const Error error) noexcept -> std::string_view {
+    switch (error) {
+        case Error::FallsOffEnd:
+            return "Execution falls off the end of the code";
+        case Error::FrameMismatch:
+            return "Current frame is not assignable to the stack map frame";
+        case Error::IncompatibleType:
+            return "Operand has an incompatible type";
+        case Error::InvalidBranchTarget:
+            return "Branch target is not the start of an instruction";
+        case Error::InvalidConstant:
+            return "Invalid constant pool reference";
+        case Error::InvalidDescriptor:
+            return "Invalid descriptor";
+        case Error::InvalidInstruction:
+            return "Invalid instruction";
+        case Error::InvalidLocal:
+            return "Invalid local variable access";
+        case Error::InvalidStackMapFrame:
+            return "Invalid stack map frame";
+        case Error::MissingCode:
+            return "Missing code attribute";
+        case Error::MissingFrame:
+            return "Missing stack map frame";
+        case Error::StackOverflow:
+            return "Operand stack exceeds max_stack";
+        case Error::StackUnderflow:
+            return "Operand stack underflow";
+        case Error::UnsupportedVersion:
+            return "Class version predates stack map verification";
+    }
+
+    return "Unknown error";
+}
+
+// NOTE(garrett): Follows the JVMS type checking verifier for class version 50
+// and later, relying on the StackMapTable rather than inferring types. Class
+// hierarchies aren't available offline, so one class type is considered
+// assignable to another. Arrays, primitives and initialization state are
+// still checked exactly. Abstract and native methods always pass.
+auto verify_method(const kh::jvm::classfile::ClassFile&, std::size_t method_index)
+        -> std::expected<void, Failure>;
+
+// NOTE(garrett): Methods are independent of each other, so they're spread
+// across up to `concurrency` threads. Failures are ordered by method index.
+auto verify(
+        const kh::jvm::classfile::ClassFile&,
+        unsigned int concurrency = std::thread::hardware_concurrency())
+        -> std::vector<Failure>;
+
+} // namespace kh::jvm::verification
+
+#endif // VERIFICATION_H
@@ -39,9 +39,33 @@ auto MethodView::name() const -> std::string_view {
     ).text;
 }
 
-ClassView::ClassView(const kh::jvm::classfile::ClassFile& klass) : klass(klass) {};
+ClassView::ClassView(const kh::jvm::classfile::ClassFile& klass)
+        : klass(klass)
+        , pooled(nullptr)
+        , symbols(nullptr) {};
+
+ClassView::ClassView(
+        const kh::jvm::classpool::PooledClass& pooled,
+        const kh::jvm::classpool::SymbolTable& symbols)
+        : klass(pooled.class_file)
+        , pooled(&pooled)
+        , symbols(&symbols) {};
 
 auto ClassView::method(std::string_view name) const -> std::optional<MethodView> {
+    if (pooled != nullptr) {
+        // NOTE(garrett): Text that was never interned can't name a method
+        const auto symbol = symbols->find(name);
+        const auto* method = symbol
+            ? kh::jvm::classpool::find_method(*pooled, symbol.value())
+            : nullptr;
+
+        if (method == nullptr) {
+            return std::nullopt;
+        }
+
+        return MethodView{klass.constant_pool, *method};
+    }
+
     auto candidates = klass.methods | std::views::filter(
         [this, name](const auto& method){
             return MethodView{klass.constant_pool, method}.name() == name;
@@ -2,6 +2,7 @@
 #define VIEWS_H
 
 #include "classfile.h"
+#include "classpool.h"
 
 namespace kh::jvm::views {
     struct AttributeView {
@@ -31,8 +32,16 @@ namespace kh::jvm::views {
 
     struct ClassView {
         const kh::jvm::classfile::ClassFile& klass;
+        // NOTE(garrett): Set for classes from a `ClassPool`, whose lookups then
+        // compare interned symbols rather than text
+        const kh::jvm::classpool::PooledClass* pooled;
+        const kh::jvm::classpool::SymbolTable* symbols;
 
         explicit ClassView(const kh::jvm::classfile::ClassFile&);
+        ClassView(
+            const kh::jvm::classpool::PooledClass&,
+            const kh::jvm::classpool::SymbolTable&
+        );
 
         // TODO(garrett): Also include descriptor to handle overloads
         auto method(std::string_view) const -> std::optional<MethodView>;
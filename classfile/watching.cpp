@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "watching.h"
+
+namespace kh::watching {
+
+namespace {
+
+auto collect_changes(const std::map<std::filesystem::path, ChangeKind>& changes)
+        -> std::vector<Change> {
+    auto collected = std::vector<Change>{};
+    collected.reserve(changes.size());
+
+    for (const auto& [path, kind] : changes) {
+        collected.push_back(Change{path, kind});
+    }
+
+    return collected;
+}
+
+#if defined(__linux__)
+
+auto within(const std::filesystem::path& path, const std::filesystem::path& directory) -> bool {
+    return std::ranges::mismatch(directory, path).in1 == directory.end();
+}
+
+#endif
+
+} // namespace
+
+#if defined(__linux__)
+
+Watcher::Watcher(const std::filesystem::path& root)
+        : root_(root)
+        , descriptor_(::inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+        , directories_(std::unordered_map<int, std::filesystem::path>{})
+        , files_(std::set<std::filesystem::path>{}) {
+    if (descriptor_ < 0) {
+        throw std::system_error(errno, std::generic_category(), "Failed to initialize inotify");
+    }
+
+    try {
+        add_watches(std::filesystem::path{}, nullptr);
+    } catch (...) {
+        ::close(descriptor_);
+        throw;
+    }
+}
+
+Watcher::~Watcher() {
+    ::close(descriptor_);
+}
+
+auto Watcher::add_watches(
+        const std::filesystem::path& relative,
+        std::map<std::filesystem::path, ChangeKind>* changes) -> void {
+    constexpr auto mask = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM
+        | IN_MOVED_TO | IN_ONLYDIR;
+
+    const auto path = root_ / relative;
+    const auto watch = ::inotify_add_watch(descriptor_, path.c_str(), mask);
+
+    if (watch < 0) {
+        // NOTE(garrett): Directories can vanish again before they're watched
+        if (errno == ENOENT || errno == ENOTDIR) {
+            return;
+        }
+
+        throw std::system_error(errno, std::generic_category(), "Failed to add inotify watch");
+    }
+
+    directories_.insert_or_assign(watch, relative);
+
+    // NOTE(garrett): Anything created in a new directory before its watch was
+    // added would otherwise go unreported
+    auto error = std::error_code{};
+
+    for (const auto& entry : std::filesystem::directory_iterator{path, error}) {
+        const auto child = relative / entry.path().filename();
+
+        if (entry.is_directory(error) && !entry.is_symlink(error)) {
+            add_watches(child, changes);
+        } else if (entry.is_regular_file(error)) {
+            files_.insert(child);
+
+            if (changes) {
+                changes->insert_or_assign(child, ChangeKind::Modified);
+            }
+        }
+    }
+}
+
+// NOTE(garrett): A directory moved elsewhere keeps its watches, which would
+// go on reporting its files under the old path, so they're dropped along with
+// everything below it
+auto Watcher::remove_watches(
+        const std::filesystem::path& relative,
+        std::map<std::filesystem::path, ChangeKind>& changes) -> void {
+    std::erase_if(directories_, [this, &relative](const auto& directory) {
+        if (!within(directory.second, relative)) {
+            return false;
+        }
+
+        ::inotify_rm_watch(descriptor_, directory.first);
+        return true;
+    });
+
+    auto file = files_.lower_bound(relative);
+
+    while (file != files_.end() && within(*file, relative)) {
+        changes.insert_or_assign(*file, ChangeKind::Removed);
+        file = files_.erase(file);
+    }
+}
+
+// NOTE(garrett): Events were dropped, so every file still present is reported
+// as modified rather than guessing what was missed, and the rest as removed
+auto Watcher::rescan(std::map<std::filesystem::path, ChangeKind>& changes) -> void {
+    const auto previous = std::exchange(files_, std::set<std::filesystem::path>{});
+
+    directories_.clear();
+    add_watches(std::filesystem::path{}, &changes);
+
+    for (const auto& file : previous) {
+        if (!files_.contains(file)) {
+            changes.insert_or_assign(file, ChangeKind::Removed);
+        }
+    }
+}
+
+auto Watcher::wait(const std::chrono::milliseconds quiet) -> std::vector<Change> {
+    alignas(::inotify_event) auto buffer = std::array<char, 16384>{};
+    auto changes = std::map<std::filesystem::path, ChangeKind>{};
+
+    while (true) {
+        auto descriptor = ::pollfd{descriptor_, POLLIN, 0};
+        const auto timeout = changes.empty() ? -1 : static_cast<int>(quiet.count());
+        const auto ready = ::poll(&descriptor, 1u, timeout);
+
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            throw std::system_error(errno, std::generic_category(), "Failed to poll inotify");
+        }
+
+        if (!ready) {
+            return collect_changes(changes);
+        }
+
+        const auto length = ::read(descriptor_, buffer.data(), buffer.size());
+
+        if (length < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+
+            throw std::system_error(errno, std::generic_category(), "Failed to read inotify");
+        }
+
+        for (auto offset = 0z; offset < length;) {
+            const auto* event = reinterpret_cast<const ::inotify_event*>(buffer.data() + offset);
+            offset += static_cast<std::ptrdiff_t>(sizeof(::inotify_event) + event->len);
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                rescan(changes);
+                continue;
+            }
+
+            if (event->mask & IN_IGNORED) {
+                directories_.erase(event->wd);
+                continue;
+            }
+
+            const auto directory = directories_.find(event->wd);
+
+            if (directory == directories_.end() || !event->len) {
+                continue;
+            }
+
+            const auto relative = directory->second / event->name;
+
+            if (event->mask & IN_ISDIR) {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    add_watches(relative, &changes);
+                } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    remove_watches(relative, changes);
+                }
+            } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                files_.insert(relative);
+                changes.insert_or_assign(relative, ChangeKind::Modified);
+            } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                files_.erase(relative);
+                changes.insert_or_assign(relative, ChangeKind::Removed);
+            }
+        }
+    }
+}
+
+#else
+
+Watcher::Watcher(const std::filesystem::path& root)
+        : root_(root)
+        , snapshot_(std::map<std::filesystem::path, std::filesystem::file_time_type>{}) {
+    snapshot_ = scan();
+}
+
+Watcher::~Watcher() = default;
+
+auto Watcher::scan() const
+        -> std::map<std::filesystem::path, std::filesystem::file_time_type> {
+    auto files = std::map<std::filesystem::path, std::filesystem::file_time_type>{};
+    auto error = std::error_code{};
+
+    for (const auto& entry : std::filesystem::recursive_directory_iterator{root_, error}) {
+        if (entry.is_regular_file(error)) {
+            files.emplace(entry.path().lexically_relative(root_), entry.last_write_time(error));
+        }
+    }
+
+    return files;
+}
+
+auto Watcher::wait(const std::chrono::milliseconds quiet) -> std::vector<Change> {
+    auto changes = std::map<std::filesystem::path, ChangeKind>{};
+
+    while (true) {
+        std::this_thread::sleep_for(quiet);
+
+        auto current = scan();
+        auto changed = false;
+
+        for (const auto& [path, time] : current) {
+            const auto previous = snapshot_.find(path);
+
+            if (previous == snapshot_.end() || previous->second != time) {
+                changes.insert_or_assign(path, ChangeKind::Modified);
+                changed = true;
+            }
+        }
+
+        for (const auto& [path, time] : snapshot_) {
+            if (!current.contains(path)) {
+                changes.insert_or_assign(path, ChangeKind::Removed);
+                changed = true;
+            }
+        }
+
+        snapshot_ = std::move(current);
+
+        if (!changed && !changes.empty()) {
+            return collect_changes(changes);
+        }
+    }
+}
+
+#endif
+
+} // namespace kh::watching
@@ -0,0 +1,69 @@
+#ifndef WATCHING_H
+#define WATCHING_H
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace kh::watching {
+
+enum class ChangeKind : std::uint8_t {
+    Modified,
+    Removed
+};
+
+struct Change {
+    // NOTE(garrett): Relative to the watched root
+    std::filesystem::path path;
+    ChangeKind kind;
+};
+
+// NOTE(garrett): Reports changes to regular files anywhere below a directory.
+// On Linux this is driven by inotify, with watches added for directories as
+// they appear. Elsewhere the tree is polled and compared by modification time,
+// which is slower but needs nothing from the platform. Changes made after
+// construction are never missed, even when they happen between calls to
+// `wait`. Moving a directory out of the tree reports every file below it as
+// removed.
+class Watcher {
+private:
+    std::filesystem::path root_;
+#if defined(__linux__)
+    int descriptor_;
+    std::unordered_map<int, std::filesystem::path> directories_;
+    // NOTE(garrett): Every file known to be in the tree, so that files below
+    // a directory that's moved away can be reported without events of their own
+    std::set<std::filesystem::path> files_;
+
+    auto add_watches(
+        const std::filesystem::path& relative,
+        std::map<std::filesystem::path, ChangeKind>* changes) -> void;
+    auto remove_watches(
+        const std::filesystem::path& relative,
+        std::map<std::filesystem::path, ChangeKind>& changes) -> void;
+    auto rescan(std::map<std::filesystem::path, ChangeKind>& changes) -> void;
+#else
+    std::map<std::filesystem::path, std::filesystem::file_time_type> snapshot_;
+
+    auto scan() const -> std::map<std::filesystem::path, std::filesystem::file_time_type>;
+#endif
+public:
+    explicit Watcher(const std::filesystem::path& root);
+    Watcher(const Watcher&) = delete;
+    auto operator=(const Watcher&) -> Watcher& = delete;
+    ~Watcher();
+
+    // NOTE(garrett): Blocks until something changes, then keeps collecting
+    // until nothing further happens for `quiet`, so a burst of writes from a
+    // compiler is reported once. Each path appears at most once, with its
+    // latest state.
+    auto wait(std::chrono::milliseconds quiet) -> std::vector<Change>;
+};
+
+} // namespace kh::watching
+
+#endif // WATCHING_H
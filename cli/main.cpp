@@ -1,9 +1,25 @@
+#include <algorithm>
 #include <filesystem>
+#include <map>
+#include <mutex>
+#include <ranges>
+
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "argparse.h"
+#include "batch.h"
+#include "classindex.h"
+#include "corpus.h"
+#include "hashing.h"
+#include "instrumentation.h"
 #include "parsing.h"
+#include "registry.h"
 #include "serialization.h"
+#include "streaming.h"
+#include "verification.h"
 #include "views.h"
+#include "watching.h"
 
 constexpr auto jdk_version(
         const kh::jvm::classfile::Version version) noexcept -> uint8_t {
@@ -67,19 +83,7 @@ auto attachment_targets() -> kh::argparse::CommandResult {
     return {};
 }
 
-auto inspect_class_file(std::string_view target) -> kh::argparse::CommandResult {
-    const auto result = kh::jvm::parsing::load_class_from_file(target);
-
-    if (!result) {
-        return kh::argparse::fatal(
-            std::format(
-                "Failed to parse class from file ({})",
-                target
-            )
-        );
-    }
-
-    const auto& klass = result.value().class_file;
+auto print_class_file(const kh::jvm::classfile::ClassFile& klass) -> void {
     const auto class_view = kh::jvm::views::ClassView{klass};
 
     std::println("Class File Overview:");
@@ -107,12 +111,16 @@ auto inspect_class_file(std::string_view target) -> kh::argparse::CommandResult
     if (entries.size() > 0) {
         std::println("Constant Pool Entries:");
 
-        for (auto i = 0uz; i < entries.size(); ++i) {
+        auto index = 1uz;
+
+        for (const auto& entry : entries) {
             std::println(
                 "  {:>2}#: [{}]",
-                i + 1,
-                kh::jvm::constant_pool::name(entries[i])
+                index,
+                kh::jvm::constant_pool::name(entry)
             );
+
+            index += kh::jvm::constant_pool::is_wide(entry) ? 2 : 1;
         }
     }
 
@@ -139,11 +147,62 @@ auto inspect_class_file(std::string_view target) -> kh::argparse::CommandResult
             );
         }
     }
+}
+
+// NOTE(garrett): Directories and jars are streamed a class at a time, so any
+// number of classes can be inspected in constant memory
+auto inspect_classes(const std::filesystem::path& path) -> kh::argparse::CommandResult {
+    auto failures = 0uz;
+
+    for (const auto& streamed : kh::jvm::streaming::stream(path)) {
+        if (!streamed.klass) {
+            std::println(
+                stderr,
+                "  {}: {}",
+                streamed.name,
+                kh::jvm::streaming::name(streamed.klass.error())
+            );
+
+            ++failures;
+            continue;
+        }
+
+        std::println("{}:", streamed.name);
+        print_class_file(streamed.klass.value());
+    }
+
+    if (failures) {
+        return kh::argparse::fatal(
+            std::format("{} class(es) could not be read or parsed", failures)
+        );
+    }
 
     return {};
 }
 
-auto write_modified_class(std::string_view target) -> kh::argparse::CommandResult {
+auto inspect_class_file(std::string_view target) -> kh::argparse::CommandResult {
+    const auto path = std::filesystem::path{target};
+
+    if (std::filesystem::is_directory(path) || path.extension() == ".jar") {
+        return inspect_classes(path);
+    }
+
+    const auto result = kh::jvm::parsing::load_class_from_file(target);
+
+    if (!result) {
+        return kh::argparse::fatal(
+            std::format(
+                "Failed to parse class from file ({})",
+                target
+            )
+        );
+    }
+
+    print_class_file(result.value().class_file);
+    return {};
+}
+
+auto verify_class_file(std::string_view target) -> kh::argparse::CommandResult {
     const auto result = kh::jvm::parsing::load_class_from_file(target);
 
     if (!result) {
@@ -156,6 +215,44 @@ auto write_modified_class(std::string_view target) -> kh::argparse::CommandResul
     }
 
     const auto& klass = result.value().class_file;
+    const auto failures = kh::jvm::verification::verify(klass);
+
+    for (const auto& failure : failures) {
+        std::println(
+            stderr,
+            "  {} @ {}: {}",
+            kh::jvm::views::MethodView{
+                klass.constant_pool,
+                klass.methods[failure.method_index]
+            }.name(),
+            failure.offset,
+            kh::jvm::verification::name(failure.error)
+        );
+    }
+
+    if (!failures.empty()) {
+        return kh::argparse::fatal(
+            std::format("Verification failed for {} method(s)", failures.size())
+        );
+    }
+
+    return {};
+}
+
+auto write_modified_class(std::string_view target) -> kh::argparse::CommandResult {
+    auto result = kh::jvm::parsing::load_class_from_file(target);
+
+    if (!result) {
+        return kh::argparse::fatal(
+            std::format(
+                "Failed to parse class from file ({})",
+                target
+            )
+        );
+    }
+
+    auto& loaded = result.value();
+    const auto& klass = loaded.class_file;
     const auto class_view = kh::jvm::views::ClassView{klass};
     const auto method = class_view.method("main");
 
@@ -169,40 +266,684 @@ auto write_modified_class(std::string_view target) -> kh::argparse::CommandResul
         return kh::argparse::fatal("Could not find code attribute for method");
     }
 
-    // TODO(garrett): Modify code attribute
+    const auto probes = kh::jvm::instrumentation::add_latency_probes(
+        loaded.class_file,
+        loaded.arena,
+        kh::jvm::instrumentation::LatencyOptions{.methods = {"main"}}
+    );
+
+    if (!probes) {
+        return kh::argparse::fatal("Failed to add latency probes to main method");
+    }
 
     const auto source_path = std::filesystem::path{target};
 
     const auto destination_path = source_path.parent_path()
         / (source_path.stem().string() + "Modified.class");
 
-    std::ofstream stream{destination_path};
+    const auto descriptor = ::open(
+        destination_path.c_str(),
+        O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+        0644
+    );
 
-    if (!stream) {
+    if (descriptor < 0) {
         return kh::argparse::fatal(
             std::format("Failed to open requested file ({})", destination_path.string())
         );
     }
 
-    kh::sinks::FileSink sink{stream};
-    kh::jvm::serialization::serialize(sink, klass);
+    // NOTE(garrett): A partially written class is removed rather than left
+    // behind for the JVM to reject later
+    auto error = std::error_code{};
+
+    try {
+        kh::sinks::VectoredSink sink{descriptor};
+        kh::jvm::serialization::serialize(sink, klass);
+        sink.flush();
+    } catch (const std::system_error&) {
+        ::close(descriptor);
+        std::filesystem::remove(destination_path, error);
+
+        return kh::argparse::fatal(
+            std::format("Failed to write requested file ({})", destination_path.string())
+        );
+    }
+
+    if (::close(descriptor) < 0) {
+        std::filesystem::remove(destination_path, error);
+
+        return kh::argparse::fatal(
+            std::format("Failed to write requested file ({})", destination_path.string())
+        );
+    }
+
+    return {};
+}
+
+// NOTE(garrett): Follows the XDG base directory layout, which macOS tooling
+// commonly honours as well
+auto cache_directory() -> std::optional<std::filesystem::path> {
+    if (const auto cache_home = std::getenv("XDG_CACHE_HOME"); cache_home && *cache_home) {
+        return std::filesystem::path{cache_home} / "keyhole";
+    }
+
+    if (const auto home = std::getenv("HOME"); home && *home) {
+        return std::filesystem::path{home} / ".cache" / "keyhole";
+    }
+
+    return std::nullopt;
+}
+
+// NOTE(garrett): Answers from an index of the classpath kept in the cache
+// directory, one per distinct `CLASSPATH`, which is only refreshed when files on
+// it have changed since it was built
+auto find_class(std::string_view target) -> kh::argparse::CommandResult {
+    const auto cache_path = cache_directory();
+
+    if (!cache_path) {
+        return kh::argparse::fatal("No cache directory could be determined");
+    }
+
+    const auto variable = std::getenv("CLASSPATH");
+    const auto classpath_text = std::string_view{variable && *variable ? variable : "."};
+    auto classpath = std::vector<std::filesystem::path>{};
+    auto key = std::string{};
+
+    // NOTE(garrett): Elements are resolved to absolute, canonical paths, so a
+    // relative classpath never picks up an index built from another working
+    // directory, and spellings of the same classpath share one
+    for (const auto element : std::views::split(classpath_text, ':')) {
+        if (element.empty()) {
+            continue;
+        }
+
+        auto error = std::error_code{};
+        auto path = std::filesystem::absolute(
+            std::string_view{element.begin(), element.end()},
+            error
+        );
+
+        if (auto canonical = std::filesystem::weakly_canonical(path, error); !error) {
+            path = std::move(canonical);
+        }
+
+        key.append(path.native()).push_back('\0');
+        classpath.push_back(std::move(path));
+    }
+
+    const auto index_path = *cache_path / std::format(
+        "classpath-{:016x}.index",
+        kh::hashing::xxh64(std::as_bytes(std::span{key}))
+    );
+
+    auto index = kh::jvm::classindex::Index::open(index_path);
+
+    if (!index || !index->changed().empty()) {
+        const auto bytes = kh::jvm::classindex::build(classpath, index ? &index.value() : nullptr);
+
+        if (const auto written = kh::jvm::classindex::write(index_path, bytes); !written) {
+            return kh::argparse::fatal(
+                std::format(
+                    "{} ({})",
+                    kh::jvm::classindex::name(written.error()),
+                    index_path.string()
+                )
+            );
+        }
+
+        index = kh::jvm::classindex::Index::open(index_path);
+
+        if (!index) {
+            return kh::argparse::fatal(
+                std::format(
+                    "{} ({})",
+                    kh::jvm::classindex::name(index.error()),
+                    index_path.string()
+                )
+            );
+        }
+    }
+
+    auto name = std::string{target};
+    std::ranges::replace(name, '.', '/');
+
+    const auto klass = index->find(name);
+
+    if (!klass) {
+        return kh::argparse::fatal(
+            std::format("Class ({}) was not found on the classpath", target)
+        );
+    }
+
+    std::println(
+        "{} in {} at offset {} ({} bytes)",
+        klass->name,
+        index->file(klass->file).path,
+        klass->offset,
+        klass->size
+    );
+
+    if (!klass->superclass.empty()) {
+        std::println("  Extends {}", klass->superclass);
+    }
+
+    for (auto i = 0uz; i < klass->interface_count; ++i) {
+        std::println("  Implements {}", index->interface(klass.value(), i));
+    }
+
+    for (auto i = 0uz; i < klass->method_count; ++i) {
+        const auto method = index->method(klass.value(), i);
+        std::println("  Method {}{}", method.name, method.descriptor);
+    }
 
     return {};
 }
 
+// NOTE(garrett): Results cached by `modify-classes` are evicted past this
+constexpr auto cache_capacity = std::uint64_t{1u} << 30u;
+
+// NOTE(garrett): Trailing separators, `.` and `..` would otherwise leave the
+// name outputs are derived from empty, or point it back into the input
+auto normalized(const std::filesystem::path& path) -> std::optional<std::filesystem::path> {
+    auto error = std::error_code{};
+    auto canonical = std::filesystem::canonical(path, error);
+
+    if (error) {
+        return std::nullopt;
+    }
+
+    if (!canonical.has_filename()) {
+        canonical = canonical.parent_path();
+    }
+
+    return canonical;
+}
+
+// NOTE(garrett): Mirrors `modify-class`, leaving classes without a main method
+// untouched
+auto latency_transforms() -> std::array<kh::jvm::batch::Transform, 1> {
+    return std::to_array<kh::jvm::batch::Transform>({
+        kh::jvm::batch::Transform{
+            "latency",
+            [](kh::jvm::classfile::ClassFile& klass, kh::arena::Arena& arena) {
+                if (!kh::jvm::views::ClassView{klass}.method("main")) {
+                    return true;
+                }
+
+                return kh::jvm::instrumentation::add_latency_probes(
+                    klass,
+                    arena,
+                    kh::jvm::instrumentation::LatencyOptions{.methods = {"main"}}
+                ).has_value();
+            },
+            // NOTE(garrett): Bump whenever the probes emitted change
+            1u
+        }
+    });
+}
+
+auto write_modified_classes(std::string_view target) -> kh::argparse::CommandResult {
+    const auto normalized_path = normalized(target);
+
+    if (!normalized_path) {
+        return kh::argparse::fatal(
+            std::format("Requested path ({}) does not exist", target)
+        );
+    }
+
+    const auto& source_path = normalized_path.value();
+
+    const auto source_name = std::filesystem::is_directory(source_path)
+        ? source_path.filename().string()
+        : source_path.stem().string();
+
+    const auto destination_path = source_path.parent_path()
+        / (source_name + "Modified.jar");
+
+    const auto descriptor = ::open(
+        destination_path.c_str(),
+        O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+        0644
+    );
+
+    if (descriptor < 0) {
+        return kh::argparse::fatal(
+            std::format("Failed to open requested file ({})", destination_path.string())
+        );
+    }
+
+    const auto transforms = latency_transforms();
+    const auto cache_path = cache_directory();
+    auto cache = std::optional<kh::cache::Cache>{};
+
+    // NOTE(garrett): The cache only saves work, so one that can't be opened
+    // is reported and the run goes ahead without it
+    if (cache_path) {
+        try {
+            cache.emplace(*cache_path, cache_capacity);
+        } catch (const std::system_error& error) {
+            std::println(stderr, "Continuing without a cache: {}", error.what());
+        }
+    }
+
+    auto pool = kh::threading::ThreadPool{};
+    auto writer = kh::jvm::jar::Writer{descriptor, pool};
+    const auto report = kh::jvm::batch::run(
+        source_path,
+        transforms,
+        writer,
+        pool,
+        cache ? &cache.value() : nullptr
+    );
+    const auto finished = report ? writer.finish() : std::unexpected(report.error());
+    const auto closed = ::close(descriptor) == 0;
+
+    // NOTE(garrett): A truncated archive is removed rather than left behind
+    auto error = std::error_code{};
+
+    if (!report) {
+        std::filesystem::remove(destination_path, error);
+
+        return kh::argparse::fatal(
+            std::format("Failed to process classes from ({})", source_path.string())
+        );
+    }
+
+    if (!finished || !closed) {
+        std::filesystem::remove(destination_path, error);
+
+        return kh::argparse::fatal(
+            std::format("Failed to write archive ({})", destination_path.string())
+        );
+    }
+
+    for (const auto& failure : report->failures) {
+        std::println(
+            stderr,
+            "  {}: {}",
+            failure.name,
+            kh::jvm::batch::name(failure.error)
+        );
+    }
+
+    const auto seconds = std::chrono::duration<double>{report->elapsed}.count();
+
+    std::println(
+        "Modified {} class(es), {} cached, in {:.3f}s "
+        "({:.0f} classes/s, {:.1f} MiB/s) on {} worker(s)",
+        report->classes,
+        report->cached,
+        seconds,
+        static_cast<double>(report->classes) / seconds,
+        static_cast<double>(report->input_bytes) / (1024.0 * 1024.0) / seconds,
+        pool.size()
+    );
+
+    for (auto i = 0uz; i < report->stages.size(); ++i) {
+        std::println(
+            "  {:<9} - {:.3f}s",
+            kh::jvm::batch::name(static_cast<kh::jvm::batch::Stage>(i)),
+            std::chrono::duration<double>{report->stages[i]}.count()
+        );
+    }
+
+    if (!report->failures.empty()) {
+        return kh::argparse::fatal(
+            std::format("{} class(es) were copied without modification", report->failures.size())
+        );
+    }
+
+    return {};
+}
+
+auto parse_classes(std::string_view target) -> kh::argparse::CommandResult {
+    const auto source_path = std::filesystem::path{target};
+
+    if (!std::filesystem::exists(source_path)) {
+        return kh::argparse::fatal(
+            std::format("Requested path ({}) does not exist", target)
+        );
+    }
+
+    auto pool = kh::threading::ThreadPool{};
+    const auto report = kh::jvm::corpus::parse(
+        std::span{&source_path, 1u},
+        pool,
+        [](const auto& source, const auto& klass, auto&) {
+            if (!klass) {
+                std::println(stderr, "  {}: Class file could not be parsed", source.name);
+            }
+        }
+    );
+
+    const auto seconds = std::chrono::duration<double>{report.elapsed}.count();
+
+    std::println(
+        "Parsed {} class(es) in {:.3f}s ({:.0f} classes/s, {:.1f} MiB/s) on {} worker(s)",
+        report.classes,
+        seconds,
+        static_cast<double>(report.classes) / seconds,
+        static_cast<double>(report.bytes) / (1024.0 * 1024.0) / seconds,
+        pool.size()
+    );
+
+    if (report.failures) {
+        return kh::argparse::fatal(
+            std::format("{} class(es) could not be read or parsed", report.failures)
+        );
+    }
+
+    return {};
+}
+
+// NOTE(garrett): Class bytes are gathered up front, so only registering and
+// looking classes up is timed, with every worker hitting the registry at once
+auto register_classes(std::string_view target) -> kh::argparse::CommandResult {
+    const auto source_path = std::filesystem::path{target};
+
+    if (!std::filesystem::exists(source_path)) {
+        return kh::argparse::fatal(
+            std::format("Requested path ({}) does not exist", target)
+        );
+    }
+
+    auto pool = kh::threading::ThreadPool{};
+    auto mutex = std::mutex{};
+    auto classes = std::vector<std::vector<std::byte>>{};
+
+    kh::jvm::corpus::parse(
+        std::span{&source_path, 1u},
+        pool,
+        [&mutex, &classes](const auto& source, const auto& klass, auto&) {
+            if (klass) {
+                const auto lock = std::lock_guard{mutex};
+                classes.emplace_back(source.bytes.begin(), source.bytes.end());
+            }
+        }
+    );
+
+    auto registry = kh::jvm::registry::Registry{};
+    auto entries = std::vector<const kh::jvm::registry::Entry*>(classes.size());
+    auto duplicates = std::atomic<std::size_t>{0u};
+
+    // NOTE(garrett): Runs `work` on a stripe of the classes per worker
+    auto time_striped = [&pool, &classes](const auto& work) {
+        const auto start = std::chrono::steady_clock::now();
+        auto futures = std::vector<std::future<void>>{};
+
+        for (auto worker = 0uz; worker < pool.size(); ++worker) {
+            futures.push_back(pool.submit([&work, &classes, &pool, worker] {
+                for (auto i = worker; i < classes.size(); i += pool.size()) {
+                    work(i);
+                }
+            }));
+        }
+
+        for (auto& future : futures) {
+            future.get();
+        }
+
+        return std::chrono::duration<double>{std::chrono::steady_clock::now() - start}.count();
+    };
+
+    const auto inserting = time_striped([&registry, &classes, &entries, &duplicates](auto i) {
+        const auto inserted = registry.insert(0u, std::move(classes[i]));
+
+        if (!inserted) {
+            return;
+        }
+
+        entries[i] = inserted->first;
+
+        if (!inserted->second) {
+            ++duplicates;
+        }
+    });
+
+    auto misses = std::atomic<std::size_t>{0u};
+
+    const auto looking_up = time_striped([&registry, &entries, &misses](auto i) {
+        if (entries[i] && registry.find(0u, entries[i]->name) != entries[i]) {
+            ++misses;
+        }
+    });
+
+    std::println(
+        "Registered {} class(es) in {:.3f}s ({:.0f} classes/s) on {} worker(s)",
+        registry.size(),
+        inserting,
+        static_cast<double>(classes.size()) / inserting,
+        pool.size()
+    );
+
+    std::println(
+        "Looked up {} class(es) in {:.3f}s ({:.0f} lookups/s)",
+        registry.size(),
+        looking_up,
+        static_cast<double>(classes.size()) / looking_up
+    );
+
+    if (duplicates) {
+        std::println("  {} class(es) shared a name with one already registered", duplicates.load());
+    }
+
+    if (misses) {
+        return kh::argparse::fatal(
+            std::format("{} registered class(es) could not be found", misses.load())
+        );
+    }
+
+    return {};
+}
+
+// NOTE(garrett): Written beside the destination and renamed over it, so readers
+// never observe a partially written class
+auto replace_file(
+        const std::filesystem::path& destination,
+        std::span<const std::byte> contents) -> bool {
+    auto temporary = destination;
+    temporary += ".tmp";
+
+    auto error = std::error_code{};
+    std::filesystem::create_directories(destination.parent_path(), error);
+
+    if (error) {
+        return false;
+    }
+
+    const auto descriptor = ::open(
+        temporary.c_str(),
+        O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+        0644
+    );
+
+    if (descriptor < 0) {
+        return false;
+    }
+
+    try {
+        kh::sinks::VectoredSink sink{descriptor};
+        sink.write_bytes(contents);
+        sink.flush();
+    } catch (const std::system_error&) {
+        ::close(descriptor);
+        std::filesystem::remove(temporary, error);
+
+        return false;
+    }
+
+    if (::close(descriptor) < 0) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+
+    std::filesystem::rename(temporary, destination, error);
+
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+
+    return true;
+}
+
+auto watch_classes(std::string_view target) -> kh::argparse::CommandResult {
+    const auto normalized_path = normalized(target);
+
+    if (!normalized_path || !std::filesystem::is_directory(normalized_path.value())) {
+        return kh::argparse::fatal(
+            std::format("Requested path ({}) is not a directory", target)
+        );
+    }
+
+    const auto& source_path = normalized_path.value();
+    const auto destination_path = source_path.parent_path()
+        / (source_path.filename().string() + "Modified");
+
+    // NOTE(garrett): Outputs written inside the watched tree would be seen as
+    // changes and written again one level deeper, without end
+    if (std::ranges::mismatch(source_path, destination_path).in1 == source_path.end()) {
+        return kh::argparse::fatal(
+            std::format(
+                "Output directory ({}) would be inside the watched directory",
+                destination_path.string()
+            )
+        );
+    }
+
+    const auto transforms = latency_transforms();
+
+    // NOTE(garrett): Every class as its output was last written, so files that
+    // a build rewrites with the same bytes aren't instrumented and written again
+    auto classes = std::map<std::filesystem::path, kh::jvm::parsing::LoadedClass>{};
+
+    // NOTE(garrett): Each class is handled on its own, so one that fails to
+    // load, instrument or write is reported without ending the session. The
+    // file may also be gone again by the time its change is handled.
+    const auto update = [&](const std::filesystem::path& relative) -> bool {
+        try {
+            auto loaded = kh::jvm::parsing::load_class_from_file(source_path / relative);
+
+            if (!loaded) {
+                std::println(stderr, "  {}: Failed to parse class", relative.string());
+                return false;
+            }
+
+            const auto warm = classes.find(relative);
+
+            if (warm != classes.end() && warm->second.raw == loaded->raw) {
+                return true;
+            }
+
+            auto klass = loaded->class_file;
+            auto arena = kh::arena::Arena{};
+            auto output = std::vector<std::byte>{};
+
+            const auto applied = std::ranges::all_of(transforms, [&](const auto& transform) {
+                return transform.apply(klass, arena);
+            });
+
+            if (applied) {
+                output.resize(kh::jvm::serialization::serialized_size(klass));
+
+                auto sink = kh::sinks::SpanSink{output};
+                kh::jvm::serialization::serialize(sink, klass);
+            } else {
+                std::println(stderr, "  {}: Failed to instrument class", relative.string());
+                output = loaded->raw;
+            }
+
+            if (!replace_file(destination_path / relative, output)) {
+                std::println(stderr, "  {}: Failed to write class", relative.string());
+                return false;
+            }
+
+            classes.insert_or_assign(relative, std::move(loaded.value()));
+            return true;
+        } catch (const std::exception& error) {
+            std::println(stderr, "  {}: {}", relative.string(), error.what());
+            return false;
+        }
+    };
+
+    // NOTE(garrett): Watches are in place before the initial pass, so nothing
+    // written during it is missed
+    auto watcher = kh::watching::Watcher{source_path};
+    auto watched = 0uz;
+
+    for (const auto& relative : kh::jvm::batch::collect(source_path)) {
+        watched += update(relative);
+    }
+
+    std::println(
+        "Watching {} class(es), writing to {}",
+        watched,
+        destination_path.string()
+    );
+
+    while (true) {
+        const auto changes = watcher.wait(std::chrono::milliseconds{30});
+        const auto start = std::chrono::steady_clock::now();
+        auto count = 0uz;
+
+        for (const auto& change : changes) {
+            if (change.path.extension() != ".class") {
+                continue;
+            }
+
+            if (change.kind == kh::watching::ChangeKind::Removed) {
+                auto error = std::error_code{};
+                classes.erase(change.path);
+                std::filesystem::remove(destination_path / change.path, error);
+
+                if (error) {
+                    std::println(stderr, "  {}: Failed to remove class", change.path.string());
+                }
+            } else {
+                update(change.path);
+            }
+
+            ++count;
+        }
+
+        if (count) {
+            std::println(
+                "Updated {} class(es) in {:.1f}ms",
+                count,
+                std::chrono::duration<double, std::milli>{
+                    std::chrono::steady_clock::now() - start
+                }.count()
+            );
+        }
+    }
+}
+
 auto main(const int argc, const char** argv) -> int {
     using AttachmentTargetsCommand = kh::argparse::Command<
         "attachment-targets", ::attachment_targets
     >;
 
+    using FindCommand = kh::argparse::Command<"find-class", ::find_class>;
     using InspectCommand = kh::argparse::Command<"inspect", ::inspect_class_file>;
     using ModifyCommand = kh::argparse::Command<"modify-class", ::write_modified_class>;
+    using ModifyAllCommand = kh::argparse::Command<"modify-classes", ::write_modified_classes>;
+    using ParseCommand = kh::argparse::Command<"parse-classes", ::parse_classes>;
+    using RegisterCommand = kh::argparse::Command<"register-classes", ::register_classes>;
+    using VerifyCommand = kh::argparse::Command<"verify", ::verify_class_file>;
+    using WatchCommand = kh::argparse::Command<"watch", ::watch_classes>;
 
     try {
         const auto result = kh::argparse::CLI<
             AttachmentTargetsCommand,
+            FindCommand,
             InspectCommand,
-            ModifyCommand
+            ModifyCommand,
+            ModifyAllCommand,
+            ParseCommand,
+            RegisterCommand,
+            VerifyCommand,
+            WatchCommand
         >{
             .name = "KeyHole CLI",
             .version = "0.1.0",